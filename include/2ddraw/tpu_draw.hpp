@@ -2,6 +2,8 @@
 #include "core.hpp"
 #include "cvi_draw_ive.h"
 
+#include <vector>
+
 inline void getYUVColorLimitedUV(IVE_COLOR_S &color, uint8_t *out) {
   // clang-format off
   out[0] =  (0.257 * color.r) + (0.504 * color.g) + (0.098 * color.b) + 16;  // Y
@@ -10,8 +12,33 @@ inline void getYUVColorLimitedUV(IVE_COLOR_S &color, uint8_t *out) {
   // clang-format on
 }
 
-class IveTPUDrawHollowRect {
+/**
+ * @brief A constant fill of one plane, laid out as a TDMA global tensor. w bytes are contiguous,
+ *        the other dimensions step by their stride in bytes.
+ *
+ */
+struct DrawFill {
+  uint32_t plane;
+  uint32_t offset;
+  uint32_t n, c, h, w;
+  uint32_t stride_n, stride_c, stride_h;
+  uint8_t value;
+};
+
+/**
+ * @brief Build the fills of hollow rectangles on an image. The same list is executed by the TPU
+ *        and the CPU, so both give the same pixels.
+ *
+ * @param items Rectangles with their colour and thickness, colours are RGB.
+ * @param num Number of rectangles.
+ * @param output Destination image, used for its type, size and strides.
+ * @param fills Output fills, no dimension is larger than a TDMA fill allows.
+ * @return int Return CVI_SUCCESS if the image type is supported.
+ */
+int genDrawRectFills(const IVE_DRAW_RECT_ITEM_S *items, uint32_t num, const CviImg &output,
+                     std::vector<DrawFill> *fills);
+
+class IveTPUDrawFill {
  public:
-  static int addCmd(cvk_context_t *cvk_ctx, uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2,
-                    uint8_t *color, CviImg &output);
-};
\ No newline at end of file
+  static void addCmd(cvk_context_t *cvk_ctx, const DrawFill &fill, const CviImg &output);
+};
@@ -17,6 +17,12 @@ class IveCore {
   int run(CVI_RT_HANDLE rt_handle, cvk_context_t *cvk_ctx, const std::vector<CviImg *> &input,
           std::vector<CviImg *> &output, bool legacy_mode = false);
   void set_force_alignment(bool alignment) { m_force_addr_align_ = alignment; }
+  // While set, run() leaves its commands in the command buffer so that several runs share one
+  // submission. submitDeferred() submits them and runs postProcess once.
+  void set_defer_submit(bool defer) { m_defer_submit = defer; }
+  int submitDeferred(CVI_RT_HANDLE rt_handle, cvk_context_t *cvk_ctx);
+  // Runs postProcess without a submission, as a failed run() does, once a deferred run failed.
+  int dropDeferred(CVI_RT_HANDLE rt_handle);
 
  protected:
   cvk_tl_t *allocTLMem(cvk_context_t *cvk_ctx, cvk_tl_shape_t tl_shape, cvk_fmt_t fmt, int eu_align,
@@ -69,4 +75,5 @@ class IveCore {
   cvk_chip_info_t m_chip_info;
   uint32_t m_table_per_channel_size = 0;
   bool m_force_addr_align_ = false;
+  bool m_defer_submit = false;
 };
\ No newline at end of file
@@ -159,6 +159,34 @@ typedef struct IVE_HOG_CTRL {
   CVI_U16 u16BlkStepY;
 } IVE_HOG_CTRL_S;
 
+/*
+ * Linear SVM model used by HOG detector. stWeight stores u32FeatureLen floats.
+ */
+typedef struct IVE_HOG_SVM_MODEL {
+  CVI_U32 u32FeatureLen;
+  CVI_FLOAT f32Bias;
+  IVE_MEM_INFO_S stWeight;
+} IVE_HOG_SVM_MODEL_S;
+
+typedef struct IVE_HOG_DETECT_CTRL {
+  IVE_HOG_CTRL_S stHogCtrl;
+  CVI_U16 u16WinWidth;      /* Detection window width in pixels, multiple of cell size */
+  CVI_U16 u16WinHeight;     /* Detection window height in pixels, multiple of cell size */
+  CVI_U16 u16WinStepInBlkX; /* Window step in units of block step */
+  CVI_U16 u16WinStepInBlkY; /* Window step in units of block step */
+  CVI_FLOAT f32Threshold;   /* Minimum SVM score of an output box */
+  CVI_U8 u8ScaleNum;        /* Number of pyramid levels, 1 for single scale */
+  CVI_FLOAT f32ScaleFactor; /* Downscale factor between two pyramid levels, > 1 */
+} IVE_HOG_DETECT_CTRL_S;
+
+typedef struct IVE_HOG_DETECT_BOX {
+  CVI_U16 u16X;
+  CVI_U16 u16Y;
+  CVI_U16 u16Width;
+  CVI_U16 u16Height;
+  CVI_FLOAT f32Score;
+} IVE_HOG_DETECT_BOX_S;
+
 typedef enum IVE_MAG_AND_ANG_OUT_CTRL {
   IVE_MAG_AND_ANG_OUT_CTRL_MAG = 0x0,
   IVE_MAG_AND_ANG_OUT_CTRL_ANG = 0x1,
@@ -199,12 +227,14 @@ typedef struct IVE_NORM_GRAD_CTRL {
 typedef enum IVE_ORD_STAT_FILTER_MODE {
   IVE_ORD_STAT_FILTER_MODE_MAX = 0x0,
   IVE_ORD_STAT_FILTER_MODE_MIN = 0x1,
+  IVE_ORD_STAT_FILTER_MODE_MEDIAN = 0x2,
 
   IVE_ORD_STAT_FILTER_MODE_BUTT
 } IVE_ORD_STAT_FILTER_MODE_E;
 
 typedef struct IVE_ORD_STAT_FILTER_CTRL {
   IVE_ORD_STAT_FILTER_MODE_E enMode;
+  CVI_U8 u8KernelSize; /*Odd window size, 0 keeps the legacy 3x3. Median supports 3 and 5*/
 } IVE_ORD_STAT_FILTER_CTRL_S;
 
 /*
@@ -377,6 +407,269 @@ typedef struct cviIVE_LBP_CTRL_S {
   IVE_8BIT_U un8BitThr;
 } IVE_LBP_CTRL_S;
 
+typedef struct cviIVE_STATS_ROI_S {
+  CVI_U16 u16X;
+  CVI_U16 u16Y;
+  CVI_U16 u16Width;
+  CVI_U16 u16Height;
+} IVE_STATS_ROI_S;
+
+typedef struct cviIVE_STATS_CTRL_S {
+  IVE_STATS_ROI_S *pstRoi; /*Optional ROI list, the whole image is used if u32RoiNum is 0*/
+  CVI_U32 u32RoiNum;
+} IVE_STATS_CTRL_S;
+
+typedef struct cviIVE_STATS_S {
+  CVI_DOUBLE dSum;
+  CVI_DOUBLE dSqSum;
+  CVI_FLOAT f32Mean;
+  CVI_FLOAT f32Stddev; /*Population standard deviation*/
+  CVI_FLOAT f32Min;
+  CVI_FLOAT f32Max;
+  CVI_U16 u16MinX; /*First location of min and max in raster order, in image coordinates*/
+  CVI_U16 u16MinY;
+  CVI_U16 u16MaxX;
+  CVI_U16 u16MaxY;
+  CVI_U32 u32Count; /*Number of pixels taken, the others are 0 if it is 0*/
+} IVE_STATS_S;
+
+typedef struct cviIVE_SEQ_READER_S {
+  IVE_IMAGE_TYPE_E enType; /*Frame type, taken from the header for Y4M*/
+  CVI_U32 u32Width;
+  CVI_U32 u32Height;
+  CVI_U32 u32FrameNum; /*Number of complete frames in the file*/
+  void *pvCtx;         /*Internal state, do not touch*/
+} IVE_SEQ_READER_S;
+
+typedef enum IVE_WRITE_FORMAT {
+  IVE_WRITE_FORMAT_AUTO = 0x0, /*From the file extension, PNG if unknown*/
+  IVE_WRITE_FORMAT_PNG = 0x1,
+  IVE_WRITE_FORMAT_PNM = 0x2, /*PGM for one channel, PPM for three channels*/
+  IVE_WRITE_FORMAT_RAW = 0x3, /*Planes without padding, readable by CVI_IVE_OpenSeqReader*/
+  IVE_WRITE_FORMAT_BUTT
+} IVE_WRITE_FORMAT_E;
+
+typedef enum IVE_ASYNC_WRITE_POLICY {
+  IVE_ASYNC_WRITE_POLICY_DROP_NEWEST = 0x0, /*Reject the new image if the queue is full*/
+  IVE_ASYNC_WRITE_POLICY_DROP_OLDEST = 0x1, /*Discard the oldest pending image*/
+  IVE_ASYNC_WRITE_POLICY_BLOCK = 0x2,       /*Wait until the queue has room*/
+  IVE_ASYNC_WRITE_POLICY_BUTT
+} IVE_ASYNC_WRITE_POLICY_E;
+
+typedef struct IVE_ASYNC_WRITER_CTRL {
+  CVI_U32 u32QueueDepth; /*Maximum number of pending images, 0 means 4*/
+  IVE_ASYNC_WRITE_POLICY_E enPolicy;
+} IVE_ASYNC_WRITER_CTRL_S;
+
+typedef enum IVE_ROI_MODE {
+  IVE_ROI_MODE_AUTO = 0x0, /*CPU for tiny ROIs, TPU for the others*/
+  IVE_ROI_MODE_TPU = 0x1,
+  IVE_ROI_MODE_CPU = 0x2,
+  IVE_ROI_MODE_BUTT
+} IVE_ROI_MODE_E;
+
+typedef struct IVE_ROI {
+  CVI_U16 u16X;
+  CVI_U16 u16Y;
+  CVI_U16 u16Width;
+  CVI_U16 u16Height;
+} IVE_ROI_S;
+
+typedef struct IVE_ROI_LIST {
+  CVI_U32 u32Num;
+  IVE_ROI_S *pstRois; /*Must lie inside the images, the same rectangle on every image*/
+  IVE_ROI_MODE_E enMode;
+} IVE_ROI_LIST_S;
+
+typedef enum IVE_BG_MODEL_TYPE {
+  IVE_BG_MODEL_TYPE_RUNNING_AVG = 0x0, /*Exponential running average of the frames*/
+  IVE_BG_MODEL_TYPE_GMM = 0x1,         /*Mixture of IVE_BG_MODEL_GMM_NUM gaussians per pixel*/
+  IVE_BG_MODEL_TYPE_BUTT
+} IVE_BG_MODEL_TYPE_E;
+
+#define IVE_BG_MODEL_GMM_NUM 3
+
+typedef struct IVE_BG_MODEL {
+  IVE_BG_MODEL_TYPE_E enType;
+  CVI_U32 u32FrameNum; /*Frames learned so far, set to 0 to restart from the next frame*/
+  /*Running average: U16C1 background in UQ8.8.
+    GMM: FP32C1, IVE_BG_MODEL_GMM_NUM x (weight, mean, variance) planes stacked vertically*/
+  IVE_IMAGE_S stModel;
+} IVE_BG_MODEL_S;
+
+typedef struct IVE_BG_MODEL_CTRL {
+  CVI_FLOAT f32LearnRate; /*Weight of the new frame in [0, 1], at least 1 / (u32FrameNum + 1)*/
+  CVI_U8 u8DiffThr;       /*Running average: foreground if |frame - background| > u8DiffThr*/
+  CVI_FLOAT f32SigmaThr;  /*GMM: a mode matches within f32SigmaThr standard deviations*/
+  CVI_FLOAT f32BgRatio;   /*GMM: weight of the heaviest modes that form the background*/
+  CVI_FLOAT f32InitVar;   /*GMM: variance of a new mode, also the lower bound of variances*/
+} IVE_BG_MODEL_CTRL_S;
+
+typedef struct IVE_LK_POINT {
+  CVI_FLOAT f32X;
+  CVI_FLOAT f32Y;
+} IVE_LK_POINT_S;
+
+typedef struct IVE_LK_OPTICAL_FLOW_CTRL {
+  CVI_U8 u8MaxLevel;      /*Pyramid levels above the input resolution, up to 4*/
+  CVI_U8 u8WinSize;       /*Odd tracking window size in [5, 31]*/
+  CVI_U8 u8MaxIter;       /*Maximum iterations per pyramid level*/
+  CVI_FLOAT f32Eps;       /*Stop iterating when the update is shorter than f32Eps pixels*/
+  CVI_FLOAT f32MinEigThr; /*Lose points whose gradient matrix min eigenvalue / area is smaller*/
+} IVE_LK_OPTICAL_FLOW_CTRL_S;
+
+typedef struct IVE_STEREO_BM_CTRL {
+  CVI_U8 u8WinSize;         /*Odd SAD window size in [3, 15]*/
+  CVI_U16 u16NumDisp;       /*Search disparities [0, u16NumDisp), multiple of 16 up to 240*/
+  CVI_U8 u8UniquenessRatio; /*Reject if a far disparity costs less than best * (1 + ratio%)*/
+  CVI_S8 s8MaxLRDiff;       /*Maximum left right check difference, negative disables the check*/
+  CVI_U8 u8InvalidVal;      /*Disparity written for border and rejected pixels*/
+} IVE_STEREO_BM_CTRL_S;
+
+typedef struct IVE_MOTION_DETECT_CTRL {
+  CVI_U8 u8DiffThr;    /*Foreground if |cur - ref| > u8DiffThr*/
+  CVI_U8 u8ErodeSize;  /*Odd square erosion size up to 15, 0 or 1 disables*/
+  CVI_U8 u8DilateSize; /*Odd square dilation size up to 15 after the erosion, 0 or 1 disables*/
+  IVE_CC_DIR_E enMode; /*Blob connectivity*/
+  CVI_U32 u32MinArea;  /*Blobs with fewer foreground pixels are dropped*/
+} IVE_MOTION_DETECT_CTRL_S;
+
+typedef struct IVE_MOTION_BLOB {
+  CVI_U16 u16X;
+  CVI_U16 u16Y;
+  CVI_U16 u16Width;
+  CVI_U16 u16Height;
+  CVI_U32 u32Area; /*Foreground pixels of the blob*/
+} IVE_MOTION_BLOB_S;
+
+typedef struct IVE_CANNY_CTRL {
+  IVE_MAG_DIST_E enDistCtrl; /*L1 |gx| + |gy| or L2 sqrt(gx^2 + gy^2) magnitude*/
+  CVI_U16 u16LowThr;         /*Edge candidate if the magnitude > u16LowThr*/
+  CVI_U16 u16HighThr;        /*Edge seed if the magnitude > u16HighThr*/
+} IVE_CANNY_CTRL_S;
+
+typedef enum IVE_CORNER_TYPE {
+  IVE_CORNER_TYPE_HARRIS = 0x0,     /*det(M) - k * trace(M)^2 of the gradient matrix M*/
+  IVE_CORNER_TYPE_SHI_TOMASI = 0x1, /*Minimum eigenvalue of the gradient matrix M*/
+  IVE_CORNER_TYPE_FAST = 0x2,       /*FAST-9 segment test on a radius 3 circle*/
+  IVE_CORNER_TYPE_BUTT
+} IVE_CORNER_TYPE_E;
+
+typedef struct IVE_CORNER_CTRL {
+  IVE_CORNER_TYPE_E enType;
+  CVI_U8 u8BlockSize;   /*Harris and Shi-Tomasi: odd window of M in [3, 7]*/
+  CVI_FLOAT f32HarrisK; /*Harris: k, usually 0.04*/
+  /*Corners score higher. Harris and Shi-Tomasi: M of gradients normalized to [-1, 1] averaged
+    over the window. FAST: the largest contrast of a 9 pixel arc, an integer in [0, 255)*/
+  CVI_FLOAT f32Thr;
+  CVI_U16 u16CellSize; /*Keep only the best corner of each cell of this size, 0 disables*/
+} IVE_CORNER_CTRL_S;
+
+typedef struct IVE_CORNER {
+  CVI_U16 u16X;
+  CVI_U16 u16Y;
+  CVI_FLOAT f32Score;
+} IVE_CORNER_S;
+
+typedef enum IVE_BORDER_MODE {
+  IVE_BORDER_MODE_REPLICATE = 0x0,   /*aaa|abcd|ddd*/
+  IVE_BORDER_MODE_REFLECT_101 = 0x1, /*dcb|abcd|cba*/
+  IVE_BORDER_MODE_CONSTANT = 0x2,    /*vvv|abcd|vvv*/
+  IVE_BORDER_MODE_BUTT
+} IVE_BORDER_MODE_E;
+
+#define IVE_SEP_FILTER_MAX_SIZE 31
+
+typedef struct IVE_SEP_FILTER_CTRL {
+  CVI_U8 u8RowSize; /*Odd horizontal kernel size in [1, IVE_SEP_FILTER_MAX_SIZE]*/
+  CVI_U8 u8ColSize; /*Odd vertical kernel size in [1, IVE_SEP_FILTER_MAX_SIZE]*/
+  CVI_S16 as16RowMask[IVE_SEP_FILTER_MAX_SIZE];
+  CVI_S16 as16ColMask[IVE_SEP_FILTER_MAX_SIZE];
+  CVI_U8 u8RowShift; /*Rounding right shift of the row pass, saturated to 16 bits*/
+  CVI_U8 u8ColShift; /*Rounding right shift of the column pass, saturated to the output*/
+  IVE_BORDER_MODE_E enBorder;
+  CVI_U8 u8BorderVal; /*Pixels outside the image for IVE_BORDER_MODE_CONSTANT*/
+} IVE_SEP_FILTER_CTRL_S;
+
+typedef struct IVE_BOX_FILTER_CTRL {
+  CVI_U8 u8Width;  /*Odd window width in [1, 255]*/
+  CVI_U8 u8Height; /*Odd window height in [1, 255]*/
+  IVE_BORDER_MODE_E enBorder;
+  CVI_U8 u8BorderVal; /*Pixels outside the image for IVE_BORDER_MODE_CONSTANT*/
+} IVE_BOX_FILTER_CTRL_S;
+
+typedef enum IVE_MORPH_OP {
+  IVE_MORPH_OP_ERODE = 0x0,
+  IVE_MORPH_OP_DILATE = 0x1,
+  IVE_MORPH_OP_OPEN = 0x2,     /*Dilate(Erode(src))*/
+  IVE_MORPH_OP_CLOSE = 0x3,    /*Erode(Dilate(src))*/
+  IVE_MORPH_OP_GRADIENT = 0x4, /*Dilate(src) - Erode(src)*/
+  IVE_MORPH_OP_TOPHAT = 0x5,   /*src - Open(src)*/
+  IVE_MORPH_OP_BLACKHAT = 0x6, /*Close(src) - src*/
+  IVE_MORPH_OP_BUTT
+} IVE_MORPH_OP_E;
+
+typedef enum IVE_MORPH_SHAPE {
+  IVE_MORPH_SHAPE_RECT = 0x0,
+  IVE_MORPH_SHAPE_CROSS = 0x1, /*One pixel thick horizontal and vertical lines*/
+  /*Union of 4 centered rectangles with corners (W / 2 * cos(t), H / 2 * sin(t)) rounded to the
+    nearest integer, t = (2 * i + 1) * pi / 16 for i in [0, 4)*/
+  IVE_MORPH_SHAPE_ELLIPSE = 0x2,
+  IVE_MORPH_SHAPE_BUTT
+} IVE_MORPH_SHAPE_E;
+
+typedef struct IVE_MORPH_CTRL {
+  IVE_MORPH_OP_E enOp;
+  IVE_MORPH_SHAPE_E enShape;
+  CVI_U8 u8Width;  /*Odd structuring element width W in [1, 255]*/
+  CVI_U8 u8Height; /*Odd structuring element height H in [1, 255]*/
+} IVE_MORPH_CTRL_S;
+
+typedef enum IVE_DIST_TRANSFORM_TYPE {
+  IVE_DIST_TRANSFORM_TYPE_EUCLIDEAN = 0x0, /*Exact Euclidean distance*/
+  /*3x3 chamfer with weights 3 and 4 for the axial and diagonal steps, divided by 3*/
+  IVE_DIST_TRANSFORM_TYPE_CHAMFER = 0x1,
+  IVE_DIST_TRANSFORM_TYPE_BUTT
+} IVE_DIST_TRANSFORM_TYPE_E;
+
+typedef struct IVE_DIST_TRANSFORM_CTRL {
+  IVE_DIST_TRANSFORM_TYPE_E enType;
+} IVE_DIST_TRANSFORM_CTRL_S;
+
+typedef enum IVE_CONTOUR_APPROX {
+  IVE_CONTOUR_APPROX_NONE = 0x0,           /*Every border pixel*/
+  IVE_CONTOUR_APPROX_DOUGLAS_PEUCKER = 0x1, /*Douglas-Peucker simplification of the border*/
+  IVE_CONTOUR_APPROX_CONVEX_HULL = 0x2,     /*Convex hull of the border, collinear points dropped*/
+  IVE_CONTOUR_APPROX_BUTT
+} IVE_CONTOUR_APPROX_E;
+
+typedef struct IVE_CONTOUR_CTRL {
+  IVE_CC_DIR_E enMode; /*Region connectivity*/
+  IVE_CONTOUR_APPROX_E enApprox;
+  CVI_FLOAT f32Epsilon; /*Douglas-Peucker: largest distance in pixels of a dropped point*/
+} IVE_CONTOUR_CTRL_S;
+
+typedef struct IVE_POINT_U16 {
+  CVI_U16 u16X;
+  CVI_U16 u16Y;
+} IVE_POINT_U16_S;
+
+typedef struct IVE_CONTOUR {
+  CVI_U32 u32PointOffset; /*Index of the first point in the point arena*/
+  CVI_U32 u32PointNum;
+  CVI_U8 u8Label; /*Pixel value of the region*/
+  CVI_U16 u16X;   /*Bounding box of the region*/
+  CVI_U16 u16Y;
+  CVI_U16 u16Width;
+  CVI_U16 u16Height;
+} IVE_CONTOUR_S;
+
+typedef struct IVE_TEMPLATE_MATCH_RESULT {
+  CVI_U16 u16X; /*Top left corner of the best match in the search image*/
+  CVI_U16 u16Y;
+  CVI_U32 u32MinSad;
+} IVE_TEMPLATE_MATCH_RESULT_S;
+
 // csc/resize
 
 typedef enum cviIVE_CSC_MODE_E {
@@ -40,4 +40,35 @@ typedef struct IVE_DRAW_RECT_CTRL {
   CVI_U8 thickness;  // Reserved variable.
 } IVE_DRAW_RECT_CTRL_S;
 
+/**
+ * @brief IVE draw engine selection.
+ *
+ */
+typedef enum IVE_DRAW_MODE {
+  IVE_DRAW_MODE_AUTO = 0x0,  // CPU for a few rectangles, TPU otherwise.
+  IVE_DRAW_MODE_TPU = 0x1,
+  IVE_DRAW_MODE_CPU = 0x2,
+  IVE_DRAW_MODE_BUTT
+} IVE_DRAW_MODE_E;
+
+/**
+ * @brief IVE rectangle with its own style.
+ *
+ */
+typedef struct IVE_DRAW_RECT_ITEM {
+  IVE_RECT_S rect;  // Inclusive corners, clipped to the image.
+  IVE_COLOR_S color;
+  CVI_U8 thickness;  // Line width inside the rectangle, 0 means 2. Rounded up to even on YUV.
+} IVE_DRAW_RECT_ITEM_S;
+
+/**
+ * @brief IVE batched draw rect control parameters.
+ *
+ */
+typedef struct IVE_DRAW_RECTS_CTRL {
+  CVI_U32 u32Num;
+  IVE_DRAW_RECT_ITEM_S *pstItems;
+  IVE_DRAW_MODE_E enMode;
+} IVE_DRAW_RECTS_CTRL_S;
+
 #endif  // End of _CVI_DRAW_IVE_H_
\ No newline at end of file
@@ -24,6 +24,7 @@ typedef enum _EN_IVE_ERR_CODE_E {
   ERR_IVE_OPEN_FILE = 0x42,     /* IVE open file error */
   ERR_IVE_READ_FILE = 0x43,     /* IVE read file error */
   ERR_IVE_WRITE_FILE = 0x44,    /* IVE write file error */
+  ERR_IVE_BUF_FULL = 0x45,      /* IVE output buffer too small, the result is truncated */
 
   ERR_IVE_BUTT
 } EN_IVE_ERR_CODE_E;
@@ -137,6 +138,31 @@ CVI_S32 CVI_IVE_Image2VideoFrameInfo(IVE_IMAGE_S *pstIISrc, VIDEO_FRAME_INFO_S *
  */
 CVI_S32 CVI_IVE_VideoFrameInfo2Image(VIDEO_FRAME_INFO_S *pstVFISrc, IVE_IMAGE_S *pstIIDst);
 
+/**
+ * @brief Convert VIDEO_FRAME_INFO_S to IVE_IMAGE_S with a wrapper owned by the handle. Frames with
+ * the same address, format and geometry, such as recurring VB pool blocks, reuse the same wrapper
+ * without any allocation. Release the image with CVI_SYS_FreeI as usual, the wrapper stays cached
+ * for the next frame.
+ *
+ * @param pIveHandle Ive instance handler.
+ * @param pstVFISrc VIDEO_FRAME_INFO_S input.
+ * @param pstIIDst IVE_IMAGE_S output, tpu_block is overwritten.
+ * @return CVI_S32 Return CVI_SUCCESS if operation succeeded.
+ */
+CVI_S32 CVI_IVE_VideoFrameInfo2ImageCached(IVE_HANDLE pIveHandle, VIDEO_FRAME_INFO_S *pstVFISrc,
+                                           IVE_IMAGE_S *pstIIDst);
+
+/**
+ * @brief Drop the cached video frame wrappers covering a physical address. Call it when a block
+ * is released back to its pool or unmapped. Wrappers still in use are dropped by their last
+ * CVI_SYS_FreeI.
+ *
+ * @param pIveHandle Ive instance handler.
+ * @param u64PhyAddr Physical address inside the released block, 0 drops all the wrappers.
+ * @return CVI_S32 Return CVI_SUCCESS.
+ */
+CVI_S32 CVI_IVE_InvalidateVideoFrame(IVE_HANDLE pIveHandle, CVI_U64 u64PhyAddr);
+
 /**
  * @brief Read an image from file system. Default is in the order of RGB.
  *
@@ -159,8 +185,41 @@ IVE_IMAGE_S CVI_IVE_ReadImage(IVE_HANDLE pIveHandle, const char *filename, IVE_I
 IVE_IMAGE_S CVI_IVE_ReadImage2(IVE_HANDLE pIveHandle, const char *filename, IVE_IMAGE_TYPE_E enType,
                                CVI_BOOL invertPackage);
 
+/**
+ * @brief Read an image from file system into an existing image. The device memory of pstImg is
+ *        reused if its type and size match the decoded image, otherwise it is reallocated.
+ *
+ * @param pIveHandle Ive instance handler.
+ * @param filename File path to the image.
+ * @param pstImg Destination image, must be zero initialized or a valid image.
+ * @param enType Type of the destination image.
+ * @param invertPackage Invert the order of RGB package image to BGR.
+ * @return CVI_S32 Return CVI_SUCCESS if succeed.
+ */
+CVI_S32 CVI_IVE_ReadImageTo(IVE_HANDLE pIveHandle, const char *filename, IVE_IMAGE_S *pstImg,
+                            IVE_IMAGE_TYPE_E enType, CVI_BOOL invertPackage);
+
+/**
+ * @brief Read a list of images from file system on a pool of worker threads. Every image follows
+ *        the rules of CVI_IVE_ReadImageTo. At most u32ThreadNum decoded images are held in memory.
+ *
+ * @param pIveHandle Ive instance handler.
+ * @param filenames File paths to the images.
+ * @param pstImgs Destination images, must be zero initialized or valid images.
+ * @param u32Num Number of images.
+ * @param enType Type of the destination images.
+ * @param invertPackage Invert the order of RGB package image to BGR.
+ * @param u32ThreadNum Maximum number of worker threads, 0 means one per core.
+ * @return CVI_S32 Return CVI_SUCCESS if all images are read.
+ */
+CVI_S32 CVI_IVE_ReadImageBatch(IVE_HANDLE pIveHandle, const char **filenames, IVE_IMAGE_S *pstImgs,
+                               CVI_U32 u32Num, IVE_IMAGE_TYPE_E enType, CVI_BOOL invertPackage,
+                               CVI_U32 u32ThreadNum);
+
 /**
  * @brief Read an image from file system. for yuv.
+ *        The file holds the planes without padding, subsampled chroma of odd sizes is rounded up.
+ *        A file shorter than one frame is rejected with ERR_IVE_READ_FILE.
  *
  * @param pIveHandle Ive instance handler.
  * @param pstImg pointer of src1.
@@ -168,7 +227,7 @@ IVE_IMAGE_S CVI_IVE_ReadImage2(IVE_HANDLE pIveHandle, const char *filename, IVE_
  * @param enType Type of the destination image.
  * @param u32Width Yuv w
  * @param u32Width Yuv h
- * @return IVE_IMAGE_S Return IVE_IMAGE_S
+ * @return CVI_S32 Return CVI_SUCCESS if the first frame is read.
  */
 CVI_S32 CVI_IVE_ReadRawImage(IVE_HANDLE pIveHandle, IVE_IMAGE_S *pstImg, const char *filename,
                              IVE_IMAGE_TYPE_E enType, CVI_U16 u32Width, CVI_U16 u32Height);
@@ -187,6 +246,44 @@ CVI_S32 CVI_IVE_ReadRawImage(IVE_HANDLE pIveHandle, IVE_IMAGE_S *pstImg, const c
 CVI_S32 CVI_IVE_ReadImageArray(IVE_HANDLE pIveHandle, IVE_IMAGE_S *pstImg, char *pBuffer,
                                IVE_IMAGE_TYPE_E enType, CVI_U16 u32Width, CVI_U16 u32Height);
 
+/**
+ * @brief Open a raw frame sequence (U8C1, YUV420SP, YUV420P, ...) or a Y4M file for random frame
+ *        access. The file is memory mapped, nothing is read until a frame is requested. For Y4M
+ *        the type and the size are taken from the header and the given ones are ignored.
+ *
+ * @param pIveHandle Ive instance handler.
+ * @param filename File path to the sequence.
+ * @param enType Frame type of a raw sequence.
+ * @param u32Width Frame width of a raw sequence.
+ * @param u32Height Frame height of a raw sequence.
+ * @param pstReader Output reader, filled with the frame format and the frame number.
+ * @return CVI_S32 Return CVI_SUCCESS if the file contains at least one complete frame.
+ */
+CVI_S32 CVI_IVE_OpenSeqReader(IVE_HANDLE pIveHandle, const char *filename, IVE_IMAGE_TYPE_E enType,
+                              CVI_U32 u32Width, CVI_U32 u32Height, IVE_SEQ_READER_S *pstReader);
+
+/**
+ * @brief Copy frame u32Index of a sequence into pstImg. The device memory of pstImg is reused if
+ *        its type and size match, and the following frames are prefetched.
+ *
+ * @param pIveHandle Ive instance handler.
+ * @param pstReader Reader from CVI_IVE_OpenSeqReader.
+ * @param u32Index Frame index.
+ * @param pstImg Destination image, must be zero initialized or a valid image.
+ * @return CVI_S32 Return CVI_SUCCESS if succeed.
+ */
+CVI_S32 CVI_IVE_SeqReaderGetFrame(IVE_HANDLE pIveHandle, IVE_SEQ_READER_S *pstReader,
+                                  CVI_U32 u32Index, IVE_IMAGE_S *pstImg);
+
+/**
+ * @brief Close a sequence reader and release its mapping.
+ *
+ * @param pIveHandle Ive instance handler.
+ * @param pstReader Reader from CVI_IVE_OpenSeqReader.
+ * @return CVI_S32 Return CVI_SUCCESS if succeed.
+ */
+CVI_S32 CVI_IVE_CloseSeqReader(IVE_HANDLE pIveHandle, IVE_SEQ_READER_S *pstReader);
+
 /**
  * @brief Write an IVE_IMAGE_S to file system.
  *
@@ -197,6 +294,54 @@ CVI_S32 CVI_IVE_ReadImageArray(IVE_HANDLE pIveHandle, IVE_IMAGE_S *pstImg, char
  */
 CVI_S32 CVI_IVE_WriteImage(IVE_HANDLE pIveHandle, const char *filename, IVE_IMAGE_S *pstImg);
 
+/**
+ * @brief Write an IVE_IMAGE_S to file system in the given format. PNG and PNM support U8C1, S8C1,
+ *        U8C3_PACKAGE and U8C3_PLANAR, RAW supports every type CVI_IVE_OpenSeqReader reads.
+ *
+ * @param pIveHandle Ive instance handler.
+ * @param filename Save file path.
+ * @param pstImg Input image.
+ * @param enFormat File format.
+ * @return CVI_S32 Return CVI_SUCCESS if succeed.
+ */
+CVI_S32 CVI_IVE_WriteImage2(IVE_HANDLE pIveHandle, const char *filename, IVE_IMAGE_S *pstImg,
+                            IVE_WRITE_FORMAT_E enFormat);
+
+/**
+ * @brief Configure the asynchronous writer of the handle. Pending images of a previous
+ *        configuration are written first. Calling this is optional, see IVE_ASYNC_WRITER_CTRL_S
+ *        for the defaults.
+ *
+ * @param pIveHandle Ive instance handler.
+ * @param pstCtrl Writer control parameter.
+ * @return CVI_S32 Return CVI_SUCCESS if succeed.
+ */
+CVI_S32 CVI_IVE_AsyncWriterInit(IVE_HANDLE pIveHandle, const IVE_ASYNC_WRITER_CTRL_S *pstCtrl);
+
+/**
+ * @brief Copy pstImg into a pooled buffer and encode it on the background thread of the handle.
+ *        The image can be reused as soon as this returns.
+ *
+ * @param pIveHandle Ive instance handler.
+ * @param filename Save file path.
+ * @param pstImg Input image.
+ * @param enFormat File format.
+ * @return CVI_S32 Return CVI_SUCCESS if the image is queued, CVI_FAILURE if it is dropped or not
+ *         supported by the format.
+ */
+CVI_S32 CVI_IVE_WriteImageAsync(IVE_HANDLE pIveHandle, const char *filename, IVE_IMAGE_S *pstImg,
+                                IVE_WRITE_FORMAT_E enFormat);
+
+/**
+ * @brief Wait until all the queued images are written.
+ *
+ * @param pIveHandle Ive instance handler.
+ * @param pu32DropNum Optional output, number of images dropped or failed to write since the
+ *                    writer is initialized.
+ * @return CVI_S32 Return CVI_SUCCESS if succeed.
+ */
+CVI_S32 CVI_IVE_AsyncWriterFlush(IVE_HANDLE pIveHandle, CVI_U32 *pu32DropNum);
+
 /**
  * @brief Free Allocated IVE_MEM_INFO_S.
  *
@@ -209,9 +354,11 @@ CVI_S32 CVI_SYS_FreeM(IVE_HANDLE pIveHandle, IVE_MEM_INFO_S *pstMemInfo);
 /**
  * @brief Free Allocated IVE_IMAGE_S.
  *
- * @param pIveHandle Ive instance handler.
+ * @param pIveHandle Ive instance handler. Required for images allocated by IVE and for wrappers
+ * from CVI_IVE_VideoFrameInfo2ImageCached, NULL is only accepted for plain wrappers.
  * @param pstMemInfo Allocated IVE_IMAGE_S.
- * @return CVI_S32 Return CVI_SUCCESS.
+ * @return CVI_S32 Return CVI_SUCCESS, or CVI_FAILURE if the handle is required but NULL. The
+ * image is left untouched then.
  */
 CVI_S32 CVI_SYS_FreeI(IVE_HANDLE pIveHandle, IVE_IMAGE_S *pstImg);
 
@@ -230,6 +377,10 @@ CVI_S32 CVI_IVE_DMA(IVE_HANDLE pIveHandle, IVE_SRC_IMAGE_S *pstSrc, IVE_DST_IMAG
 
 /**
  * @brief Convert image to different image type.
+ *        Supports any pair of U8C1, S8C1, U16C1, S16C1, BF16C1 and FP32C1, and between
+ *        U8C3_PLANAR and S8C3_PLANAR. IVE_ITC_SATURATE rounds and clamps to the output range.
+ *        IVE_ITC_NORMALIZE maps [min, max] of the input to the full output range for integer
+ *        outputs and keeps the values for BF16C1 and FP32C1 outputs.
  *
  * @param pIveHandle Ive instance handler.
  * @param pstSrc Input image.
@@ -364,6 +515,23 @@ CVI_S32 CVI_IVE_Erode(IVE_HANDLE pIveHandle, IVE_SRC_IMAGE_S *pstSrc, IVE_DST_IM
 CVI_S32 CVI_IVE_Blend(IVE_HANDLE pIveHandle, IVE_SRC_IMAGE_S *pstSrc1, IVE_SRC_IMAGE_S *pstSrc2,
                       IVE_DST_IMAGE_S *pstDst, IVE_BLEND_CTRL_S *pstBlendCtrl, bool bInstant);
 
+/**
+ * @brief Alpha Blending on a list of ROIs. All the TPU ROIs share one command stream.
+ *
+ * @param pIveHandle Ive instance handler.
+ * @param pstSrc1 Input image. Both U8C3_PLANAR and U8C1 format are accepted.
+ * @param pstSrc2 Input image, same type and size as pstSrc1.
+ * @param pstDst Output result, same type and size as pstSrc1. Only the ROIs are written.
+ * @param pstRoiList ROIs and execution mode.
+ * @param pstBlendCtrl blend control variable.
+ * @param bInstant Dummy variable.
+ * @return CVI_S32 Return CVI_SUCCESS if succeed.
+ */
+CVI_S32 CVI_IVE_BlendROIs(IVE_HANDLE pIveHandle, IVE_SRC_IMAGE_S *pstSrc1,
+                          IVE_SRC_IMAGE_S *pstSrc2, IVE_DST_IMAGE_S *pstDst,
+                          IVE_ROI_LIST_S *pstRoiList, IVE_BLEND_CTRL_S *pstBlendCtrl,
+                          bool bInstant);
+
 /**
  * @brief Pixel-wise alpha blending for two images.
  *
@@ -419,6 +587,23 @@ CVI_S32 CVI_IVE_Blend_Pixel_U8_AB(IVE_HANDLE pIveHandle, IVE_SRC_IMAGE_S *pstSrc
 CVI_S32 CVI_IVE_Filter(IVE_HANDLE pIveHandle, IVE_SRC_IMAGE_S *pstSrc, IVE_DST_IMAGE_S *pstDst,
                        IVE_FILTER_CTRL_S *pstFltCtrl, bool bInstant);
 
+/**
+ * @brief Apply a filter to a list of ROIs. Every ROI is filtered as a standalone image, so only
+ * its pixels at least u8MaskSize / 2 away from the ROI border are written. All the TPU ROIs share
+ * one command stream.
+ *
+ * @param pIveHandle Ive instance handler.
+ * @param pstSrc Input image, U8C1 or U8C3_PLANAR.
+ * @param pstDst Output result, same type and size as pstSrc.
+ * @param pstRoiList ROIs and execution mode.
+ * @param pstFltCtrl Filter control parameter, mask size 3, 5 or 13.
+ * @param bInstant Dummy variable.
+ * @return CVI_S32 Return CVI_SUCCESS if succeed.
+ */
+CVI_S32 CVI_IVE_FilterROIs(IVE_HANDLE pIveHandle, IVE_SRC_IMAGE_S *pstSrc,
+                           IVE_DST_IMAGE_S *pstDst, IVE_ROI_LIST_S *pstRoiList,
+                           IVE_FILTER_CTRL_S *pstFltCtrl, bool bInstant);
+
 /**
  * @brief Get size of the HOG histogram.
  *
@@ -455,6 +640,40 @@ CVI_S32 CVI_IVE_HOG(IVE_HANDLE pIveHandle, IVE_SRC_IMAGE_S *pstSrc, IVE_DST_IMAG
                     IVE_DST_IMAGE_S *pstDstAng, IVE_DST_MEM_INFO_S *pstDstHist,
                     IVE_HOG_CTRL_S *pstHogCtrl, bool bInstant);
 
+/**
+ * @brief Load a two-class linear SVM model saved by LibLinear for HOG detection. The class with
+ *        the larger label is treated as the object class. Use CVI_SYS_FreeM to free
+ *        pstModel->stWeight.
+ *
+ * @param pIveHandle Ive instance handler.
+ * @param filename LibLinear model file.
+ * @param pstModel Output model.
+ * @return CVI_S32 Return CVI_SUCCESS if succeed.
+ */
+CVI_S32 CVI_IVE_LoadHOGSVMModel(IVE_HANDLE pIveHandle, const char *filename,
+                                IVE_HOG_SVM_MODEL_S *pstModel);
+
+/**
+ * @brief Sliding window HOG + linear SVM detector. The cell histograms and the normalized block
+ *        features are computed once per pyramid level and shared by all overlapping windows. The
+ *        window feature is the concatenation of its normalized blocks in row-major block order,
+ *        each block storing its cells row by row with u8BinSize bins per cell.
+ *
+ * @param pIveHandle Ive instance handler.
+ * @param pstSrc Input image. Only accepts U8C1.
+ * @param pstModel Linear SVM model, feature length must match the window feature length.
+ * @param pstBoxes Output boxes in source image coordinates.
+ * @param u32MaxBoxNum Capacity of pstBoxes.
+ * @param pu32BoxNum Number of boxes written to pstBoxes.
+ * @param pstDetCtrl Detector control parameter.
+ * @param bInstant Dummy variable.
+ * @return CVI_S32 Return CVI_SUCCESS if succeed.
+ */
+CVI_S32 CVI_IVE_HOGDetect(IVE_HANDLE pIveHandle, IVE_SRC_IMAGE_S *pstSrc,
+                          IVE_HOG_SVM_MODEL_S *pstModel, IVE_HOG_DETECT_BOX_S *pstBoxes,
+                          CVI_U32 u32MaxBoxNum, CVI_U32 *pu32BoxNum,
+                          IVE_HOG_DETECT_CTRL_S *pstDetCtrl, bool bInstant);
+
 /**
  * @brief Calculate the Magnitude and Nagular result from given horizontal and vertical gradients.
  *
@@ -472,11 +691,13 @@ CVI_S32 CVI_IVE_MagAndAng(IVE_HANDLE pIveHandle, IVE_SRC_IMAGE_S *pstSrcH, IVE_S
                           IVE_MAG_AND_ANG_CTRL_S *pstMaaCtrl, bool bInstant);
 
 /**
- * @brief Map src image to dst image with a given table.
+ * @brief Map src image to dst image with a given table. Small images are looked up on CPU, the
+ *        scratch buffers of the TPU path are kept in the handle and reused between calls.
  *
  * @param pIveHandle Ive instance handler.
- * @param pstSrc Input image.
- * @param pstMap Mapping table. (length 256.)
+ * @param pstSrc Input image, U8C1 or U16C1.
+ * @param pstMap Mapping table. (length 256 for U8C1, 512 for U16C1, larger values map to the
+ *               last entry on both the CPU and the TPU path.)
  * @param pstDst Output image.
  * @param bInstant Dummy variable.
  * @return CVI_S32 Return CVI_SUCCESS if succeed.
@@ -540,12 +761,31 @@ CVI_S32 CVI_IVE_Average(IVE_HANDLE pIveHandle, IVE_SRC_IMAGE_S *pstSrc, float *a
                         bool bInstant);
 
 /**
- * @brief Find min max of an image with a 3x3 size kernel.
+ * @brief Compute sum, sum of squares, mean, standard deviation, min, max and the locations of min
+ *        and max in one pass. Only the valid width of each row is read.
+ *
+ * @param pIveHandle Ive instance handler.
+ * @param pstSrc Input image. U8C1, U8C3_PLANAR, U16C1, S16C1 or BF16C1.
+ * @param pstMask Optional U8C1 mask of the input size, only pixels with non-zero mask are taken.
+ *                Can be NULL.
+ * @param pstStats Output statistics. Holds one entry per ROI and channel, ordered by ROI first,
+ *                 i.e. pstStats[roi * channels + channel].
+ * @param pstStatsCtrl Optional ROI list. Can be NULL to use the whole image.
+ * @param bInstant Dummy variable.
+ * @return CVI_S32 Return CVI_SUCCESS if succeed.
+ */
+CVI_S32 CVI_IVE_Stats(IVE_HANDLE pIveHandle, IVE_SRC_IMAGE_S *pstSrc, IVE_SRC_IMAGE_S *pstMask,
+                      IVE_STATS_S *pstStats, IVE_STATS_CTRL_S *pstStatsCtrl, bool bInstant);
+
+/**
+ * @brief Find max, min or median of an image with a square kernel. 3x3 max and min run on TPU,
+ *        median and larger max and min windows run on CPU.
  *
  * @param pIveHandle Ive instance handler.
  * @param pstSrc Input image.
- * @param pstDst Output image, width, height should be (input_length - ((kernel - 1)/2)).
- * @param pstOrdStatFltCtrl OrdStatFilter control parameter.
+ * @param pstDst Output image, width, height should be (input_length - (kernel - 1)).
+ * @param pstOrdStatFltCtrl OrdStatFilter control parameter. u8KernelSize 0 keeps the legacy
+ *                          3x3 window.
  * @param bInstant Dummy variable.
  * @return CVI_S32 Return CVI_SUCCESS if succeed.
  */
@@ -622,6 +862,22 @@ CVI_S32 CVI_IVE_Sub(IVE_HANDLE pIveHandle, IVE_SRC_IMAGE_S *pstSrc1, IVE_SRC_IMA
 CVI_S32 CVI_IVE_Thresh(IVE_HANDLE pIveHandle, IVE_SRC_IMAGE_S *pstSrc, IVE_DST_IMAGE_S *pstDst,
                        IVE_THRESH_CTRL_S *ctrl, bool bInstant);
 
+/**
+ * @brief Calculate the threshold result on a list of ROIs. All the TPU ROIs share one command
+ * stream. A binary threshold of 0 runs on the CPU in any mode, every pixel becomes u8MaxVal.
+ *
+ * @param pIveHandle Ive instance handler.
+ * @param pstSrc Input image, U8C1 or U8C3_PLANAR.
+ * @param pstDst Output result, same type and size as pstSrc. Only the ROIs are written.
+ * @param pstRoiList ROIs and execution mode.
+ * @param ctrl Threshold control parameter.
+ * @param bInstant Dummy variable.
+ * @return CVI_S32 Return CVI_SUCCESS if succeed.
+ */
+CVI_S32 CVI_IVE_ThreshROIs(IVE_HANDLE pIveHandle, IVE_SRC_IMAGE_S *pstSrc,
+                           IVE_DST_IMAGE_S *pstDst, IVE_ROI_LIST_S *pstRoiList,
+                           IVE_THRESH_CTRL_S *ctrl, bool bInstant);
+
 /**
  * @brief Threshold an S16 image with high low threshold to U8 or S8.
  *
@@ -698,6 +954,20 @@ CVI_S32 CVI_IVE_EqualizeHist(IVE_HANDLE pIveHandle, IVE_SRC_IMAGE_S *pstSrc,
                              IVE_DST_IMAGE_S *pstDst, IVE_EQUALIZE_HIST_CTRL_S *ctrl,
                              bool bInstant);
 
+/**
+ * @brief Convert a 16 bit image to 8 bit with saturation. The value is first scaled by
+ *        u8Numerator / u16Denominator (truncated), then converted according to enMode:
+ *        S16_TO_S8 clamps to [-128, 127], S16_TO_U8_ABS takes the absolute value,
+ *        S16_TO_U8_BIAS adds s8Bias, and U16_TO_U8 clamps to [0, 255].
+ *
+ * @param pIveHandle Ive instance handler.
+ * @param pstSrc Input image. S16C1 for S16 modes, U16C1 for U16_TO_U8.
+ * @param pstDst Output image. S8C1 for S16_TO_S8, U8C1 for the others.
+ * @param ctrl 16 bit to 8 bit control parameter. u16Denominator must be non-zero and not less
+ *             than u8Numerator.
+ * @param bInstant Dummy variable.
+ * @return CVI_S32 Return CVI_SUCCESS if succeed.
+ */
 CVI_S32 CVI_IVE_16BitTo8Bit(IVE_HANDLE pIveHandle, IVE_SRC_IMAGE_S *pstSrc, IVE_DST_IMAGE_S *pstDst,
                             IVE_16BIT_TO_8BIT_CTRL_S *ctrl, bool bInstant);
 
@@ -754,6 +1024,281 @@ CVI_S32 CVI_IVE_Zero(IVE_HANDLE pIveHandle, IVE_DST_IMAGE_S *pstDst);
 CVI_S32 CVI_IVE_Blend_Pixel_Y(IVE_HANDLE pIveHandle, VIDEO_FRAME_INFO_S *pstSrc1,
                               VIDEO_FRAME_INFO_S *pstSrc2_dst, VIDEO_FRAME_INFO_S *pstAlpha);
 
+/**
+ * @brief Allocate the state of a background model. Use CVI_SYS_FreeI to free pstModel->stModel.
+ *
+ * @param pIveHandle Ive instance handler.
+ * @param pstModel Output model, learns from the first frame given to CVI_IVE_BGModel.
+ * @param enType Running average or gaussian mixture.
+ * @param u32Width Frame width.
+ * @param u32Height Frame height.
+ * @return CVI_S32 Return CVI_SUCCESS if succeed.
+ */
+CVI_S32 CVI_IVE_CreateBGModel(IVE_HANDLE pIveHandle, IVE_BG_MODEL_S *pstModel,
+                              IVE_BG_MODEL_TYPE_E enType, CVI_U32 u32Width, CVI_U32 u32Height);
+
+/**
+ * @brief Update a background model with a frame and output the foreground mask in the same pass.
+ *        The model is updated in place on CPU, the running average is vectorized with NEON.
+ *
+ * @param pIveHandle Ive instance handler.
+ * @param pstSrc Input frame. Only accepts U8C1.
+ * @param pstFg Output foreground mask, 255 for foreground and 0 for background. U8C1.
+ * @param pstModel Background model created by CVI_IVE_CreateBGModel.
+ * @param pstCtrl Background model control parameter.
+ * @param bInstant Dummy variable.
+ * @return CVI_S32 Return CVI_SUCCESS if succeed.
+ */
+CVI_S32 CVI_IVE_BGModel(IVE_HANDLE pIveHandle, IVE_SRC_IMAGE_S *pstSrc, IVE_DST_IMAGE_S *pstFg,
+                        IVE_BG_MODEL_S *pstModel, IVE_BG_MODEL_CTRL_S *pstCtrl, bool bInstant);
+
+/**
+ * @brief Get the background image of a model, the mean of the heaviest mode for GMM.
+ *
+ * @param pIveHandle Ive instance handler.
+ * @param pstModel Background model.
+ * @param pstDst Output background image. U8C1.
+ * @return CVI_S32 Return CVI_SUCCESS if succeed.
+ */
+CVI_S32 CVI_IVE_GetBGImage(IVE_HANDLE pIveHandle, IVE_BG_MODEL_S *pstModel,
+                           IVE_DST_IMAGE_S *pstDst);
+
+/**
+ * @brief Pyramidal Lucas-Kanade sparse optical flow. The gradients of every pyramid level come
+ *        from CVI_IVE_Sobel and the gradient matrices are read from integral images. Points are
+ *        tracked four at a time with NEON.
+ *
+ * @param pIveHandle Ive instance handler.
+ * @param pstPrev Previous frame. Only accepts U8C1.
+ * @param pstNext Next frame. Only accepts U8C1, same size as pstPrev.
+ * @param pstPrevPts Points to track in pstPrev.
+ * @param pstNextPts Output tracked points in pstNext.
+ * @param pu8Status Output status, 1 if the point is tracked and 0 if it is lost.
+ * @param pf32Err Output mean absolute difference of the tracked windows, can be NULL.
+ * @param u32PtsNum Number of points.
+ * @param pstLkCtrl Optical flow control parameter.
+ * @param bInstant Dummy variable.
+ * @return CVI_S32 Return CVI_SUCCESS if succeed.
+ */
+CVI_S32 CVI_IVE_LKOpticalFlow(IVE_HANDLE pIveHandle, IVE_SRC_IMAGE_S *pstPrev,
+                              IVE_SRC_IMAGE_S *pstNext, IVE_LK_POINT_S *pstPrevPts,
+                              IVE_LK_POINT_S *pstNextPts, CVI_U8 *pu8Status, CVI_FLOAT *pf32Err,
+                              CVI_U32 u32PtsNum, IVE_LK_OPTICAL_FLOW_CTRL_S *pstLkCtrl,
+                              bool bInstant);
+
+/**
+ * @brief Stereo block matching over all disparities. Every disparity updates sliding SAD window
+ *        sums row by row and only the best disparity and cost of each pixel are kept, the cost
+ *        volume is never stored. Rows are split over threads and the sums are vectorized across
+ *        disparities with NEON.
+ *
+ * @param pIveHandle Ive instance handler.
+ * @param pstLeft Left image. Only accepts U8C1.
+ * @param pstRight Right image. Only accepts U8C1, same size as pstLeft.
+ * @param pstDisp Output disparity of the left image. U8C1.
+ * @param pstCost Output SAD of the best disparity, 65535 on the border. U16C1, can be NULL.
+ * @param pstBmCtrl Block matching control parameter.
+ * @param bInstant Dummy variable.
+ * @return CVI_S32 Return CVI_SUCCESS if succeed.
+ */
+CVI_S32 CVI_IVE_StereoBM(IVE_HANDLE pIveHandle, IVE_SRC_IMAGE_S *pstLeft, IVE_SRC_IMAGE_S *pstRight,
+                         IVE_DST_IMAGE_S *pstDisp, IVE_DST_IMAGE_S *pstCost,
+                         IVE_STEREO_BM_CTRL_S *pstBmCtrl, bool bInstant);
+
+/**
+ * @brief Detect moving blobs. Frame difference, threshold, erosion, dilation and the extraction
+ *        of foreground runs are fused per slice of rows, so no full frame intermediate is made.
+ *        The runs are then labelled with union find. Out of image pixels are ignored by the
+ *        morphology. Blobs are sorted by area from the largest, ties in raster order.
+ *
+ * @param pIveHandle Ive instance handler.
+ * @param pstCur Current frame. Only accepts U8C1.
+ * @param pstRef Previous frame or background. Only accepts U8C1, same size as pstCur.
+ * @param pstMask Output foreground after the morphology. U8C1, can be NULL.
+ * @param pstBlobs Output blobs.
+ * @param u32MaxBlobNum Size of pstBlobs. Only the largest blobs are kept.
+ * @param pu32BlobNum Output number of blobs in pstBlobs.
+ * @param pstMdCtrl Motion detection control parameter.
+ * @param bInstant Dummy variable.
+ * @return CVI_S32 Return CVI_SUCCESS if succeed.
+ */
+CVI_S32 CVI_IVE_MotionDetect(IVE_HANDLE pIveHandle, IVE_SRC_IMAGE_S *pstCur,
+                             IVE_SRC_IMAGE_S *pstRef, IVE_DST_IMAGE_S *pstMask,
+                             IVE_MOTION_BLOB_S *pstBlobs, CVI_U32 u32MaxBlobNum,
+                             CVI_U32 *pu32BlobNum, IVE_MOTION_DETECT_CTRL_S *pstMdCtrl,
+                             bool bInstant);
+
+/**
+ * @brief Canny edge detector. 3x3 Sobel gradients, the magnitude and the quantized direction are
+ *        computed in one SIMD pass per row, followed by vectorized non-maximum suppression.
+ *        Weak pixels connected to strong ones are then kept by a stack based hysteresis. The L2
+ *        magnitude is compared squared, so no square root is taken. The 1 pixel image border is
+ *        never an edge.
+ *
+ * @param pIveHandle Ive instance handler.
+ * @param pstSrc Input image. Only accepts U8C1.
+ * @param pstDst Output edge map, 255 on edges and 0 elsewhere. U8C1, same size as pstSrc.
+ * @param pstCannyCtrl Canny control parameter.
+ * @param bInstant Dummy variable.
+ * @return CVI_S32 Return CVI_SUCCESS if succeed.
+ */
+CVI_S32 CVI_IVE_Canny(IVE_HANDLE pIveHandle, IVE_SRC_IMAGE_S *pstSrc, IVE_DST_IMAGE_S *pstDst,
+                      IVE_CANNY_CTRL_S *pstCannyCtrl, bool bInstant);
+
+/**
+ * @brief Detect corners. Harris and Shi-Tomasi scores are computed from 3x3 Sobel gradient
+ *        products summed with sliding window sums, FAST-9 tests 16 pixels at a time with NEON.
+ *        Corners are local maxima in 3x3 above the threshold, optionally only the best one of
+ *        each grid cell. Rows are processed in parallel.
+ *
+ * @param pIveHandle Ive instance handler.
+ * @param pstSrc Input image. Only accepts U8C1.
+ * @param pstCorners Output corners sorted by score from the highest, ties in raster order.
+ * @param u32MaxNum Size of pstCorners. Only the best corners are kept.
+ * @param pu32Num Output number of corners in pstCorners.
+ * @param pstCornerCtrl Corner control parameter.
+ * @param bInstant Dummy variable.
+ * @return CVI_S32 Return CVI_SUCCESS if succeed.
+ */
+CVI_S32 CVI_IVE_CornerDetect(IVE_HANDLE pIveHandle, IVE_SRC_IMAGE_S *pstSrc,
+                             IVE_CORNER_S *pstCorners, CVI_U32 u32MaxNum, CVI_U32 *pu32Num,
+                             IVE_CORNER_CTRL_S *pstCornerCtrl, bool bInstant);
+
+/**
+ * @brief Separable filter with kernel sizes up to 31. The row pass and the column pass run as 1D
+ *        SIMD passes over a ring of filtered rows, so the cost grows with the sum of the kernel
+ *        sizes instead of their product. Rows are processed in parallel. The sums of both passes
+ *        must fit in 32 bits.
+ *
+ * @param pIveHandle Ive instance handler.
+ * @param pstSrc Input image. Only accepts U8C1.
+ * @param pstDst Output image. U8C1 or S16C1, same size as pstSrc.
+ * @param pstSepCtrl Separable filter control parameter.
+ * @param bInstant Dummy variable.
+ * @return CVI_S32 Return CVI_SUCCESS if succeed.
+ */
+CVI_S32 CVI_IVE_SepFilter(IVE_HANDLE pIveHandle, IVE_SRC_IMAGE_S *pstSrc, IVE_DST_IMAGE_S *pstDst,
+                          IVE_SEP_FILTER_CTRL_S *pstSepCtrl, bool bInstant);
+
+/**
+ * @brief Fill a separable filter control parameter with a Gaussian kernel. Both masks sum to
+ *        4096 and the shifts keep 7 fractional bits between the passes. The border mode is set
+ *        to IVE_BORDER_MODE_REFLECT_101.
+ *
+ * @param f32Sigma Standard deviation in pixels.
+ * @param u8Size Odd kernel size in [1, IVE_SEP_FILTER_MAX_SIZE], 0 picks the smallest odd size
+ *        covering 3 sigmas, up to IVE_SEP_FILTER_MAX_SIZE.
+ * @param pstSepCtrl Output control parameter.
+ * @return CVI_S32 Return CVI_SUCCESS if succeed.
+ */
+CVI_S32 CVI_IVE_InitGaussianSepFilterCtrl(CVI_FLOAT f32Sigma, CVI_U8 u8Size,
+                                          IVE_SEP_FILTER_CTRL_S *pstSepCtrl);
+
+/**
+ * @brief Local mean and variance over a box window of any odd size up to 255x255. Column sums
+ *        are updated with SIMD while sliding down the rows and the horizontal window slides over
+ *        them, so the cost per pixel does not depend on the window size. Rows are processed in
+ *        parallel.
+ *
+ * @param pIveHandle Ive instance handler.
+ * @param pstSrc Input image. Only accepts U8C1.
+ * @param pstDstMean Output mean, same size as pstSrc. U8C1 for the rounded mean, U16C1 for the
+ *        rounded mean in 8.8 fixed point or FP32C1.
+ * @param pstDstVar Optional output variance, same size as pstSrc. U16C1 for the rounded variance
+ *        or FP32C1. NULL skips the sum of squares.
+ * @param pstBoxCtrl Box filter control parameter.
+ * @param bInstant Dummy variable.
+ * @return CVI_S32 Return CVI_SUCCESS if succeed.
+ */
+CVI_S32 CVI_IVE_BoxFilter(IVE_HANDLE pIveHandle, IVE_SRC_IMAGE_S *pstSrc,
+                          IVE_DST_IMAGE_S *pstDstMean, IVE_DST_IMAGE_S *pstDstVar,
+                          IVE_BOX_FILTER_CTRL_S *pstBoxCtrl, bool bInstant);
+
+/**
+ * @brief Gray scale morphology with large rectangle, cross or ellipse structuring elements. Each
+ *        rectangle is decomposed into a horizontal and a vertical van Herk/Gil-Werman pass, so
+ *        the cost per pixel does not depend on its size. Pixels outside the image are ignored,
+ *        the result equals the brute force definition over the element. Compound operations
+ *        run on bands of rows, each band filters its own halo so that both passes and the
+ *        subtraction stay within band sized buffers.
+ *
+ * @param pIveHandle Ive instance handler.
+ * @param pstSrc Input image. Only accepts U8C1.
+ * @param pstDst Output image. U8C1, same size as pstSrc. Can be pstSrc.
+ * @param pstMorphCtrl Morphology control parameter.
+ * @param bInstant Dummy variable.
+ * @return CVI_S32 Return CVI_SUCCESS if succeed.
+ */
+CVI_S32 CVI_IVE_Morph(IVE_HANDLE pIveHandle, IVE_SRC_IMAGE_S *pstSrc, IVE_DST_IMAGE_S *pstDst,
+                      IVE_MORPH_CTRL_S *pstMorphCtrl, bool bInstant);
+
+/**
+ * @brief Distance from every foreground pixel of a mask to the nearest background pixel. The
+ *        Euclidean transform runs a column pass followed by the Felzenszwalb-Huttenlocher lower
+ *        envelope on every row, both in parallel. The chamfer transform runs the two raster
+ *        scans with the previous row terms in SIMD.
+ *
+ * @param pIveHandle Ive instance handler.
+ * @param pstSrc Input mask. U8C1, non zero pixels are foreground, e.g. the output of
+ *        CVI_IVE_Thresh.
+ * @param pstDst Output distance in pixels, same size as pstSrc. U16C1 rounded to the nearest
+ *        integer or FP32C1. A mask without background gives 65535 or infinity.
+ * @param pstDistCtrl Distance transform control parameter.
+ * @param bInstant Dummy variable.
+ * @return CVI_S32 Return CVI_SUCCESS if succeed.
+ */
+CVI_S32 CVI_IVE_DistanceTransform(IVE_HANDLE pIveHandle, IVE_SRC_IMAGE_S *pstSrc,
+                                  IVE_DST_IMAGE_S *pstDst,
+                                  IVE_DIST_TRANSFORM_CTRL_S *pstDistCtrl, bool bInstant);
+
+/**
+ * @brief Outer contours of the regions of a mask or a label image. A region is a connected set of
+ *        pixels with the same non zero value, so the output of CVI_IVE_Thresh and CVI_IVE_CC can
+ *        be used directly. Borders are followed in a single raster scan (Suzuki-Abe), the points
+ *        of every contour are written to a caller arena in tracing order. Contours come in the
+ *        raster order of their first pixel. Once a contour does not fit in pstContours or in the
+ *        arena, it and all the following ones are dropped and ERR_IVE_BUF_FULL is returned, the
+ *        contours before it are still valid.
+ *
+ * @param pIveHandle Ive instance handler.
+ * @param pstSrc Input mask or label image. Only accepts U8C1.
+ * @param pstContours Output contours.
+ * @param u32MaxContourNum Size of pstContours.
+ * @param pstPoints Point arena shared by the contours.
+ * @param u32MaxPointNum Size of pstPoints.
+ * @param pu32ContourNum Output number of contours in pstContours.
+ * @param pstContourCtrl Contour control parameter.
+ * @param bInstant Dummy variable.
+ * @return CVI_S32 Return CVI_SUCCESS if all the contours are found, ERR_IVE_BUF_FULL if they are
+ * truncated.
+ */
+CVI_S32 CVI_IVE_FindContours(IVE_HANDLE pIveHandle, IVE_SRC_IMAGE_S *pstSrc,
+                             IVE_CONTOUR_S *pstContours, CVI_U32 u32MaxContourNum,
+                             IVE_POINT_U16_S *pstPoints, CVI_U32 u32MaxPointNum,
+                             CVI_U32 *pu32ContourNum, IVE_CONTOUR_CTRL_S *pstContourCtrl,
+                             bool bInstant);
+
+/**
+ * @brief Slide a template over a search image and find the position with the smallest sum of
+ *        absolute differences. 16 positions are scored at once with SIMD absolute difference
+ *        accumulation, rows of positions are processed in parallel. Without a cost map, a group
+ *        of positions stops as soon as all of them cost more than the best one so far. Use
+ *        CVI_IVE_SubImage to restrict the search window. Ties go to the first position in
+ *        raster order.
+ *
+ * @param pIveHandle Ive instance handler.
+ * @param pstSrc Search image. Only accepts U8C1.
+ * @param pstTemplate Template. U8C1, at most 255 pixels wide and not larger than pstSrc.
+ * @param pstDst Optional cost map of every position, (src width - template width + 1) x
+ *        (src height - template height + 1). U16C1 saturated or U32C1. Can be NULL.
+ * @param pstResult Output best position and its cost.
+ * @param bInstant Dummy variable.
+ * @return CVI_S32 Return CVI_SUCCESS if succeed.
+ */
+CVI_S32 CVI_IVE_MatchTemplateSAD(IVE_HANDLE pIveHandle, IVE_SRC_IMAGE_S *pstSrc,
+                                 IVE_SRC_IMAGE_S *pstTemplate, IVE_DST_IMAGE_S *pstDst,
+                                 IVE_TEMPLATE_MATCH_RESULT_S *pstResult, bool bInstant);
+
 #ifdef __cplusplus
 }
 #endif
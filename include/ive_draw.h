@@ -20,6 +20,21 @@ extern "C" {
 CVI_S32 CVI_IVE_DrawRect(IVE_HANDLE pIveHandle, IVE_DST_IMAGE_S *pstDst,
                          IVE_DRAW_RECT_CTRL_S *pstDrawCtrl, bool bInstant);
 
+/**
+ * @brief Draw hollow rectangles with their own colour and thickness on IVE_DST_IMAGE_S. All
+ *        rectangles are built into one command stream, horizontal edges on the same rows are
+ *        merged. The CPU and the TPU paths produce the same pixels. Where rectangles of
+ *        different colours overlap, the order of the rectangles is not kept.
+ *
+ * @param pIveHandle Ive instanace handler.
+ * @param pstDst The output image, U8C3_PLANAR, YUV420P or YUV420SP.
+ * @param pstCtrl Rectangles and draw mode.
+ * @param bInstant Dummy variable.
+ * @return CVI_S32 Return CVI_SUCCESS if succeed.
+ */
+CVI_S32 CVI_IVE_DrawRects(IVE_HANDLE pIveHandle, IVE_DST_IMAGE_S *pstDst,
+                          IVE_DRAW_RECTS_CTRL_S *pstCtrl, bool bInstant);
+
 #ifdef __cplusplus
 }
 #endif
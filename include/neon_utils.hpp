@@ -8,7 +8,9 @@
 #include "neon2sse/NEON_2_SSE.h"
 #pragma clang diagnostic pop
 #endif
+#include <algorithm>
 #include <cmath>
+#include <cstring>
 #include <limits>
 
 union neonfloatshort {
@@ -557,11 +559,65 @@ inline void neonS162S8ThresholdLH(int16_t *src_ptr, int8_t *dst_ptr, const uint6
   }
 }
 
+// Splits an interleaved 3 channels row into three planes.
+inline void neonU8C3PackageToPlanarRow(const uint8_t *src, uint8_t *dst0, uint8_t *dst1,
+                                       uint8_t *dst2, const int width) {
+  int i = 0;
+  for (; i + 16 <= width; i += 16) {
+    uint8x16x3_t v = vld3q_u8(src + i * 3);
+    vst1q_u8(dst0 + i, v.val[0]);
+    vst1q_u8(dst1 + i, v.val[1]);
+    vst1q_u8(dst2 + i, v.val[2]);
+  }
+  for (; i < width; i++) {
+    dst0[i] = src[i * 3];
+    dst1[i] = src[i * 3 + 1];
+    dst2[i] = src[i * 3 + 2];
+  }
+}
+
+// Interleaves three planes into a 3 channels row.
+inline void neonU8C3PlanarToPackageRow(const uint8_t *src0, const uint8_t *src1,
+                                       const uint8_t *src2, uint8_t *dst, const int width) {
+  int i = 0;
+  for (; i + 16 <= width; i += 16) {
+    uint8x16x3_t v;
+    v.val[0] = vld1q_u8(src0 + i);
+    v.val[1] = vld1q_u8(src1 + i);
+    v.val[2] = vld1q_u8(src2 + i);
+    vst3q_u8(dst + i * 3, v);
+  }
+  for (; i < width; i++) {
+    dst[i * 3] = src0[i];
+    dst[i * 3 + 1] = src1[i];
+    dst[i * 3 + 2] = src2[i];
+  }
+}
+
+// Copies an interleaved 3 channels row with the first and the last channel swapped.
+inline void neonU8C3SwapRow(const uint8_t *src, uint8_t *dst, const int width) {
+  int i = 0;
+  for (; i + 16 <= width; i += 16) {
+    uint8x16x3_t v = vld3q_u8(src + i * 3);
+    uint8x16_t tmp = v.val[0];
+    v.val[0] = v.val[2];
+    v.val[2] = tmp;
+    vst3q_u8(dst + i * 3, v);
+  }
+  for (; i < width; i++) {
+    uint8_t tmp = src[i * 3];
+    dst[i * 3] = src[i * 3 + 2];
+    dst[i * 3 + 1] = src[i * 3 + 1];
+    dst[i * 3 + 2] = tmp;
+  }
+}
+
 inline void neonU16SeperateU8(uint16_t *src_ptr, uint8_t *dst1_ptr, uint8_t *dst2_ptr,
-                              const uint64_t arr_size) {
+                              const uint64_t arr_size, const uint16_t max_val = 0xFFFF) {
   uint64_t neon_turn = arr_size / 8;
+  const uint16x8_t v_max = vdupq_n_u16(max_val);
   for (uint64_t i = 0; i < neon_turn; i++) {
-    uint16x8_t u16_data = vld1q_u16(src_ptr);
+    uint16x8_t u16_data = vminq_u16(vld1q_u16(src_ptr), v_max);
     uint8x8_t u8_table_index = vqshrn_n_u16(u16_data, 8);
     uint8x8_t u8_lookup_index = vmovn_u16(u16_data);
 
@@ -572,6 +628,83 @@ inline void neonU16SeperateU8(uint16_t *src_ptr, uint8_t *dst1_ptr, uint8_t *dst
     dst1_ptr += 8;
     dst2_ptr += 8;
   }
+  for (uint64_t i = neon_turn * 8; i < arr_size; i++) {
+    uint16_t val = std::min(*src_ptr++, max_val);
+    *dst1_ptr++ = (uint8_t)(val >> 8);
+    *dst2_ptr++ = (uint8_t)val;
+  }
+}
+
+#if defined(__aarch64__)
+// 256 entries lookup, table is split in four 64 bytes registers and an index out of range of
+// one register keeps the lane from the previous lookup.
+inline uint8x16_t neonLut256(const uint8x16x4_t *table, const uint8x16_t idx) {
+  const uint8x16_t v64 = vdupq_n_u8(64);
+  uint8x16_t idx_sub = idx;
+  uint8x16_t res = vqtbl4q_u8(table[0], idx_sub);
+  idx_sub = vsubq_u8(idx_sub, v64);
+  res = vqtbx4q_u8(res, table[1], idx_sub);
+  idx_sub = vsubq_u8(idx_sub, v64);
+  res = vqtbx4q_u8(res, table[2], idx_sub);
+  idx_sub = vsubq_u8(idx_sub, v64);
+  return vqtbx4q_u8(res, table[3], idx_sub);
+}
+
+inline void neonLoadLut256(const uint8_t *table, uint8x16x4_t *lut) {
+  for (int i = 0; i < 4; i++) {
+    for (int j = 0; j < 4; j++) {
+      lut[i].val[j] = vld1q_u8(table + i * 64 + j * 16);
+    }
+  }
+}
+#endif
+
+// dst[i] = table[src[i]] with a 256 entries table.
+inline void neonU8LutRow(const uint8_t *src, uint8_t *dst, const uint8_t *table, const int size) {
+  int i = 0;
+#if defined(__aarch64__)
+  uint8x16x4_t lut[4];
+  neonLoadLut256(table, lut);
+  for (; i + 16 <= size; i += 16) {
+    vst1q_u8(dst + i, neonLut256(lut, vld1q_u8(src + i)));
+  }
+#endif
+  for (; i + 4 <= size; i += 4) {
+    uint8_t v0 = table[src[i]], v1 = table[src[i + 1]];
+    uint8_t v2 = table[src[i + 2]], v3 = table[src[i + 3]];
+    dst[i] = v0;
+    dst[i + 1] = v1;
+    dst[i + 2] = v2;
+    dst[i + 3] = v3;
+  }
+  for (; i < size; i++) {
+    dst[i] = table[src[i]];
+  }
+}
+
+// dst[i] = table[min(src[i], 511)] with a 512 entries table.
+inline void neonU16Lut512Row(const uint16_t *src, uint8_t *dst, const uint8_t *table,
+                             const int size) {
+  int i = 0;
+#if defined(__aarch64__)
+  uint8x16x4_t lut_lo[4], lut_hi[4];
+  neonLoadLut256(table, lut_lo);
+  neonLoadLut256(table + 256, lut_hi);
+  const uint16x8_t v511 = vdupq_n_u16(511);
+  for (; i + 16 <= size; i += 16) {
+    uint16x8_t v0 = vminq_u16(vld1q_u16(src + i), v511);
+    uint16x8_t v1 = vminq_u16(vld1q_u16(src + i + 8), v511);
+    uint8x16_t idx = vcombine_u8(vmovn_u16(v0), vmovn_u16(v1));
+    uint8x16_t is_hi = vcombine_u8(vshrn_n_u16(v0, 8), vshrn_n_u16(v1, 8));
+    uint8x16_t res_lo = neonLut256(lut_lo, idx);
+    uint8x16_t res_hi = neonLut256(lut_hi, idx);
+    vst1q_u8(dst + i, vbslq_u8(vtstq_u8(is_hi, is_hi), res_hi, res_lo));
+  }
+#endif
+  for (; i < size; i++) {
+    uint16_t val = src[i];
+    dst[i] = table[val > 511 ? 511 : val];
+  }
 }
 
 inline void neonS162U8ThresholdLH(int16_t *src_ptr, uint8_t *dst_ptr, const uint64_t arr_size,
@@ -622,4 +755,789 @@ inline void neonS162U8ThresholdLH(int16_t *src_ptr, uint8_t *dst_ptr, const uint
       dst_ptr[i] = val;
     }
   }
-}
\ No newline at end of file
+}
+inline float neonF32Dot(const float *src1_ptr, const float *src2_ptr, const uint64_t arr_size) {
+  uint64_t neon_turn = arr_size / 8;
+  float32x4_t v_sum1 = vdupq_n_f32(0.f);
+  float32x4_t v_sum2 = vdupq_n_f32(0.f);
+  const float *src1_ptr1 = src1_ptr;
+  const float *src2_ptr1 = src2_ptr;
+  for (uint64_t i = 0; i < neon_turn; i++) {
+    v_sum1 = vmlaq_f32(v_sum1, vld1q_f32(src1_ptr1), vld1q_f32(src2_ptr1));
+    v_sum2 = vmlaq_f32(v_sum2, vld1q_f32(src1_ptr1 + 4), vld1q_f32(src2_ptr1 + 4));
+    src1_ptr1 += 8;
+    src2_ptr1 += 8;
+  }
+  v_sum1 = vaddq_f32(v_sum1, v_sum2);
+  float32x2_t v_sum = vadd_f32(vget_low_f32(v_sum1), vget_high_f32(v_sum1));
+  v_sum = vpadd_f32(v_sum, v_sum);
+  float result = vget_lane_f32(v_sum, 0);
+  for (uint64_t i = neon_turn * 8; i < arr_size; i++) {
+    result += src1_ptr[i] * src2_ptr[i];
+  }
+  return result;
+}
+
+/**
+ * Truncated division of p by a positive den, as the C operator "/" does. The quotient is first
+ * estimated with a float reciprocal then corrected by one, so the result is exact as long as
+ * |p| < 2^24.
+ */
+__attribute__((always_inline)) inline int32x4_t vdivq_s32_trunc(int32x4_t p, int32x4_t den,
+                                                                float32x4_t inv_den) {
+  int32x4_t sign = vshrq_n_s32(p, 31);
+  int32x4_t a = vabsq_s32(p);
+  int32x4_t q = vcvtq_s32_f32(vmulq_f32(vcvtq_f32_s32(a), inv_den));
+  int32x4_t r = vsubq_s32(a, vmulq_s32(q, den));
+  q = vaddq_s32(q, vreinterpretq_s32_u32(vcltq_s32(r, vdupq_n_s32(0))));
+  q = vsubq_s32(q, vreinterpretq_s32_u32(vcgeq_s32(r, den)));
+  return vsubq_s32(veorq_s32(q, sign), sign);
+}
+
+inline void neonU162U8Scale(const uint16_t *src_ptr, uint8_t *dst_ptr, const uint64_t arr_size,
+                            const uint8_t numerator, const uint16_t denominator) {
+  uint64_t neon_turn = arr_size / 8;
+  int32x4_t v_den = vdupq_n_s32(denominator);
+  float32x4_t v_inv_den = vdupq_n_f32(1.f / denominator);
+  const uint16_t *src_ptr1 = src_ptr;
+  uint8_t *dst_ptr1 = dst_ptr;
+  for (uint64_t i = 0; i < neon_turn; i++) {
+    uint16x8_t v16 = vld1q_u16(src_ptr1);
+    int32x4_t p_low = vreinterpretq_s32_u32(vmull_n_u16(vget_low_u16(v16), numerator));
+    int32x4_t p_high = vreinterpretq_s32_u32(vmull_n_u16(vget_high_u16(v16), numerator));
+    int32x4_t q_low = vdivq_s32_trunc(p_low, v_den, v_inv_den);
+    int32x4_t q_high = vdivq_s32_trunc(p_high, v_den, v_inv_den);
+    uint16x8_t u16_q = vcombine_u16(vqmovun_s32(q_low), vqmovun_s32(q_high));
+    vst1_u8(dst_ptr1, vqmovn_u16(u16_q));
+    src_ptr1 += 8;
+    dst_ptr1 += 8;
+  }
+  for (uint64_t i = neon_turn * 8; i < arr_size; i++) {
+    uint32_t val = (uint32_t)src_ptr[i] * numerator / denominator;
+    dst_ptr[i] = val > 255 ? 255 : val;
+  }
+}
+
+inline void neonS162S8Scale(const int16_t *src_ptr, int8_t *dst_ptr, const uint64_t arr_size,
+                            const uint8_t numerator, const uint16_t denominator) {
+  uint64_t neon_turn = arr_size / 8;
+  int32x4_t v_den = vdupq_n_s32(denominator);
+  float32x4_t v_inv_den = vdupq_n_f32(1.f / denominator);
+  const int16_t *src_ptr1 = src_ptr;
+  int8_t *dst_ptr1 = dst_ptr;
+  for (uint64_t i = 0; i < neon_turn; i++) {
+    int16x8_t v16 = vld1q_s16(src_ptr1);
+    int32x4_t q_low = vdivq_s32_trunc(vmull_n_s16(vget_low_s16(v16), numerator), v_den, v_inv_den);
+    int32x4_t q_high =
+        vdivq_s32_trunc(vmull_n_s16(vget_high_s16(v16), numerator), v_den, v_inv_den);
+    int16x8_t s16_q = vcombine_s16(vqmovn_s32(q_low), vqmovn_s32(q_high));
+    vst1_s8(dst_ptr1, vqmovn_s16(s16_q));
+    src_ptr1 += 8;
+    dst_ptr1 += 8;
+  }
+  for (uint64_t i = neon_turn * 8; i < arr_size; i++) {
+    int32_t val = (int32_t)src_ptr[i] * numerator / (int32_t)denominator;
+    dst_ptr[i] = val > 127 ? 127 : (val < -128 ? -128 : val);
+  }
+}
+
+inline void neonS162U8AbsScale(const int16_t *src_ptr, uint8_t *dst_ptr, const uint64_t arr_size,
+                               const uint8_t numerator, const uint16_t denominator) {
+  uint64_t neon_turn = arr_size / 8;
+  int32x4_t v_den = vdupq_n_s32(denominator);
+  float32x4_t v_inv_den = vdupq_n_f32(1.f / denominator);
+  const int16_t *src_ptr1 = src_ptr;
+  uint8_t *dst_ptr1 = dst_ptr;
+  for (uint64_t i = 0; i < neon_turn; i++) {
+    int16x8_t v16 = vld1q_s16(src_ptr1);
+    int32x4_t q_low = vdivq_s32_trunc(vmull_n_s16(vget_low_s16(v16), numerator), v_den, v_inv_den);
+    int32x4_t q_high =
+        vdivq_s32_trunc(vmull_n_s16(vget_high_s16(v16), numerator), v_den, v_inv_den);
+    uint16x8_t u16_q = vcombine_u16(vqmovun_s32(vabsq_s32(q_low)), vqmovun_s32(vabsq_s32(q_high)));
+    vst1_u8(dst_ptr1, vqmovn_u16(u16_q));
+    src_ptr1 += 8;
+    dst_ptr1 += 8;
+  }
+  for (uint64_t i = neon_turn * 8; i < arr_size; i++) {
+    int32_t val = std::abs((int32_t)src_ptr[i] * numerator / (int32_t)denominator);
+    dst_ptr[i] = val > 255 ? 255 : val;
+  }
+}
+
+inline void neonS162U8BiasScale(const int16_t *src_ptr, uint8_t *dst_ptr, const uint64_t arr_size,
+                                const uint8_t numerator, const uint16_t denominator,
+                                const int8_t bias) {
+  uint64_t neon_turn = arr_size / 8;
+  int32x4_t v_den = vdupq_n_s32(denominator);
+  int32x4_t v_bias = vdupq_n_s32(bias);
+  float32x4_t v_inv_den = vdupq_n_f32(1.f / denominator);
+  const int16_t *src_ptr1 = src_ptr;
+  uint8_t *dst_ptr1 = dst_ptr;
+  for (uint64_t i = 0; i < neon_turn; i++) {
+    int16x8_t v16 = vld1q_s16(src_ptr1);
+    int32x4_t q_low = vdivq_s32_trunc(vmull_n_s16(vget_low_s16(v16), numerator), v_den, v_inv_den);
+    int32x4_t q_high =
+        vdivq_s32_trunc(vmull_n_s16(vget_high_s16(v16), numerator), v_den, v_inv_den);
+    q_low = vaddq_s32(q_low, v_bias);
+    q_high = vaddq_s32(q_high, v_bias);
+    uint16x8_t u16_q = vcombine_u16(vqmovun_s32(q_low), vqmovun_s32(q_high));
+    vst1_u8(dst_ptr1, vqmovn_u16(u16_q));
+    src_ptr1 += 8;
+    dst_ptr1 += 8;
+  }
+  for (uint64_t i = neon_turn * 8; i < arr_size; i++) {
+    int32_t val = (int32_t)src_ptr[i] * numerator / (int32_t)denominator + bias;
+    dst_ptr[i] = val > 255 ? 255 : (val < 0 ? 0 : val);
+  }
+}
+
+/**
+ * Element formats used by the type conversion kernels. Each one loads or stores 8 elements as two
+ * float32x4_t and provides the scalar conversions for the row tail. Integer stores round to
+ * nearest and saturate to the range of the format, BF16 stores round to nearest even.
+ */
+template <typename T>
+__attribute__((always_inline)) inline T neonClampRound(float v, const float lo, const float hi) {
+  v = !(v >= lo) ? lo : (v > hi ? hi : v);
+  return (T)std::round(v);
+}
+
+struct neonU8Fmt {
+  typedef uint8_t type;
+  static constexpr float lo() { return 0.f; }
+  static constexpr float hi() { return 255.f; }
+  static inline void load(const uint8_t *ptr, float32x4x2_t *v) {
+    uint16x8_t v16 = vmovl_u8(vld1_u8(ptr));
+    v->val[0] = vcvtq_f32_u32(vmovl_u16(vget_low_u16(v16)));
+    v->val[1] = vcvtq_f32_u32(vmovl_u16(vget_high_u16(v16)));
+  }
+  static inline void store(uint8_t *ptr, const float32x4x2_t &v) {
+    const float32x4_t v_lo = vdupq_n_f32(lo()), v_hi = vdupq_n_f32(hi());
+    int32x4_t s32_0 = vcvtq_s32_f32_r(vminq_f32(vmaxq_f32(v.val[0], v_lo), v_hi));
+    int32x4_t s32_1 = vcvtq_s32_f32_r(vminq_f32(vmaxq_f32(v.val[1], v_lo), v_hi));
+    vst1_u8(ptr, vqmovun_s16(vcombine_s16(vmovn_s32(s32_0), vmovn_s32(s32_1))));
+  }
+  static inline float toF32(const uint8_t v) { return v; }
+  static inline uint8_t fromF32(const float v) { return neonClampRound<uint8_t>(v, lo(), hi()); }
+};
+
+struct neonS8Fmt {
+  typedef int8_t type;
+  static constexpr float lo() { return -128.f; }
+  static constexpr float hi() { return 127.f; }
+  static inline void load(const int8_t *ptr, float32x4x2_t *v) {
+    int16x8_t v16 = vmovl_s8(vld1_s8(ptr));
+    v->val[0] = vcvtq_f32_s32(vmovl_s16(vget_low_s16(v16)));
+    v->val[1] = vcvtq_f32_s32(vmovl_s16(vget_high_s16(v16)));
+  }
+  static inline void store(int8_t *ptr, const float32x4x2_t &v) {
+    const float32x4_t v_lo = vdupq_n_f32(lo()), v_hi = vdupq_n_f32(hi());
+    int32x4_t s32_0 = vcvtq_s32_f32_r(vminq_f32(vmaxq_f32(v.val[0], v_lo), v_hi));
+    int32x4_t s32_1 = vcvtq_s32_f32_r(vminq_f32(vmaxq_f32(v.val[1], v_lo), v_hi));
+    vst1_s8(ptr, vqmovn_s16(vcombine_s16(vmovn_s32(s32_0), vmovn_s32(s32_1))));
+  }
+  static inline float toF32(const int8_t v) { return v; }
+  static inline int8_t fromF32(const float v) { return neonClampRound<int8_t>(v, lo(), hi()); }
+};
+
+struct neonU16Fmt {
+  typedef uint16_t type;
+  static constexpr float lo() { return 0.f; }
+  static constexpr float hi() { return 65535.f; }
+  static inline void load(const uint16_t *ptr, float32x4x2_t *v) {
+    uint16x8_t v16 = vld1q_u16(ptr);
+    v->val[0] = vcvtq_f32_u32(vmovl_u16(vget_low_u16(v16)));
+    v->val[1] = vcvtq_f32_u32(vmovl_u16(vget_high_u16(v16)));
+  }
+  static inline void store(uint16_t *ptr, const float32x4x2_t &v) {
+    const float32x4_t v_lo = vdupq_n_f32(lo()), v_hi = vdupq_n_f32(hi());
+    int32x4_t s32_0 = vcvtq_s32_f32_r(vminq_f32(vmaxq_f32(v.val[0], v_lo), v_hi));
+    int32x4_t s32_1 = vcvtq_s32_f32_r(vminq_f32(vmaxq_f32(v.val[1], v_lo), v_hi));
+    vst1q_u16(ptr, vcombine_u16(vqmovun_s32(s32_0), vqmovun_s32(s32_1)));
+  }
+  static inline float toF32(const uint16_t v) { return v; }
+  static inline uint16_t fromF32(const float v) { return neonClampRound<uint16_t>(v, lo(), hi()); }
+};
+
+struct neonS16Fmt {
+  typedef int16_t type;
+  static constexpr float lo() { return -32768.f; }
+  static constexpr float hi() { return 32767.f; }
+  static inline void load(const int16_t *ptr, float32x4x2_t *v) {
+    int16x8_t v16 = vld1q_s16(ptr);
+    v->val[0] = vcvtq_f32_s32(vmovl_s16(vget_low_s16(v16)));
+    v->val[1] = vcvtq_f32_s32(vmovl_s16(vget_high_s16(v16)));
+  }
+  static inline void store(int16_t *ptr, const float32x4x2_t &v) {
+    const float32x4_t v_lo = vdupq_n_f32(lo()), v_hi = vdupq_n_f32(hi());
+    int32x4_t s32_0 = vcvtq_s32_f32_r(vminq_f32(vmaxq_f32(v.val[0], v_lo), v_hi));
+    int32x4_t s32_1 = vcvtq_s32_f32_r(vminq_f32(vmaxq_f32(v.val[1], v_lo), v_hi));
+    vst1q_s16(ptr, vcombine_s16(vqmovn_s32(s32_0), vqmovn_s32(s32_1)));
+  }
+  static inline float toF32(const int16_t v) { return v; }
+  static inline int16_t fromF32(const float v) { return neonClampRound<int16_t>(v, lo(), hi()); }
+};
+
+struct neonBF16Fmt {
+  typedef uint16_t type;
+  static constexpr float lo() { return -std::numeric_limits<float>::max(); }
+  static constexpr float hi() { return std::numeric_limits<float>::max(); }
+  static inline void load(const uint16_t *ptr, float32x4x2_t *v) {
+    uint16x8_t v16 = vld1q_u16(ptr);
+    neonfloatshort n_float_short;
+    n_float_short.v_u16 = vzipq_u16(vdupq_n_u16(0), v16);
+    *v = n_float_short.v_f32;
+  }
+  static inline uint16x4_t roundToBF16(const float32x4_t v) {
+    uint32x4_t u32 = vreinterpretq_u32_f32(v);
+    uint32x4_t lsb = vandq_u32(vshrq_n_u32(u32, 16), vdupq_n_u32(1));
+    uint32x4_t rounded = vaddq_u32(u32, vaddq_u32(lsb, vdupq_n_u32(0x7fff)));
+    // NaN must not be rounded into infinity.
+    uint32x4_t is_nan = vmvnq_u32(vceqq_f32(v, v));
+    rounded = vbslq_u32(is_nan, vdupq_n_u32(0x7fc00000), rounded);
+    return vshrn_n_u32(rounded, 16);
+  }
+  static inline void store(uint16_t *ptr, const float32x4x2_t &v) {
+    vst1q_u16(ptr, vcombine_u16(roundToBF16(v.val[0]), roundToBF16(v.val[1])));
+  }
+  static inline float toF32(const uint16_t v) {
+    union {
+      uint32_t u;
+      float f;
+    } val;
+    val.u = (uint32_t)v << 16;
+    return val.f;
+  }
+  static inline uint16_t fromF32(const float v) {
+    union {
+      uint32_t u;
+      float f;
+    } val;
+    val.f = v;
+    if (v != v) {
+      return 0x7fc0;
+    }
+    return (val.u + 0x7fff + ((val.u >> 16) & 1)) >> 16;
+  }
+};
+
+struct neonF32Fmt {
+  typedef float type;
+  static constexpr float lo() { return -std::numeric_limits<float>::max(); }
+  static constexpr float hi() { return std::numeric_limits<float>::max(); }
+  static inline void load(const float *ptr, float32x4x2_t *v) {
+    v->val[0] = vld1q_f32(ptr);
+    v->val[1] = vld1q_f32(ptr + 4);
+  }
+  static inline void store(float *ptr, const float32x4x2_t &v) {
+    vst1q_f32(ptr, v.val[0]);
+    vst1q_f32(ptr + 4, v.val[1]);
+  }
+  static inline float toF32(const float v) { return v; }
+  static inline float fromF32(const float v) { return v; }
+};
+
+/**
+ * Convert one row as dst = (src - sub) * scale + add, rounded and saturated to the output
+ * format. sub = 0, scale = 1, add = 0 is a plain saturating conversion.
+ */
+template <typename SrcFmt, typename DstFmt>
+inline void neonConvertRow(const typename SrcFmt::type *src_ptr, typename DstFmt::type *dst_ptr,
+                           const uint64_t arr_size, const float sub, const float scale,
+                           const float add) {
+  uint64_t neon_turn = arr_size / 8;
+  float32x4_t v_sub = vdupq_n_f32(sub);
+  float32x4_t v_scale = vdupq_n_f32(scale);
+  float32x4_t v_add = vdupq_n_f32(add);
+  const typename SrcFmt::type *src_ptr1 = src_ptr;
+  typename DstFmt::type *dst_ptr1 = dst_ptr;
+  for (uint64_t i = 0; i < neon_turn; i++) {
+    float32x4x2_t v;
+    SrcFmt::load(src_ptr1, &v);
+    v.val[0] = vmlaq_f32(v_add, vsubq_f32(v.val[0], v_sub), v_scale);
+    v.val[1] = vmlaq_f32(v_add, vsubq_f32(v.val[1], v_sub), v_scale);
+    DstFmt::store(dst_ptr1, v);
+    src_ptr1 += 8;
+    dst_ptr1 += 8;
+  }
+  for (uint64_t i = neon_turn * 8; i < arr_size; i++) {
+    dst_ptr[i] = DstFmt::fromF32((SrcFmt::toF32(src_ptr[i]) - sub) * scale + add);
+  }
+}
+
+/**
+ * Update min and max with the values of one row. NaN values are skipped.
+ */
+template <typename SrcFmt>
+inline void neonFindMinMaxRow(const typename SrcFmt::type *src_ptr, const uint64_t arr_size,
+                              float *min, float *max) {
+  uint64_t neon_turn = arr_size / 8;
+  float32x4_t v_min = vdupq_n_f32(*min);
+  float32x4_t v_max = vdupq_n_f32(*max);
+  const typename SrcFmt::type *src_ptr1 = src_ptr;
+  for (uint64_t i = 0; i < neon_turn; i++) {
+    float32x4x2_t v;
+    SrcFmt::load(src_ptr1, &v);
+    for (int j = 0; j < 2; j++) {
+      uint32x4_t is_num = vceqq_f32(v.val[j], v.val[j]);
+      v_min = vbslq_f32(is_num, vminq_f32(v_min, v.val[j]), v_min);
+      v_max = vbslq_f32(is_num, vmaxq_f32(v_max, v.val[j]), v_max);
+    }
+    src_ptr1 += 8;
+  }
+  float lane_min[4], lane_max[4];
+  vst1q_f32(lane_min, v_min);
+  vst1q_f32(lane_max, v_max);
+  for (int i = 0; i < 4; i++) {
+    if (lane_min[i] < *min) *min = lane_min[i];
+    if (lane_max[i] > *max) *max = lane_max[i];
+  }
+  for (uint64_t i = neon_turn * 8; i < arr_size; i++) {
+    float val = SrcFmt::toF32(src_ptr[i]);
+    if (val < *min) *min = val;
+    if (val > *max) *max = val;
+  }
+}
+
+/**
+ * Row statistics kernels. Accumulate sum, sum of squares, count, min and max of the pixels whose
+ * mask is non-zero. mask_ptr can be NULL to take every pixel. The outputs are accumulated, so
+ * they must be initialized by the caller. The lane accumulators are flushed every
+ * STATS_FLUSH_TURN turns to stay clear of overflow on long rows.
+ */
+#define STATS_FLUSH_TURN 1024
+
+inline void neonU8RowStats(const uint8_t *src_ptr, const uint8_t *mask_ptr,
+                           const uint64_t arr_size, uint64_t *sum, uint64_t *sq_sum,
+                           uint64_t *count, uint8_t *min, uint8_t *max) {
+  uint64_t neon_turn = arr_size / 16;
+  const uint8x16_t ones = vdupq_n_u8(0xFF);
+  const uint8x16_t v_one = vdupq_n_u8(1);
+  uint8x16_t v_min = vdupq_n_u8(*min);
+  uint8x16_t v_max = vdupq_n_u8(*max);
+  uint32x4_t v_sum = vdupq_n_u32(0), v_sq = vdupq_n_u32(0), v_cnt = vdupq_n_u32(0);
+  uint32_t lanes[4];
+  for (uint64_t i = 0; i < neon_turn; i++) {
+    uint8x16_t v8 = vld1q_u8(src_ptr + i * 16);
+    uint8x16_t m8 = ones;
+    if (mask_ptr != NULL) {
+      uint8x16_t mask = vld1q_u8(mask_ptr + i * 16);
+      m8 = vtstq_u8(mask, mask);
+    }
+    uint8x16_t vm = vandq_u8(v8, m8);
+    v_sum = vpadalq_u16(v_sum, vpaddlq_u8(vm));
+    v_sq = vpadalq_u16(v_sq, vmull_u8(vget_low_u8(vm), vget_low_u8(vm)));
+    v_sq = vpadalq_u16(v_sq, vmull_u8(vget_high_u8(vm), vget_high_u8(vm)));
+    v_cnt = vpadalq_u16(v_cnt, vpaddlq_u8(vandq_u8(m8, v_one)));
+    v_min = vminq_u8(v_min, vbslq_u8(m8, v8, ones));
+    v_max = vmaxq_u8(v_max, vm);
+    if ((i + 1) % STATS_FLUSH_TURN == 0 || i + 1 == neon_turn) {
+      vst1q_u32(lanes, v_sum);
+      *sum += (uint64_t)lanes[0] + lanes[1] + lanes[2] + lanes[3];
+      vst1q_u32(lanes, v_sq);
+      *sq_sum += (uint64_t)lanes[0] + lanes[1] + lanes[2] + lanes[3];
+      vst1q_u32(lanes, v_cnt);
+      *count += (uint64_t)lanes[0] + lanes[1] + lanes[2] + lanes[3];
+      v_sum = vdupq_n_u32(0);
+      v_sq = vdupq_n_u32(0);
+      v_cnt = vdupq_n_u32(0);
+    }
+  }
+  uint8_t lane_min[16], lane_max[16];
+  vst1q_u8(lane_min, v_min);
+  vst1q_u8(lane_max, v_max);
+  for (int i = 0; i < 16; i++) {
+    if (lane_min[i] < *min) *min = lane_min[i];
+    if (lane_max[i] > *max) *max = lane_max[i];
+  }
+  for (uint64_t i = neon_turn * 16; i < arr_size; i++) {
+    if (mask_ptr != NULL && mask_ptr[i] == 0) continue;
+    uint32_t val = src_ptr[i];
+    *sum += val;
+    *sq_sum += val * val;
+    *count += 1;
+    if (val < *min) *min = val;
+    if (val > *max) *max = val;
+  }
+}
+
+__attribute__((always_inline)) inline uint16x8_t neonLoadMask16(const uint8_t *mask_ptr) {
+  if (mask_ptr == NULL) {
+    return vdupq_n_u16(0xFFFF);
+  }
+  uint16x8_t mask = vmovl_u8(vld1_u8(mask_ptr));
+  return vtstq_u16(mask, mask);
+}
+
+inline void neonU16RowStats(const uint16_t *src_ptr, const uint8_t *mask_ptr,
+                            const uint64_t arr_size, uint64_t *sum, uint64_t *sq_sum,
+                            uint64_t *count, uint16_t *min, uint16_t *max) {
+  uint64_t neon_turn = arr_size / 8;
+  const uint16x8_t ones = vdupq_n_u16(0xFFFF);
+  uint16x8_t v_min = vdupq_n_u16(*min);
+  uint16x8_t v_max = vdupq_n_u16(*max);
+  uint32x4_t v_sum = vdupq_n_u32(0), v_cnt = vdupq_n_u32(0);
+  uint64x2_t v_sq = vdupq_n_u64(0);
+  uint32_t lanes[4];
+  uint64_t lanes64[2];
+  for (uint64_t i = 0; i < neon_turn; i++) {
+    uint16x8_t v16 = vld1q_u16(src_ptr + i * 8);
+    uint16x8_t m16 = neonLoadMask16(mask_ptr == NULL ? NULL : mask_ptr + i * 8);
+    uint16x8_t vm = vandq_u16(v16, m16);
+    v_sum = vpadalq_u16(v_sum, vm);
+    v_sq = vpadalq_u32(v_sq, vmull_u16(vget_low_u16(vm), vget_low_u16(vm)));
+    v_sq = vpadalq_u32(v_sq, vmull_u16(vget_high_u16(vm), vget_high_u16(vm)));
+    v_cnt = vpadalq_u16(v_cnt, vshrq_n_u16(m16, 15));
+    v_min = vminq_u16(v_min, vbslq_u16(m16, v16, ones));
+    v_max = vmaxq_u16(v_max, vm);
+    if ((i + 1) % STATS_FLUSH_TURN == 0 || i + 1 == neon_turn) {
+      vst1q_u32(lanes, v_sum);
+      *sum += (uint64_t)lanes[0] + lanes[1] + lanes[2] + lanes[3];
+      vst1q_u32(lanes, v_cnt);
+      *count += (uint64_t)lanes[0] + lanes[1] + lanes[2] + lanes[3];
+      v_sum = vdupq_n_u32(0);
+      v_cnt = vdupq_n_u32(0);
+    }
+  }
+  vst1q_u64(lanes64, v_sq);
+  *sq_sum += lanes64[0] + lanes64[1];
+  uint16_t lane_min[8], lane_max[8];
+  vst1q_u16(lane_min, v_min);
+  vst1q_u16(lane_max, v_max);
+  for (int i = 0; i < 8; i++) {
+    if (lane_min[i] < *min) *min = lane_min[i];
+    if (lane_max[i] > *max) *max = lane_max[i];
+  }
+  for (uint64_t i = neon_turn * 8; i < arr_size; i++) {
+    if (mask_ptr != NULL && mask_ptr[i] == 0) continue;
+    uint64_t val = src_ptr[i];
+    *sum += val;
+    *sq_sum += val * val;
+    *count += 1;
+    if (val < *min) *min = val;
+    if (val > *max) *max = val;
+  }
+}
+
+inline void neonS16RowStats(const int16_t *src_ptr, const uint8_t *mask_ptr,
+                            const uint64_t arr_size, int64_t *sum, uint64_t *sq_sum,
+                            uint64_t *count, int16_t *min, int16_t *max) {
+  uint64_t neon_turn = arr_size / 8;
+  const int16x8_t v_lowest = vdupq_n_s16(-32768);
+  const int16x8_t v_highest = vdupq_n_s16(32767);
+  int16x8_t v_min = vdupq_n_s16(*min);
+  int16x8_t v_max = vdupq_n_s16(*max);
+  int32x4_t v_sum = vdupq_n_s32(0);
+  uint32x4_t v_cnt = vdupq_n_u32(0);
+  uint64x2_t v_sq = vdupq_n_u64(0);
+  int32_t lanes[4];
+  uint32_t ulanes[4];
+  uint64_t lanes64[2];
+  for (uint64_t i = 0; i < neon_turn; i++) {
+    int16x8_t v16 = vld1q_s16(src_ptr + i * 8);
+    uint16x8_t m16 = neonLoadMask16(mask_ptr == NULL ? NULL : mask_ptr + i * 8);
+    int16x8_t vm = vandq_s16(v16, vreinterpretq_s16_u16(m16));
+    v_sum = vpadalq_s16(v_sum, vm);
+    // The square of an int16 always fits in the positive range of int32.
+    v_sq = vpadalq_u32(
+        v_sq, vreinterpretq_u32_s32(vmull_s16(vget_low_s16(vm), vget_low_s16(vm))));
+    v_sq = vpadalq_u32(
+        v_sq, vreinterpretq_u32_s32(vmull_s16(vget_high_s16(vm), vget_high_s16(vm))));
+    v_cnt = vpadalq_u16(v_cnt, vshrq_n_u16(m16, 15));
+    v_min = vminq_s16(v_min, vbslq_s16(m16, v16, v_highest));
+    v_max = vmaxq_s16(v_max, vbslq_s16(m16, v16, v_lowest));
+    if ((i + 1) % STATS_FLUSH_TURN == 0 || i + 1 == neon_turn) {
+      vst1q_s32(lanes, v_sum);
+      *sum += (int64_t)lanes[0] + lanes[1] + lanes[2] + lanes[3];
+      vst1q_u32(ulanes, v_cnt);
+      *count += (uint64_t)ulanes[0] + ulanes[1] + ulanes[2] + ulanes[3];
+      v_sum = vdupq_n_s32(0);
+      v_cnt = vdupq_n_u32(0);
+    }
+  }
+  vst1q_u64(lanes64, v_sq);
+  *sq_sum += lanes64[0] + lanes64[1];
+  int16_t lane_min[8], lane_max[8];
+  vst1q_s16(lane_min, v_min);
+  vst1q_s16(lane_max, v_max);
+  for (int i = 0; i < 8; i++) {
+    if (lane_min[i] < *min) *min = lane_min[i];
+    if (lane_max[i] > *max) *max = lane_max[i];
+  }
+  for (uint64_t i = neon_turn * 8; i < arr_size; i++) {
+    if (mask_ptr != NULL && mask_ptr[i] == 0) continue;
+    int64_t val = src_ptr[i];
+    *sum += val;
+    *sq_sum += val * val;
+    *count += 1;
+    if (val < *min) *min = val;
+    if (val > *max) *max = val;
+  }
+}
+
+inline void neonBF16RowStats(const uint16_t *src_ptr, const uint8_t *mask_ptr,
+                             const uint64_t arr_size, double *sum, double *sq_sum,
+                             uint64_t *count, float *min, float *max) {
+  uint64_t neon_turn = arr_size / 8;
+  const uint16x8_t zeros = vdupq_n_u16(0);
+  const float32x4_t v_highest = vdupq_n_f32(std::numeric_limits<float>::max());
+  const float32x4_t v_lowest = vdupq_n_f32(-std::numeric_limits<float>::max());
+  float32x4_t v_min = vdupq_n_f32(*min);
+  float32x4_t v_max = vdupq_n_f32(*max);
+  float32x4_t v_sum = vdupq_n_f32(0), v_sq = vdupq_n_f32(0);
+  uint32x4_t v_cnt = vdupq_n_u32(0);
+  float lanes[4];
+  uint32_t ulanes[4];
+  // Float lanes lose precision quickly, flush them more often than the integer ones.
+  const uint64_t flush_turn = STATS_FLUSH_TURN / 16;
+  for (uint64_t i = 0; i < neon_turn; i++) {
+    neonfloatshort n_float_short;
+    n_float_short.v_u16 = vzipq_u16(zeros, vld1q_u16(src_ptr + i * 8));
+    int16x8_t m16 =
+        vreinterpretq_s16_u16(neonLoadMask16(mask_ptr == NULL ? NULL : mask_ptr + i * 8));
+    for (int j = 0; j < 2; j++) {
+      float32x4_t v = n_float_short.v_f32.val[j];
+      uint32x4_t m32 = vreinterpretq_u32_s32(
+          vmovl_s16(j == 0 ? vget_low_s16(m16) : vget_high_s16(m16)));
+      float32x4_t vm = vreinterpretq_f32_u32(vandq_u32(vreinterpretq_u32_f32(v), m32));
+      v_sum = vaddq_f32(v_sum, vm);
+      v_sq = vmlaq_f32(v_sq, vm, vm);
+      v_cnt = vsubq_u32(v_cnt, m32);
+      v_min = vminq_f32(v_min, vbslq_f32(m32, v, v_highest));
+      v_max = vmaxq_f32(v_max, vbslq_f32(m32, v, v_lowest));
+    }
+    if ((i + 1) % flush_turn == 0 || i + 1 == neon_turn) {
+      vst1q_f32(lanes, v_sum);
+      *sum += (double)lanes[0] + lanes[1] + lanes[2] + lanes[3];
+      vst1q_f32(lanes, v_sq);
+      *sq_sum += (double)lanes[0] + lanes[1] + lanes[2] + lanes[3];
+      v_sum = vdupq_n_f32(0);
+      v_sq = vdupq_n_f32(0);
+    }
+  }
+  vst1q_u32(ulanes, v_cnt);
+  *count += (uint64_t)ulanes[0] + ulanes[1] + ulanes[2] + ulanes[3];
+  float lane_min[4], lane_max[4];
+  vst1q_f32(lane_min, v_min);
+  vst1q_f32(lane_max, v_max);
+  for (int i = 0; i < 4; i++) {
+    if (lane_min[i] < *min) *min = lane_min[i];
+    if (lane_max[i] > *max) *max = lane_max[i];
+  }
+  for (uint64_t i = neon_turn * 8; i < arr_size; i++) {
+    if (mask_ptr != NULL && mask_ptr[i] == 0) continue;
+    float val = convert_bf16_fp32(src_ptr[i]);
+    *sum += val;
+    *sq_sum += (double)val * val;
+    *count += 1;
+    if (val < *min) *min = val;
+    if (val > *max) *max = val;
+  }
+}
+
+__attribute__((always_inline)) inline void neonSort2(uint8x16_t &a, uint8x16_t &b) {
+  uint8x16_t t = vminq_u8(a, b);
+  b = vmaxq_u8(a, b);
+  a = t;
+}
+
+__attribute__((always_inline)) inline uint8x16_t neonMedian3(uint8x16_t a, uint8x16_t b,
+                                                              uint8x16_t c) {
+  return vmaxq_u8(vminq_u8(a, b), vminq_u8(vmaxq_u8(a, b), c));
+}
+
+/**
+ * 3x3 median of one output row. Each input column is sorted once, then the median is the median
+ * of the max of the lows, the median of the mids and the min of the highs of three columns.
+ * col_buf needs 3 * (dst_width + 2) bytes.
+ */
+inline void neonU8Median3x3Row(const uint8_t *src_ptr, const uint32_t stride, uint8_t *col_buf,
+                               uint8_t *dst_ptr, const uint64_t dst_width) {
+  const uint64_t src_width = dst_width + 2;
+  uint8_t *lo = col_buf, *mid = col_buf + src_width, *hi = col_buf + 2 * src_width;
+  uint64_t neon_turn = src_width / 16;
+  for (uint64_t i = 0; i < neon_turn * 16; i += 16) {
+    uint8x16_t a = vld1q_u8(src_ptr + i);
+    uint8x16_t b = vld1q_u8(src_ptr + stride + i);
+    uint8x16_t c = vld1q_u8(src_ptr + 2 * stride + i);
+    neonSort2(a, b);
+    neonSort2(b, c);
+    neonSort2(a, b);
+    vst1q_u8(lo + i, a);
+    vst1q_u8(mid + i, b);
+    vst1q_u8(hi + i, c);
+  }
+  for (uint64_t i = neon_turn * 16; i < src_width; i++) {
+    uint8_t a = src_ptr[i], b = src_ptr[stride + i], c = src_ptr[2 * stride + i];
+    lo[i] = std::min(std::min(a, b), c);
+    hi[i] = std::max(std::max(a, b), c);
+    mid[i] = std::max(std::min(a, b), std::min(std::max(a, b), c));
+  }
+  neon_turn = dst_width / 16;
+  for (uint64_t i = 0; i < neon_turn * 16; i += 16) {
+    uint8x16_t max_lo =
+        vmaxq_u8(vmaxq_u8(vld1q_u8(lo + i), vld1q_u8(lo + i + 1)), vld1q_u8(lo + i + 2));
+    uint8x16_t min_hi =
+        vminq_u8(vminq_u8(vld1q_u8(hi + i), vld1q_u8(hi + i + 1)), vld1q_u8(hi + i + 2));
+    uint8x16_t med_mid =
+        neonMedian3(vld1q_u8(mid + i), vld1q_u8(mid + i + 1), vld1q_u8(mid + i + 2));
+    vst1q_u8(dst_ptr + i, neonMedian3(max_lo, med_mid, min_hi));
+  }
+  for (uint64_t i = neon_turn * 16; i < dst_width; i++) {
+    uint8_t max_lo = std::max(std::max(lo[i], lo[i + 1]), lo[i + 2]);
+    uint8_t min_hi = std::min(std::min(hi[i], hi[i + 1]), hi[i + 2]);
+    uint8_t a = mid[i], b = mid[i + 1], c = mid[i + 2];
+    uint8_t med_mid = std::max(std::min(a, b), std::min(std::max(a, b), c));
+    dst_ptr[i] = std::max(std::min(max_lo, med_mid), std::min(std::max(max_lo, med_mid), min_hi));
+  }
+}
+
+/**
+ * Median of 25 vectors, left in p[12]. Batcher's odd-even merge sort of 32 inputs with the
+ * padding folded away and the comparators that do not reach the median pruned.
+ */
+inline void neonMedian25(uint8x16_t *p) {
+  // clang-format off
+  neonSort2(p[0], p[1]); neonSort2(p[2], p[3]); neonSort2(p[0], p[2]); neonSort2(p[1], p[3]);
+  neonSort2(p[1], p[2]); neonSort2(p[4], p[5]); neonSort2(p[6], p[7]); neonSort2(p[4], p[6]);
+  neonSort2(p[5], p[7]); neonSort2(p[5], p[6]); neonSort2(p[8], p[9]); neonSort2(p[10], p[11]);
+  neonSort2(p[8], p[10]); neonSort2(p[9], p[11]); neonSort2(p[9], p[10]); neonSort2(p[4], p[8]);
+  neonSort2(p[6], p[10]); neonSort2(p[6], p[8]); neonSort2(p[5], p[9]); neonSort2(p[7], p[11]);
+  neonSort2(p[7], p[9]); neonSort2(p[5], p[6]); neonSort2(p[7], p[8]); neonSort2(p[9], p[10]);
+  neonSort2(p[0], p[8]); neonSort2(p[0], p[4]); neonSort2(p[2], p[10]); neonSort2(p[2], p[6]);
+  neonSort2(p[2], p[4]); neonSort2(p[6], p[8]); neonSort2(p[1], p[9]); neonSort2(p[1], p[5]);
+  neonSort2(p[3], p[11]); neonSort2(p[3], p[7]); neonSort2(p[3], p[5]); neonSort2(p[7], p[9]);
+  neonSort2(p[1], p[2]); neonSort2(p[3], p[4]); neonSort2(p[5], p[6]); neonSort2(p[7], p[8]);
+  neonSort2(p[9], p[10]); neonSort2(p[12], p[13]); neonSort2(p[14], p[15]);
+  neonSort2(p[12], p[14]); neonSort2(p[13], p[15]); neonSort2(p[13], p[14]);
+  neonSort2(p[16], p[17]); neonSort2(p[18], p[19]); neonSort2(p[16], p[18]);
+  neonSort2(p[17], p[19]); neonSort2(p[17], p[18]); neonSort2(p[12], p[16]);
+  neonSort2(p[14], p[18]); neonSort2(p[14], p[16]); neonSort2(p[13], p[17]);
+  neonSort2(p[15], p[19]); neonSort2(p[15], p[17]); neonSort2(p[13], p[14]);
+  neonSort2(p[15], p[16]); neonSort2(p[17], p[18]); neonSort2(p[20], p[21]);
+  neonSort2(p[22], p[23]); neonSort2(p[20], p[22]); neonSort2(p[21], p[23]);
+  neonSort2(p[21], p[22]); neonSort2(p[20], p[24]); neonSort2(p[22], p[24]);
+  neonSort2(p[21], p[22]); neonSort2(p[23], p[24]); neonSort2(p[12], p[20]);
+  neonSort2(p[16], p[24]); neonSort2(p[16], p[20]); neonSort2(p[14], p[22]);
+  neonSort2(p[18], p[22]); neonSort2(p[14], p[16]); neonSort2(p[18], p[20]);
+  neonSort2(p[22], p[24]); neonSort2(p[13], p[21]); neonSort2(p[17], p[21]);
+  neonSort2(p[15], p[23]); neonSort2(p[19], p[23]); neonSort2(p[15], p[17]);
+  neonSort2(p[19], p[21]); neonSort2(p[13], p[14]); neonSort2(p[15], p[16]);
+  neonSort2(p[17], p[18]); neonSort2(p[19], p[20]); neonSort2(p[21], p[22]);
+  neonSort2(p[23], p[24]); p[4] = vminq_u8(p[4], p[20]); p[12] = vmaxq_u8(p[4], p[12]);
+  p[16] = vmaxq_u8(p[0], p[16]); p[8] = vminq_u8(p[8], p[24]); p[8] = vminq_u8(p[8], p[16]);
+  p[12] = vmaxq_u8(p[8], p[12]); p[6] = vminq_u8(p[6], p[22]); p[14] = vmaxq_u8(p[6], p[14]);
+  p[18] = vmaxq_u8(p[2], p[18]); p[10] = vminq_u8(p[10], p[18]); p[10] = vminq_u8(p[10], p[14]);
+  p[12] = vmaxq_u8(p[10], p[12]); p[5] = vminq_u8(p[5], p[21]); p[13] = vmaxq_u8(p[5], p[13]);
+  p[17] = vmaxq_u8(p[1], p[17]); p[9] = vminq_u8(p[9], p[17]); p[13] = vmaxq_u8(p[9], p[13]);
+  p[7] = vminq_u8(p[7], p[23]); p[15] = vmaxq_u8(p[7], p[15]); p[19] = vmaxq_u8(p[3], p[19]);
+  p[11] = vminq_u8(p[11], p[19]); p[11] = vminq_u8(p[11], p[15]); p[11] = vminq_u8(p[11], p[13]);
+  p[12] = vmaxq_u8(p[11], p[12]);
+  // clang-format on
+}
+
+/**
+ * 5x5 median of one output row. The row tail is run through a zero padded copy so every pixel
+ * goes through the same network.
+ */
+inline void neonU8Median5x5Row(const uint8_t *src_ptr, const uint32_t stride, uint8_t *dst_ptr,
+                               const uint64_t dst_width) {
+  uint64_t neon_turn = dst_width / 16;
+  uint8x16_t p[25];
+  for (uint64_t i = 0; i < neon_turn * 16; i += 16) {
+    for (int r = 0; r < 5; r++) {
+      for (int c = 0; c < 5; c++) {
+        p[r * 5 + c] = vld1q_u8(src_ptr + r * stride + i + c);
+      }
+    }
+    neonMedian25(p);
+    vst1q_u8(dst_ptr + i, p[12]);
+  }
+  uint64_t rest = dst_width - neon_turn * 16;
+  if (rest == 0) {
+    return;
+  }
+  uint8_t tail[5][20] = {{0}};
+  for (int r = 0; r < 5; r++) {
+    memcpy(tail[r], src_ptr + r * stride + neon_turn * 16, rest + 4);
+    for (int c = 0; c < 5; c++) {
+      p[r * 5 + c] = vld1q_u8(tail[r] + c);
+    }
+  }
+  neonMedian25(p);
+  uint8_t out[16];
+  vst1q_u8(out, p[12]);
+  memcpy(dst_ptr + neon_turn * 16, out, rest);
+}
+
+/**
+ * Max or min filter of one output row with a kz x kz window, done as a vertical pass into
+ * col_buf followed by a horizontal pass. col_buf needs dst_width + kz - 1 bytes.
+ */
+template <bool IsMax>
+inline void neonU8MaxMinRow(const uint8_t *src_ptr, const uint32_t stride, uint8_t *col_buf,
+                            uint8_t *dst_ptr, const uint64_t dst_width, const uint32_t kz) {
+  const uint64_t src_width = dst_width + kz - 1;
+  uint64_t neon_turn = src_width / 16;
+  for (uint64_t i = 0; i < neon_turn * 16; i += 16) {
+    uint8x16_t v = vld1q_u8(src_ptr + i);
+    for (uint32_t r = 1; r < kz; r++) {
+      uint8x16_t v2 = vld1q_u8(src_ptr + r * stride + i);
+      v = IsMax ? vmaxq_u8(v, v2) : vminq_u8(v, v2);
+    }
+    vst1q_u8(col_buf + i, v);
+  }
+  for (uint64_t i = neon_turn * 16; i < src_width; i++) {
+    uint8_t v = src_ptr[i];
+    for (uint32_t r = 1; r < kz; r++) {
+      v = IsMax ? std::max(v, src_ptr[r * stride + i]) : std::min(v, src_ptr[r * stride + i]);
+    }
+    col_buf[i] = v;
+  }
+  neon_turn = dst_width / 16;
+  for (uint64_t i = 0; i < neon_turn * 16; i += 16) {
+    uint8x16_t v = vld1q_u8(col_buf + i);
+    for (uint32_t c = 1; c < kz; c++) {
+      uint8x16_t v2 = vld1q_u8(col_buf + i + c);
+      v = IsMax ? vmaxq_u8(v, v2) : vminq_u8(v, v2);
+    }
+    vst1q_u8(dst_ptr + i, v);
+  }
+  for (uint64_t i = neon_turn * 16; i < dst_width; i++) {
+    uint8_t v = col_buf[i];
+    for (uint32_t c = 1; c < kz; c++) {
+      v = IsMax ? std::max(v, col_buf[i + c]) : std::min(v, col_buf[i + c]);
+    }
+    dst_ptr[i] = v;
+  }
+}
+
+/**
+ * One row of the running average background model. bg is in UQ8.8, rate is the learning rate in
+ * Q0.15. fg[i] = |src[i] - bg[i]| > thr ? 255 : 0, then bg[i] += (src[i] - bg[i]) * rate.
+ */
+inline void neonU8RunningAvgRow(const uint8_t *src_ptr, uint16_t *bg_ptr, uint8_t *fg_ptr,
+                                const uint32_t width, const int32_t rate, const uint8_t thr) {
+  const uint16x8_t thr16 = vdupq_n_u16(thr);
+  uint32_t i = 0;
+  for (; i + 8 <= width; i += 8) {
+    uint8x8_t src = vld1_u8(src_ptr + i);
+    uint16x8_t bg = vld1q_u16(bg_ptr + i);
+    uint16x8_t diff = vabdq_u16(vmovl_u8(src), vrshrq_n_u16(bg, 8));
+    vst1_u8(fg_ptr + i, vmovn_u16(vcgtq_u16(diff, thr16)));
+    int32x4_t bg_lo = vreinterpretq_s32_u32(vmovl_u16(vget_low_u16(bg)));
+    int32x4_t bg_hi = vreinterpretq_s32_u32(vmovl_u16(vget_high_u16(bg)));
+    uint16x8_t src16 = vshll_n_u8(src, 8);
+    int32x4_t diff_lo = vsubq_s32(vreinterpretq_s32_u32(vmovl_u16(vget_low_u16(src16))), bg_lo);
+    int32x4_t diff_hi = vsubq_s32(vreinterpretq_s32_u32(vmovl_u16(vget_high_u16(src16))), bg_hi);
+    bg_lo = vaddq_s32(bg_lo, vrshrq_n_s32(vmulq_n_s32(diff_lo, rate), 15));
+    bg_hi = vaddq_s32(bg_hi, vrshrq_n_s32(vmulq_n_s32(diff_hi, rate), 15));
+    vst1q_u16(bg_ptr + i, vcombine_u16(vmovn_u32(vreinterpretq_u32_s32(bg_lo)),
+                                       vmovn_u32(vreinterpretq_u32_s32(bg_hi))));
+  }
+  for (; i < width; i++) {
+    int32_t bg = bg_ptr[i];
+    fg_ptr[i] = std::abs(src_ptr[i] - ((bg + 128) >> 8)) > thr ? 255 : 0;
+    bg_ptr[i] = bg + (((((int32_t)src_ptr[i] << 8) - bg) * rate + (1 << 14)) >> 15);
+  }
+}
@@ -5,6 +5,8 @@
 class IveTPUTbl : public IveCore {
  public:
   void setTable(CVI_RT_HANDLE rt_handle, TblMgr *tblmgr, const uint8_t *tbl_data);
+  // The table image is kept between runs and released here.
+  int freeTable(CVI_RT_HANDLE rt_handle);
   virtual int init(CVI_RT_HANDLE rt_handle, cvk_context_t *cvk_ctx) override;
 
  protected:
@@ -27,6 +29,8 @@ class IveTPUTbl : public IveCore {
 class IveTPUTbl512 : public IveCore {
  public:
   void setTable(CVI_RT_HANDLE rt_handle, TblMgr *tblmgr, const uint8_t *tbl_data);
+  // The table image is kept between runs and released here.
+  int freeTable(CVI_RT_HANDLE rt_handle);
   virtual int init(CVI_RT_HANDLE rt_handle, cvk_context_t *cvk_ctx) override;
 
  protected:
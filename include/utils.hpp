@@ -9,7 +9,9 @@
 #include <limits.h>
 #include <string.h>
 #include <sys/sysinfo.h>
+#include <atomic>
 #include <iostream>
+#include <thread>
 #ifndef CV180X
 #include <neon_utils.hpp>
 #endif
@@ -28,7 +30,8 @@
 
 #define MULTIPLIER_ONLY_PACKED_DATA_SIZE 5
 
-inline int createHandle(CVI_RT_HANDLE *rt_handle, cvk_context_t **cvk_ctx) {
+inline int createHandle(CVI_RT_HANDLE *rt_handle, cvk_context_t **cvk_ctx,
+                        uint64_t *cmdbuf_size = nullptr) {
   if (CVI_RT_Init(rt_handle) != CVI_SUCCESS) {
     LOGE("Runtime init failed.\n");
     return CVI_FAILURE;
@@ -50,6 +53,9 @@ inline int createHandle(CVI_RT_HANDLE *rt_handle, cvk_context_t **cvk_ctx) {
     mem = CMDBUF1080;
   }
   *cvk_ctx = (cvk_context_t *)CVI_RT_RegisterKernel(*rt_handle, mem);
+  if (cmdbuf_size != nullptr) {
+    *cmdbuf_size = mem;
+  }
   return CVI_SUCCESS;
 }
 
@@ -292,3 +298,69 @@ static inline uint8_t *get_rt_vaddr(CVI_RT_HANDLE rt_handle, CVI_RT_MEM rt_dev)
   }
   return CVI_RT_MemGetVAddr(rt_dev);
 }
+
+/*
+ * Images smaller than this many pixels per worker are not worth the thread startup cost.
+ */
+#define PARALLEL_MIN_PIXELS_PER_THREAD (1 << 17)
+
+/**
+ * @brief Split rows [0, rows) into contiguous chunks and run func(row_begin, row_end) on each of
+ *        them with one thread per core. Small jobs run inline on the calling thread.
+ *
+ * @param rows Number of rows.
+ * @param row_pixels Amount of work per row, used to decide the number of threads.
+ * @param func Callable taking (uint32_t row_begin, uint32_t row_end).
+ */
+template <typename Func>
+inline void parallelRows(const uint32_t rows, const uint64_t row_pixels, Func func) {
+  uint32_t nthreads = std::thread::hardware_concurrency();
+  uint64_t max_threads = ((uint64_t)rows * row_pixels) / PARALLEL_MIN_PIXELS_PER_THREAD;
+  if (max_threads < nthreads) nthreads = max_threads;
+  if (nthreads > rows) nthreads = rows;
+  if (nthreads <= 1) {
+    func((uint32_t)0, rows);
+    return;
+  }
+  std::vector<std::thread> workers;
+  workers.reserve(nthreads - 1);
+  uint32_t chunk = (rows + nthreads - 1) / nthreads;
+  for (uint32_t begin = chunk; begin < rows; begin += chunk) {
+    uint32_t end = begin + chunk < rows ? begin + chunk : rows;
+    workers.emplace_back(func, begin, end);
+  }
+  func((uint32_t)0, chunk);
+  for (auto &worker : workers) {
+    worker.join();
+  }
+}
+
+/**
+ * @brief Run func(task) for every task in [0, tasks) on a pool of at most max_threads threads.
+ *        Workers pull the next task index when they are done, so only max_threads tasks are in
+ *        flight at any time.
+ *
+ * @param tasks Number of tasks.
+ * @param max_threads Upper bound of the pool size, 0 means one thread per core.
+ * @param func Callable taking (uint32_t task).
+ */
+template <typename Func>
+inline void parallelTasks(const uint32_t tasks, uint32_t max_threads, Func func) {
+  uint32_t nthreads = std::thread::hardware_concurrency();
+  if (max_threads != 0 && max_threads < nthreads) nthreads = max_threads;
+  if (nthreads > tasks) nthreads = tasks;
+  std::atomic<uint32_t> next(0);
+  auto worker_func = [&]() {
+    for (uint32_t task = next++; task < tasks; task = next++) {
+      func(task);
+    }
+  };
+  std::vector<std::thread> workers;
+  for (uint32_t i = 1; i < nthreads; i++) {
+    workers.emplace_back(worker_func);
+  }
+  worker_func();
+  for (auto &worker : workers) {
+    worker.join();
+  }
+}
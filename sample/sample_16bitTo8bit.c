@@ -37,6 +37,9 @@ int main(int argc, char** argv) {
 
   IVE_16BIT_TO_8BIT_CTRL_S ctrl;
   ctrl.enMode = IVE_16BIT_TO_8BIT_MODE_U16_TO_U8;
+  ctrl.u8Numerator = 1;
+  ctrl.u16Denominator = 1;
+  ctrl.s8Bias = 0;
 
   struct timeval t0, t1;
   gettimeofday(&t0, NULL);
@@ -32,6 +32,7 @@ int main(int argc, char **argv) {
   printf("Run TPU Max.\n");
   IVE_ORD_STAT_FILTER_CTRL_S pstOrdStatFltCtrl;
   pstOrdStatFltCtrl.enMode = IVE_ORD_STAT_FILTER_MODE_MAX;
+  pstOrdStatFltCtrl.u8KernelSize = 3;
   int ret = CVI_IVE_OrdStatFilter(handle, &src, &dst, &pstOrdStatFltCtrl, 0);
 
   printf("Run TPU Min.\n");
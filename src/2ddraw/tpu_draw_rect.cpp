@@ -1,167 +1,239 @@
 #include <string.h>
+#include <algorithm>
 #include "2ddraw/tpu_draw.hpp"
 
-inline void DrawPairLine(cvk_context_t *cvk_ctx, const uint8_t value, const cvk_tg_t &out) {
-  cvk_tdma_l2g_tensor_fill_constant_param_t fill_param;
-  fill_param.constant = (uint16_t)value;
-  if (out.shape.w > 4096 || out.shape.h > 4096) {
-    cvk_tg_t tmp_out = out;
-    const uint32_t hw_max = 4096;
-    for (uint32_t i = 0; i < out.shape.h; i += hw_max) {
-      for (uint32_t j = 0; j < out.shape.w; j += hw_max) {
-        uint32_t tmp_h = tmp_out.shape.h - hw_max * i;
-        uint32_t tmp_w = tmp_out.shape.w - hw_max * j;
-        tmp_out.shape.h = tmp_h > 4096 ? 4096 : tmp_h;
-        tmp_out.shape.w = tmp_w > 4096 ? 4096 : tmp_w;
-        tmp_out.start_address = out.start_address + i * out.stride.h + j * 4096;
-        fill_param.dst = &tmp_out;
-        cvk_ctx->ops->tdma_l2g_tensor_fill_constant(cvk_ctx, &fill_param);
-      }
+// Largest n, c, h or w of a single TDMA fill.
+#define DRAW_FILL_MAX_DIM 4096
+
+struct DrawPlaneDesc {
+  uint32_t plane;
+  uint32_t shift;  // Subsampling of the plane.
+  uint32_t step;   // Bytes between two pixels of the plane.
+  uint32_t phase;  // Byte of the pixel inside a step.
+  uint32_t color_idx;
+};
+
+// A horizontal band of rows [row, row + rows) and elements [x0, x0 + count * step).
+struct DrawSeg {
+  uint32_t plane;
+  uint8_t value;
+  uint32_t step;
+  uint32_t row, rows;
+  uint32_t x0, count;
+};
+
+static void pushDrawFill(const DrawFill &fill, std::vector<DrawFill> *fills) {
+  const uint32_t dims[4] = {fill.w, fill.h, fill.c, fill.n};
+  const uint32_t strides[4] = {1, fill.stride_h, fill.stride_c, fill.stride_n};
+  for (int d = 0; d < 4; d++) {
+    if (dims[d] <= DRAW_FILL_MAX_DIM) continue;
+    for (uint32_t i = 0; i < dims[d]; i += DRAW_FILL_MAX_DIM) {
+      DrawFill part = fill;
+      uint32_t len = std::min<uint32_t>(DRAW_FILL_MAX_DIM, dims[d] - i);
+      uint32_t *part_dims[4] = {&part.w, &part.h, &part.c, &part.n};
+      *part_dims[d] = len;
+      part.offset += i * strides[d];
+      pushDrawFill(part, fills);
     }
-  } else {
-    fill_param.dst = &out;
-    cvk_ctx->ops->tdma_l2g_tensor_fill_constant(cvk_ctx, &fill_param);
+    return;
   }
+  fills->push_back(fill);
 }
 
-CVI_S32 generateCMD_YUV420SP(cvk_context_t *cvk_ctx, uint16_t x1, uint16_t y1, uint16_t x2,
-                             uint16_t y2, uint8_t *color, CviImg &output) {
-  if (output.m_tg.shape.w % 2 != 0 && output.m_tg.shape.h % 2 != 0) {
-    LOGE("Currently does not support odd width or height for YUV CVI_YUV420SP\n");
-    return CVI_FAILURE;
+static bool getDrawPlanes(CVIIMGTYPE type, std::vector<DrawPlaneDesc> *planes) {
+  switch (type) {
+    case CVI_RGB_PLANAR:
+      *planes = {{0, 0, 1, 0, 0}, {1, 0, 1, 0, 1}, {2, 0, 1, 0, 2}};
+      return true;
+    case CVI_YUV420P:
+      *planes = {{0, 0, 1, 0, 0}, {1, 1, 1, 0, 1}, {2, 1, 1, 0, 2}};
+      return true;
+    case CVI_YUV420SP:
+      // Interleaved chroma starts with V.
+      *planes = {{0, 0, 1, 0, 0}, {1, 1, 2, 0, 2}, {1, 1, 2, 1, 1}};
+      return true;
+    default:
+      LOGE("Unsupported images type: %d.\n", type);
+      return false;
   }
-  uint16_t rect_width[2] = {0};
-  uint16_t rect_height[2] = {0};
-  uint8_t shift[2] = {0};
-  shift[1] = 1;
-  x1 = (x1 >> 1) << 1;
-  y1 = (y1 >> 1) << 1;
-  x2 = (x2 >> 1) << 1;
-  y2 = (y2 >> 1) << 1;
-  rect_width[0] = x2 - x1;
-  rect_width[1] = (x2 - x1) >> 1;
-  rect_height[0] = y2 - y1;
-  rect_height[1] = (y2 - y1) >> 1;
+}
 
-  // Y plane
-  cvk_tg_t out;
-  memset(&out, 0, sizeof(cvk_tg_t));
-  {
-    out.fmt = output.m_tg.fmt;
-    out.start_address = output.GetPAddr() + output.GetImgCOffsets()[0] +
-                        output.GetImgStrides()[0] * (y1 >> shift[0]) + (x1 >> shift[0]);
-    out.shape = {1, 2, (uint32_t)(2 >> shift[0]), rect_width[0]};
-    out.stride.h = output.GetImgStrides()[0];
-    out.stride.c = output.GetImgStrides()[0] * rect_height[0];
-    out.stride.n = 2 * out.stride.c;
-    DrawPairLine(cvk_ctx, color[0], out);
-    out.shape = {1, rect_height[0], 2, (uint32_t)(2 >> shift[0])};
-    out.stride.h = rect_width[0];
-    out.stride.c = output.GetImgStrides()[0];
-    out.stride.n = out.stride.c;
-    DrawPairLine(cvk_ctx, color[0], out);
+int genDrawRectFills(const IVE_DRAW_RECT_ITEM_S *items, uint32_t num, const CviImg &output,
+                     std::vector<DrawFill> *fills) {
+  std::vector<DrawPlaneDesc> planes;
+  if (!getDrawPlanes(output.GetImgType(), &planes)) {
+    return CVI_FAILURE;
   }
-
-  // v plane
-  memset(&out, 0, sizeof(cvk_tg_t));
-  {
-    out.fmt = output.m_tg.fmt;
-    out.start_address = output.GetPAddr() + output.GetImgCOffsets()[1] +
-                        output.GetImgStrides()[1] * (y1 >> shift[1]) + (x1);
-
-    out.shape = {1, 2, (uint32_t)(rect_width[0] >> 1), (uint32_t)(2 >> shift[1])};
-    out.stride.h = 2;
-    out.stride.c = output.GetImgStrides()[1] * rect_height[1];
-    out.stride.n = out.stride.c;
-    DrawPairLine(cvk_ctx, color[2], out);
-
-    out.shape = {1, rect_height[1], 2, (uint32_t)(2 >> shift[1])};
-    out.stride.h = rect_width[0];
-    out.stride.c = output.GetImgStrides()[1];
-    out.stride.n = out.stride.c;
-    DrawPairLine(cvk_ctx, color[2], out);
+  const bool is_yuv = output.GetImgType() != CVI_RGB_PLANAR;
+  const uint32_t width = output.GetImgWidth();
+  const uint32_t height = output.GetImgHeight();
+  if (is_yuv && (width % 2 != 0 || height % 2 != 0)) {
+    LOGE("Currently does not support odd width or height for YUV.\n");
+    return CVI_FAILURE;
   }
+  const std::vector<uint32_t> strides = output.GetImgStrides();
 
-  // u plane
-  memset(&out, 0, sizeof(cvk_tg_t));
-  {
-    out.fmt = output.m_tg.fmt;
-    out.start_address = output.GetPAddr() + output.GetImgCOffsets()[1] +
-                        output.GetImgStrides()[1] * (y1 >> shift[1]) + (x1 + 1);
+  fills->clear();
+  std::vector<DrawSeg> segs;
+  for (uint32_t i = 0; i < num; i++) {
+    const IVE_DRAW_RECT_ITEM_S &item = items[i];
+    uint32_t x1 = item.rect.pts[0].x, y1 = item.rect.pts[0].y;
+    uint32_t x2 = std::min<uint32_t>(item.rect.pts[1].x, width - 1);
+    uint32_t y2 = std::min<uint32_t>(item.rect.pts[1].y, height - 1);
+    uint32_t t = item.thickness == 0 ? 2 : item.thickness;
+    if (is_yuv) {
+      // Whole 2x2 blocks so that the chroma planes cover the same area.
+      x1 &= ~1u;
+      y1 &= ~1u;
+      x2 |= 1u;
+      y2 |= 1u;
+      t = (t + 1) & ~1u;
+    }
+    if (x1 > x2 || y1 > y2) continue;
 
-    out.shape = {1, 2, (uint32_t)(rect_width[0] >> 1), (uint32_t)(2 >> shift[1])};
-    out.stride.h = 2;
-    out.stride.c = output.GetImgStrides()[1] * rect_height[1];
-    out.stride.n = out.stride.c;
-    DrawPairLine(cvk_ctx, color[1], out);
+    uint8_t color[3];
+    IVE_COLOR_S rgb = item.color;
+    if (is_yuv) {
+      getYUVColorLimitedUV(rgb, color);
+    } else {
+      color[0] = rgb.r;
+      color[1] = rgb.g;
+      color[2] = rgb.b;
+    }
+    for (auto &desc : planes) {
+      const uint32_t px1 = x1 >> desc.shift, px2 = x2 >> desc.shift;
+      const uint32_t py1 = y1 >> desc.shift, py2 = y2 >> desc.shift;
+      const uint32_t pt = t >> desc.shift;
+      const uint32_t rw = px2 - px1 + 1, rh = py2 - py1 + 1;
+      const uint32_t x0 = px1 * desc.step + desc.phase;
+      const uint8_t value = color[desc.color_idx];
+      if (rw <= 2 * pt || rh <= 2 * pt) {
+        segs.push_back({desc.plane, value, desc.step, py1, rh, x0, rw});
+        continue;
+      }
+      segs.push_back({desc.plane, value, desc.step, py1, pt, x0, rw});
+      segs.push_back({desc.plane, value, desc.step, py2 - pt + 1, pt, x0, rw});
 
-    out.shape = {1, rect_height[1], 2, (uint32_t)(2 >> shift[1])};
-    out.stride.h = rect_width[0];
-    out.stride.c = output.GetImgStrides()[1];
-    out.stride.n = out.stride.c;
-    DrawPairLine(cvk_ctx, color[1], out);
+      // Left and right edges of every row between the horizontal bands.
+      DrawFill fill;
+      memset(&fill, 0, sizeof(fill));
+      fill.plane = desc.plane;
+      fill.value = value;
+      fill.offset = (py1 + pt) * strides[desc.plane] + x0;
+      const uint32_t dx = (rw - pt) * desc.step;
+      if (desc.step == 1) {
+        fill.n = 1;
+        fill.c = rh - 2 * pt;
+        fill.h = 2;
+        fill.w = pt;
+        fill.stride_c = strides[desc.plane];
+        fill.stride_h = dx;
+        fill.stride_n = fill.c * fill.stride_c;
+      } else {
+        fill.n = rh - 2 * pt;
+        fill.c = 2;
+        fill.h = pt;
+        fill.w = 1;
+        fill.stride_n = strides[desc.plane];
+        fill.stride_c = dx;
+        fill.stride_h = desc.step;
+      }
+      pushDrawFill(fill, fills);
+    }
   }
-  return CVI_SUCCESS;
-}
 
-int IveTPUDrawHollowRect::addCmd(cvk_context_t *cvk_ctx, uint16_t x1, uint16_t y1, uint16_t x2,
-                                 uint16_t y2, uint8_t *color, CviImg &output) {
-  if (x2 >= output.GetImgWidth()) x2 = output.GetImgWidth() - 1;
-  if (y2 >= output.GetImgHeight()) y2 = output.GetImgHeight() - 1;
-  if (((int)x2 - x1) < 4 || ((int)y2 - y1) < 4) {
-    LOGE("Invalid rect area\n");
-    return CVI_FAILURE;
-  }
-  if (output.IsPlanar()) {
-    uint16_t rect_width[3] = {0};
-    uint16_t rect_height[3] = {0};
-    uint8_t shift[3] = {0};
-    if (output.GetImgType() == CVI_RGB_PLANAR) {
-      rect_width[0] = rect_width[1] = rect_width[2] = x2 - x1;
-      rect_height[0] = rect_height[1] = rect_height[2] = y2 - y1;
-    } else if (output.GetImgType() == CVI_YUV420P) {
-      if (output.m_tg.shape.w % 2 != 0 && output.m_tg.shape.h % 2 != 0) {
-        LOGE("Currently does not support odd width or height for YUV CVI_YUV420P\n");
-        return CVI_FAILURE;
+  // Merge overlapping or touching bands on the same rows.
+  std::sort(segs.begin(), segs.end(), [](const DrawSeg &a, const DrawSeg &b) {
+    if (a.plane != b.plane) return a.plane < b.plane;
+    if (a.value != b.value) return a.value < b.value;
+    if (a.step != b.step) return a.step < b.step;
+    if (a.row != b.row) return a.row < b.row;
+    if (a.rows != b.rows) return a.rows < b.rows;
+    if (a.x0 % a.step != b.x0 % b.step) return a.x0 % a.step < b.x0 % b.step;
+    return a.x0 < b.x0;
+  });
+  std::vector<DrawSeg> merged;
+  for (auto &seg : segs) {
+    if (!merged.empty()) {
+      DrawSeg &last = merged.back();
+      uint32_t last_end = last.x0 + last.count * last.step;
+      if (last.plane == seg.plane && last.value == seg.value && last.step == seg.step &&
+          last.row == seg.row && last.rows == seg.rows &&
+          last.x0 % last.step == seg.x0 % seg.step && seg.x0 <= last_end) {
+        uint32_t seg_end = seg.x0 + seg.count * seg.step;
+        last.count = (std::max(last_end, seg_end) - last.x0) / last.step;
+        continue;
       }
-      shift[1] = shift[2] = 1;
-      x1 = (x1 >> 1) << 1;
-      y1 = (y1 >> 1) << 1;
-      x2 = (x2 >> 1) << 1;
-      y2 = (y2 >> 1) << 1;
-      rect_width[0] = x2 - x1;
-      rect_width[1] = rect_width[2] = (x2 - x1) >> 1;
-      rect_height[0] = y2 - y1;
-      rect_height[1] = rect_height[2] = (y2 - y1) >> 1;
-
-    } else {
-      LOGE("Unsupported copy type %d.\n", output.GetImgType());
-      return CVI_FAILURE;
     }
-    cvk_tg_t out;
-    memset(&out, 0, sizeof(cvk_tg_t));
-    for (uint8_t i = 0; i < 3; i++) {
-      out.fmt = output.m_tg.fmt;
-      out.start_address = output.GetPAddr() + output.GetImgCOffsets()[i] +
-                          output.GetImgStrides()[i] * (y1 >> shift[i]) + (x1 >> shift[i]);
-      out.shape = {1, 2, (uint32_t)(2 >> shift[i]), rect_width[i]};
-      out.stride.h = output.GetImgStrides()[i];
-      out.stride.c = output.GetImgStrides()[i] * rect_height[i];
-      out.stride.n = 2 * out.stride.c;
-      DrawPairLine(cvk_ctx, color[i], out);
-      out.shape = {1, rect_height[i], 2, (uint32_t)(2 >> shift[i])};
-      out.stride.h = rect_width[i];
-      out.stride.c = output.GetImgStrides()[i];
-      out.stride.n = out.stride.c;
-      DrawPairLine(cvk_ctx, color[i], out);
+    merged.push_back(seg);
+  }
+
+  // Bands of the same shape at a constant row distance, like the top and the bottom edge of a
+  // rectangle, share one fill.
+  std::sort(merged.begin(), merged.end(), [](const DrawSeg &a, const DrawSeg &b) {
+    if (a.plane != b.plane) return a.plane < b.plane;
+    if (a.value != b.value) return a.value < b.value;
+    if (a.step != b.step) return a.step < b.step;
+    if (a.rows != b.rows) return a.rows < b.rows;
+    if (a.x0 != b.x0) return a.x0 < b.x0;
+    if (a.count != b.count) return a.count < b.count;
+    return a.row < b.row;
+  });
+  for (size_t i = 0; i < merged.size();) {
+    const DrawSeg &seg = merged[i];
+    size_t j = i + 1;
+    uint32_t dr = 0;
+    for (; j < merged.size(); j++) {
+      const DrawSeg &next = merged[j];
+      if (next.plane != seg.plane || next.value != seg.value || next.step != seg.step ||
+          next.rows != seg.rows || next.x0 != seg.x0 || next.count != seg.count) {
+        break;
+      }
+      uint32_t d = next.row - merged[j - 1].row;
+      if (d < seg.rows || (dr != 0 && d != dr)) break;
+      dr = d;
     }
-  } else {
-    if (output.GetImgType() == CVI_YUV420SP) {
-      return generateCMD_YUV420SP(cvk_ctx, x1, y1, x2, y2, color, output);
+    const uint32_t k = j - i;
+    const uint32_t stride = strides[seg.plane];
+    DrawFill fill;
+    memset(&fill, 0, sizeof(fill));
+    fill.plane = seg.plane;
+    fill.value = seg.value;
+    fill.offset = seg.row * stride + seg.x0;
+    if (seg.step == 1) {
+      fill.n = 1;
+      fill.c = k;
+      fill.h = seg.rows;
+      fill.w = seg.count;
+      fill.stride_h = stride;
+      fill.stride_c = k > 1 ? dr * stride : seg.rows * stride;
+      fill.stride_n = k * fill.stride_c;
     } else {
-      LOGE("Unsupported images type: %d.\n", output.GetImgType());
-      return CVI_FAILURE;
+      fill.n = k;
+      fill.c = seg.rows;
+      fill.h = seg.count;
+      fill.w = 1;
+      fill.stride_h = seg.step;
+      fill.stride_c = stride;
+      fill.stride_n = k > 1 ? dr * stride : seg.rows * stride;
     }
+    pushDrawFill(fill, fills);
+    i = j;
   }
   return CVI_SUCCESS;
-}
\ No newline at end of file
+}
+
+void IveTPUDrawFill::addCmd(cvk_context_t *cvk_ctx, const DrawFill &fill, const CviImg &output) {
+  cvk_tg_t out;
+  memset(&out, 0, sizeof(cvk_tg_t));
+  out.fmt = output.m_tg.fmt;
+  out.start_address = output.GetPAddr() + output.GetImgCOffsets()[fill.plane] + fill.offset;
+  out.shape = {fill.n, fill.c, fill.h, fill.w};
+  out.stride.n = fill.stride_n;
+  out.stride.c = fill.stride_c;
+  out.stride.h = fill.stride_h;
+  cvk_tdma_l2g_tensor_fill_constant_param_t fill_param;
+  fill_param.constant = (uint16_t)fill.value;
+  fill_param.dst = &out;
+  cvk_ctx->ops->tdma_l2g_tensor_fill_constant(cvk_ctx, &fill_param);
+}
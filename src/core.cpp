@@ -543,6 +543,13 @@ void IveCore::beforeSubmit(CVI_RT_HANDLE rt_handle, cvk_context_t *cvk_ctx,
 
 int IveCore::postProcess(CVI_RT_HANDLE rt_handle) { return CVI_SUCCESS; }
 
+int IveCore::submitDeferred(CVI_RT_HANDLE rt_handle, cvk_context_t *cvk_ctx) {
+  CVI_RT_Submit(cvk_ctx);
+  return postProcess(rt_handle);
+}
+
+int IveCore::dropDeferred(CVI_RT_HANDLE rt_handle) { return postProcess(rt_handle); }
+
 int IveCore::runSingleSizeKernel(CVI_RT_HANDLE rt_handle, cvk_context_t *cvk_ctx,
                                  const std::vector<CviImg *> &input, std::vector<CviImg *> &output,
                                  bool enable_min_max) {
@@ -796,12 +803,14 @@ int IveCore::runSingleSizeKernel(CVI_RT_HANDLE rt_handle, cvk_context_t *cvk_ctx
 
   beforeSubmit(rt_handle, cvk_ctx, input, output);
 
-  if (ret == CVI_SUCCESS) {
+  if (ret == CVI_SUCCESS && !m_defer_submit) {
     CVI_RT_Submit(cvk_ctx);
   }
 
   freeTLMems(cvk_ctx);
-  postProcess(rt_handle);
+  if (!m_defer_submit) {
+    postProcess(rt_handle);
+  }
   return ret;
 }
 
@@ -1064,12 +1073,14 @@ int IveCore::runSingleSizeKernelMultiBatch(CVI_RT_HANDLE rt_handle, cvk_context_
 
   ret |= checkIsBufferOverflow(input, output, bm_src_info, bm_dest_info, m_kernel_info.pad[0],
                                m_kernel_info.pad[2], false, true);
-  if (ret == CVI_SUCCESS) {
+  if (ret == CVI_SUCCESS && !m_defer_submit) {
     CVI_RT_Submit(cvk_ctx);
   }
 
   freeTLMems(cvk_ctx);
-  postProcess(rt_handle);
+  if (!m_defer_submit) {
+    postProcess(rt_handle);
+  }
   return ret;
 }
 int IveCore::runSingleSizeExtKernel(CVI_RT_HANDLE rt_handle, cvk_context_t *cvk_ctx,
@@ -1552,12 +1563,14 @@ int IveCore::runSingleSizeExtKernel(CVI_RT_HANDLE rt_handle, cvk_context_t *cvk_
                                m_kernel_info.pad[2], true, true);
   beforeSubmit(rt_handle, cvk_ctx, input, output);
 
-  if (ret == CVI_SUCCESS) {
+  if (ret == CVI_SUCCESS && !m_defer_submit) {
     CVI_RT_Submit(cvk_ctx);
   }
 
   freeTLMems(cvk_ctx);
-  postProcess(rt_handle);
+  if (!m_defer_submit) {
+    postProcess(rt_handle);
+  }
   return CVI_SUCCESS;
 }
 
@@ -1849,11 +1862,13 @@ int IveCore::runNoKernel(CVI_RT_HANDLE rt_handle, cvk_context_t *cvk_ctx,
 
   beforeSubmit(rt_handle, cvk_ctx, input, output);
 
-  if (ret == CVI_SUCCESS) {
+  if (ret == CVI_SUCCESS && !m_defer_submit) {
     CVI_RT_Submit(cvk_ctx);
   }
 
   freeTLMems(cvk_ctx);
-  postProcess(rt_handle);
+  if (!m_defer_submit) {
+    postProcess(rt_handle);
+  }
   return CVI_SUCCESS;
 }
@@ -5,8 +5,19 @@
 #define STB_IMAGE_WRITE_IMPLEMENTATION
 #include "stb/stb_image_write.h"
 
+#include "LibLinear/linear.h"
+
+#include <fcntl.h>
+#include <strings.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <condition_variable>
 #include <iostream>
 #include <memory>
+#include <mutex>
+#include <type_traits>
+#include <unordered_set>
 /**
  * @brief String array of IVE_IMAGE_S enType.
  *
@@ -83,7 +94,8 @@ static CviImg *ExtractYuvPlane(IVE_IMAGE_S *src, int plane) {
 
 IVE_HANDLE CVI_IVE_CreateHandle() {
   IVE_HANDLE_CTX *handle_ctx = new IVE_HANDLE_CTX;
-  if (createHandle(&handle_ctx->rt_handle, &handle_ctx->cvk_ctx) != CVI_SUCCESS) {
+  if (createHandle(&handle_ctx->rt_handle, &handle_ctx->cvk_ctx, &handle_ctx->cmdbuf_size) !=
+      CVI_SUCCESS) {
     LOGE("Create handle failed.\n");
     delete handle_ctx;
     return NULL;
@@ -97,8 +109,18 @@ IVE_HANDLE CVI_IVE_CreateHandle() {
   return (void *)handle_ctx;
 }
 
+static void delete_video_frame_wrap(IVE_HANDLE_CTX *handle_ctx, size_t i);
+
 CVI_S32 CVI_IVE_DestroyHandle(IVE_HANDLE pIveHandle) {
   IVE_HANDLE_CTX *handle_ctx = reinterpret_cast<IVE_HANDLE_CTX *>(pIveHandle);
+  destroyAsyncWriter(handle_ctx->async_writer);
+  while (!handle_ctx->frame_wraps.empty()) {
+    delete_video_frame_wrap(handle_ctx, handle_ctx->frame_wraps.size() - 1);
+  }
+  CVI_SYS_FreeI(pIveHandle, &handle_ctx->map_table_index);
+  CVI_SYS_FreeI(pIveHandle, &handle_ctx->map_lookup_index);
+  handle_ctx->t_h.t_tbl.freeTable(handle_ctx->rt_handle);
+  handle_ctx->t_h.t_tbl512.freeTable(handle_ctx->rt_handle);
   handle_ctx->t_h.t_tblmgr.free(handle_ctx->rt_handle);
   destroyHandle(handle_ctx->rt_handle, handle_ctx->cvk_ctx);
   delete handle_ctx;
@@ -175,23 +197,23 @@ CVI_S32 CVI_IVE_CreateImage2(IVE_HANDLE pIveHandle, IVE_IMAGE_S *pstImg, IVE_IMA
       strides.push_back(stride);
       strides.push_back(stride);
       heights.push_back(u32Height);
-      heights.push_back(u32Height >> 1);
+      heights.push_back((u32Height + 1) / 2);
     } break;
     case IVE_IMAGE_TYPE_YUV420P: {
       img_type = CVI_YUV420P;
       const uint32_t stride = WidthAlign(u32Width, DEFAULT_ALIGN);
       strides.push_back(stride);
-      const uint32_t stride2 = WidthAlign(u32Width >> 1, DEFAULT_ALIGN);
+      const uint32_t stride2 = WidthAlign((u32Width + 1) / 2, DEFAULT_ALIGN);
       strides.push_back(stride2);
       strides.push_back(stride2);
       heights.push_back(u32Height);
-      heights.push_back(u32Height >> 1);
-      heights.push_back(u32Height >> 1);
+      heights.push_back((u32Height + 1) / 2);
+      heights.push_back((u32Height + 1) / 2);
     } break;
     case IVE_IMAGE_TYPE_YUV422P: {
       img_type = CVI_YUV422P;
       const uint32_t stride = WidthAlign(u32Width, DEFAULT_ALIGN);
-      const uint32_t stride2 = WidthAlign(u32Width >> 1, DEFAULT_ALIGN);
+      const uint32_t stride2 = WidthAlign((u32Width + 1) / 2, DEFAULT_ALIGN);
       strides.push_back(stride);
       strides.push_back(stride2);
       strides.push_back(stride2);
@@ -328,14 +350,14 @@ CVI_S32 CVI_IVE_ImageInit(IVE_IMAGE_S *pstSrc) {
       c = 2;
       img_type = CVIIMGTYPE::CVI_YUV420SP;
       heights.push_back(pstSrc->u32Height);
-      heights.push_back(pstSrc->u32Height >> 1);
+      heights.push_back((pstSrc->u32Height + 1) / 2);
     } break;
     case IVE_IMAGE_TYPE_YUV420P: {
       c = 3;
       img_type = CVIIMGTYPE::CVI_YUV420P;
       heights.push_back(pstSrc->u32Height);
-      heights.push_back(pstSrc->u32Height >> 1);
-      heights.push_back(pstSrc->u32Height >> 1);
+      heights.push_back((pstSrc->u32Height + 1) / 2);
+      heights.push_back((pstSrc->u32Height + 1) / 2);
     } break;
     case IVE_IMAGE_TYPE_YUV422P: {
       c = 3;
@@ -488,7 +510,110 @@ CVI_S32 CVI_IVE_Image2VideoFrameInfo(IVE_IMAGE_S *pstIISrc, VIDEO_FRAME_INFO_S *
   return CVI_SUCCESS;
 }
 
-CVI_S32 CVI_IVE_VideoFrameInfo2Image(VIDEO_FRAME_INFO_S *pstVFISrc, IVE_IMAGE_S *pstIIDst) {
+// Idle video frame wrappers kept by a handle before the least recently used one is dropped.
+#define VIDEO_FRAME_WRAP_NUM 16
+
+// Describes the planes of a video frame. With y_only the frame is seen as its Y plane alone.
+static CVI_S32 video_frame_layout(const VIDEO_FRAME_S *pstVFSrc, bool y_only,
+                                  CVIIMGTYPE *img_type, IVE_IMAGE_TYPE_E *enType,
+                                  std::vector<uint32_t> *heights, std::vector<uint32_t> *strides,
+                                  std::vector<uint32_t> *u32_length) {
+  size_t c = 1;
+  *img_type = CVIIMGTYPE::CVI_GRAY;
+  heights->clear();
+  if (y_only) {
+    switch (pstVFSrc->enPixelFormat) {
+      case PIXEL_FORMAT_YUV_400:
+      case PIXEL_FORMAT_NV21:
+      case PIXEL_FORMAT_NV12:
+      case PIXEL_FORMAT_YUV_PLANAR_420: {
+        *enType = IVE_IMAGE_TYPE_U8C1;
+        heights->push_back(pstVFSrc->u32Height);
+      } break;
+      default: {
+        LOGE("Unsupported conversion type: %u.\n", pstVFSrc->enPixelFormat);
+        return CVI_FAILURE;
+      } break;
+    }
+  } else {
+    switch (pstVFSrc->enPixelFormat) {
+      case PIXEL_FORMAT_YUV_400: {
+        *enType = IVE_IMAGE_TYPE_U8C1;
+        heights->push_back(pstVFSrc->u32Height);
+      } break;
+      case PIXEL_FORMAT_NV21:
+      case PIXEL_FORMAT_NV12: {
+        c = 2;
+        *img_type = CVIIMGTYPE::CVI_YUV420SP;
+        *enType = IVE_IMAGE_TYPE_YUV420SP;
+        heights->push_back(pstVFSrc->u32Height);
+        heights->push_back(pstVFSrc->u32Height >> 1);
+      } break;
+      case PIXEL_FORMAT_YUV_PLANAR_420: {
+        c = 3;
+        *img_type = CVIIMGTYPE::CVI_YUV420P;
+        *enType = IVE_IMAGE_TYPE_YUV420P;
+        heights->push_back(pstVFSrc->u32Height);
+        heights->push_back(pstVFSrc->u32Height >> 1);
+        heights->push_back(pstVFSrc->u32Height >> 1);
+      } break;
+      case PIXEL_FORMAT_YUV_PLANAR_422: {
+        c = 3;
+        *img_type = CVIIMGTYPE::CVI_YUV422P;
+        *enType = IVE_IMAGE_TYPE_YUV422P;
+        heights->resize(3, pstVFSrc->u32Height);
+      } break;
+      case PIXEL_FORMAT_RGB_888:
+      case PIXEL_FORMAT_BGR_888: {
+        c = 1;
+        *img_type = CVIIMGTYPE::CVI_RGB_PACKED;
+        *enType = IVE_IMAGE_TYPE_U8C3_PACKAGE;
+        heights->push_back(pstVFSrc->u32Height);
+      } break;
+      case PIXEL_FORMAT_RGB_888_PLANAR: {
+        c = 3;
+        *img_type = CVIIMGTYPE::CVI_RGB_PLANAR;
+        *enType = IVE_IMAGE_TYPE_U8C3_PLANAR;
+        heights->resize(c, pstVFSrc->u32Height);
+      } break;
+      default: {
+        LOGE("Unsupported conversion type: %u.\n", pstVFSrc->enPixelFormat);
+        return CVI_FAILURE;
+      } break;
+    }
+  }
+  strides->clear();
+  u32_length->clear();
+  for (size_t i = 0; i < c; i++) {
+    strides->push_back(pstVFSrc->u32Stride[i]);
+    u32_length->push_back(pstVFSrc->u32Length[i]);
+  }
+  return CVI_SUCCESS;
+}
+
+static void video_frame_image(CviImg *cpp_img, IVE_IMAGE_TYPE_E enType, IVE_IMAGE_S *pstIIDst) {
+  pstIIDst->enType = enType;
+  pstIIDst->tpu_block = reinterpret_cast<CVI_IMG *>(cpp_img);
+  pstIIDst->u32Width = cpp_img->GetImgWidth();
+  pstIIDst->u32Height = cpp_img->GetImgHeight();
+  pstIIDst->u16Reserved = getFmtSize(CVK_FMT_U8);
+
+  size_t i_limit = cpp_img->GetImgChannel();
+  for (size_t i = 0; i < i_limit; i++) {
+    pstIIDst->pu8VirAddr[i] = cpp_img->GetVAddr() + cpp_img->GetImgCOffsets()[i];
+    pstIIDst->u64PhyAddr[i] = cpp_img->GetPAddr() + cpp_img->GetImgCOffsets()[i];
+    pstIIDst->u16Stride[i] = cpp_img->GetImgStrides()[i];
+  }
+
+  for (size_t i = i_limit; i < 3; i++) {
+    pstIIDst->pu8VirAddr[i] = NULL;
+    pstIIDst->u64PhyAddr[i] = 0;
+    pstIIDst->u16Stride[i] = 0;
+  }
+}
+
+static CVI_S32 video_frame_to_image(VIDEO_FRAME_INFO_S *pstVFISrc, bool y_only,
+                                    IVE_IMAGE_S *pstIIDst) {
   CviImg *cpp_img = nullptr;
   if (pstIIDst->tpu_block != NULL) {
     cpp_img = reinterpret_cast<CviImg *>(pstIIDst->tpu_block);
@@ -502,213 +627,568 @@ CVI_S32 CVI_IVE_VideoFrameInfo2Image(VIDEO_FRAME_INFO_S *pstVFISrc, IVE_IMAGE_S
     }
   }
   VIDEO_FRAME_S *pstVFSrc = &pstVFISrc->stVFrame;
-  size_t c = 1;
-  CVIIMGTYPE img_type = CVIIMGTYPE::CVI_GRAY;
-  cvk_fmt_t fmt = CVK_FMT_U8;
-  std::vector<uint32_t> heights;
-  switch (pstVFSrc->enPixelFormat) {
-    case PIXEL_FORMAT_YUV_400: {
-      pstIIDst->enType = IVE_IMAGE_TYPE_U8C1;
-      heights.push_back(pstVFSrc->u32Height);
-    } break;
-    case PIXEL_FORMAT_NV21:
-    case PIXEL_FORMAT_NV12: {
-      c = 2;
-      img_type = CVIIMGTYPE::CVI_YUV420SP;
-      pstIIDst->enType = IVE_IMAGE_TYPE_YUV420SP;
-      heights.push_back(pstVFSrc->u32Height);
-      heights.push_back(pstVFSrc->u32Height >> 1);
-    } break;
-    case PIXEL_FORMAT_YUV_PLANAR_420: {
-      c = 3;
-      img_type = CVIIMGTYPE::CVI_YUV420P;
-      pstIIDst->enType = IVE_IMAGE_TYPE_YUV420P;
-      heights.push_back(pstVFSrc->u32Height);
-      heights.push_back(pstVFSrc->u32Height >> 1);
-      heights.push_back(pstVFSrc->u32Height >> 1);
-    } break;
-    case PIXEL_FORMAT_YUV_PLANAR_422: {
-      c = 3;
-      img_type = CVIIMGTYPE::CVI_YUV422P;
-      pstIIDst->enType = IVE_IMAGE_TYPE_YUV422P;
-      heights.resize(3, pstVFSrc->u32Height);
-    } break;
-    case PIXEL_FORMAT_RGB_888:
-    case PIXEL_FORMAT_BGR_888: {
-      c = 1;
-      img_type = CVIIMGTYPE::CVI_RGB_PACKED;
-      pstIIDst->enType = IVE_IMAGE_TYPE_U8C3_PACKAGE;
-      heights.push_back(pstVFSrc->u32Height);
-    } break;
-    case PIXEL_FORMAT_RGB_888_PLANAR: {
-      c = 3;
-      img_type = CVIIMGTYPE::CVI_RGB_PLANAR;
-      pstIIDst->enType = IVE_IMAGE_TYPE_U8C3_PLANAR;
-      heights.resize(c, pstVFSrc->u32Height);
-    } break;
-    default: {
-      LOGE("Unsupported conversion type: %u.\n", pstVFSrc->enPixelFormat);
-      return CVI_FAILURE;
-    } break;
-  }
-  std::vector<uint32_t> strides, u32_length;
-  for (size_t i = 0; i < c; i++) {
-    strides.push_back(pstVFSrc->u32Stride[i]);
-    u32_length.push_back(pstVFSrc->u32Length[i]);
+  CVIIMGTYPE img_type;
+  IVE_IMAGE_TYPE_E enType;
+  std::vector<uint32_t> heights, strides, u32_length;
+  if (video_frame_layout(pstVFSrc, y_only, &img_type, &enType, &heights, &strides, &u32_length) !=
+      CVI_SUCCESS) {
+    return CVI_FAILURE;
   }
   if (cpp_img == nullptr) {
     cpp_img = new CviImg(pstVFSrc->u32Height, pstVFSrc->u32Width, strides, heights, u32_length,
-                         pstVFSrc->pu8VirAddr[0], pstVFSrc->u64PhyAddr[0], img_type, fmt);
+                         pstVFSrc->pu8VirAddr[0], pstVFSrc->u64PhyAddr[0], img_type, CVK_FMT_U8);
   } else {
     cpp_img->ReInit(pstVFSrc->u32Height, pstVFSrc->u32Width, strides, heights, u32_length,
-                    pstVFSrc->pu8VirAddr[0], pstVFSrc->u64PhyAddr[0], img_type, fmt);
+                    pstVFSrc->pu8VirAddr[0], pstVFSrc->u64PhyAddr[0], img_type, CVK_FMT_U8);
   }
 
   if (!cpp_img->IsInit()) {
     LOGE("Failed to init IVE_IMAGE_S.\n");
     return CVI_FAILURE;
   }
+  video_frame_image(cpp_img, enType, pstIIDst);
+  return CVI_SUCCESS;
+}
+
+CVI_S32 CVI_IVE_VideoFrameInfo2Image(VIDEO_FRAME_INFO_S *pstVFISrc, IVE_IMAGE_S *pstIIDst) {
+  return video_frame_to_image(pstVFISrc, false, pstIIDst);
+}
+
+static bool video_frame_wrap_match(const VideoFrameWrap &wrap, const VIDEO_FRAME_S *pstVFSrc,
+                                   bool y_only) {
+  if (wrap.stale || wrap.y_only != y_only || wrap.paddr != pstVFSrc->u64PhyAddr[0] ||
+      wrap.vaddr != pstVFSrc->pu8VirAddr[0] || wrap.pixel_format != pstVFSrc->enPixelFormat ||
+      wrap.width != pstVFSrc->u32Width || wrap.height != pstVFSrc->u32Height) {
+    return false;
+  }
+  for (int i = 0; i < 3; i++) {
+    if (wrap.stride[i] != pstVFSrc->u32Stride[i] || wrap.length[i] != pstVFSrc->u32Length[i]) {
+      return false;
+    }
+  }
+  return true;
+}
 
-  pstIIDst->tpu_block = reinterpret_cast<CVI_IMG *>(cpp_img);
-  pstIIDst->u32Width = cpp_img->GetImgWidth();
-  pstIIDst->u32Height = cpp_img->GetImgHeight();
-  pstIIDst->u16Reserved = getFmtSize(fmt);
+// Wrappers of all handles, lets CVI_SYS_FreeI tell a cached wrapper from a plain one without
+// the handle that owns it.
+static std::mutex g_frame_wrap_mutex;
+static std::unordered_set<const CviImg *> g_frame_wrap_imgs;
 
-  size_t i_limit = cpp_img->GetImgChannel();
-  for (size_t i = 0; i < i_limit; i++) {
-    pstIIDst->pu8VirAddr[i] = cpp_img->GetVAddr() + cpp_img->GetImgCOffsets()[i];
-    pstIIDst->u64PhyAddr[i] = cpp_img->GetPAddr() + cpp_img->GetImgCOffsets()[i];
-    pstIIDst->u16Stride[i] = cpp_img->GetImgStrides()[i];
+static bool is_cached_video_frame(const CviImg *cpp_img) {
+  std::lock_guard<std::mutex> lock(g_frame_wrap_mutex);
+  return g_frame_wrap_imgs.count(cpp_img) != 0;
+}
+
+static void delete_video_frame_wrap(IVE_HANDLE_CTX *handle_ctx, size_t i) {
+  {
+    std::lock_guard<std::mutex> lock(g_frame_wrap_mutex);
+    g_frame_wrap_imgs.erase(handle_ctx->frame_wraps[i].img);
   }
+  delete handle_ctx->frame_wraps[i].img;
+  handle_ctx->frame_wraps.erase(handle_ctx->frame_wraps.begin() + i);
+}
 
-  for (size_t i = i_limit; i < 3; i++) {
-    pstIIDst->pu8VirAddr[i] = NULL;
-    pstIIDst->u64PhyAddr[i] = 0;
-    pstIIDst->u16Stride[i] = 0;
+static CVI_S32 acquire_video_frame(IVE_HANDLE_CTX *handle_ctx, VIDEO_FRAME_INFO_S *pstVFISrc,
+                                   bool y_only, IVE_IMAGE_S *pstIIDst) {
+  VIDEO_FRAME_S *pstVFSrc = &pstVFISrc->stVFrame;
+  auto &wraps = handle_ctx->frame_wraps;
+  size_t found = wraps.size();
+  for (size_t i = 0; i < wraps.size(); i++) {
+    if (video_frame_wrap_match(wraps[i], pstVFSrc, y_only)) {
+      found = i;
+      break;
+    }
+  }
+
+  if (found == wraps.size()) {
+    CVIIMGTYPE img_type;
+    IVE_IMAGE_TYPE_E enType;
+    std::vector<uint32_t> heights, strides, u32_length;
+    if (video_frame_layout(pstVFSrc, y_only, &img_type, &enType, &heights, &strides,
+                           &u32_length) != CVI_SUCCESS) {
+      return CVI_FAILURE;
+    }
+    // Drop the least recently used idle wrapper once the cache is full.
+    size_t idle_num = 0, lru = wraps.size();
+    for (size_t i = 0; i < wraps.size(); i++) {
+      if (wraps[i].ref != 0) continue;
+      idle_num++;
+      if (lru == wraps.size() || wraps[i].last_use < wraps[lru].last_use) lru = i;
+    }
+    if (idle_num >= VIDEO_FRAME_WRAP_NUM) {
+      delete_video_frame_wrap(handle_ctx, lru);
+    }
+    auto *cpp_img =
+        new CviImg(pstVFSrc->u32Height, pstVFSrc->u32Width, strides, heights, u32_length,
+                   pstVFSrc->pu8VirAddr[0], pstVFSrc->u64PhyAddr[0], img_type, CVK_FMT_U8);
+    if (!cpp_img->IsInit()) {
+      LOGE("Failed to init IVE_IMAGE_S.\n");
+      delete cpp_img;
+      return CVI_FAILURE;
+    }
+    VideoFrameWrap wrap;
+    wrap.paddr = pstVFSrc->u64PhyAddr[0];
+    wrap.vaddr = pstVFSrc->pu8VirAddr[0];
+    wrap.pixel_format = pstVFSrc->enPixelFormat;
+    wrap.width = pstVFSrc->u32Width;
+    wrap.height = pstVFSrc->u32Height;
+    for (int i = 0; i < 3; i++) {
+      wrap.stride[i] = pstVFSrc->u32Stride[i];
+      wrap.length[i] = pstVFSrc->u32Length[i];
+    }
+    wrap.y_only = y_only;
+    wrap.en_type = enType;
+    wrap.img = cpp_img;
+    wraps.push_back(wrap);
+    {
+      std::lock_guard<std::mutex> lock(g_frame_wrap_mutex);
+      g_frame_wrap_imgs.insert(cpp_img);
+    }
+    found = wraps.size() - 1;
   }
+
+  VideoFrameWrap &wrap = wraps[found];
+  wrap.ref++;
+  wrap.last_use = ++handle_ctx->frame_wrap_tick;
+  video_frame_image(wrap.img, wrap.en_type, pstIIDst);
   return CVI_SUCCESS;
 }
 
-IVE_IMAGE_S CVI_IVE_ReadImage2(IVE_HANDLE pIveHandle, const char *filename, IVE_IMAGE_TYPE_E enType,
-                               CVI_BOOL invertPackage) {
-  int desiredNChannels = -1;
+// Returns true if cpp_img belongs to the wrapper cache, the caller must not delete it then.
+static bool release_video_frame(IVE_HANDLE_CTX *handle_ctx, CviImg *cpp_img) {
+  auto &wraps = handle_ctx->frame_wraps;
+  for (size_t i = 0; i < wraps.size(); i++) {
+    if (wraps[i].img != cpp_img) continue;
+    if (wraps[i].ref > 0) wraps[i].ref--;
+    if (wraps[i].ref == 0 && wraps[i].stale) {
+      delete_video_frame_wrap(handle_ctx, i);
+    }
+    return true;
+  }
+  return false;
+}
+
+CVI_S32 CVI_IVE_VideoFrameInfo2ImageCached(IVE_HANDLE pIveHandle, VIDEO_FRAME_INFO_S *pstVFISrc,
+                                           IVE_IMAGE_S *pstIIDst) {
+  IVE_HANDLE_CTX *handle_ctx = reinterpret_cast<IVE_HANDLE_CTX *>(pIveHandle);
+  return acquire_video_frame(handle_ctx, pstVFISrc, false, pstIIDst);
+}
+
+CVI_S32 CVI_IVE_InvalidateVideoFrame(IVE_HANDLE pIveHandle, CVI_U64 u64PhyAddr) {
+  IVE_HANDLE_CTX *handle_ctx = reinterpret_cast<IVE_HANDLE_CTX *>(pIveHandle);
+  auto &wraps = handle_ctx->frame_wraps;
+  for (size_t i = wraps.size(); i-- > 0;) {
+    uint64_t size = wraps[i].img->GetImgCOffsets().back();
+    if (u64PhyAddr != 0 &&
+        (u64PhyAddr < wraps[i].paddr || u64PhyAddr >= wraps[i].paddr + size)) {
+      continue;
+    }
+    if (wraps[i].ref == 0) {
+      delete_video_frame_wrap(handle_ctx, i);
+    } else {
+      wraps[i].stale = true;
+    }
+  }
+  return CVI_SUCCESS;
+}
+
+static int read_image_channels(IVE_IMAGE_TYPE_E enType) {
   switch (enType) {
     case IVE_IMAGE_TYPE_S8C1:
     case IVE_IMAGE_TYPE_U8C1:
-      desiredNChannels = STBI_grey;
-      break;
+      return STBI_grey;
     case IVE_IMAGE_TYPE_S8C3_PLANAR:
     case IVE_IMAGE_TYPE_U8C3_PLANAR:
-      desiredNChannels = STBI_rgb;
-      break;
     case IVE_IMAGE_TYPE_S8C3_PACKAGE:
     case IVE_IMAGE_TYPE_U8C3_PACKAGE:
-      desiredNChannels = STBI_rgb;
-      break;
+      return STBI_rgb;
     default:
       LOGE("Not support channel %s.\n", cviIveImgEnTypeStr[enType]);
-      break;
+      return -1;
+  }
+}
+
+// Decodes filename into pstImg. The device image is kept if its type and size already match,
+// alloc_mutex serializes the allocation when several decoders share one handle.
+static CVI_S32 read_image_to(IVE_HANDLE pIveHandle, const char *filename, IVE_IMAGE_S *pstImg,
+                             IVE_IMAGE_TYPE_E enType, CVI_BOOL invertPackage,
+                             std::mutex *alloc_mutex) {
+  int desiredNChannels = read_image_channels(enType);
+  if (desiredNChannels < 0) {
+    return CVI_FAILURE;
   }
   LOGI("to read image:%s,type:%d,channels:%d", filename, enType, desiredNChannels);
-  IVE_IMAGE_S img;
-  memset(&img, 0, sizeof(IVE_IMAGE_S));
-  if (desiredNChannels >= 0) {
-    int width, height, nChannels;
-    stbi_uc *stbi_data = stbi_load(filename, &width, &height, &nChannels, desiredNChannels);
-    if (stbi_data == nullptr) {
-      LOGE("Image %s read failed.\n", filename);
-      return img;
-    }
-    LOGI("to create cviimage,channels, width, height: %d %d %d\n", desiredNChannels, width, height);
-    CVI_IVE_CreateImage(pIveHandle, &img, enType, width, height);
-    LOGI("desiredNChannels, width, height: %d %d %d\n", desiredNChannels, width, height);
-    if (enType == IVE_IMAGE_TYPE_U8C3_PLANAR || enType == IVE_IMAGE_TYPE_S8C3_PLANAR) {
-      for (size_t i = 0; i < (size_t)height; i++) {
-        for (size_t j = 0; j < (size_t)width; j++) {
-          size_t stb_idx = (i * width + j) * 3;
-          size_t img_idx = (i * img.u16Stride[0] + j);
-          img.pu8VirAddr[0][img_idx] = stbi_data[stb_idx];
-          img.pu8VirAddr[1][img_idx] = stbi_data[stb_idx + 1];
-          img.pu8VirAddr[2][img_idx] = stbi_data[stb_idx + 2];
-        }
+  int width, height, nChannels;
+  stbi_uc *stbi_data = stbi_load(filename, &width, &height, &nChannels, desiredNChannels);
+  if (stbi_data == nullptr) {
+    LOGE("Image %s read failed.\n", filename);
+    return CVI_FAILURE;
+  }
+  if (pstImg->tpu_block == NULL || pstImg->enType != enType ||
+      pstImg->u32Width != (CVI_U32)width || pstImg->u32Height != (CVI_U32)height) {
+    LOGI("to create cviimage,channels, width, height: %d %d %d\n", desiredNChannels, width,
+         height);
+    std::unique_lock<std::mutex> lock;
+    if (alloc_mutex != NULL) {
+      lock = std::unique_lock<std::mutex>(*alloc_mutex);
+    }
+    CVI_SYS_FreeI(pIveHandle, pstImg);
+    if (CVI_IVE_CreateImage(pIveHandle, pstImg, enType, width, height) != CVI_SUCCESS) {
+      LOGE("Failed to create image %d x %d for %s.\n", width, height, filename);
+      stbi_image_free(stbi_data);
+      return CVI_FAILURE;
+    }
+  } else {
+    CVI_IVE_BufRequest(pIveHandle, pstImg);
+  }
+
+  const bool is_planar =
+      enType == IVE_IMAGE_TYPE_U8C3_PLANAR || enType == IVE_IMAGE_TYPE_S8C3_PLANAR;
+  const bool is_swap = invertPackage && (enType == IVE_IMAGE_TYPE_U8C3_PACKAGE ||
+                                         enType == IVE_IMAGE_TYPE_S8C3_PACKAGE);
+  const size_t stb_stride = (size_t)width * desiredNChannels;
+  for (size_t i = 0; i < (size_t)height; i++) {
+    const stbi_uc *stb_row = stbi_data + i * stb_stride;
+    uint8_t *img_row = pstImg->pu8VirAddr[0] + i * pstImg->u16Stride[0];
+    if (is_planar) {
+#ifndef CV180X
+      neonU8C3PackageToPlanarRow(stb_row, img_row,
+                                 pstImg->pu8VirAddr[1] + i * pstImg->u16Stride[1],
+                                 pstImg->pu8VirAddr[2] + i * pstImg->u16Stride[2], width);
+#else
+      for (size_t j = 0; j < (size_t)width; j++) {
+        img_row[j] = stb_row[j * 3];
+        pstImg->pu8VirAddr[1][i * pstImg->u16Stride[1] + j] = stb_row[j * 3 + 1];
+        pstImg->pu8VirAddr[2][i * pstImg->u16Stride[2] + j] = stb_row[j * 3 + 2];
       }
-    } else {
-      if (invertPackage &&
-          (enType == IVE_IMAGE_TYPE_U8C3_PACKAGE || enType == IVE_IMAGE_TYPE_S8C3_PACKAGE)) {
-        for (size_t i = 0; i < (size_t)height; i++) {
-          uint32_t stb_stride = i * width * 3;
-          uint32_t image_stride = (i * img.u16Stride[0]);
-          for (size_t j = 0; j < (size_t)width; j++) {
-            uint32_t stb_idx = stb_stride + (j * 3);
-            uint32_t img_idx = image_stride + (j * 3);
-            img.pu8VirAddr[0][img_idx] = stbi_data[stb_idx + 2];
-            img.pu8VirAddr[0][img_idx + 1] = stbi_data[stb_idx + 1];
-            img.pu8VirAddr[0][img_idx + 2] = stbi_data[stb_idx];
-          }
-        }
-      } else {
-        stbi_uc *ptr = stbi_data;
-        for (size_t j = 0; j < (size_t)height; j++) {
-          memcpy(img.pu8VirAddr[0] + (j * img.u16Stride[0]), ptr, width * desiredNChannels);
-          ptr += width * desiredNChannels;
-        }
+#endif
+    } else if (is_swap) {
+#ifndef CV180X
+      neonU8C3SwapRow(stb_row, img_row, width);
+#else
+      for (size_t j = 0; j < (size_t)width; j++) {
+        img_row[j * 3] = stb_row[j * 3 + 2];
+        img_row[j * 3 + 1] = stb_row[j * 3 + 1];
+        img_row[j * 3 + 2] = stb_row[j * 3];
       }
+#endif
+    } else {
+      memcpy(img_row, stb_row, stb_stride);
     }
-    CVI_IVE_BufFlush(pIveHandle, &img);
-    stbi_image_free(stbi_data);
   }
+  CVI_IVE_BufFlush(pIveHandle, pstImg);
+  stbi_image_free(stbi_data);
+  return CVI_SUCCESS;
+}
+
+IVE_IMAGE_S CVI_IVE_ReadImage2(IVE_HANDLE pIveHandle, const char *filename, IVE_IMAGE_TYPE_E enType,
+                               CVI_BOOL invertPackage) {
+  IVE_IMAGE_S img;
+  memset(&img, 0, sizeof(IVE_IMAGE_S));
+  read_image_to(pIveHandle, filename, &img, enType, invertPackage, NULL);
   return img;
 }
 
+CVI_S32 CVI_IVE_ReadImageTo(IVE_HANDLE pIveHandle, const char *filename, IVE_IMAGE_S *pstImg,
+                            IVE_IMAGE_TYPE_E enType, CVI_BOOL invertPackage) {
+  ScopedTrace t(__PRETTY_FUNCTION__);
+  if (filename == NULL || pstImg == NULL) {
+    LOGE("filename and pstImg cannot be NULL.\n");
+    return CVI_FAILURE;
+  }
+  return read_image_to(pIveHandle, filename, pstImg, enType, invertPackage, NULL);
+}
+
+CVI_S32 CVI_IVE_ReadImageBatch(IVE_HANDLE pIveHandle, const char **filenames, IVE_IMAGE_S *pstImgs,
+                               CVI_U32 u32Num, IVE_IMAGE_TYPE_E enType, CVI_BOOL invertPackage,
+                               CVI_U32 u32ThreadNum) {
+  ScopedTrace t(__PRETTY_FUNCTION__);
+  if (filenames == NULL || pstImgs == NULL) {
+    LOGE("filenames and pstImgs cannot be NULL.\n");
+    return CVI_FAILURE;
+  }
+  if (read_image_channels(enType) < 0) {
+    return CVI_FAILURE;
+  }
+  std::mutex alloc_mutex;
+  std::atomic<CVI_U32> fail_num(0);
+  // Each worker only holds one decoded buffer at a time.
+  parallelTasks(u32Num, u32ThreadNum, [&](uint32_t i) {
+    if (read_image_to(pIveHandle, filenames[i], &pstImgs[i], enType, invertPackage,
+                      &alloc_mutex) != CVI_SUCCESS) {
+      fail_num++;
+    }
+  });
+  if (fail_num != 0) {
+    LOGE("%u of %u images failed to load.\n", (CVI_U32)fail_num, u32Num);
+    return CVI_FAILURE;
+  }
+  return CVI_SUCCESS;
+}
+
 IVE_IMAGE_S CVI_IVE_ReadImage(IVE_HANDLE pIveHandle, const char *filename,
                               IVE_IMAGE_TYPE_E enType) {
   return CVI_IVE_ReadImage2(pIveHandle, filename, enType, false);
 }
 #if 1
-CVI_S32 CVI_IVE_ReadRawImage(IVE_HANDLE pIveHandle, IVE_IMAGE_S *pstImg, const char *filename,
-                             IVE_IMAGE_TYPE_E enType, CVI_U16 u32Width, CVI_U16 u32Height) {
-  float desiredNChannels = -1;
-
+// Frames ahead of the last requested one that the kernel is asked to page in.
+#define SEQ_READ_AHEAD_FRAMES 2
+
+struct SeqPlane {
+  size_t row_bytes;
+  uint32_t rows;
+};
+
+struct SeqReaderCtx {
+  int fd = -1;
+  uint8_t *map = nullptr;
+  size_t map_size = 0;
+  size_t frame_size = 0;
+  std::vector<SeqPlane> planes;
+  std::vector<size_t> frame_offsets;
+};
+
+// Layout of one frame in a raw stream, planes are stored one after another without padding.
+// Subsampled chroma of odd sizes is rounded up as in Y4M.
+static bool seq_frame_planes(IVE_IMAGE_TYPE_E enType, uint32_t w, uint32_t h,
+                             std::vector<SeqPlane> *planes) {
+  const uint32_t cw = (w + 1) / 2;
+  const uint32_t ch = (h + 1) / 2;
+  planes->clear();
   switch (enType) {
     case IVE_IMAGE_TYPE_U8C1:
     case IVE_IMAGE_TYPE_S8C1:
-      desiredNChannels = 1;
-      break;
-    case IVE_IMAGE_TYPE_YUV420SP:
-      desiredNChannels = 1.5;
+      planes->push_back({w, h});
       break;
     case IVE_IMAGE_TYPE_U16C1:
     case IVE_IMAGE_TYPE_S16C1:
-    case IVE_IMAGE_TYPE_YUV422SP:
-      desiredNChannels = 2;
+      planes->push_back({(size_t)w * 2, h});
       break;
-    case IVE_IMAGE_TYPE_U8C3_PLANAR:
     case IVE_IMAGE_TYPE_U8C3_PACKAGE:
-      desiredNChannels = 3;
+      planes->push_back({(size_t)w * 3, h});
+      break;
+    case IVE_IMAGE_TYPE_U8C3_PLANAR:
+      planes->resize(3, {w, h});
+      break;
+    case IVE_IMAGE_TYPE_YUV420SP:
+      planes->push_back({w, h});
+      planes->push_back({w, ch});
+      break;
+    case IVE_IMAGE_TYPE_YUV422SP:
+      planes->push_back({w, h});
+      planes->push_back({w, h});
+      break;
+    case IVE_IMAGE_TYPE_YUV420P:
+      planes->push_back({w, h});
+      planes->push_back({cw, ch});
+      planes->push_back({cw, ch});
+      break;
+    case IVE_IMAGE_TYPE_YUV422P:
+      planes->push_back({w, h});
+      planes->push_back({cw, h});
+      planes->push_back({cw, h});
       break;
     default:
-      printf("Not support channel %s.\n", cviIveImgEnTypeStr[enType]);
-      return CVI_FAILURE_ILLEGAL_PARAM;
+      LOGE("Not support channel %s.\n", cviIveImgEnTypeStr[enType]);
+      return false;
+  }
+  return true;
+}
+
+// Parses "YUV4MPEG2 W<w> H<h> C<colorspace> ...\n", returns the offset of the first frame or 0.
+static size_t seq_parse_y4m_header(const uint8_t *data, size_t size, IVE_SEQ_READER_S *pstReader) {
+  const char magic[] = "YUV4MPEG2 ";
+  if (size < sizeof(magic) - 1 || memcmp(data, magic, sizeof(magic) - 1) != 0) {
+    return 0;
+  }
+  const uint8_t *end = (const uint8_t *)memchr(data, '\n', size);
+  if (end == NULL) {
+    return 0;
+  }
+  std::string header((const char *)data + sizeof(magic) - 1, (const char *)end);
+  std::string colorspace = "420";
+  pstReader->u32Width = 0;
+  pstReader->u32Height = 0;
+  size_t pos = 0;
+  while (pos < header.size()) {
+    size_t next = header.find(' ', pos);
+    if (next == std::string::npos) next = header.size();
+    std::string token = header.substr(pos, next - pos);
+    if (!token.empty()) {
+      if (token[0] == 'W') {
+        pstReader->u32Width = (CVI_U32)strtoul(token.c_str() + 1, NULL, 10);
+      } else if (token[0] == 'H') {
+        pstReader->u32Height = (CVI_U32)strtoul(token.c_str() + 1, NULL, 10);
+      } else if (token[0] == 'C') {
+        colorspace = token.substr(1);
+      }
+    }
+    pos = next + 1;
+  }
+  if (colorspace.compare(0, 3, "420") == 0) {
+    pstReader->enType = IVE_IMAGE_TYPE_YUV420P;
+  } else if (colorspace == "422") {
+    pstReader->enType = IVE_IMAGE_TYPE_YUV422P;
+  } else if (colorspace == "444") {
+    pstReader->enType = IVE_IMAGE_TYPE_U8C3_PLANAR;
+  } else if (colorspace == "mono") {
+    pstReader->enType = IVE_IMAGE_TYPE_U8C1;
+  } else {
+    LOGE("Unsupported Y4M colorspace %s.\n", colorspace.c_str());
+    return 0;
   }
+  return end - data + 1;
+}
 
-  if (desiredNChannels > 0) {
-    int buf_size = (int)((float)u32Width * (float)u32Height * (float)desiredNChannels);
-    char buffer[buf_size];
-    FILE *fp;
+CVI_S32 CVI_IVE_OpenSeqReader(IVE_HANDLE pIveHandle, const char *filename, IVE_IMAGE_TYPE_E enType,
+                              CVI_U32 u32Width, CVI_U32 u32Height, IVE_SEQ_READER_S *pstReader) {
+  ScopedTrace t(__PRETTY_FUNCTION__);
+  if (filename == NULL || pstReader == NULL) {
+    LOGE("filename and pstReader cannot be NULL.\n");
+    return CVI_FAILURE;
+  }
+  memset(pstReader, 0, sizeof(IVE_SEQ_READER_S));
+  int fd = open(filename, O_RDONLY);
+  if (fd < 0) {
+    LOGE("Cannot open %s.\n", filename);
+    return ERR_IVE_OPEN_FILE;
+  }
+  struct stat st;
+  if (fstat(fd, &st) != 0 || st.st_size == 0) {
+    LOGE("Cannot get the size of %s.\n", filename);
+    close(fd);
+    return ERR_IVE_READ_FILE;
+  }
+  void *map = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  if (map == MAP_FAILED) {
+    LOGE("Cannot map %s.\n", filename);
+    close(fd);
+    return ERR_IVE_READ_FILE;
+  }
+  madvise(map, st.st_size, MADV_SEQUENTIAL);
+
+  SeqReaderCtx *ctx = new SeqReaderCtx;
+  ctx->fd = fd;
+  ctx->map = (uint8_t *)map;
+  ctx->map_size = st.st_size;
+  pstReader->pvCtx = ctx;
+
+  size_t data_offset = seq_parse_y4m_header(ctx->map, ctx->map_size, pstReader);
+  bool is_y4m = data_offset != 0;
+  if (!is_y4m) {
+    pstReader->enType = enType;
+    pstReader->u32Width = u32Width;
+    pstReader->u32Height = u32Height;
+  }
+  if (pstReader->u32Width == 0 || pstReader->u32Height == 0 ||
+      !seq_frame_planes(pstReader->enType, pstReader->u32Width, pstReader->u32Height,
+                        &ctx->planes)) {
+    LOGE("Invalid frame format of %s.\n", filename);
+    CVI_IVE_CloseSeqReader(pIveHandle, pstReader);
+    return CVI_FAILURE;
+  }
+  for (auto &plane : ctx->planes) {
+    ctx->frame_size += plane.row_bytes * plane.rows;
+  }
+
+  if (is_y4m) {
+    // Every frame starts with its own "FRAME[ params]\n" line.
+    size_t pos = data_offset;
+    while (pos + 5 <= ctx->map_size && memcmp(ctx->map + pos, "FRAME", 5) == 0) {
+      const uint8_t *nl = (const uint8_t *)memchr(ctx->map + pos, '\n', ctx->map_size - pos);
+      if (nl == NULL) break;
+      size_t data = nl - ctx->map + 1;
+      if (data + ctx->frame_size > ctx->map_size) break;
+      ctx->frame_offsets.push_back(data);
+      pos = data + ctx->frame_size;
+    }
+  } else {
+    for (size_t pos = 0; pos + ctx->frame_size <= ctx->map_size; pos += ctx->frame_size) {
+      ctx->frame_offsets.push_back(pos);
+    }
+  }
+  pstReader->u32FrameNum = ctx->frame_offsets.size();
+  if (pstReader->u32FrameNum == 0) {
+    LOGE("%s does not contain a complete frame.\n", filename);
+    CVI_IVE_CloseSeqReader(pIveHandle, pstReader);
+    return ERR_IVE_READ_FILE;
+  }
+  return CVI_SUCCESS;
+}
 
-    fp = fopen(filename, "r");
-    int readCnt = fread(buffer, 1, buf_size, fp);
+CVI_S32 CVI_IVE_SeqReaderGetFrame(IVE_HANDLE pIveHandle, IVE_SEQ_READER_S *pstReader,
+                                  CVI_U32 u32Index, IVE_IMAGE_S *pstImg) {
+  ScopedTrace t(__PRETTY_FUNCTION__);
+  if (pstReader == NULL || pstReader->pvCtx == NULL || pstImg == NULL) {
+    LOGE("pstReader is not opened or pstImg is NULL.\n");
+    return CVI_FAILURE;
+  }
+  if (u32Index >= pstReader->u32FrameNum) {
+    LOGE("Frame index %u out of range %u.\n", u32Index, pstReader->u32FrameNum);
+    return CVI_FAILURE;
+  }
+  SeqReaderCtx *ctx = reinterpret_cast<SeqReaderCtx *>(pstReader->pvCtx);
+  if (pstImg->tpu_block == NULL || pstImg->enType != pstReader->enType ||
+      pstImg->u32Width != pstReader->u32Width || pstImg->u32Height != pstReader->u32Height) {
+    CVI_SYS_FreeI(pIveHandle, pstImg);
+    if (CVI_IVE_CreateImage(pIveHandle, pstImg, pstReader->enType, pstReader->u32Width,
+                            pstReader->u32Height) != CVI_SUCCESS) {
+      LOGE("Failed to create frame image.\n");
+      return CVI_FAILURE;
+    }
+  } else {
+    CVI_IVE_BufRequest(pIveHandle, pstImg);
+  }
 
-    if (readCnt == 0) {
-      printf("Image %s read failed.\n", filename);
-      return ERR_IVE_READ_FILE;
+  // The mapping is not physically contiguous, so the frame is copied into the device buffer.
+  const uint8_t *ptr = ctx->map + ctx->frame_offsets[u32Index];
+  for (size_t k = 0; k < ctx->planes.size(); k++) {
+    for (uint32_t i = 0; i < ctx->planes[k].rows; i++) {
+      memcpy(pstImg->pu8VirAddr[k] + i * pstImg->u16Stride[k], ptr, ctx->planes[k].row_bytes);
+      ptr += ctx->planes[k].row_bytes;
     }
-    fclose(fp);
+  }
+  CVI_IVE_BufFlush(pIveHandle, pstImg);
+
+  if (u32Index + 1 < pstReader->u32FrameNum) {
+    const size_t page = sysconf(_SC_PAGESIZE);
+    size_t begin = ctx->frame_offsets[u32Index + 1] & ~(page - 1);
+    size_t end = ctx->frame_offsets[u32Index + 1] + SEQ_READ_AHEAD_FRAMES * ctx->frame_size;
+    if (end > ctx->map_size) end = ctx->map_size;
+    madvise(ctx->map + begin, end - begin, MADV_WILLNEED);
+  }
+  return CVI_SUCCESS;
+}
 
-    CVI_IVE_ReadImageArray(pIveHandle, pstImg, buffer, enType, u32Width, u32Height);
+CVI_S32 CVI_IVE_CloseSeqReader(IVE_HANDLE pIveHandle, IVE_SEQ_READER_S *pstReader) {
+  if (pstReader == NULL || pstReader->pvCtx == NULL) {
     return CVI_SUCCESS;
   }
-  return CVI_FAILURE;
+  SeqReaderCtx *ctx = reinterpret_cast<SeqReaderCtx *>(pstReader->pvCtx);
+  munmap(ctx->map, ctx->map_size);
+  close(ctx->fd);
+  delete ctx;
+  pstReader->pvCtx = NULL;
+  pstReader->u32FrameNum = 0;
+  return CVI_SUCCESS;
+}
+
+CVI_S32 CVI_IVE_ReadRawImage(IVE_HANDLE pIveHandle, IVE_IMAGE_S *pstImg, const char *filename,
+                             IVE_IMAGE_TYPE_E enType, CVI_U16 u32Width, CVI_U16 u32Height) {
+  std::vector<SeqPlane> planes;
+  if (!seq_frame_planes(enType, u32Width, u32Height, &planes)) {
+    return CVI_FAILURE_ILLEGAL_PARAM;
+  }
+  IVE_SEQ_READER_S reader;
+  CVI_S32 ret = CVI_IVE_OpenSeqReader(pIveHandle, filename, enType, u32Width, u32Height, &reader);
+  if (ret != CVI_SUCCESS) {
+    LOGE("Image %s read failed.\n", filename);
+    return ret;
+  }
+  memset(pstImg, 0, sizeof(IVE_IMAGE_S));
+  ret = CVI_IVE_SeqReaderGetFrame(pIveHandle, &reader, 0, pstImg);
+  CVI_IVE_CloseSeqReader(pIveHandle, &reader);
+  return ret;
 }
 
 CVI_S32 CVI_IVE_ReadImageArray(IVE_HANDLE pIveHandle, IVE_IMAGE_S *pstImg, char *pBuffer,
@@ -794,52 +1274,367 @@ CVI_S32 CVI_IVE_ReadImageArray(IVE_HANDLE pIveHandle, IVE_IMAGE_S *pstImg, char
   return CVI_SUCCESS;
 }
 
-CVI_S32 CVI_IVE_WriteImage(IVE_HANDLE pIveHandle, const char *filename, IVE_IMAGE_S *pstImg) {
-  int desiredNChannels = -1;
-  int stride = 1;
-  uint8_t *arr = nullptr;
-  bool remove_buffer = false;
-  switch (pstImg->enType) {
+// Plane pointers of an image to encode, either the device image itself or a packed snapshot.
+struct WriteImageView {
+  IVE_IMAGE_TYPE_E enType;
+  uint32_t width;
+  uint32_t height;
+  const uint8_t *ptr[3];
+  size_t stride[3];
+};
+
+static IVE_WRITE_FORMAT_E resolve_write_format(const char *filename, IVE_WRITE_FORMAT_E enFormat) {
+  if (enFormat != IVE_WRITE_FORMAT_AUTO) {
+    return enFormat;
+  }
+  const char *ext = strrchr(filename, '.');
+  if (ext != NULL) {
+    if (strcasecmp(ext, ".pgm") == 0 || strcasecmp(ext, ".ppm") == 0 ||
+        strcasecmp(ext, ".pnm") == 0) {
+      return IVE_WRITE_FORMAT_PNM;
+    }
+    if (strcasecmp(ext, ".raw") == 0 || strcasecmp(ext, ".yuv") == 0 ||
+        strcasecmp(ext, ".bin") == 0) {
+      return IVE_WRITE_FORMAT_RAW;
+    }
+  }
+  return IVE_WRITE_FORMAT_PNG;
+}
+
+// Returns the number of encoded channels, or 0 if the format cannot hold the type.
+static int write_image_channels(IVE_WRITE_FORMAT_E enFormat, IVE_IMAGE_TYPE_E enType) {
+  if (enFormat == IVE_WRITE_FORMAT_RAW) {
+    std::vector<SeqPlane> planes;
+    return seq_frame_planes(enType, 2, 2, &planes) ? 1 : 0;
+  }
+  switch (enType) {
     case IVE_IMAGE_TYPE_U8C1:
-      desiredNChannels = STBI_grey;
-      arr = pstImg->pu8VirAddr[0];
-      break;
-    case IVE_IMAGE_TYPE_U8C3_PLANAR: {
-      desiredNChannels = STBI_rgb;
-      stride = 1;
-      arr = new uint8_t[pstImg->u16Stride[0] * pstImg->u32Height * desiredNChannels];
-      size_t image_total = pstImg->u16Stride[0] * pstImg->u32Height;
-      for (size_t i = 0; i < image_total; i++) {
-        size_t stb_idx = i * 3;
-        arr[stb_idx] = pstImg->pu8VirAddr[0][i];
-        arr[stb_idx + 1] = pstImg->pu8VirAddr[1][i];
-        arr[stb_idx + 2] = pstImg->pu8VirAddr[2][i];
-      }
-      stride = 3;
-      remove_buffer = true;
-    } break;
+    case IVE_IMAGE_TYPE_S8C1:
+      return 1;
     case IVE_IMAGE_TYPE_U8C3_PACKAGE:
-      desiredNChannels = STBI_rgb;
-      arr = pstImg->pu8VirAddr[0];
-      stride = 1;
-      break;
+    case IVE_IMAGE_TYPE_U8C3_PLANAR:
+      return 3;
     default:
-      LOGE("Not supported channel %s.", cviIveImgEnTypeStr[pstImg->enType]);
-      return CVI_FAILURE;
-      break;
-  }
-  CVI_IVE_BufRequest(pIveHandle, pstImg);
-  stbi_write_png(filename, pstImg->u32Width, pstImg->u32Height, desiredNChannels, arr,
-                 pstImg->u16Stride[0] * stride);
-  if (remove_buffer) {
-    delete[] arr;
+      LOGE("Not supported channel %s.\n", cviIveImgEnTypeStr[enType]);
+      return 0;
   }
-  return CVI_SUCCESS;
 }
+
+static void write_image_interleave_row(const WriteImageView &view, uint32_t row, uint8_t *dst) {
+  const uint8_t *src0 = view.ptr[0] + row * view.stride[0];
+  const uint8_t *src1 = view.ptr[1] + row * view.stride[1];
+  const uint8_t *src2 = view.ptr[2] + row * view.stride[2];
+#ifndef CV180X
+  neonU8C3PlanarToPackageRow(src0, src1, src2, dst, view.width);
+#else
+  for (uint32_t j = 0; j < view.width; j++) {
+    dst[j * 3] = src0[j];
+    dst[j * 3 + 1] = src1[j];
+    dst[j * 3 + 2] = src2[j];
+  }
 #endif
+}
 
-CVI_S32 CVI_SYS_FreeM(IVE_HANDLE pIveHandle, IVE_MEM_INFO_S *pstMemInfo) {
-  delete[] pstMemInfo->pu8VirAddr;
+// scratch keeps the interleaved copy of planar images between calls.
+static CVI_S32 encode_image(const char *filename, IVE_WRITE_FORMAT_E enFormat,
+                            const WriteImageView &view, std::vector<uint8_t> *scratch) {
+  const int channels = write_image_channels(enFormat, view.enType);
+  if (channels == 0) {
+    return CVI_FAILURE;
+  }
+  const bool is_planar = view.enType == IVE_IMAGE_TYPE_U8C3_PLANAR;
+  if (enFormat == IVE_WRITE_FORMAT_PNG) {
+    const uint8_t *data = view.ptr[0];
+    size_t stride = view.stride[0];
+    if (is_planar) {
+      stride = (size_t)view.width * 3;
+      scratch->resize(stride * view.height);
+      for (uint32_t i = 0; i < view.height; i++) {
+        write_image_interleave_row(view, i, scratch->data() + i * stride);
+      }
+      data = scratch->data();
+    }
+    if (stbi_write_png(filename, view.width, view.height, channels, data, stride) == 0) {
+      LOGE("Failed to write %s.\n", filename);
+      return ERR_IVE_WRITE_FILE;
+    }
+    return CVI_SUCCESS;
+  }
+
+  FILE *fp = fopen(filename, "wb");
+  if (fp == NULL) {
+    LOGE("Cannot open %s.\n", filename);
+    return ERR_IVE_OPEN_FILE;
+  }
+  bool ok = true;
+  if (enFormat == IVE_WRITE_FORMAT_RAW) {
+    std::vector<SeqPlane> planes;
+    seq_frame_planes(view.enType, view.width, view.height, &planes);
+    for (size_t k = 0; k < planes.size() && ok; k++) {
+      for (uint32_t i = 0; i < planes[k].rows && ok; i++) {
+        ok = fwrite(view.ptr[k] + i * view.stride[k], 1, planes[k].row_bytes, fp) ==
+             planes[k].row_bytes;
+      }
+    }
+  } else {
+    const size_t row_bytes = (size_t)view.width * channels;
+    ok = fprintf(fp, "P%c\n%u %u\n255\n", channels == 1 ? '5' : '6', view.width, view.height) > 0;
+    if (is_planar) {
+      scratch->resize(row_bytes);
+    }
+    for (uint32_t i = 0; i < view.height && ok; i++) {
+      const uint8_t *row = view.ptr[0] + i * view.stride[0];
+      if (is_planar) {
+        write_image_interleave_row(view, i, scratch->data());
+        row = scratch->data();
+      }
+      ok = fwrite(row, 1, row_bytes, fp) == row_bytes;
+    }
+  }
+  if (fclose(fp) != 0 || !ok) {
+    LOGE("Failed to write %s.\n", filename);
+    return ERR_IVE_WRITE_FILE;
+  }
+  return CVI_SUCCESS;
+}
+
+static WriteImageView write_image_view(IVE_IMAGE_S *pstImg) {
+  WriteImageView view;
+  memset(&view, 0, sizeof(view));
+  view.enType = pstImg->enType;
+  view.width = pstImg->u32Width;
+  view.height = pstImg->u32Height;
+  for (int k = 0; k < 3; k++) {
+    view.ptr[k] = pstImg->pu8VirAddr[k];
+    view.stride[k] = pstImg->u16Stride[k];
+  }
+  return view;
+}
+
+CVI_S32 CVI_IVE_WriteImage2(IVE_HANDLE pIveHandle, const char *filename, IVE_IMAGE_S *pstImg,
+                            IVE_WRITE_FORMAT_E enFormat) {
+  ScopedTrace t(__PRETTY_FUNCTION__);
+  if (filename == NULL || pstImg == NULL) {
+    LOGE("filename and pstImg cannot be NULL.\n");
+    return CVI_FAILURE;
+  }
+  enFormat = resolve_write_format(filename, enFormat);
+  if (write_image_channels(enFormat, pstImg->enType) == 0) {
+    return CVI_FAILURE;
+  }
+  CVI_IVE_BufRequest(pIveHandle, pstImg);
+  std::vector<uint8_t> scratch;
+  return encode_image(filename, enFormat, write_image_view(pstImg), &scratch);
+}
+
+CVI_S32 CVI_IVE_WriteImage(IVE_HANDLE pIveHandle, const char *filename, IVE_IMAGE_S *pstImg) {
+  return CVI_IVE_WriteImage2(pIveHandle, filename, pstImg, IVE_WRITE_FORMAT_PNG);
+}
+
+#define ASYNC_WRITER_DEFAULT_DEPTH 4
+
+struct AsyncWriteJob {
+  std::string filename;
+  IVE_WRITE_FORMAT_E enFormat;
+  IVE_IMAGE_TYPE_E enType;
+  uint32_t width;
+  uint32_t height;
+  std::vector<uint8_t> data;
+};
+
+// One encoder thread fed by a bounded queue. Snapshot buffers go back to a free list after
+// encoding, so steady state capture does not allocate.
+class AsyncImageWriter {
+ public:
+  explicit AsyncImageWriter(const IVE_ASYNC_WRITER_CTRL_S &ctrl) : m_ctrl(ctrl) {
+    if (m_ctrl.u32QueueDepth == 0) {
+      m_ctrl.u32QueueDepth = ASYNC_WRITER_DEFAULT_DEPTH;
+    }
+    m_thread = std::thread(&AsyncImageWriter::loop, this);
+  }
+
+  ~AsyncImageWriter() {
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_stop = true;
+    }
+    m_cond.notify_all();
+    m_thread.join();
+  }
+
+  CVI_S32 push(const char *filename, IVE_WRITE_FORMAT_E enFormat, IVE_IMAGE_S *pstImg) {
+    std::vector<SeqPlane> planes;
+    seq_frame_planes(pstImg->enType, pstImg->u32Width, pstImg->u32Height, &planes);
+    size_t size = 0;
+    for (auto &plane : planes) {
+      size += plane.row_bytes * plane.rows;
+    }
+
+    std::unique_ptr<AsyncWriteJob> job;
+    {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      if (m_ctrl.enPolicy == IVE_ASYNC_WRITE_POLICY_DROP_NEWEST &&
+          m_queue.size() >= m_ctrl.u32QueueDepth) {
+        m_drop_num++;
+        LOGW("Async writer queue is full, %s is dropped.\n", filename);
+        return CVI_FAILURE;
+      }
+      if (!m_free.empty()) {
+        job = std::move(m_free.back());
+        m_free.pop_back();
+      }
+    }
+    if (job == nullptr) {
+      job.reset(new AsyncWriteJob);
+    }
+    job->filename = filename;
+    job->enFormat = enFormat;
+    job->enType = pstImg->enType;
+    job->width = pstImg->u32Width;
+    job->height = pstImg->u32Height;
+    job->data.resize(size);
+    uint8_t *ptr = job->data.data();
+    for (size_t k = 0; k < planes.size(); k++) {
+      for (uint32_t i = 0; i < planes[k].rows; i++) {
+        memcpy(ptr, pstImg->pu8VirAddr[k] + i * pstImg->u16Stride[k], planes[k].row_bytes);
+        ptr += planes[k].row_bytes;
+      }
+    }
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    if (m_ctrl.enPolicy == IVE_ASYNC_WRITE_POLICY_BLOCK) {
+      m_cond.wait(lock, [this] { return m_queue.size() < m_ctrl.u32QueueDepth; });
+    } else if (m_ctrl.enPolicy == IVE_ASYNC_WRITE_POLICY_DROP_NEWEST &&
+               m_queue.size() >= m_ctrl.u32QueueDepth) {
+      m_drop_num++;
+      LOGW("Async writer queue is full, %s is dropped.\n", filename);
+      m_free.push_back(std::move(job));
+      return CVI_FAILURE;
+    } else {
+      while (m_queue.size() >= m_ctrl.u32QueueDepth) {
+        m_drop_num++;
+        LOGW("Async writer queue is full, %s is dropped.\n", m_queue.front()->filename.c_str());
+        m_free.push_back(std::move(m_queue.front()));
+        m_queue.pop_front();
+      }
+    }
+    m_queue.push_back(std::move(job));
+    lock.unlock();
+    m_cond.notify_all();
+    return CVI_SUCCESS;
+  }
+
+  void flush(CVI_U32 *pu32DropNum) {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_cond.wait(lock, [this] { return m_queue.empty() && !m_busy; });
+    if (pu32DropNum != NULL) {
+      *pu32DropNum = m_drop_num;
+    }
+  }
+
+ private:
+  void loop() {
+    std::vector<uint8_t> scratch;
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true) {
+      m_cond.wait(lock, [this] { return m_stop || !m_queue.empty(); });
+      if (m_queue.empty()) {
+        break;
+      }
+      std::unique_ptr<AsyncWriteJob> job = std::move(m_queue.front());
+      m_queue.pop_front();
+      m_busy = true;
+      lock.unlock();
+      m_cond.notify_all();
+
+      std::vector<SeqPlane> planes;
+      seq_frame_planes(job->enType, job->width, job->height, &planes);
+      WriteImageView view;
+      memset(&view, 0, sizeof(view));
+      view.enType = job->enType;
+      view.width = job->width;
+      view.height = job->height;
+      const uint8_t *ptr = job->data.data();
+      for (size_t k = 0; k < planes.size(); k++) {
+        view.ptr[k] = ptr;
+        view.stride[k] = planes[k].row_bytes;
+        ptr += planes[k].row_bytes * planes[k].rows;
+      }
+      CVI_S32 ret = encode_image(job->filename.c_str(), job->enFormat, view, &scratch);
+
+      lock.lock();
+      if (ret != CVI_SUCCESS) {
+        m_drop_num++;
+      }
+      m_free.push_back(std::move(job));
+      m_busy = false;
+      m_cond.notify_all();
+    }
+  }
+
+  IVE_ASYNC_WRITER_CTRL_S m_ctrl;
+  std::thread m_thread;
+  std::mutex m_mutex;
+  std::condition_variable m_cond;
+  std::deque<std::unique_ptr<AsyncWriteJob>> m_queue;
+  std::vector<std::unique_ptr<AsyncWriteJob>> m_free;
+  CVI_U32 m_drop_num = 0;
+  bool m_busy = false;
+  bool m_stop = false;
+};
+
+void destroyAsyncWriter(AsyncImageWriter *writer) { delete writer; }
+
+CVI_S32 CVI_IVE_AsyncWriterInit(IVE_HANDLE pIveHandle, const IVE_ASYNC_WRITER_CTRL_S *pstCtrl) {
+  ScopedTrace t(__PRETTY_FUNCTION__);
+  if (pstCtrl == NULL || pstCtrl->enPolicy >= IVE_ASYNC_WRITE_POLICY_BUTT) {
+    LOGE("Invalid async writer control parameter.\n");
+    return CVI_FAILURE;
+  }
+  IVE_HANDLE_CTX *handle_ctx = reinterpret_cast<IVE_HANDLE_CTX *>(pIveHandle);
+  // The destructor writes the pending images before the thread exits.
+  delete handle_ctx->async_writer;
+  handle_ctx->async_writer = new AsyncImageWriter(*pstCtrl);
+  return CVI_SUCCESS;
+}
+
+CVI_S32 CVI_IVE_WriteImageAsync(IVE_HANDLE pIveHandle, const char *filename, IVE_IMAGE_S *pstImg,
+                                IVE_WRITE_FORMAT_E enFormat) {
+  ScopedTrace t(__PRETTY_FUNCTION__);
+  if (filename == NULL || pstImg == NULL) {
+    LOGE("filename and pstImg cannot be NULL.\n");
+    return CVI_FAILURE;
+  }
+  enFormat = resolve_write_format(filename, enFormat);
+  if (write_image_channels(enFormat, pstImg->enType) == 0) {
+    return CVI_FAILURE;
+  }
+  IVE_HANDLE_CTX *handle_ctx = reinterpret_cast<IVE_HANDLE_CTX *>(pIveHandle);
+  if (handle_ctx->async_writer == nullptr) {
+    IVE_ASYNC_WRITER_CTRL_S ctrl;
+    memset(&ctrl, 0, sizeof(ctrl));
+    handle_ctx->async_writer = new AsyncImageWriter(ctrl);
+  }
+  CVI_IVE_BufRequest(pIveHandle, pstImg);
+  return handle_ctx->async_writer->push(filename, enFormat, pstImg);
+}
+
+CVI_S32 CVI_IVE_AsyncWriterFlush(IVE_HANDLE pIveHandle, CVI_U32 *pu32DropNum) {
+  ScopedTrace t(__PRETTY_FUNCTION__);
+  IVE_HANDLE_CTX *handle_ctx = reinterpret_cast<IVE_HANDLE_CTX *>(pIveHandle);
+  if (handle_ctx->async_writer == nullptr) {
+    if (pu32DropNum != NULL) {
+      *pu32DropNum = 0;
+    }
+    return CVI_SUCCESS;
+  }
+  handle_ctx->async_writer->flush(pu32DropNum);
+  return CVI_SUCCESS;
+}
+#endif
+
+CVI_S32 CVI_SYS_FreeM(IVE_HANDLE pIveHandle, IVE_MEM_INFO_S *pstMemInfo) {
+  delete[] pstMemInfo->pu8VirAddr;
   pstMemInfo->u32ByteSize = 0;
   return CVI_SUCCESS;
 }
@@ -850,10 +1645,17 @@ CVI_S32 CVI_SYS_FreeI(IVE_HANDLE pIveHandle, IVE_IMAGE_S *pstImg) {
     return CVI_SUCCESS;
   }
   auto *cpp_img = reinterpret_cast<CviImg *>(pstImg->tpu_block);
-  if (!cpp_img->IsNullMem()) {
-    if (pIveHandle == NULL) {
-      LOGE("should have ive handle to release cpp_img inside memory");
+  if (pIveHandle == NULL) {
+    // The wrapper cache and the device memory both live in the handle.
+    if (is_cached_video_frame(cpp_img) || !cpp_img->IsNullMem()) {
+      LOGE("should have ive handle to release cpp_img inside memory or cached video frame.\n");
+      return CVI_FAILURE;
     }
+  } else if (release_video_frame(reinterpret_cast<IVE_HANDLE_CTX *>(pIveHandle), cpp_img)) {
+    pstImg->tpu_block = NULL;
+    return CVI_SUCCESS;
+  }
+  if (!cpp_img->IsNullMem()) {
     IVE_HANDLE_CTX *handle_ctx = reinterpret_cast<IVE_HANDLE_CTX *>(pIveHandle);
     cpp_img->Free(handle_ctx->rt_handle);
   }
@@ -912,9 +1714,205 @@ CVI_S32 CVI_IVE_DMA(IVE_HANDLE pIveHandle, IVE_SRC_IMAGE_S *pstSrc, IVE_DST_IMAG
   return ret;
 }
 
+// Element formats of the type conversion matrix, in the order used by the dispatch tables.
+enum ItcFmt { ITC_U8 = 0, ITC_S8, ITC_U16, ITC_S16, ITC_BF16, ITC_F32, ITC_FMT_NUM };
+
+static int itc_fmt_index(const IVE_IMAGE_TYPE_E enType) {
+  switch (enType) {
+    case IVE_IMAGE_TYPE_U8C1:
+    case IVE_IMAGE_TYPE_U8C3_PLANAR:
+      return ITC_U8;
+    case IVE_IMAGE_TYPE_S8C1:
+    case IVE_IMAGE_TYPE_S8C3_PLANAR:
+      return ITC_S8;
+    case IVE_IMAGE_TYPE_U16C1:
+      return ITC_U16;
+    case IVE_IMAGE_TYPE_S16C1:
+      return ITC_S16;
+    case IVE_IMAGE_TYPE_BF16C1:
+      return ITC_BF16;
+    case IVE_IMAGE_TYPE_FP32C1:
+      return ITC_F32;
+    default:
+      return -1;
+  }
+}
+
+// Linear map applied on the way, dst = (src - sub) * scale + add.
+struct ItcAffine {
+  float sub;
+  float scale;
+  float add;
+};
+
+typedef void (*ItcRowFunc)(const uint8_t *src, uint8_t *dst, const uint32_t width,
+                           const ItcAffine &affine);
+typedef void (*ItcMinMaxFunc)(const uint8_t *src, const uint32_t width, float *min, float *max);
+
+#ifndef CV180X
+template <typename SrcFmt, typename DstFmt>
+static void itc_convert_row(const uint8_t *src, uint8_t *dst, const uint32_t width,
+                            const ItcAffine &affine) {
+  neonConvertRow<SrcFmt, DstFmt>((const typename SrcFmt::type *)src,
+                                 (typename DstFmt::type *)dst, width, affine.sub, affine.scale,
+                                 affine.add);
+}
+
+template <typename SrcFmt>
+static void itc_minmax_row(const uint8_t *src, const uint32_t width, float *min, float *max) {
+  neonFindMinMaxRow<SrcFmt>((const typename SrcFmt::type *)src, width, min, max);
+}
+
+#define ITC_ROW_FUNCS(SrcFmt)                                                                   \
+  {                                                                                             \
+    itc_convert_row<SrcFmt, neonU8Fmt>, itc_convert_row<SrcFmt, neonS8Fmt>,                     \
+        itc_convert_row<SrcFmt, neonU16Fmt>, itc_convert_row<SrcFmt, neonS16Fmt>,               \
+        itc_convert_row<SrcFmt, neonBF16Fmt>, itc_convert_row<SrcFmt, neonF32Fmt>               \
+  }
+static const ItcRowFunc itc_row_table[ITC_FMT_NUM][ITC_FMT_NUM] = {
+    ITC_ROW_FUNCS(neonU8Fmt),  ITC_ROW_FUNCS(neonS8Fmt),   ITC_ROW_FUNCS(neonU16Fmt),
+    ITC_ROW_FUNCS(neonS16Fmt), ITC_ROW_FUNCS(neonBF16Fmt), ITC_ROW_FUNCS(neonF32Fmt)};
+#undef ITC_ROW_FUNCS
+
+static const ItcMinMaxFunc itc_minmax_table[ITC_FMT_NUM] = {
+    itc_minmax_row<neonU8Fmt>,  itc_minmax_row<neonS8Fmt>,   itc_minmax_row<neonU16Fmt>,
+    itc_minmax_row<neonS16Fmt>, itc_minmax_row<neonBF16Fmt>, itc_minmax_row<neonF32Fmt>};
+#else
+static float itc_load(const uint8_t *src, const int fmt, const uint32_t i) {
+  switch (fmt) {
+    case ITC_U8:
+      return src[i];
+    case ITC_S8:
+      return ((const int8_t *)src)[i];
+    case ITC_U16:
+      return ((const uint16_t *)src)[i];
+    case ITC_S16:
+      return ((const int16_t *)src)[i];
+    case ITC_BF16:
+      return convert_bf16_fp32(((const uint16_t *)src)[i]);
+    default:
+      return ((const float *)src)[i];
+  }
+}
+
+static void itc_store(uint8_t *dst, const int fmt, const uint32_t i, float v) {
+  static const float lo[] = {0.f, -128.f, 0.f, -32768.f};
+  static const float hi[] = {255.f, 127.f, 65535.f, 32767.f};
+  if (fmt < ITC_BF16) {
+    v = !(v >= lo[fmt]) ? lo[fmt] : (v > hi[fmt] ? hi[fmt] : v);
+    v = std::round(v);
+  }
+  switch (fmt) {
+    case ITC_U8:
+      dst[i] = (uint8_t)v;
+      break;
+    case ITC_S8:
+      ((int8_t *)dst)[i] = (int8_t)v;
+      break;
+    case ITC_U16:
+      ((uint16_t *)dst)[i] = (uint16_t)v;
+      break;
+    case ITC_S16:
+      ((int16_t *)dst)[i] = (int16_t)v;
+      break;
+    case ITC_BF16:
+      ((uint16_t *)dst)[i] = convert_fp32_bf16(v);
+      break;
+    default:
+      ((float *)dst)[i] = v;
+      break;
+  }
+}
+
+template <int SrcFmt, int DstFmt>
+static void itc_convert_row(const uint8_t *src, uint8_t *dst, const uint32_t width,
+                            const ItcAffine &affine) {
+  for (uint32_t i = 0; i < width; i++) {
+    itc_store(dst, DstFmt, i, (itc_load(src, SrcFmt, i) - affine.sub) * affine.scale + affine.add);
+  }
+}
+
+template <int SrcFmt>
+static void itc_minmax_row(const uint8_t *src, const uint32_t width, float *min, float *max) {
+  for (uint32_t i = 0; i < width; i++) {
+    float val = itc_load(src, SrcFmt, i);
+    if (val < *min) *min = val;
+    if (val > *max) *max = val;
+  }
+}
+
+#define ITC_ROW_FUNCS(SrcFmt)                                                                 \
+  {                                                                                           \
+    itc_convert_row<SrcFmt, ITC_U8>, itc_convert_row<SrcFmt, ITC_S8>,                         \
+        itc_convert_row<SrcFmt, ITC_U16>, itc_convert_row<SrcFmt, ITC_S16>,                   \
+        itc_convert_row<SrcFmt, ITC_BF16>, itc_convert_row<SrcFmt, ITC_F32>                   \
+  }
+static const ItcRowFunc itc_row_table[ITC_FMT_NUM][ITC_FMT_NUM] = {
+    ITC_ROW_FUNCS(ITC_U8),  ITC_ROW_FUNCS(ITC_S8),   ITC_ROW_FUNCS(ITC_U16),
+    ITC_ROW_FUNCS(ITC_S16), ITC_ROW_FUNCS(ITC_BF16), ITC_ROW_FUNCS(ITC_F32)};
+#undef ITC_ROW_FUNCS
+
+static const ItcMinMaxFunc itc_minmax_table[ITC_FMT_NUM] = {
+    itc_minmax_row<ITC_U8>,  itc_minmax_row<ITC_S8>,   itc_minmax_row<ITC_U16>,
+    itc_minmax_row<ITC_S16>, itc_minmax_row<ITC_BF16>, itc_minmax_row<ITC_F32>};
+#endif
+
+static void itc_find_minmax(IVE_IMAGE_S *pstSrc, const uint32_t planes, const int fmt,
+                            float *min, float *max) {
+  std::mutex mtx;
+  *min = std::numeric_limits<float>::max();
+  *max = -std::numeric_limits<float>::max();
+  for (uint32_t k = 0; k < planes; k++) {
+    auto find_rows = [&](uint32_t row_begin, uint32_t row_end) {
+      float local_min = std::numeric_limits<float>::max();
+      float local_max = -std::numeric_limits<float>::max();
+      for (uint32_t i = row_begin; i < row_end; i++) {
+        itc_minmax_table[fmt](pstSrc->pu8VirAddr[k] + i * pstSrc->u16Stride[k], pstSrc->u32Width,
+                              &local_min, &local_max);
+      }
+      std::lock_guard<std::mutex> lock(mtx);
+      if (local_min < *min) *min = local_min;
+      if (local_max > *max) *max = local_max;
+    };
+    parallelRows(pstSrc->u32Height, pstSrc->u32Width, find_rows);
+  }
+}
+
 CVI_S32 CVI_IVE_ImageTypeConvert(IVE_HANDLE pIveHandle, IVE_SRC_IMAGE_S *pstSrc,
                                  IVE_DST_IMAGE_S *pstDst, IVE_ITC_CRTL_S *pstItcCtrl,
                                  bool bInstant) {
+  ScopedTrace t(__PRETTY_FUNCTION__);
+  if (pstItcCtrl->enType != IVE_ITC_SATURATE && pstItcCtrl->enType != IVE_ITC_NORMALIZE) {
+    LOGE("Unsupported enType %u.\n", pstItcCtrl->enType);
+    return CVI_FAILURE;
+  }
+  if (!IsValidImageType(pstSrc, STRFY(pstSrc), IVE_IMAGE_TYPE_U8C1, IVE_IMAGE_TYPE_S8C1,
+                        IVE_IMAGE_TYPE_U8C3_PLANAR, IVE_IMAGE_TYPE_S8C3_PLANAR,
+                        IVE_IMAGE_TYPE_U16C1, IVE_IMAGE_TYPE_S16C1, IVE_IMAGE_TYPE_BF16C1,
+                        IVE_IMAGE_TYPE_FP32C1) ||
+      !IsValidImageType(pstDst, STRFY(pstDst), IVE_IMAGE_TYPE_U8C1, IVE_IMAGE_TYPE_S8C1,
+                        IVE_IMAGE_TYPE_U8C3_PLANAR, IVE_IMAGE_TYPE_S8C3_PLANAR,
+                        IVE_IMAGE_TYPE_U16C1, IVE_IMAGE_TYPE_S16C1, IVE_IMAGE_TYPE_BF16C1,
+                        IVE_IMAGE_TYPE_FP32C1)) {
+    return CVI_FAILURE;
+  }
+  const bool src_planar =
+      pstSrc->enType == IVE_IMAGE_TYPE_U8C3_PLANAR || pstSrc->enType == IVE_IMAGE_TYPE_S8C3_PLANAR;
+  const bool dst_planar =
+      pstDst->enType == IVE_IMAGE_TYPE_U8C3_PLANAR || pstDst->enType == IVE_IMAGE_TYPE_S8C3_PLANAR;
+  if (src_planar != dst_planar) {
+    LOGE("Input and output channel number mismatch.\n");
+    return CVI_FAILURE;
+  }
+  if (pstSrc->u32Width != pstDst->u32Width || pstSrc->u32Height != pstDst->u32Height) {
+    LOGE("Input and output size mismatch. %ux%u vs %ux%u.\n", pstSrc->u32Width,
+         pstSrc->u32Height, pstDst->u32Width, pstDst->u32Height);
+    return CVI_FAILURE;
+  }
+  const int src_fmt = itc_fmt_index(pstSrc->enType);
+  const int dst_fmt = itc_fmt_index(pstDst->enType);
+  const uint32_t planes = src_planar ? 3 : 1;
+
 #ifndef CV180X
   if (CVI_IVE_ImageInit(pstSrc) != CVI_SUCCESS) {
     LOGE("Source cannot be inited.\n");
@@ -924,154 +1922,57 @@ CVI_S32 CVI_IVE_ImageTypeConvert(IVE_HANDLE pIveHandle, IVE_SRC_IMAGE_S *pstSrc,
     LOGE("Destination cannot be inited.\n");
     return CVI_FAILURE;
   }
-  ScopedTrace t(__PRETTY_FUNCTION__);
   IVE_HANDLE_CTX *handle_ctx = reinterpret_cast<IVE_HANDLE_CTX *>(pIveHandle);
   CviImg *cpp_src = reinterpret_cast<CviImg *>(pstSrc->tpu_block);
   CviImg *cpp_dst = reinterpret_cast<CviImg *>(pstDst->tpu_block);
-  if (pstItcCtrl->enType == IVE_ITC_NORMALIZE) {
-    if (cpp_src->m_tg.fmt == CVK_FMT_BF16 && cpp_dst->m_tg.fmt == CVK_FMT_F32) {
-      cpp_src->Invld(handle_ctx->rt_handle);
-      cpp_dst->Invld(handle_ctx->rt_handle);
-      // uint16_t *src_ptr = (uint16_t *)cpp_src->GetVAddr();
-      // float *dst_ptr = (float *)cpp_dst->GetVAddr();
-      // uint64_t img_size = cpp_src->GetImgSize() / 2;
-      // neonBF162F32(src_ptr, dst_ptr, img_size);
-      union {
-        short a[2];
-        float b;
-      } aaa;
-      uint16_t stride = cpp_src->GetImgStrides()[0];
-      uint16_t stride2 = cpp_dst->GetImgStrides()[0];
-      for (size_t i = 0; i < cpp_src->GetImgHeight(); i++) {
-        uint16_t *line16 = (uint16_t *)(cpp_src->GetVAddr() + i * stride);
-        float *linef = (float *)(cpp_dst->GetVAddr() + i * stride2);
-        for (size_t j = 0; j < cpp_src->GetImgWidth(); j++) {
-          aaa.a[0] = 0;
-          aaa.a[1] = line16[j];
-          linef[j] = aaa.b;
-        }
-      }
-      cpp_src->Flush(handle_ctx->rt_handle);
-      cpp_dst->Flush(handle_ctx->rt_handle);
-    } else if (cpp_src->m_tg.fmt == CVK_FMT_BF16 && cpp_dst->m_tg.fmt == CVK_FMT_U16) {
-      cpp_src->Invld(handle_ctx->rt_handle);
-      cpp_dst->Invld(handle_ctx->rt_handle);
-      uint16_t *src_ptr = (uint16_t *)cpp_src->GetVAddr();
-      uint16_t *dst_ptr = (uint16_t *)cpp_dst->GetVAddr();
-      float min = std::numeric_limits<float>::max(), max = std::numeric_limits<float>::min();
-      uint64_t img_size = cpp_src->m_tg.shape.c * cpp_src->m_tg.shape.h * cpp_src->m_tg.shape.w;
-      neonBF16FindMinMax(src_ptr, img_size, &min, &max);
-      neonBF162U16Normalize(src_ptr, dst_ptr, img_size, min, max);
-      cpp_src->Flush(handle_ctx->rt_handle);
-      cpp_dst->Flush(handle_ctx->rt_handle);
-    } else if (cpp_src->m_tg.fmt == CVK_FMT_BF16 && cpp_dst->m_tg.fmt == CVK_FMT_I16) {
-      cpp_src->Invld(handle_ctx->rt_handle);
-      cpp_dst->Invld(handle_ctx->rt_handle);
-      uint16_t *src_ptr = (uint16_t *)cpp_src->GetVAddr();
-      int16_t *dst_ptr = (int16_t *)cpp_dst->GetVAddr();
-      float min = std::numeric_limits<float>::max(), max = std::numeric_limits<float>::min();
-      uint64_t img_size = cpp_src->m_tg.shape.c * cpp_src->m_tg.shape.h * cpp_src->m_tg.shape.w;
-      neonBF16FindMinMax(src_ptr, img_size, &min, &max);
-      neonBF162S16Normalize(src_ptr, dst_ptr, img_size, min, max);
-      cpp_src->Flush(handle_ctx->rt_handle);
-      cpp_dst->Flush(handle_ctx->rt_handle);
-    } else if (cpp_src->m_tg.fmt == CVK_FMT_U16 &&
-               (cpp_dst->m_tg.fmt == CVK_FMT_U8 || cpp_dst->m_tg.fmt == CVK_FMT_I8)) {
-      cpp_src->Invld(handle_ctx->rt_handle);
-      cpp_dst->Invld(handle_ctx->rt_handle);
-      uint16_t *src_ptr = (uint16_t *)cpp_src->GetVAddr();
-      uint8_t *dst_ptr = (uint8_t *)cpp_dst->GetVAddr();
-      uint16_t min = 65535, max = 0;
-      uint64_t img_size = cpp_src->m_tg.shape.c * cpp_src->m_tg.shape.h * cpp_src->m_tg.shape.w;
-      neonU16FindMinMax(src_ptr, img_size, &min, &max);
-      if (cpp_dst->m_tg.fmt == CVK_FMT_U8) {
-        neonU162U8Normalize(src_ptr, dst_ptr, img_size, min, max);
-      } else {
-        neonU162S8Normalize(src_ptr, (int8_t *)dst_ptr, img_size, min, max);
-      }
-      cpp_src->Flush(handle_ctx->rt_handle);
-      cpp_dst->Flush(handle_ctx->rt_handle);
-    } else if (cpp_src->m_tg.fmt == CVK_FMT_BF16 &&
-               (cpp_dst->m_tg.fmt == CVK_FMT_U8 || cpp_dst->m_tg.fmt == CVK_FMT_I8)) {
-      cpp_src->Invld(handle_ctx->rt_handle);
-      cpp_dst->Invld(handle_ctx->rt_handle);
-      uint16_t *src_ptr = (uint16_t *)cpp_src->GetVAddr();
-      float min = std::numeric_limits<float>::max(), max = std::numeric_limits<float>::min();
-      uint64_t img_size = cpp_src->m_tg.shape.c * cpp_src->m_tg.shape.h * cpp_src->m_tg.shape.w;
-      neonBF16FindMinMax(src_ptr, img_size, &min, &max);
+  const bool tpu_fmt = (src_fmt == ITC_U8 || src_fmt == ITC_S8 || src_fmt == ITC_BF16) &&
+                       (dst_fmt == ITC_U8 || dst_fmt == ITC_S8 || dst_fmt == ITC_BF16);
+  // TDMA converts between BF16, U8 and I8 with saturation in a single pass.
+  if (pstItcCtrl->enType == IVE_ITC_SATURATE && tpu_fmt) {
+    return IveTPUCopyDirect::run(handle_ctx->rt_handle, handle_ctx->cvk_ctx, cpp_src, cpp_dst);
+  }
+#endif
+
+  CVI_IVE_BufRequest(pIveHandle, pstSrc);
+  CVI_IVE_BufRequest(pIveHandle, pstDst);
+  // Normalize maps [min, max] of the valid pixels to the full range of an integer output. Floating
+  // point outputs keep the input values.
+  ItcAffine affine = {0.f, 1.f, 0.f};
+  if (pstItcCtrl->enType == IVE_ITC_NORMALIZE && dst_fmt < ITC_BF16) {
+    static const float range_lo[] = {0.f, -128.f, 0.f, -32768.f};
+    static const float range_hi[] = {255.f, 127.f, 65535.f, 32767.f};
+    float min = 0, max = 0;
+    itc_find_minmax(pstSrc, planes, src_fmt, &min, &max);
+#ifndef CV180X
+    if (tpu_fmt && src_fmt == ITC_BF16 && max > min) {
       handle_ctx->t_h.t_norm.setMinMax(min, max);
       handle_ctx->t_h.t_norm.setOutputFMT(cpp_dst->m_tg.fmt);
       handle_ctx->t_h.t_norm.init(handle_ctx->rt_handle, handle_ctx->cvk_ctx);
-      CviImg *cpp_src = reinterpret_cast<CviImg *>(pstSrc->tpu_block);
-      CviImg *cpp_dst = reinterpret_cast<CviImg *>(pstDst->tpu_block);
       std::vector<CviImg *> inputs = {cpp_src};
       std::vector<CviImg *> outputs = {cpp_dst};
-      handle_ctx->t_h.t_norm.run(handle_ctx->rt_handle, handle_ctx->cvk_ctx, inputs, outputs);
-    }
-  } else if (pstItcCtrl->enType == IVE_ITC_SATURATE) {
-    if (cpp_src->m_tg.fmt == CVK_FMT_BF16 && cpp_dst->m_tg.fmt == CVK_FMT_F32) {
-      cpp_src->Invld(handle_ctx->rt_handle);
-      cpp_dst->Invld(handle_ctx->rt_handle);
-      // uint16_t *src_ptr = (uint16_t *)cpp_src->GetVAddr();
-      // float *dst_ptr = (float *)cpp_dst->GetVAddr();
-      // uint64_t img_size = cpp_src->GetImgSize() / 2;
-      // neonBF162F32(src_ptr, dst_ptr, img_size);
-      union {
-        short a[2];
-        float b;
-      } aaa;
-      uint16_t stride = cpp_src->GetImgStrides()[0];
-      uint16_t stride2 = cpp_dst->GetImgStrides()[0];
-      for (size_t i = 0; i < cpp_src->GetImgHeight(); i++) {
-        uint16_t *line16 = (uint16_t *)(cpp_src->GetVAddr() + i * stride);
-        float *linef = (float *)(cpp_dst->GetVAddr() + i * stride2);
-        for (size_t j = 0; j < cpp_src->GetImgWidth(); j++) {
-          aaa.a[0] = 0;
-          aaa.a[1] = line16[j];
-          linef[j] = aaa.b;
-        }
-      }
-      cpp_src->Flush(handle_ctx->rt_handle);
-      cpp_dst->Flush(handle_ctx->rt_handle);
-    } else if (cpp_src->m_tg.fmt == CVK_FMT_BF16 && cpp_dst->m_tg.fmt == CVK_FMT_U16) {
-      cpp_src->Invld(handle_ctx->rt_handle);
-      cpp_dst->Invld(handle_ctx->rt_handle);
-      uint16_t *src_ptr = (uint16_t *)cpp_src->GetVAddr();
-      uint16_t *dst_ptr = (uint16_t *)cpp_dst->GetVAddr();
-      uint64_t img_size = cpp_src->GetImgSize() / 2;
-      neonBF162U16(src_ptr, dst_ptr, img_size);
-      cpp_src->Flush(handle_ctx->rt_handle);
-      cpp_dst->Flush(handle_ctx->rt_handle);
-    } else if (cpp_src->m_tg.fmt == CVK_FMT_BF16 && cpp_dst->m_tg.fmt == CVK_FMT_I16) {
-      cpp_src->Invld(handle_ctx->rt_handle);
-      cpp_dst->Invld(handle_ctx->rt_handle);
-      uint16_t *src_ptr = (uint16_t *)cpp_src->GetVAddr();
-      int16_t *dst_ptr = (int16_t *)cpp_dst->GetVAddr();
-      uint64_t img_size = cpp_src->GetImgSize() / 2;
-      neonBF162S16(src_ptr, dst_ptr, img_size);
-      cpp_src->Flush(handle_ctx->rt_handle);
-      cpp_dst->Flush(handle_ctx->rt_handle);
-    } else if ((cpp_src->m_tg.fmt == CVK_FMT_BF16 || cpp_src->m_tg.fmt == CVK_FMT_U8 ||
-                cpp_src->m_tg.fmt == CVK_FMT_I8) &&
-               (cpp_dst->m_tg.fmt == CVK_FMT_BF16 || cpp_dst->m_tg.fmt == CVK_FMT_U8 ||
-                cpp_dst->m_tg.fmt == CVK_FMT_I8)) {
-      CviImg *cpp_src = reinterpret_cast<CviImg *>(pstSrc->tpu_block);
-      CviImg *cpp_dst = reinterpret_cast<CviImg *>(pstDst->tpu_block);
-
-      IveTPUCopyDirect::run(handle_ctx->rt_handle, handle_ctx->cvk_ctx, cpp_src, cpp_dst);
-    } else {
-      LOGE("Unsupported input output image type ( %u, %u).\n", cpp_src->m_tg.fmt,
-           cpp_dst->m_tg.fmt);
-      return CVI_FAILURE;
+      return handle_ctx->t_h.t_norm.run(handle_ctx->rt_handle, handle_ctx->cvk_ctx, inputs,
+                                        outputs);
     }
-  } else {
-    LOGE("Unsupported enType %u.\n", pstItcCtrl->enType);
-    return CVI_FAILURE;
+#endif
+    affine.sub = min;
+    affine.scale = max > min ? (range_hi[dst_fmt] - range_lo[dst_fmt]) / (max - min) : 0.f;
+    affine.add = range_lo[dst_fmt];
+  }
+
+  // Only the valid width of each row is converted, the stride padding is left untouched.
+  const ItcRowFunc convert_row = itc_row_table[src_fmt][dst_fmt];
+  for (uint32_t k = 0; k < planes; k++) {
+    auto convert_rows = [=](uint32_t row_begin, uint32_t row_end) {
+      for (uint32_t i = row_begin; i < row_end; i++) {
+        convert_row(pstSrc->pu8VirAddr[k] + i * pstSrc->u16Stride[k],
+                    pstDst->pu8VirAddr[k] + i * pstDst->u16Stride[k], pstSrc->u32Width, affine);
+      }
+    };
+    parallelRows(pstSrc->u32Height, pstSrc->u32Width, convert_rows);
   }
+
+  CVI_IVE_BufFlush(pIveHandle, pstDst);
   return CVI_SUCCESS;
-#else
-  return CVI_FAILURE;
-#endif
 }
 
 CVI_S32 CVI_IVE_ConstFill(IVE_HANDLE pIveHandle, const CVI_FLOAT value, IVE_DST_IMAGE_S *pstDst,
@@ -1875,6 +2776,24 @@ CVI_S32 CVI_IVE_Erode(IVE_HANDLE pIveHandle, IVE_SRC_IMAGE_S *pstSrc, IVE_DST_IM
   return ret;
 }
 
+// The mask is repeated for every NPU lane, free kernel->img after the submission.
+static void create_filter_kernel(IVE_HANDLE_CTX *handle_ctx, const IVE_FILTER_CTRL_S *pstFltCtrl,
+                                 IveKernel *kernel) {
+  uint32_t npu_num = handle_ctx->t_h.t_filter.getNpuNum(handle_ctx->cvk_ctx);
+  CviImg cimg(handle_ctx->rt_handle, npu_num, pstFltCtrl->u8MaskSize, pstFltCtrl->u8MaskSize,
+              CVK_FMT_I8);
+  kernel->img = cimg;
+  int mask_length = pstFltCtrl->u8MaskSize * pstFltCtrl->u8MaskSize;
+  for (size_t i = 0; i < npu_num; i++) {
+    memcpy((int8_t *)(kernel->img.GetVAddr() + i * mask_length), pstFltCtrl->as8Mask,
+           mask_length);
+  }
+  kernel->img.Flush(handle_ctx->rt_handle);
+  kernel->multiplier.f = 1.f / pstFltCtrl->u32Norm;
+  QuantizeMultiplierSmallerThanOne(kernel->multiplier.f, &kernel->multiplier.base,
+                                   &kernel->multiplier.shift);
+}
+
 CVI_S32 CVI_IVE_Filter(IVE_HANDLE pIveHandle, IVE_SRC_IMAGE_S *pstSrc, IVE_DST_IMAGE_S *pstDst,
                        IVE_FILTER_CTRL_S *pstFltCtrl, bool bInstant) {
   ScopedTrace t(__PRETTY_FUNCTION__);
@@ -1899,20 +2818,8 @@ CVI_S32 CVI_IVE_Filter(IVE_HANDLE pIveHandle, IVE_SRC_IMAGE_S *pstSrc, IVE_DST_I
   if (pstFltCtrl->u8MaskSize != 3 && pstFltCtrl->u8MaskSize != 5 && pstFltCtrl->u8MaskSize != 13) {
     LOGE("Currently Filter only supports filter size 3, 5, 13.\n");
   }
-  uint32_t npu_num = handle_ctx->t_h.t_filter.getNpuNum(handle_ctx->cvk_ctx);
-  CviImg cimg(handle_ctx->rt_handle, npu_num, pstFltCtrl->u8MaskSize, pstFltCtrl->u8MaskSize,
-              CVK_FMT_I8);
   IveKernel kernel;
-  kernel.img = cimg;
-  kernel.img.GetVAddr();
-  int mask_length = pstFltCtrl->u8MaskSize * pstFltCtrl->u8MaskSize;
-  for (size_t i = 0; i < npu_num; i++) {
-    memcpy((int8_t *)(kernel.img.GetVAddr() + i * mask_length), pstFltCtrl->as8Mask, mask_length);
-  }
-  kernel.img.Flush(handle_ctx->rt_handle);
-  kernel.multiplier.f = 1.f / pstFltCtrl->u32Norm;
-  QuantizeMultiplierSmallerThanOne(kernel.multiplier.f, &kernel.multiplier.base,
-                                   &kernel.multiplier.shift);
+  create_filter_kernel(handle_ctx, pstFltCtrl, &kernel);
   handle_ctx->t_h.t_filter.setKernel(kernel);
   int ret =
       handle_ctx->t_h.t_filter.run(handle_ctx->rt_handle, handle_ctx->cvk_ctx, inputs, outputs);
@@ -2130,41 +3037,354 @@ CVI_S32 CVI_IVE_HOG(IVE_HANDLE pIveHandle, IVE_SRC_IMAGE_S *pstSrc, IVE_DST_IMAG
 #endif
 }
 
-CVI_S32 CVI_IVE_MagAndAng(IVE_HANDLE pIveHandle, IVE_SRC_IMAGE_S *pstSrcH, IVE_SRC_IMAGE_S *pstSrcV,
-                          IVE_DST_IMAGE_S *pstDstMag, IVE_DST_IMAGE_S *pstDstAng,
-                          IVE_MAG_AND_ANG_CTRL_S *pstMaaCtrl, bool bInstant) {
-  ScopedTrace t(__PRETTY_FUNCTION__);
-  if (!IsValidImageType(pstSrcH, STRFY(pstSrcH), IVE_IMAGE_TYPE_BF16C1)) {
+CVI_S32 CVI_IVE_LoadHOGSVMModel(IVE_HANDLE pIveHandle, const char *filename,
+                                IVE_HOG_SVM_MODEL_S *pstModel) {
+  struct model *svm = load_model(filename);
+  if (svm == NULL) {
+    LOGE("Failed to load SVM model %s.\n", filename);
     return CVI_FAILURE;
   }
-  if (!IsValidImageType(pstSrcV, STRFY(pstSrcV), IVE_IMAGE_TYPE_BF16C1)) {
-    return CVI_FAILURE;
+  int label_idx = 0;
+  if (!check_regression_model(svm)) {
+    if (get_nr_class(svm) != 2 || svm->param.solver_type == MCSVM_CS) {
+      LOGE("HOG detector only supports two-class linear SVM model.\n");
+      free_and_destroy_model(&svm);
+      return CVI_FAILURE;
+    }
+    int labels[2];
+    get_labels(svm, labels);
+    label_idx = labels[0] > labels[1] ? 0 : 1;
+  }
+  uint32_t nr_feature = get_nr_feature(svm);
+  CVI_IVE_CreateMemInfo(pIveHandle, &pstModel->stWeight, nr_feature * sizeof(float));
+  float *weight = (float *)pstModel->stWeight.pu8VirAddr;
+  for (uint32_t i = 0; i < nr_feature; i++) {
+    weight[i] = get_decfun_coef(svm, i + 1, label_idx);
+  }
+  pstModel->f32Bias = get_decfun_bias(svm, label_idx);
+  pstModel->u32FeatureLen = nr_feature;
+  free_and_destroy_model(&svm);
+  return CVI_SUCCESS;
+}
+
+#ifndef CV180X
+/**
+ * @brief Generate cell histograms of a whole image with the same binning as CVI_IVE_HOG.
+ *
+ */
+static void hog_cell_histogram(IVE_IMAGE_S *pstMag, IVE_IMAGE_S *pstAng, const uint32_t cell_size,
+                               const uint8_t bin_size, const uint32_t width_cell,
+                               const uint32_t height_cell, float *cell_histogram) {
+  uint16_t *ang_ptr = (uint16_t *)pstAng->pu8VirAddr[0];
+  uint16_t *mag_ptr = (uint16_t *)pstMag->pu8VirAddr[0];
+  uint32_t ang_stride = pstAng->u16Stride[0] / sizeof(uint16_t);
+  uint32_t mag_stride = pstMag->u16Stride[0] / sizeof(uint16_t);
+  float div = 180 / bin_size;
+  memset(cell_histogram, 0, width_cell * height_cell * bin_size * sizeof(float));
+  // Sobel result on the image border is invalid, skip them as CVI_IVE_HOG does.
+  uint32_t height_end = std::min(height_cell * cell_size, pstAng->u32Height - 1);
+  uint32_t width_end = std::min(width_cell * cell_size, pstAng->u32Width - 1);
+  for (uint32_t i = 1; i < height_end; i++) {
+    uint16_t *ang_row = ang_ptr + i * ang_stride;
+    uint16_t *mag_row = mag_ptr + i * mag_stride;
+    float *cell_row = cell_histogram + (i / cell_size) * width_cell * bin_size;
+    for (uint32_t j = 1; j < width_end; j++) {
+      float *cell = cell_row + (j / cell_size) * bin_size;
+      float mag = convert_bf16_fp32(mag_row[j]);
+      float bin_div = (uint32_t)std::abs(convert_bf16_fp32(ang_row[j])) / div;
+      uint32_t bin_index = bin_div;
+      float bin_div_dec = bin_div - bin_index;
+      if (bin_index >= bin_size) {
+        bin_index = 0;
+      }
+      if (bin_div_dec == 0) {
+        cell[bin_index] += mag;
+      } else {
+        uint32_t bin_index_2 = bin_index + 1;
+        if (bin_index_2 >= bin_size) bin_index_2 = 0;
+        cell[bin_index] += mag * (1.f - bin_div_dec);
+        cell[bin_index_2] += mag * bin_div_dec;
+      }
+    }
   }
-  IVE_HANDLE_CTX *handle_ctx = reinterpret_cast<IVE_HANDLE_CTX *>(pIveHandle);
-  handle_ctx->t_h.t_magandang.setTblMgr(&handle_ctx->t_h.t_tblmgr);
-  CviImg *cpp_src1 = reinterpret_cast<CviImg *>(pstSrcH->tpu_block);
-  CviImg *cpp_src2 = reinterpret_cast<CviImg *>(pstSrcV->tpu_block);
-  CviImg *cpp_dst = nullptr, *cpp_dst2 = nullptr;
-  std::vector<CviImg *> inputs = {cpp_src1, cpp_src2};
-  std::vector<CviImg *> outputs;
-  switch (pstMaaCtrl->enOutCtrl) {
-    case IVE_MAG_AND_ANG_OUT_CTRL_MAG: {
-      if (!IsValidImageType(pstDstMag, STRFY(pstDstMag), IVE_IMAGE_TYPE_BF16C1)) {
-        return CVI_FAILURE;
+}
+
+/**
+ * @brief Gather and L2 normalize every block on the block grid once, so that overlapping windows
+ *        can share them.
+ *
+ */
+static void hog_block_feature(const float *cell_histogram, const uint32_t width_cell,
+                              const IVE_HOG_CTRL_S *pstHogCtrl, const uint32_t width_block,
+                              const uint32_t height_block, float *block_feature) {
+  const uint32_t copy_length = pstHogCtrl->u16BlkSizeInCell * pstHogCtrl->u8BinSize;
+  const uint32_t block_data_length = copy_length * pstHogCtrl->u16BlkSizeInCell;
+  float *block_head = block_feature;
+  for (uint32_t i = 0; i < height_block; i++) {
+    uint32_t cell_y = i * pstHogCtrl->u16BlkStepY;
+    for (uint32_t j = 0; j < width_block; j++) {
+      uint32_t cell_x = j * pstHogCtrl->u16BlkStepX;
+      for (uint32_t k = 0; k < pstHogCtrl->u16BlkSizeInCell; k++) {
+        const float *cell_hist_ptr =
+            cell_histogram + ((cell_y + k) * width_cell + cell_x) * pstHogCtrl->u8BinSize;
+        memcpy(block_head + k * copy_length, cell_hist_ptr, copy_length * sizeof(float));
       }
-      cpp_dst = reinterpret_cast<CviImg *>(pstDstMag->tpu_block);
-      handle_ctx->t_h.t_magandang.exportOption(true, false);
-      outputs.emplace_back(cpp_dst);
-    } break;
-    case IVE_MAG_AND_ANG_OUT_CTRL_ANG: {
-      if (!IsValidImageType(pstDstAng, STRFY(pstDstAng), IVE_IMAGE_TYPE_BF16C1)) {
-        return CVI_FAILURE;
+      float count_total = neonF32Dot(block_head, block_head, block_data_length);
+      float count = count_total == 0 ? 0 : 1.f / sqrt(count_total);
+      for (uint32_t k = 0; k < block_data_length; k++) {
+        block_head[k] *= count;
       }
-      cpp_dst = reinterpret_cast<CviImg *>(pstDstAng->tpu_block);
-      handle_ctx->t_h.t_magandang.exportOption(false, true);
-      outputs.emplace_back(cpp_dst);
-    } break;
-    case IVE_MAG_AND_ANG_OUT_CTRL_MAG_AND_ANG: {
+      block_head += block_data_length;
+    }
+  }
+}
+
+/**
+ * @brief Bilinear downscale used to build the detector pyramid. Honors the strides of both images.
+ *
+ */
+static void hog_pyramid_resize(IVE_IMAGE_S *pstSrc, IVE_IMAGE_S *pstDst) {
+  const float scale_x = (float)pstSrc->u32Width / pstDst->u32Width;
+  const float scale_y = (float)pstSrc->u32Height / pstDst->u32Height;
+  std::vector<uint32_t> x0(pstDst->u32Width);
+  std::vector<float> fx(pstDst->u32Width);
+  for (uint32_t j = 0; j < pstDst->u32Width; j++) {
+    float sx = std::max((j + 0.5f) * scale_x - 0.5f, 0.f);
+    x0[j] = std::min((uint32_t)sx, pstSrc->u32Width - 2);
+    fx[j] = std::min(sx - x0[j], 1.f);
+  }
+  for (uint32_t i = 0; i < pstDst->u32Height; i++) {
+    float sy = std::max((i + 0.5f) * scale_y - 0.5f, 0.f);
+    uint32_t y0 = std::min((uint32_t)sy, pstSrc->u32Height - 2);
+    float fy = std::min(sy - y0, 1.f);
+    const uint8_t *row0 = pstSrc->pu8VirAddr[0] + y0 * pstSrc->u16Stride[0];
+    const uint8_t *row1 = row0 + pstSrc->u16Stride[0];
+    uint8_t *dst_row = pstDst->pu8VirAddr[0] + i * pstDst->u16Stride[0];
+    for (uint32_t j = 0; j < pstDst->u32Width; j++) {
+      uint32_t x = x0[j];
+      float top = row0[x] + (row0[x + 1] - row0[x]) * fx[j];
+      float bottom = row1[x] + (row1[x + 1] - row1[x]) * fx[j];
+      dst_row[j] = (uint8_t)(top + (bottom - top) * fy + 0.5f);
+    }
+  }
+}
+
+/**
+ * @brief Run the detector on one pyramid level and append the boxes above threshold.
+ *
+ */
+static CVI_S32 hog_detect_level(IVE_HANDLE pIveHandle, IVE_SRC_IMAGE_S *pstSrc,
+                                IVE_HOG_SVM_MODEL_S *pstModel, IVE_HOG_DETECT_CTRL_S *pstDetCtrl,
+                                const float scale, std::vector<IVE_HOG_DETECT_BOX_S> *boxes) {
+  const IVE_HOG_CTRL_S *pstHogCtrl = &pstDetCtrl->stHogCtrl;
+  uint32_t width_cell = pstSrc->u32Width / pstHogCtrl->u32CellSize;
+  uint32_t height_cell = pstSrc->u32Height / pstHogCtrl->u32CellSize;
+  uint32_t win_width_cell = pstDetCtrl->u16WinWidth / pstHogCtrl->u32CellSize;
+  uint32_t win_height_cell = pstDetCtrl->u16WinHeight / pstHogCtrl->u32CellSize;
+  if (width_cell < win_width_cell || height_cell < win_height_cell) {
+    return CVI_SUCCESS;
+  }
+  uint32_t width_block = (width_cell - pstHogCtrl->u16BlkSizeInCell) / pstHogCtrl->u16BlkStepX + 1;
+  uint32_t height_block =
+      (height_cell - pstHogCtrl->u16BlkSizeInCell) / pstHogCtrl->u16BlkStepY + 1;
+  uint32_t win_width_block =
+      (win_width_cell - pstHogCtrl->u16BlkSizeInCell) / pstHogCtrl->u16BlkStepX + 1;
+  uint32_t win_height_block =
+      (win_height_cell - pstHogCtrl->u16BlkSizeInCell) / pstHogCtrl->u16BlkStepY + 1;
+  uint32_t block_data_length =
+      pstHogCtrl->u16BlkSizeInCell * pstHogCtrl->u16BlkSizeInCell * pstHogCtrl->u8BinSize;
+
+  IVE_IMAGE_S stDstH, stDstV, stDstMag, stDstAng;
+  CVI_IVE_CreateImage(pIveHandle, &stDstH, IVE_IMAGE_TYPE_BF16C1, pstSrc->u32Width,
+                      pstSrc->u32Height);
+  CVI_IVE_CreateImage(pIveHandle, &stDstV, IVE_IMAGE_TYPE_BF16C1, pstSrc->u32Width,
+                      pstSrc->u32Height);
+  CVI_IVE_CreateImage(pIveHandle, &stDstMag, IVE_IMAGE_TYPE_BF16C1, pstSrc->u32Width,
+                      pstSrc->u32Height);
+  CVI_IVE_CreateImage(pIveHandle, &stDstAng, IVE_IMAGE_TYPE_BF16C1, pstSrc->u32Width,
+                      pstSrc->u32Height);
+  IVE_SOBEL_CTRL_S iveSblCtrl;
+  iveSblCtrl.enOutCtrl = IVE_SOBEL_OUT_CTRL_BOTH;
+  iveSblCtrl.u8MaskSize = 1;
+  IVE_MAG_AND_ANG_CTRL_S iveMaaCtrl;
+  iveMaaCtrl.enOutCtrl = IVE_MAG_AND_ANG_OUT_CTRL_MAG_AND_ANG;
+  iveMaaCtrl.enDistCtrl = IVE_MAG_DIST_L2;
+  CVI_S32 ret = CVI_IVE_Sobel(pIveHandle, pstSrc, &stDstH, &stDstV, &iveSblCtrl, 0);
+  if (ret == CVI_SUCCESS) {
+    ret = CVI_IVE_MagAndAng(pIveHandle, &stDstH, &stDstV, &stDstMag, &stDstAng, &iveMaaCtrl, 0);
+  }
+  if (ret == CVI_SUCCESS) {
+    Tracer::TraceBegin("HOG block features");
+    CVI_IVE_BufRequest(pIveHandle, &stDstAng);
+    CVI_IVE_BufRequest(pIveHandle, &stDstMag);
+    std::vector<float> cell_histogram(width_cell * height_cell * pstHogCtrl->u8BinSize);
+    std::vector<float> block_feature(width_block * height_block * block_data_length);
+    hog_cell_histogram(&stDstMag, &stDstAng, pstHogCtrl->u32CellSize, pstHogCtrl->u8BinSize,
+                       width_cell, height_cell, cell_histogram.data());
+    hog_block_feature(cell_histogram.data(), width_cell, pstHogCtrl, width_block, height_block,
+                      block_feature.data());
+    Tracer::TraceEnd();
+
+    Tracer::TraceBegin("HOG window scoring");
+    // Blocks in one window row are contiguous in both the feature map and the model, so each
+    // window row is a single dot product.
+    const float *weight = (const float *)pstModel->stWeight.pu8VirAddr;
+    const uint32_t row_length = win_width_block * block_data_length;
+    const uint32_t step_x = pstDetCtrl->u16WinStepInBlkX;
+    const uint32_t step_y = pstDetCtrl->u16WinStepInBlkY;
+    for (uint32_t i = 0; i + win_height_block <= height_block; i += step_y) {
+      for (uint32_t j = 0; j + win_width_block <= width_block; j += step_x) {
+        float score = pstModel->f32Bias;
+        for (uint32_t k = 0; k < win_height_block; k++) {
+          const float *feature_ptr =
+              block_feature.data() + ((i + k) * width_block + j) * block_data_length;
+          score += neonF32Dot(weight + k * row_length, feature_ptr, row_length);
+        }
+        if (score < pstDetCtrl->f32Threshold) {
+          continue;
+        }
+        IVE_HOG_DETECT_BOX_S box;
+        box.u16X = std::round(j * pstHogCtrl->u16BlkStepX * pstHogCtrl->u32CellSize * scale);
+        box.u16Y = std::round(i * pstHogCtrl->u16BlkStepY * pstHogCtrl->u32CellSize * scale);
+        box.u16Width = std::round(pstDetCtrl->u16WinWidth * scale);
+        box.u16Height = std::round(pstDetCtrl->u16WinHeight * scale);
+        box.f32Score = score;
+        boxes->push_back(box);
+      }
+    }
+    Tracer::TraceEnd();
+  }
+  CVI_SYS_FreeI(pIveHandle, &stDstH);
+  CVI_SYS_FreeI(pIveHandle, &stDstV);
+  CVI_SYS_FreeI(pIveHandle, &stDstMag);
+  CVI_SYS_FreeI(pIveHandle, &stDstAng);
+  return ret;
+}
+#endif
+
+CVI_S32 CVI_IVE_HOGDetect(IVE_HANDLE pIveHandle, IVE_SRC_IMAGE_S *pstSrc,
+                          IVE_HOG_SVM_MODEL_S *pstModel, IVE_HOG_DETECT_BOX_S *pstBoxes,
+                          CVI_U32 u32MaxBoxNum, CVI_U32 *pu32BoxNum,
+                          IVE_HOG_DETECT_CTRL_S *pstDetCtrl, bool bInstant) {
+#ifndef CV180X
+  ScopedTrace t(__PRETTY_FUNCTION__);
+  if (!IsValidImageType(pstSrc, STRFY(pstSrc), IVE_IMAGE_TYPE_U8C1)) {
+    return CVI_FAILURE;
+  }
+  const IVE_HOG_CTRL_S *pstHogCtrl = &pstDetCtrl->stHogCtrl;
+  if (pstHogCtrl->u32CellSize == 0 || pstHogCtrl->u8BinSize == 0 ||
+      pstHogCtrl->u16BlkSizeInCell == 0) {
+    LOGE("Cell size, bin size and block size cannot be 0.\n");
+    return CVI_FAILURE;
+  }
+  if (pstHogCtrl->u16BlkStepX == 0 || pstHogCtrl->u16BlkStepY == 0) {
+    LOGE("u16BlkStepX and u16BlkStepY cannot be 0.\n");
+    return CVI_FAILURE;
+  }
+  if (pstDetCtrl->u16WinStepInBlkX == 0 || pstDetCtrl->u16WinStepInBlkY == 0) {
+    LOGE("u16WinStepInBlkX and u16WinStepInBlkY cannot be 0.\n");
+    return CVI_FAILURE;
+  }
+  if (pstDetCtrl->u16WinWidth % pstHogCtrl->u32CellSize != 0 ||
+      pstDetCtrl->u16WinHeight % pstHogCtrl->u32CellSize != 0) {
+    LOGE("Window size %ux%u is not divisible by cell size %u.\n", pstDetCtrl->u16WinWidth,
+         pstDetCtrl->u16WinHeight, pstHogCtrl->u32CellSize);
+    return CVI_FAILURE;
+  }
+  uint32_t win_width_cell = pstDetCtrl->u16WinWidth / pstHogCtrl->u32CellSize;
+  uint32_t win_height_cell = pstDetCtrl->u16WinHeight / pstHogCtrl->u32CellSize;
+  if (win_width_cell < pstHogCtrl->u16BlkSizeInCell ||
+      win_height_cell < pstHogCtrl->u16BlkSizeInCell) {
+    LOGE("Block size exceed window size.\n");
+    return CVI_FAILURE;
+  }
+  uint32_t win_feature_length =
+      ((win_width_cell - pstHogCtrl->u16BlkSizeInCell) / pstHogCtrl->u16BlkStepX + 1) *
+      ((win_height_cell - pstHogCtrl->u16BlkSizeInCell) / pstHogCtrl->u16BlkStepY + 1) *
+      pstHogCtrl->u16BlkSizeInCell * pstHogCtrl->u16BlkSizeInCell * pstHogCtrl->u8BinSize;
+  if (pstModel->u32FeatureLen != win_feature_length ||
+      pstModel->stWeight.u32ByteSize < win_feature_length * sizeof(float)) {
+    LOGE("Model feature length mismatch! Given: %u, required: %u.\n", pstModel->u32FeatureLen,
+         win_feature_length);
+    return CVI_FAILURE;
+  }
+  uint32_t scale_num = pstDetCtrl->u8ScaleNum == 0 ? 1 : pstDetCtrl->u8ScaleNum;
+  if (scale_num > 1 && pstDetCtrl->f32ScaleFactor <= 1.f) {
+    LOGE("f32ScaleFactor must be larger than 1 for multi-scale detection.\n");
+    return CVI_FAILURE;
+  }
+
+  std::vector<IVE_HOG_DETECT_BOX_S> boxes;
+  CVI_S32 ret = hog_detect_level(pIveHandle, pstSrc, pstModel, pstDetCtrl, 1.f, &boxes);
+  float scale = 1.f;
+  for (uint32_t i = 1; i < scale_num && ret == CVI_SUCCESS; i++) {
+    scale *= pstDetCtrl->f32ScaleFactor;
+    uint32_t level_width = std::round(pstSrc->u32Width / scale);
+    uint32_t level_height = std::round(pstSrc->u32Height / scale);
+    if (level_width < pstDetCtrl->u16WinWidth || level_height < pstDetCtrl->u16WinHeight) {
+      break;
+    }
+    IVE_IMAGE_S stLevel;
+    CVI_IVE_CreateImage(pIveHandle, &stLevel, IVE_IMAGE_TYPE_U8C1, level_width, level_height);
+    CVI_IVE_BufRequest(pIveHandle, pstSrc);
+    hog_pyramid_resize(pstSrc, &stLevel);
+    CVI_IVE_BufFlush(pIveHandle, &stLevel);
+    ret = hog_detect_level(pIveHandle, &stLevel, pstModel, pstDetCtrl, scale, &boxes);
+    CVI_SYS_FreeI(pIveHandle, &stLevel);
+  }
+  if (ret != CVI_SUCCESS) {
+    return ret;
+  }
+
+  // Keep the boxes with the highest scores if the output buffer is not large enough.
+  uint32_t box_num = std::min((uint32_t)boxes.size(), (uint32_t)u32MaxBoxNum);
+  std::partial_sort(boxes.begin(), boxes.begin() + box_num, boxes.end(),
+                    [](const IVE_HOG_DETECT_BOX_S &a, const IVE_HOG_DETECT_BOX_S &b) {
+                      return a.f32Score > b.f32Score;
+                    });
+  memcpy(pstBoxes, boxes.data(), box_num * sizeof(IVE_HOG_DETECT_BOX_S));
+  *pu32BoxNum = box_num;
+  return CVI_SUCCESS;
+#else
+  return CVI_FAILURE;
+#endif
+}
+
+CVI_S32 CVI_IVE_MagAndAng(IVE_HANDLE pIveHandle, IVE_SRC_IMAGE_S *pstSrcH, IVE_SRC_IMAGE_S *pstSrcV,
+                          IVE_DST_IMAGE_S *pstDstMag, IVE_DST_IMAGE_S *pstDstAng,
+                          IVE_MAG_AND_ANG_CTRL_S *pstMaaCtrl, bool bInstant) {
+  ScopedTrace t(__PRETTY_FUNCTION__);
+  if (!IsValidImageType(pstSrcH, STRFY(pstSrcH), IVE_IMAGE_TYPE_BF16C1)) {
+    return CVI_FAILURE;
+  }
+  if (!IsValidImageType(pstSrcV, STRFY(pstSrcV), IVE_IMAGE_TYPE_BF16C1)) {
+    return CVI_FAILURE;
+  }
+  IVE_HANDLE_CTX *handle_ctx = reinterpret_cast<IVE_HANDLE_CTX *>(pIveHandle);
+  handle_ctx->t_h.t_magandang.setTblMgr(&handle_ctx->t_h.t_tblmgr);
+  CviImg *cpp_src1 = reinterpret_cast<CviImg *>(pstSrcH->tpu_block);
+  CviImg *cpp_src2 = reinterpret_cast<CviImg *>(pstSrcV->tpu_block);
+  CviImg *cpp_dst = nullptr, *cpp_dst2 = nullptr;
+  std::vector<CviImg *> inputs = {cpp_src1, cpp_src2};
+  std::vector<CviImg *> outputs;
+  switch (pstMaaCtrl->enOutCtrl) {
+    case IVE_MAG_AND_ANG_OUT_CTRL_MAG: {
+      if (!IsValidImageType(pstDstMag, STRFY(pstDstMag), IVE_IMAGE_TYPE_BF16C1)) {
+        return CVI_FAILURE;
+      }
+      cpp_dst = reinterpret_cast<CviImg *>(pstDstMag->tpu_block);
+      handle_ctx->t_h.t_magandang.exportOption(true, false);
+      outputs.emplace_back(cpp_dst);
+    } break;
+    case IVE_MAG_AND_ANG_OUT_CTRL_ANG: {
+      if (!IsValidImageType(pstDstAng, STRFY(pstDstAng), IVE_IMAGE_TYPE_BF16C1)) {
+        return CVI_FAILURE;
+      }
+      cpp_dst = reinterpret_cast<CviImg *>(pstDstAng->tpu_block);
+      handle_ctx->t_h.t_magandang.exportOption(false, true);
+      outputs.emplace_back(cpp_dst);
+    } break;
+    case IVE_MAG_AND_ANG_OUT_CTRL_MAG_AND_ANG: {
       if (!IsValidImageType(pstDstMag, STRFY(pstDstMag), IVE_IMAGE_TYPE_BF16C1)) {
         return CVI_FAILURE;
       }
@@ -2190,9 +3410,30 @@ CVI_S32 CVI_IVE_MagAndAng(IVE_HANDLE pIveHandle, IVE_SRC_IMAGE_S *pstSrcH, IVE_S
                                          outputs);
 }
 
+// Below this size the TPU submission and the cache maintenance cost more than the lookup.
+#define MAP_CPU_MAX_PIXELS (320 * 240)
+
+#ifndef CV180X
+// Keeps a handle owned U8C1 scratch image, the device memory is only reallocated when the
+// requested size differs from the last call.
+static CVI_S32 reuse_scratch_image(IVE_HANDLE pIveHandle, IVE_IMAGE_S *pstImg,
+                                   const CVI_U32 u32Width, const CVI_U32 u32Height) {
+  if (pstImg->tpu_block != NULL && pstImg->u32Width == u32Width &&
+      pstImg->u32Height == u32Height) {
+    return CVI_SUCCESS;
+  }
+  CVI_SYS_FreeI(pIveHandle, pstImg);
+  if (CVI_IVE_CreateImage(pIveHandle, pstImg, IVE_IMAGE_TYPE_U8C1, u32Width, u32Height) !=
+      CVI_SUCCESS) {
+    LOGE("Failed to allocate scratch image %u x %u.\n", u32Width, u32Height);
+    return CVI_FAILURE;
+  }
+  return CVI_SUCCESS;
+}
+#endif
+
 CVI_S32 CVI_IVE_Map(IVE_HANDLE pIveHandle, IVE_SRC_IMAGE_S *pstSrc, IVE_MEM_INFO_S *pstMap,
                     IVE_DST_IMAGE_S *pstDst, bool bInstant) {
-#ifndef CV180X
   ScopedTrace t(__PRETTY_FUNCTION__);
   if (!IsValidImageType(pstSrc, STRFY(pstSrc), IVE_IMAGE_TYPE_U8C1, IVE_IMAGE_TYPE_U16C1)) {
     return CVI_FAILURE;
@@ -2200,37 +3441,84 @@ CVI_S32 CVI_IVE_Map(IVE_HANDLE pIveHandle, IVE_SRC_IMAGE_S *pstSrc, IVE_MEM_INFO
   if (!IsValidImageType(pstDst, STRFY(pstDst), IVE_IMAGE_TYPE_U8C1)) {
     return CVI_FAILURE;
   }
+  if (pstSrc->u32Width != pstDst->u32Width || pstSrc->u32Height != pstDst->u32Height) {
+    LOGE("pstSrc and pstDst must have the same size.\n");
+    return CVI_FAILURE;
+  }
+  const bool is_u16 = pstSrc->enType == IVE_IMAGE_TYPE_U16C1;
+  const CVI_U32 u32TblSize = is_u16 ? 512 : 256;
+  if (pstMap == NULL || pstMap->pu8VirAddr == NULL || pstMap->u32ByteSize != u32TblSize) {
+    LOGE("Mapping table of %s must be size %u in CVI_U8 format.\n",
+         cviIveImgEnTypeStr[pstSrc->enType], u32TblSize);
+    return CVI_FAILURE;
+  }
 
-  if (pstMap->u32ByteSize == 512) {
-    IVE_IMAGE_S table_index, lookup_index;
-    CVI_IVE_CreateImage(pIveHandle, &table_index, IVE_IMAGE_TYPE_U8C1, pstSrc->u32Width,
-                        pstSrc->u32Height);
-    CVI_IVE_CreateImage(pIveHandle, &lookup_index, IVE_IMAGE_TYPE_U8C1, pstSrc->u32Width,
-                        pstSrc->u32Height);
-    neonU16SeperateU8((uint16_t *)pstSrc->pu8VirAddr[0], table_index.pu8VirAddr[0],
-                      lookup_index.pu8VirAddr[0], (pstSrc->u16Stride[0] / 2) * pstSrc->u32Height);
+  bool use_cpu = true;
+#ifndef CV180X
+  use_cpu = (uint64_t)pstSrc->u32Width * pstSrc->u32Height <= MAP_CPU_MAX_PIXELS;
+#endif
+  if (use_cpu) {
+    CVI_IVE_BufRequest(pIveHandle, pstSrc);
+    CVI_IVE_BufRequest(pIveHandle, pstDst);
+    const uint8_t *table = pstMap->pu8VirAddr;
+    auto map_rows = [=](uint32_t row_begin, uint32_t row_end) {
+      for (uint32_t i = row_begin; i < row_end; i++) {
+        const uint8_t *src_row = pstSrc->pu8VirAddr[0] + i * pstSrc->u16Stride[0];
+        uint8_t *dst_row = pstDst->pu8VirAddr[0] + i * pstDst->u16Stride[0];
+#ifndef CV180X
+        if (is_u16) {
+          neonU16Lut512Row((const uint16_t *)src_row, dst_row, table, pstSrc->u32Width);
+        } else {
+          neonU8LutRow(src_row, dst_row, table, pstSrc->u32Width);
+        }
+#else
+        const uint16_t *src_row_u16 = (const uint16_t *)src_row;
+        for (uint32_t j = 0; j < pstSrc->u32Width; j++) {
+          dst_row[j] = is_u16 ? table[src_row_u16[j] > 511 ? 511 : src_row_u16[j]]
+                              : table[src_row[j]];
+        }
+#endif
+      }
+    };
+    parallelRows(pstSrc->u32Height, pstSrc->u32Width, map_rows);
+    CVI_IVE_BufFlush(pIveHandle, pstDst);
+    return CVI_SUCCESS;
+  }
 
-    CVI_IVE_BufFlush(pIveHandle, &table_index);
-    CVI_IVE_BufFlush(pIveHandle, &lookup_index);
+#ifndef CV180X
+  IVE_HANDLE_CTX *handle_ctx = reinterpret_cast<IVE_HANDLE_CTX *>(pIveHandle);
+  if (is_u16) {
+    IVE_IMAGE_S *table_index = &handle_ctx->map_table_index;
+    IVE_IMAGE_S *lookup_index = &handle_ctx->map_lookup_index;
+    if (reuse_scratch_image(pIveHandle, table_index, pstSrc->u32Width, pstSrc->u32Height) !=
+            CVI_SUCCESS ||
+        reuse_scratch_image(pIveHandle, lookup_index, pstSrc->u32Width, pstSrc->u32Height) !=
+            CVI_SUCCESS) {
+      return CVI_FAILURE;
+    }
+    CVI_IVE_BufRequest(pIveHandle, pstSrc);
+    // The table kernel blends the two halves by the high byte, so values above 511 are clamped
+    // to the last entry like on CPU.
+    for (uint32_t i = 0; i < pstSrc->u32Height; i++) {
+      neonU16SeperateU8((uint16_t *)(pstSrc->pu8VirAddr[0] + i * pstSrc->u16Stride[0]),
+                        table_index->pu8VirAddr[0] + i * table_index->u16Stride[0],
+                        lookup_index->pu8VirAddr[0] + i * lookup_index->u16Stride[0],
+                        pstSrc->u32Width, 511);
+    }
+    CVI_IVE_BufFlush(pIveHandle, table_index);
+    CVI_IVE_BufFlush(pIveHandle, lookup_index);
 
-    IVE_HANDLE_CTX *handle_ctx = reinterpret_cast<IVE_HANDLE_CTX *>(pIveHandle);
-    CviImg *cpp_src_index = reinterpret_cast<CviImg *>(table_index.tpu_block);
-    CviImg *cpp_src = reinterpret_cast<CviImg *>(lookup_index.tpu_block);
+    CviImg *cpp_src_index = reinterpret_cast<CviImg *>(table_index->tpu_block);
+    CviImg *cpp_src = reinterpret_cast<CviImg *>(lookup_index->tpu_block);
     CviImg *cpp_dst = reinterpret_cast<CviImg *>(pstDst->tpu_block);
     std::vector<CviImg *> inputs = {cpp_src_index, cpp_src};
     std::vector<CviImg *> outputs = {cpp_dst};
     handle_ctx->t_h.t_tbl512.setTable(handle_ctx->rt_handle, &handle_ctx->t_h.t_tblmgr,
                                       pstMap->pu8VirAddr);
     handle_ctx->t_h.t_tbl512.init(handle_ctx->rt_handle, handle_ctx->cvk_ctx);
-    CVI_S32 ret =
-        handle_ctx->t_h.t_tbl512.run(handle_ctx->rt_handle, handle_ctx->cvk_ctx, inputs, outputs);
-
-    CVI_SYS_FreeI(pIveHandle, &table_index);
-    CVI_SYS_FreeI(pIveHandle, &lookup_index);
-
-    return ret;
+    return handle_ctx->t_h.t_tbl512.run(handle_ctx->rt_handle, handle_ctx->cvk_ctx, inputs,
+                                        outputs);
   } else {
-    IVE_HANDLE_CTX *handle_ctx = reinterpret_cast<IVE_HANDLE_CTX *>(pIveHandle);
     auto &shape = handle_ctx->t_h.t_tblmgr.getTblTLShape(CVK_FMT_U8);
     uint32_t tbl_sz = shape.h * shape.w;
     if (pstMap->u32ByteSize != tbl_sz) {
@@ -2486,16 +3774,287 @@ CVI_S32 CVI_IVE_Average(IVE_HANDLE pIveHandle, IVE_SRC_IMAGE_S *pstSrc, float *a
   }
 
   CVI_IVE_BufRequest(pIveHandle, pstSrc);
+  // Accumulate row by row so the stride padding is not counted.
   uint64_t accumulate = 0;
-  neonU8Accumulate(pstSrc->pu8VirAddr[0], pstSrc->u16Stride[0] * pstSrc->u32Height, &accumulate);
+  for (uint32_t i = 0; i < pstSrc->u32Height; i++) {
+    uint64_t row_sum = 0;
+    neonU8Accumulate(pstSrc->pu8VirAddr[0] + i * pstSrc->u16Stride[0], pstSrc->u32Width,
+                     &row_sum);
+    accumulate += row_sum;
+  }
   *average = (float)accumulate / (pstSrc->u32Width * pstSrc->u32Height);
 #endif
   return CVI_SUCCESS;
 }
 
+// Partial statistics of one ROI channel. Integer inputs are summed exactly, BF16 in double.
+struct StatsAcc {
+  int64_t isum = 0;
+  uint64_t isq_sum = 0;
+  double fsum = 0;
+  double fsq_sum = 0;
+  uint64_t count = 0;
+  float min = std::numeric_limits<float>::max();
+  float max = -std::numeric_limits<float>::max();
+  uint32_t min_x = 0, min_y = 0, max_x = 0, max_y = 0;
+};
+
+static float stats_load(const uint8_t *row, const IVE_IMAGE_TYPE_E enType, const uint32_t i) {
+  switch (enType) {
+    case IVE_IMAGE_TYPE_U16C1:
+      return ((const uint16_t *)row)[i];
+    case IVE_IMAGE_TYPE_S16C1:
+      return ((const int16_t *)row)[i];
+    case IVE_IMAGE_TYPE_BF16C1:
+      return convert_bf16_fp32(((const uint16_t *)row)[i]);
+    default:
+      return row[i];
+  }
+}
+
+static uint32_t stats_find_first(const uint8_t *row, const uint8_t *mask, const uint32_t width,
+                                 const IVE_IMAGE_TYPE_E enType, const float value) {
+  for (uint32_t i = 0; i < width; i++) {
+    if ((mask == NULL || mask[i] != 0) && stats_load(row, enType, i) == value) {
+      return i;
+    }
+  }
+  return 0;
+}
+
+static void stats_row(const uint8_t *row, const uint8_t *mask, const uint32_t width,
+                      const IVE_IMAGE_TYPE_E enType, const uint32_t x, const uint32_t y,
+                      StatsAcc *acc) {
+  uint64_t count = 0;
+  float row_min = 0, row_max = 0;
+#ifndef CV180X
+  switch (enType) {
+    case IVE_IMAGE_TYPE_U16C1: {
+      uint64_t sum = 0;
+      uint16_t min = 65535, max = 0;
+      neonU16RowStats((const uint16_t *)row, mask, width, &sum, &acc->isq_sum, &count, &min,
+                      &max);
+      acc->isum += sum;
+      row_min = min;
+      row_max = max;
+    } break;
+    case IVE_IMAGE_TYPE_S16C1: {
+      int16_t min = 32767, max = -32768;
+      neonS16RowStats((const int16_t *)row, mask, width, &acc->isum, &acc->isq_sum, &count, &min,
+                      &max);
+      row_min = min;
+      row_max = max;
+    } break;
+    case IVE_IMAGE_TYPE_BF16C1: {
+      row_min = std::numeric_limits<float>::max();
+      row_max = -std::numeric_limits<float>::max();
+      neonBF16RowStats((const uint16_t *)row, mask, width, &acc->fsum, &acc->fsq_sum, &count,
+                       &row_min, &row_max);
+    } break;
+    default: {
+      uint64_t sum = 0;
+      uint8_t min = 255, max = 0;
+      neonU8RowStats(row, mask, width, &sum, &acc->isq_sum, &count, &min, &max);
+      acc->isum += sum;
+      row_min = min;
+      row_max = max;
+    } break;
+  }
+#else
+  row_min = std::numeric_limits<float>::max();
+  row_max = -std::numeric_limits<float>::max();
+  for (uint32_t i = 0; i < width; i++) {
+    if (mask != NULL && mask[i] == 0) continue;
+    float val = stats_load(row, enType, i);
+    if (enType == IVE_IMAGE_TYPE_BF16C1) {
+      acc->fsum += val;
+      acc->fsq_sum += (double)val * val;
+    } else {
+      acc->isum += (int64_t)val;
+      acc->isq_sum += (uint64_t)((int64_t)val * (int64_t)val);
+    }
+    if (val < row_min) row_min = val;
+    if (val > row_max) row_max = val;
+    count++;
+  }
+#endif
+  if (count == 0) {
+    return;
+  }
+  // Locations are only searched for when a row improves the extremes, which is rare after the
+  // first rows. Keeping the first hit in raster order makes the result independent of threads.
+  if (acc->count == 0 || row_min < acc->min) {
+    acc->min = row_min;
+    acc->min_x = x + stats_find_first(row, mask, width, enType, row_min);
+    acc->min_y = y;
+  }
+  if (acc->count == 0 || row_max > acc->max) {
+    acc->max = row_max;
+    acc->max_x = x + stats_find_first(row, mask, width, enType, row_max);
+    acc->max_y = y;
+  }
+  acc->count += count;
+}
+
+static void stats_merge(const StatsAcc &part, StatsAcc *acc) {
+  if (part.count == 0) {
+    return;
+  }
+  if (acc->count == 0 || part.min < acc->min ||
+      (part.min == acc->min && (part.min_y < acc->min_y ||
+                                (part.min_y == acc->min_y && part.min_x < acc->min_x)))) {
+    acc->min = part.min;
+    acc->min_x = part.min_x;
+    acc->min_y = part.min_y;
+  }
+  if (acc->count == 0 || part.max > acc->max ||
+      (part.max == acc->max && (part.max_y < acc->max_y ||
+                                (part.max_y == acc->max_y && part.max_x < acc->max_x)))) {
+    acc->max = part.max;
+    acc->max_x = part.max_x;
+    acc->max_y = part.max_y;
+  }
+  acc->isum += part.isum;
+  acc->isq_sum += part.isq_sum;
+  acc->fsum += part.fsum;
+  acc->fsq_sum += part.fsq_sum;
+  acc->count += part.count;
+}
+
+CVI_S32 CVI_IVE_Stats(IVE_HANDLE pIveHandle, IVE_SRC_IMAGE_S *pstSrc, IVE_SRC_IMAGE_S *pstMask,
+                      IVE_STATS_S *pstStats, IVE_STATS_CTRL_S *pstStatsCtrl, bool bInstant) {
+  ScopedTrace t(__PRETTY_FUNCTION__);
+  if (!IsValidImageType(pstSrc, STRFY(pstSrc), IVE_IMAGE_TYPE_U8C1, IVE_IMAGE_TYPE_U8C3_PLANAR,
+                        IVE_IMAGE_TYPE_U16C1, IVE_IMAGE_TYPE_S16C1, IVE_IMAGE_TYPE_BF16C1)) {
+    return CVI_FAILURE;
+  }
+  if (pstStats == NULL) {
+    LOGE("pstStats cannot be NULL.\n");
+    return CVI_FAILURE;
+  }
+  if (pstMask != NULL) {
+    if (!IsValidImageType(pstMask, STRFY(pstMask), IVE_IMAGE_TYPE_U8C1)) {
+      return CVI_FAILURE;
+    }
+    if (pstMask->u32Width != pstSrc->u32Width || pstMask->u32Height != pstSrc->u32Height) {
+      LOGE("Mask size %ux%u does not match input %ux%u.\n", pstMask->u32Width,
+           pstMask->u32Height, pstSrc->u32Width, pstSrc->u32Height);
+      return CVI_FAILURE;
+    }
+  }
+  IVE_STATS_ROI_S full_roi = {0, 0, (CVI_U16)pstSrc->u32Width, (CVI_U16)pstSrc->u32Height};
+  const IVE_STATS_ROI_S *rois = &full_roi;
+  uint32_t roi_num = 1;
+  if (pstStatsCtrl != NULL && pstStatsCtrl->u32RoiNum != 0) {
+    if (pstStatsCtrl->pstRoi == NULL) {
+      LOGE("pstRoi cannot be NULL when u32RoiNum is %u.\n", pstStatsCtrl->u32RoiNum);
+      return CVI_FAILURE;
+    }
+    rois = pstStatsCtrl->pstRoi;
+    roi_num = pstStatsCtrl->u32RoiNum;
+  }
+  for (uint32_t r = 0; r < roi_num; r++) {
+    if (rois[r].u16Width == 0 || rois[r].u16Height == 0 ||
+        (uint32_t)rois[r].u16X + rois[r].u16Width > pstSrc->u32Width ||
+        (uint32_t)rois[r].u16Y + rois[r].u16Height > pstSrc->u32Height) {
+      LOGE("ROI %u (%u, %u, %u, %u) is empty or out of image %ux%u.\n", r, rois[r].u16X,
+           rois[r].u16Y, rois[r].u16Width, rois[r].u16Height, pstSrc->u32Width,
+           pstSrc->u32Height);
+      return CVI_FAILURE;
+    }
+  }
+  CVI_IVE_BufRequest(pIveHandle, pstSrc);
+  if (pstMask != NULL) {
+    CVI_IVE_BufRequest(pIveHandle, pstMask);
+  }
+
+  const uint32_t channels = pstSrc->enType == IVE_IMAGE_TYPE_U8C3_PLANAR ? 3 : 1;
+  const uint32_t elem_size = pstSrc->enType == IVE_IMAGE_TYPE_U8C1 ||
+                                     pstSrc->enType == IVE_IMAGE_TYPE_U8C3_PLANAR
+                                 ? 1
+                                 : 2;
+  const IVE_IMAGE_TYPE_E elem_type =
+      pstSrc->enType == IVE_IMAGE_TYPE_U8C3_PLANAR ? IVE_IMAGE_TYPE_U8C1 : pstSrc->enType;
+  std::mutex mtx;
+  for (uint32_t r = 0; r < roi_num; r++) {
+    const IVE_STATS_ROI_S &roi = rois[r];
+    for (uint32_t c = 0; c < channels; c++) {
+      StatsAcc acc;
+      auto stats_rows = [&](uint32_t row_begin, uint32_t row_end) {
+        StatsAcc part;
+        for (uint32_t i = roi.u16Y + row_begin; i < roi.u16Y + row_end; i++) {
+          const uint8_t *row =
+              pstSrc->pu8VirAddr[c] + i * pstSrc->u16Stride[c] + roi.u16X * elem_size;
+          const uint8_t *mask =
+              pstMask == NULL ? NULL
+                              : pstMask->pu8VirAddr[0] + i * pstMask->u16Stride[0] + roi.u16X;
+          stats_row(row, mask, roi.u16Width, elem_type, roi.u16X, i, &part);
+        }
+        std::lock_guard<std::mutex> lock(mtx);
+        stats_merge(part, &acc);
+      };
+      parallelRows(roi.u16Height, roi.u16Width, stats_rows);
+
+      IVE_STATS_S *stats = &pstStats[r * channels + c];
+      memset(stats, 0, sizeof(IVE_STATS_S));
+      stats->u32Count = acc.count;
+      if (acc.count == 0) {
+        continue;
+      }
+      stats->dSum = (double)acc.isum + acc.fsum;
+      stats->dSqSum = (double)acc.isq_sum + acc.fsq_sum;
+      double mean = stats->dSum / acc.count;
+      double var = stats->dSqSum / acc.count - mean * mean;
+      stats->f32Mean = mean;
+      stats->f32Stddev = var > 0 ? std::sqrt(var) : 0.f;
+      stats->f32Min = acc.min;
+      stats->f32Max = acc.max;
+      stats->u16MinX = acc.min_x;
+      stats->u16MinY = acc.min_y;
+      stats->u16MaxX = acc.max_x;
+      stats->u16MaxY = acc.max_y;
+    }
+  }
+  return CVI_SUCCESS;
+}
+
+#ifdef CV180X
+static void ord_stat_row(const uint8_t *src, const uint32_t stride, uint8_t *buf, uint8_t *dst,
+                         const uint32_t dst_width, const uint32_t kz,
+                         const IVE_ORD_STAT_FILTER_MODE_E enMode) {
+  const uint32_t src_width = dst_width + kz - 1;
+  if (enMode == IVE_ORD_STAT_FILTER_MODE_MEDIAN) {
+    for (uint32_t i = 0; i < dst_width; i++) {
+      for (uint32_t r = 0; r < kz; r++) {
+        memcpy(buf + r * kz, src + r * stride + i, kz);
+      }
+      std::nth_element(buf, buf + kz * kz / 2, buf + kz * kz);
+      dst[i] = buf[kz * kz / 2];
+    }
+    return;
+  }
+  const bool is_max = enMode == IVE_ORD_STAT_FILTER_MODE_MAX;
+  for (uint32_t i = 0; i < src_width; i++) {
+    uint8_t v = src[i];
+    for (uint32_t r = 1; r < kz; r++) {
+      v = is_max ? std::max(v, src[r * stride + i]) : std::min(v, src[r * stride + i]);
+    }
+    buf[i] = v;
+  }
+  for (uint32_t i = 0; i < dst_width; i++) {
+    uint8_t v = buf[i];
+    for (uint32_t c = 1; c < kz; c++) {
+      v = is_max ? std::max(v, buf[i + c]) : std::min(v, buf[i + c]);
+    }
+    dst[i] = v;
+  }
+}
+#endif
+
 CVI_S32 CVI_IVE_OrdStatFilter(IVE_HANDLE *pIveHandle, IVE_SRC_IMAGE_S *pstSrc,
                               IVE_DST_IMAGE_S *pstDst,
                               IVE_ORD_STAT_FILTER_CTRL_S *pstOrdStatFltCtrl, bool bInstant) {
+  ScopedTrace t(__PRETTY_FUNCTION__);
   if (!IsValidImageType(pstSrc, STRFY(pstSrc), IVE_IMAGE_TYPE_U8C1)) {
     return CVI_FAILURE;
   }
@@ -2503,7 +4062,17 @@ CVI_S32 CVI_IVE_OrdStatFilter(IVE_HANDLE *pIveHandle, IVE_SRC_IMAGE_S *pstSrc,
     return CVI_FAILURE;
   }
 
-  const uint32_t kz = 3;
+  const IVE_ORD_STAT_FILTER_MODE_E enMode = pstOrdStatFltCtrl->enMode;
+  const uint32_t kz = pstOrdStatFltCtrl->u8KernelSize == 0 ? 3 : pstOrdStatFltCtrl->u8KernelSize;
+  if (enMode != IVE_ORD_STAT_FILTER_MODE_MAX && enMode != IVE_ORD_STAT_FILTER_MODE_MIN &&
+      enMode != IVE_ORD_STAT_FILTER_MODE_MEDIAN) {
+    LOGE("Unsupported enMode %d.\n", enMode);
+    return CVI_FAILURE;
+  }
+  if (kz % 2 == 0 || (enMode == IVE_ORD_STAT_FILTER_MODE_MEDIAN && kz != 3 && kz != 5)) {
+    LOGE("Unsupported kernel size %u, median supports 3 and 5, max and min any odd size.\n", kz);
+    return CVI_FAILURE;
+  }
   const uint32_t pad_sz = kz - 1;
   if ((pstDst->u32Width + pad_sz != pstSrc->u32Width) ||
       (pstDst->u32Height + pad_sz != pstSrc->u32Height)) {
@@ -2511,22 +4080,55 @@ CVI_S32 CVI_IVE_OrdStatFilter(IVE_HANDLE *pIveHandle, IVE_SRC_IMAGE_S *pstSrc,
          pad_sz);
     return CVI_FAILURE;
   }
-  IVE_HANDLE_CTX *handle_ctx = reinterpret_cast<IVE_HANDLE_CTX *>(pIveHandle);
-  CviImg *cpp_src = reinterpret_cast<CviImg *>(pstSrc->tpu_block);
-  CviImg *cpp_dst = reinterpret_cast<CviImg *>(pstDst->tpu_block);
-  std::vector<CviImg *> inputs = {cpp_src};
-  std::vector<CviImg *> outputs = {cpp_dst};
-  int ret = CVI_SUCCESS;
-  if (pstOrdStatFltCtrl->enMode == IVE_ORD_STAT_FILTER_MODE_MAX) {
-    handle_ctx->t_h.t_max.setKernelSize(kz);
-    handle_ctx->t_h.t_max.init(handle_ctx->rt_handle, handle_ctx->cvk_ctx);
-    ret |= handle_ctx->t_h.t_max.run(handle_ctx->rt_handle, handle_ctx->cvk_ctx, inputs, outputs);
-  } else if (pstOrdStatFltCtrl->enMode == IVE_ORD_STAT_FILTER_MODE_MIN) {
-    handle_ctx->t_h.t_min.setKernelSize(kz);
-    handle_ctx->t_h.t_min.init(handle_ctx->rt_handle, handle_ctx->cvk_ctx);
-    ret |= handle_ctx->t_h.t_min.run(handle_ctx->rt_handle, handle_ctx->cvk_ctx, inputs, outputs);
+  if (enMode != IVE_ORD_STAT_FILTER_MODE_MEDIAN && kz == 3) {
+    IVE_HANDLE_CTX *handle_ctx = reinterpret_cast<IVE_HANDLE_CTX *>(pIveHandle);
+    CviImg *cpp_src = reinterpret_cast<CviImg *>(pstSrc->tpu_block);
+    CviImg *cpp_dst = reinterpret_cast<CviImg *>(pstDst->tpu_block);
+    std::vector<CviImg *> inputs = {cpp_src};
+    std::vector<CviImg *> outputs = {cpp_dst};
+    int ret = CVI_SUCCESS;
+    if (enMode == IVE_ORD_STAT_FILTER_MODE_MAX) {
+      handle_ctx->t_h.t_max.setKernelSize(kz);
+      handle_ctx->t_h.t_max.init(handle_ctx->rt_handle, handle_ctx->cvk_ctx);
+      ret |=
+          handle_ctx->t_h.t_max.run(handle_ctx->rt_handle, handle_ctx->cvk_ctx, inputs, outputs);
+    } else {
+      handle_ctx->t_h.t_min.setKernelSize(kz);
+      handle_ctx->t_h.t_min.init(handle_ctx->rt_handle, handle_ctx->cvk_ctx);
+      ret |=
+          handle_ctx->t_h.t_min.run(handle_ctx->rt_handle, handle_ctx->cvk_ctx, inputs, outputs);
+    }
+    return ret;
   }
-  return ret;
+
+  // Median has no TPU counterpart and larger max/min windows are cheaper as two separable CPU
+  // passes than as one kz x kz pooling.
+  CVI_IVE_BufRequest(pIveHandle, pstSrc);
+  CVI_IVE_BufRequest(pIveHandle, pstDst);
+  const uint32_t dst_width = pstDst->u32Width;
+  auto filter_rows = [&](uint32_t row_begin, uint32_t row_end) {
+    std::vector<uint8_t> buf(std::max(3 * (dst_width + 2), kz * kz) + pad_sz);
+    for (uint32_t i = row_begin; i < row_end; i++) {
+      const uint8_t *src_row = pstSrc->pu8VirAddr[0] + i * pstSrc->u16Stride[0];
+      uint8_t *dst_row = pstDst->pu8VirAddr[0] + i * pstDst->u16Stride[0];
+#ifndef CV180X
+      if (enMode == IVE_ORD_STAT_FILTER_MODE_MEDIAN && kz == 3) {
+        neonU8Median3x3Row(src_row, pstSrc->u16Stride[0], buf.data(), dst_row, dst_width);
+      } else if (enMode == IVE_ORD_STAT_FILTER_MODE_MEDIAN) {
+        neonU8Median5x5Row(src_row, pstSrc->u16Stride[0], dst_row, dst_width);
+      } else if (enMode == IVE_ORD_STAT_FILTER_MODE_MAX) {
+        neonU8MaxMinRow<true>(src_row, pstSrc->u16Stride[0], buf.data(), dst_row, dst_width, kz);
+      } else {
+        neonU8MaxMinRow<false>(src_row, pstSrc->u16Stride[0], buf.data(), dst_row, dst_width, kz);
+      }
+#else
+      ord_stat_row(src_row, pstSrc->u16Stride[0], buf.data(), dst_row, dst_width, kz, enMode);
+#endif
+    }
+  };
+  parallelRows(pstDst->u32Height, dst_width * kz, filter_rows);
+  CVI_IVE_BufFlush(pIveHandle, pstDst);
+  return CVI_SUCCESS;
 }
 
 CVI_S32 CVI_IVE_Sigmoid(IVE_HANDLE pIveHandle, IVE_SRC_IMAGE_S *pstSrc, IVE_DST_IMAGE_S *pstDst,
@@ -2831,10 +4433,328 @@ CVI_S32 CVI_IVE_Thresh(IVE_HANDLE pIveHandle, IVE_SRC_IMAGE_S *pstSrc, IVE_DST_I
   return ret;
 }
 
-CVI_S32 CVI_IVE_Thresh_S16(IVE_HANDLE pIveHandle, IVE_SRC_IMAGE_S *pstSrc, IVE_DST_IMAGE_S *pstDst,
-                           IVE_THRESH_S16_CTRL_S *pstThrS16Ctrl, bool bInstant) {
-#ifndef CV180X
-  if (!IsValidImageType(pstSrc, STRFY(pstSrc), IVE_IMAGE_TYPE_S16C1)) {
+// Command buffer bytes reserved for one ROI plane, and the ROI pixels covered by that estimate.
+#define ROI_CMD_BYTES 4096
+#define ROI_CMD_PIXELS (64 * 1024)
+// In IVE_ROI_MODE_AUTO, ROIs up to this many pixels are cheaper on the CPU than a TPU run.
+#define ROI_CPU_MAX_PIXELS (32 * 32)
+
+static CVI_S32 check_roi_list(const IVE_ROI_LIST_S *pstRoiList, const IVE_IMAGE_S *pstImg) {
+  if (pstRoiList == NULL || (pstRoiList->u32Num != 0 && pstRoiList->pstRois == NULL)) {
+    LOGE("ROI list cannot be empty.\n");
+    return CVI_FAILURE;
+  }
+  if (pstRoiList->enMode >= IVE_ROI_MODE_BUTT) {
+    LOGE("Unsupported ROI mode %d.\n", pstRoiList->enMode);
+    return CVI_FAILURE;
+  }
+  for (CVI_U32 i = 0; i < pstRoiList->u32Num; i++) {
+    const IVE_ROI_S &roi = pstRoiList->pstRois[i];
+    if (roi.u16Width == 0 || roi.u16Height == 0 ||
+        (CVI_U32)roi.u16X + roi.u16Width > pstImg->u32Width ||
+        (CVI_U32)roi.u16Y + roi.u16Height > pstImg->u32Height) {
+      LOGE("ROI %u (%u, %u, %u, %u) is outside of the %ux%u image.\n", i, roi.u16X, roi.u16Y,
+           roi.u16Width, roi.u16Height, pstImg->u32Width, pstImg->u32Height);
+      return CVI_FAILURE;
+    }
+  }
+  return CVI_SUCCESS;
+}
+
+static bool is_same_size(const IVE_IMAGE_S *pstImg1, const IVE_IMAGE_S *pstImg2) {
+  return pstImg1->enType == pstImg2->enType && pstImg1->u32Width == pstImg2->u32Width &&
+         pstImg1->u32Height == pstImg2->u32Height;
+}
+
+static bool roi_on_cpu(const IVE_ROI_LIST_S *pstRoiList, const IVE_ROI_S &roi) {
+  return pstRoiList->enMode == IVE_ROI_MODE_CPU ||
+         (pstRoiList->enMode == IVE_ROI_MODE_AUTO &&
+          (uint32_t)roi.u16Width * roi.u16Height <= ROI_CPU_MAX_PIXELS);
+}
+
+static uint32_t roi_plane_num(const IVE_IMAGE_S *pstImg) {
+  return pstImg->enType == IVE_IMAGE_TYPE_U8C3_PLANAR ? 3 : 1;
+}
+
+// Runs core on every TPU ROI of every plane. The runs share one submission unless their commands
+// would not fit in the command buffer of the handle. Stops at the first failed run, the pending
+// runs are dropped then.
+static CVI_S32 run_tpu_rois(IVE_HANDLE_CTX *handle_ctx, IveCore *core,
+                            const std::vector<IVE_IMAGE_S *> &inputs,
+                            const std::vector<IVE_IMAGE_S *> &outputs,
+                            const IVE_ROI_LIST_S *pstRoiList) {
+  // One U8C1 view per plane, the ROI views are cut from them.
+  uint32_t plane_num = roi_plane_num(inputs[0]);
+  std::vector<IVE_IMAGE_S *> images = inputs;
+  images.insert(images.end(), outputs.begin(), outputs.end());
+  std::vector<std::unique_ptr<CviImg>> planes;
+  for (auto *img : images) {
+    for (uint32_t k = 0; k < plane_num; k++) {
+      std::vector<uint32_t> strides = {img->u16Stride[k]};
+      std::vector<uint32_t> heights = {img->u32Height};
+      std::vector<uint32_t> u32_length = {img->u16Stride[k] * img->u32Height};
+      planes.emplace_back(new CviImg(img->u32Height, img->u32Width, strides, heights, u32_length,
+                                     img->pu8VirAddr[k], img->u64PhyAddr[k], CVI_GRAY,
+                                     CVK_FMT_U8));
+    }
+  }
+
+  CVI_S32 ret = CVI_SUCCESS;
+  uint64_t cmd_bytes = 0;
+  core->set_defer_submit(true);
+  for (CVI_U32 i = 0; i < pstRoiList->u32Num; i++) {
+    const IVE_ROI_S &roi = pstRoiList->pstRois[i];
+    if (roi_on_cpu(pstRoiList, roi)) continue;
+    uint64_t roi_bytes =
+        ROI_CMD_BYTES * plane_num * (1 + (uint32_t)roi.u16Width * roi.u16Height / ROI_CMD_PIXELS);
+    if (cmd_bytes != 0 && cmd_bytes + roi_bytes > handle_ctx->cmdbuf_size) {
+      core->submitDeferred(handle_ctx->rt_handle, handle_ctx->cvk_ctx);
+      cmd_bytes = 0;
+    }
+    for (uint32_t k = 0; k < plane_num; k++) {
+      std::vector<std::unique_ptr<CviImg>> views;
+      std::vector<CviImg *> roi_inputs, roi_outputs;
+      for (size_t j = 0; j < images.size(); j++) {
+        views.emplace_back(new CviImg(handle_ctx->rt_handle, *planes[j * plane_num + k], roi.u16X,
+                                      roi.u16Y, roi.u16X + roi.u16Width,
+                                      roi.u16Y + roi.u16Height));
+        (j < inputs.size() ? roi_inputs : roi_outputs).push_back(views.back().get());
+      }
+      if (core->run(handle_ctx->rt_handle, handle_ctx->cvk_ctx, roi_inputs, roi_outputs) !=
+          CVI_SUCCESS) {
+        LOGE("Failed to run ROI %u.\n", i);
+        ret = CVI_FAILURE;
+        break;
+      }
+    }
+    if (ret != CVI_SUCCESS) break;
+    cmd_bytes += roi_bytes;
+  }
+  if (ret != CVI_SUCCESS) {
+    core->dropDeferred(handle_ctx->rt_handle);
+  } else if (cmd_bytes != 0) {
+    core->submitDeferred(handle_ctx->rt_handle, handle_ctx->cvk_ctx);
+  }
+  core->set_defer_submit(false);
+  return ret;
+}
+
+// Calls func(plane, roi) for the CPU ROIs after the caches of the images are refreshed.
+template <typename Func>
+static void run_cpu_rois(IVE_HANDLE pIveHandle, const std::vector<IVE_IMAGE_S *> &inputs,
+                         IVE_IMAGE_S *pstDst, const IVE_ROI_LIST_S *pstRoiList, Func func) {
+  bool has_cpu_roi = false;
+  for (CVI_U32 i = 0; i < pstRoiList->u32Num; i++) {
+    has_cpu_roi |= roi_on_cpu(pstRoiList, pstRoiList->pstRois[i]);
+  }
+  if (!has_cpu_roi) return;
+  for (auto *img : inputs) {
+    CVI_IVE_BufRequest(pIveHandle, img);
+  }
+  CVI_IVE_BufRequest(pIveHandle, pstDst);
+  for (CVI_U32 i = 0; i < pstRoiList->u32Num; i++) {
+    if (!roi_on_cpu(pstRoiList, pstRoiList->pstRois[i])) continue;
+    for (uint32_t k = 0; k < roi_plane_num(pstDst); k++) {
+      func(k, pstRoiList->pstRois[i]);
+    }
+  }
+  CVI_IVE_BufFlush(pIveHandle, pstDst);
+}
+
+CVI_S32 CVI_IVE_ThreshROIs(IVE_HANDLE pIveHandle, IVE_SRC_IMAGE_S *pstSrc,
+                           IVE_DST_IMAGE_S *pstDst, IVE_ROI_LIST_S *pstRoiList,
+                           IVE_THRESH_CTRL_S *ctrl, bool bInstant) {
+  ScopedTrace t(__PRETTY_FUNCTION__);
+  if (!IsValidImageType(pstSrc, STRFY(pstSrc), IVE_IMAGE_TYPE_U8C1, IVE_IMAGE_TYPE_U8C3_PLANAR)) {
+    return CVI_FAILURE;
+  }
+  if (!IsValidImageType(pstDst, STRFY(pstDst), IVE_IMAGE_TYPE_U8C1, IVE_IMAGE_TYPE_U8C3_PLANAR)) {
+    return CVI_FAILURE;
+  }
+  if (!is_same_size(pstSrc, pstDst)) {
+    LOGE("pstSrc & pstDst must have the same type and size.\n");
+    return CVI_FAILURE;
+  }
+  if (check_roi_list(pstRoiList, pstSrc) != CVI_SUCCESS) {
+    return CVI_FAILURE;
+  }
+  if (ctrl->enMode != IVE_THRESH_MODE_BINARY && ctrl->enMode != IVE_THRESH_MODE_SLOPE) {
+    LOGE("Unsupported threshold mode %u.\n", ctrl->enMode);
+    return CVI_FAILURE;
+  }
+
+  IVE_HANDLE_CTX *handle_ctx = reinterpret_cast<IVE_HANDLE_CTX *>(pIveHandle);
+  // The TPU threshold cannot be 0, every pixel passes it then so the ROIs are filled on the CPU.
+  IVE_ROI_LIST_S roi_list = *pstRoiList;
+  if (ctrl->enMode == IVE_THRESH_MODE_BINARY && ctrl->u8LowThr == 0) {
+    roi_list.enMode = IVE_ROI_MODE_CPU;
+  }
+  CVI_S32 ret = CVI_SUCCESS;
+  if (roi_list.enMode != IVE_ROI_MODE_CPU) {
+    IveCore *core = nullptr;
+    if (ctrl->enMode == IVE_THRESH_MODE_BINARY) {
+      if (ctrl->u8MinVal == 0 && ctrl->u8MaxVal == 255) {
+        handle_ctx->t_h.t_thresh.init(handle_ctx->rt_handle, handle_ctx->cvk_ctx);
+        handle_ctx->t_h.t_thresh.setThreshold(ctrl->u8LowThr);
+        core = &handle_ctx->t_h.t_thresh;
+      } else {
+        handle_ctx->t_h.t_thresh_hl.init(handle_ctx->rt_handle, handle_ctx->cvk_ctx);
+        handle_ctx->t_h.t_thresh_hl.setThreshold(ctrl->u8LowThr, ctrl->u8MinVal, ctrl->u8MaxVal);
+        core = &handle_ctx->t_h.t_thresh_hl;
+      }
+    } else {
+      handle_ctx->t_h.t_thresh_s.init(handle_ctx->rt_handle, handle_ctx->cvk_ctx);
+      handle_ctx->t_h.t_thresh_s.setThreshold(ctrl->u8LowThr, ctrl->u8MaxVal);
+      core = &handle_ctx->t_h.t_thresh_s;
+    }
+    ret = run_tpu_rois(handle_ctx, core, {pstSrc}, {pstDst}, &roi_list);
+  }
+
+  run_cpu_rois(pIveHandle, {pstSrc}, pstDst, &roi_list, [&](uint32_t k, const IVE_ROI_S &roi) {
+    for (uint32_t y = roi.u16Y; y < (uint32_t)roi.u16Y + roi.u16Height; y++) {
+      const uint8_t *src = pstSrc->pu8VirAddr[k] + y * pstSrc->u16Stride[k];
+      uint8_t *dst = pstDst->pu8VirAddr[k] + y * pstDst->u16Stride[k];
+      for (uint32_t x = roi.u16X; x < (uint32_t)roi.u16X + roi.u16Width; x++) {
+        if (ctrl->enMode == IVE_THRESH_MODE_BINARY) {
+          dst[x] = src[x] >= ctrl->u8LowThr ? ctrl->u8MaxVal : ctrl->u8MinVal;
+        } else {
+          dst[x] = std::min(std::max(src[x], ctrl->u8LowThr), ctrl->u8MaxVal);
+        }
+      }
+    }
+  });
+  return ret;
+}
+
+CVI_S32 CVI_IVE_BlendROIs(IVE_HANDLE pIveHandle, IVE_SRC_IMAGE_S *pstSrc1,
+                          IVE_SRC_IMAGE_S *pstSrc2, IVE_DST_IMAGE_S *pstDst,
+                          IVE_ROI_LIST_S *pstRoiList, IVE_BLEND_CTRL_S *pstBlendCtrl,
+                          bool bInstant) {
+  ScopedTrace t(__PRETTY_FUNCTION__);
+  if (!IsValidImageType(pstSrc1, STRFY(pstSrc1), IVE_IMAGE_TYPE_U8C1,
+                        IVE_IMAGE_TYPE_U8C3_PLANAR)) {
+    return CVI_FAILURE;
+  }
+  if (!IsValidImageType(pstSrc2, STRFY(pstSrc2), IVE_IMAGE_TYPE_U8C1,
+                        IVE_IMAGE_TYPE_U8C3_PLANAR)) {
+    return CVI_FAILURE;
+  }
+  if (!IsValidImageType(pstDst, STRFY(pstDst), IVE_IMAGE_TYPE_U8C1, IVE_IMAGE_TYPE_U8C3_PLANAR)) {
+    return CVI_FAILURE;
+  }
+  if (!is_same_size(pstSrc1, pstSrc2) || !is_same_size(pstSrc1, pstDst)) {
+    LOGE("source1/source2/dst image type or size do not match!\n");
+    return CVI_FAILURE;
+  }
+  if (check_roi_list(pstRoiList, pstSrc1) != CVI_SUCCESS) {
+    return CVI_FAILURE;
+  }
+
+  IVE_HANDLE_CTX *handle_ctx = reinterpret_cast<IVE_HANDLE_CTX *>(pIveHandle);
+  handle_ctx->t_h.t_blend.init(handle_ctx->rt_handle, handle_ctx->cvk_ctx);
+  handle_ctx->t_h.t_blend.setWeight(pstBlendCtrl->u8Weight);
+  CVI_S32 ret =
+      run_tpu_rois(handle_ctx, &handle_ctx->t_h.t_blend, {pstSrc1, pstSrc2}, {pstDst}, pstRoiList);
+
+  // Same rounding as the 8 bits right shift of the TPU mac.
+  uint32_t w1 = pstBlendCtrl->u8Weight, w2 = 255 - pstBlendCtrl->u8Weight;
+  run_cpu_rois(pIveHandle, {pstSrc1, pstSrc2}, pstDst, pstRoiList,
+               [&](uint32_t k, const IVE_ROI_S &roi) {
+                 for (uint32_t y = roi.u16Y; y < (uint32_t)roi.u16Y + roi.u16Height; y++) {
+                   const uint8_t *src1 = pstSrc1->pu8VirAddr[k] + y * pstSrc1->u16Stride[k];
+                   const uint8_t *src2 = pstSrc2->pu8VirAddr[k] + y * pstSrc2->u16Stride[k];
+                   uint8_t *dst = pstDst->pu8VirAddr[k] + y * pstDst->u16Stride[k];
+                   for (uint32_t x = roi.u16X; x < (uint32_t)roi.u16X + roi.u16Width; x++) {
+                     dst[x] = (src1[x] * w1 + src2[x] * w2 + 128) >> 8;
+                   }
+                 }
+               });
+  return ret;
+}
+
+// Requantizes a filter sum like the depthwise convolution of IveTPUFilter, a rounding doubling
+// high multiply followed by a rounding right shift, then clamps to U8 as the relu output does.
+static inline uint8_t filter_requantize(int32_t sum, uint32_t base, int shift) {
+  int64_t ab = (int64_t)sum * (int64_t)base;
+  int64_t nudge = ab >= 0 ? (1ll << 30) : (1 - (1ll << 30));
+  int32_t high = (int32_t)((ab + nudge) / (1ll << 31));
+  if (shift > 0) {
+    int32_t mask = (1 << shift) - 1;
+    int32_t remainder = high & mask;
+    int32_t threshold = (mask >> 1) + (high < 0 ? 1 : 0);
+    high = (high >> shift) + (remainder > threshold ? 1 : 0);
+  }
+  return high < 0 ? 0 : (high > 255 ? 255 : high);
+}
+
+CVI_S32 CVI_IVE_FilterROIs(IVE_HANDLE pIveHandle, IVE_SRC_IMAGE_S *pstSrc,
+                           IVE_DST_IMAGE_S *pstDst, IVE_ROI_LIST_S *pstRoiList,
+                           IVE_FILTER_CTRL_S *pstFltCtrl, bool bInstant) {
+  ScopedTrace t(__PRETTY_FUNCTION__);
+  if (!IsValidImageType(pstSrc, STRFY(pstSrc), IVE_IMAGE_TYPE_U8C1, IVE_IMAGE_TYPE_U8C3_PLANAR)) {
+    return CVI_FAILURE;
+  }
+  if (!IsValidImageType(pstDst, STRFY(pstDst), IVE_IMAGE_TYPE_U8C1, IVE_IMAGE_TYPE_U8C3_PLANAR)) {
+    return CVI_FAILURE;
+  }
+  if (!is_same_size(pstSrc, pstDst)) {
+    LOGE("pstSrc & pstDst must have the same type and size.\n");
+    return CVI_FAILURE;
+  }
+  if (check_roi_list(pstRoiList, pstSrc) != CVI_SUCCESS) {
+    return CVI_FAILURE;
+  }
+  if (pstFltCtrl->u8MaskSize != 3 && pstFltCtrl->u8MaskSize != 5 && pstFltCtrl->u8MaskSize != 13) {
+    LOGE("Currently Filter only supports filter size 3, 5, 13.\n");
+    return CVI_FAILURE;
+  }
+  if (pstFltCtrl->u32Norm == 0) {
+    LOGE("u32Norm cannot be 0.\n");
+    return CVI_FAILURE;
+  }
+  // ROIs smaller than the mask have no output pixel.
+  uint32_t size = pstFltCtrl->u8MaskSize;
+  std::vector<IVE_ROI_S> rois;
+  for (CVI_U32 i = 0; i < pstRoiList->u32Num; i++) {
+    if (pstRoiList->pstRois[i].u16Width >= size && pstRoiList->pstRois[i].u16Height >= size) {
+      rois.push_back(pstRoiList->pstRois[i]);
+    }
+  }
+  IVE_ROI_LIST_S roi_list = *pstRoiList;
+  roi_list.u32Num = rois.size();
+  roi_list.pstRois = rois.data();
+
+  IVE_HANDLE_CTX *handle_ctx = reinterpret_cast<IVE_HANDLE_CTX *>(pIveHandle);
+  handle_ctx->t_h.t_filter.init(handle_ctx->rt_handle, handle_ctx->cvk_ctx);
+  IveKernel kernel;
+  create_filter_kernel(handle_ctx, pstFltCtrl, &kernel);
+  handle_ctx->t_h.t_filter.setKernel(kernel);
+  CVI_S32 ret = run_tpu_rois(handle_ctx, &handle_ctx->t_h.t_filter, {pstSrc}, {pstDst}, &roi_list);
+  kernel.img.Free(handle_ctx->rt_handle);
+
+  uint32_t pad = size / 2;
+  run_cpu_rois(pIveHandle, {pstSrc}, pstDst, &roi_list, [&](uint32_t k, const IVE_ROI_S &roi) {
+    for (uint32_t y = roi.u16Y + pad; y < (uint32_t)roi.u16Y + roi.u16Height - pad; y++) {
+      uint8_t *dst = pstDst->pu8VirAddr[k] + y * pstDst->u16Stride[k];
+      for (uint32_t x = roi.u16X + pad; x < (uint32_t)roi.u16X + roi.u16Width - pad; x++) {
+        int32_t sum = 0;
+        for (uint32_t i = 0; i < size; i++) {
+          const uint8_t *src = pstSrc->pu8VirAddr[k] + (y - pad + i) * pstSrc->u16Stride[k];
+          for (uint32_t j = 0; j < size; j++) {
+            sum += src[x - pad + j] * pstFltCtrl->as8Mask[i * size + j];
+          }
+        }
+        dst[x] = filter_requantize(sum, kernel.multiplier.base, kernel.multiplier.shift);
+      }
+    }
+  });
+  return ret;
+}
+
+CVI_S32 CVI_IVE_Thresh_S16(IVE_HANDLE pIveHandle, IVE_SRC_IMAGE_S *pstSrc, IVE_DST_IMAGE_S *pstDst,
+                           IVE_THRESH_S16_CTRL_S *pstThrS16Ctrl, bool bInstant) {
+#ifndef CV180X
+  if (!IsValidImageType(pstSrc, STRFY(pstSrc), IVE_IMAGE_TYPE_S16C1)) {
     return CVI_FAILURE;
   }
 
@@ -3318,34 +5238,108 @@ CVI_S32 CVI_IVE_NCC(IVE_HANDLE pIveHandle, IVE_SRC_IMAGE_S *pstSrc1, IVE_SRC_IMA
   return CVI_SUCCESS;
 }
 
-inline void uint16_8bit(uint16_t *in, uint8_t *out, int dim) {
-  int i;
-
-  for (i = 0; i < dim; i++) {
-    // uint16_t n = in[i];  // because shifting the sign bit invokes UB
-    // uint8_t hi = ((n >> 8) & 0xff);
-    uint8_t lo = ((in[i] >> 0) & 0xff);
-    out[i] = lo;
+#ifdef CV180X
+static void convert_16bit_8bit_row(const uint8_t *src, uint8_t *dst, const uint32_t width,
+                                   const IVE_16BIT_TO_8BIT_CTRL_S *ctrl) {
+  const int32_t num = ctrl->u8Numerator;
+  const int32_t den = ctrl->u16Denominator;
+  for (uint32_t i = 0; i < width; i++) {
+    int32_t val = 0;
+    if (ctrl->enMode == IVE_16BIT_TO_8BIT_MODE_U16_TO_U8) {
+      val = ((const uint16_t *)src)[i] * num / den;
+    } else {
+      val = ((const int16_t *)src)[i] * num / den;
+    }
+    switch (ctrl->enMode) {
+      case IVE_16BIT_TO_8BIT_MODE_S16_TO_S8:
+        ((int8_t *)dst)[i] = val > 127 ? 127 : (val < -128 ? -128 : val);
+        continue;
+      case IVE_16BIT_TO_8BIT_MODE_S16_TO_U8_ABS:
+        val = std::abs(val);
+        break;
+      case IVE_16BIT_TO_8BIT_MODE_S16_TO_U8_BIAS:
+        val += ctrl->s8Bias;
+        break;
+      default:
+        break;
+    }
+    dst[i] = val > 255 ? 255 : (val < 0 ? 0 : val);
   }
 }
+#endif
 
 CVI_S32 CVI_IVE_16BitTo8Bit(IVE_HANDLE pIveHandle, IVE_SRC_IMAGE_S *pstSrc, IVE_DST_IMAGE_S *pstDst,
                             IVE_16BIT_TO_8BIT_CTRL_S *ctrl, bool bInstant) {
-  if (pstSrc->enType != IVE_IMAGE_TYPE_U16C1) {
-    LOGE("Input only accepts U16C1 image format.\n");
+  ScopedTrace t(__PRETTY_FUNCTION__);
+  switch (ctrl->enMode) {
+    case IVE_16BIT_TO_8BIT_MODE_S16_TO_S8:
+      if (!IsValidImageType(pstSrc, STRFY(pstSrc), IVE_IMAGE_TYPE_S16C1) ||
+          !IsValidImageType(pstDst, STRFY(pstDst), IVE_IMAGE_TYPE_S8C1)) {
+        return CVI_FAILURE;
+      }
+      break;
+    case IVE_16BIT_TO_8BIT_MODE_S16_TO_U8_ABS:
+    case IVE_16BIT_TO_8BIT_MODE_S16_TO_U8_BIAS:
+      if (!IsValidImageType(pstSrc, STRFY(pstSrc), IVE_IMAGE_TYPE_S16C1) ||
+          !IsValidImageType(pstDst, STRFY(pstDst), IVE_IMAGE_TYPE_U8C1)) {
+        return CVI_FAILURE;
+      }
+      break;
+    case IVE_16BIT_TO_8BIT_MODE_U16_TO_U8:
+      if (!IsValidImageType(pstSrc, STRFY(pstSrc), IVE_IMAGE_TYPE_U16C1) ||
+          !IsValidImageType(pstDst, STRFY(pstDst), IVE_IMAGE_TYPE_U8C1)) {
+        return CVI_FAILURE;
+      }
+      break;
+    default:
+      LOGE("Unsupported 16bit to 8bit mode %d.\n", ctrl->enMode);
+      return CVI_FAILURE;
+  }
+  if (ctrl->u16Denominator == 0 || ctrl->u8Numerator > ctrl->u16Denominator) {
+    LOGE("Invalid scale %u / %u, denominator must be non-zero and not less than numerator.\n",
+         ctrl->u8Numerator, ctrl->u16Denominator);
     return CVI_FAILURE;
   }
-  if (pstDst->enType != IVE_IMAGE_TYPE_U8C1) {
-    LOGE("Output only accepts U8C1 image format.\n");
+  if (pstSrc->u32Width != pstDst->u32Width || pstSrc->u32Height != pstDst->u32Height) {
+    LOGE("Input and output size mismatch. %ux%u vs %ux%u.\n", pstSrc->u32Width,
+         pstSrc->u32Height, pstDst->u32Width, pstDst->u32Height);
     return CVI_FAILURE;
   }
   CVI_IVE_BufRequest(pIveHandle, pstSrc);
   CVI_IVE_BufRequest(pIveHandle, pstDst);
 
-  int wxh = ((int)pstSrc->u16Stride[0] / 2 * (int)pstSrc->u32Height);
-  uint16_8bit((uint16_t *)pstSrc->pu8VirAddr[0], (uint8_t *)pstDst->pu8VirAddr[0], wxh);
+  // Only the valid width of each row is converted, the stride padding is left untouched.
+  const uint32_t width = pstSrc->u32Width;
+  auto convert_rows = [=](uint32_t row_begin, uint32_t row_end) {
+    for (uint32_t i = row_begin; i < row_end; i++) {
+      uint8_t *src_row = pstSrc->pu8VirAddr[0] + i * pstSrc->u16Stride[0];
+      uint8_t *dst_row = pstDst->pu8VirAddr[0] + i * pstDst->u16Stride[0];
+#ifndef CV180X
+      switch (ctrl->enMode) {
+        case IVE_16BIT_TO_8BIT_MODE_S16_TO_S8:
+          neonS162S8Scale((int16_t *)src_row, (int8_t *)dst_row, width, ctrl->u8Numerator,
+                          ctrl->u16Denominator);
+          break;
+        case IVE_16BIT_TO_8BIT_MODE_S16_TO_U8_ABS:
+          neonS162U8AbsScale((int16_t *)src_row, dst_row, width, ctrl->u8Numerator,
+                             ctrl->u16Denominator);
+          break;
+        case IVE_16BIT_TO_8BIT_MODE_S16_TO_U8_BIAS:
+          neonS162U8BiasScale((int16_t *)src_row, dst_row, width, ctrl->u8Numerator,
+                              ctrl->u16Denominator, ctrl->s8Bias);
+          break;
+        default:
+          neonU162U8Scale((uint16_t *)src_row, dst_row, width, ctrl->u8Numerator,
+                          ctrl->u16Denominator);
+          break;
+      }
+#else
+      convert_16bit_8bit_row(src_row, dst_row, width, ctrl);
+#endif
+    }
+  };
+  parallelRows(pstSrc->u32Height, width, convert_rows);
 
-  CVI_IVE_BufFlush(pIveHandle, pstSrc);
   CVI_IVE_BufFlush(pIveHandle, pstDst);
   return CVI_SUCCESS;
 }
@@ -3884,114 +5878,2848 @@ CVI_S32 CVI_IVE_Zero(IVE_HANDLE pIveHandle, IVE_DST_IMAGE_S *pstDst) {
   return ret;
 }
 
-CVI_S32 VideoFrameYInfo2Image(VIDEO_FRAME_INFO_S *pstVFISrc, IVE_IMAGE_S *pstIIDst) {
-  CviImg *cpp_img = nullptr;
-  if (pstIIDst->tpu_block != NULL) {
-    cpp_img = reinterpret_cast<CviImg *>(pstIIDst->tpu_block);
-    if (!cpp_img->IsNullMem()) {
-      LOGE("pstIIDst->tpu_block->m_rtmem is not NULL");
-      return CVI_FAILURE;
-    }
-    if (cpp_img->GetMagicNum() != CVI_IMG_VIDEO_FRM_MAGIC_NUM) {
-      printf("pstIIDst->tpu_block is not constructed from VIDEO_FRAME_INFO_S");
-      return CVI_FAILURE;
-    }
-  }
-  VIDEO_FRAME_S *pstVFSrc = &pstVFISrc->stVFrame;
-  size_t c = 1;
-  CVIIMGTYPE img_type = CVIIMGTYPE::CVI_GRAY;
-  cvk_fmt_t fmt = CVK_FMT_U8;
-  std::vector<uint32_t> heights;
-  switch (pstVFSrc->enPixelFormat) {
-    case PIXEL_FORMAT_YUV_400:
-    case PIXEL_FORMAT_NV21:
-    case PIXEL_FORMAT_NV12:
-    case PIXEL_FORMAT_YUV_PLANAR_420: {
-      pstIIDst->enType = IVE_IMAGE_TYPE_U8C1;
-      heights.push_back(pstVFSrc->u32Height);
-    } break;
-    default: {
-      LOGE("Unsupported conversion type: %u.\n", pstVFSrc->enPixelFormat);
-      return CVI_FAILURE;
-    } break;
-  }
-  std::vector<uint32_t> strides, u32_length;
-  for (size_t i = 0; i < c; i++) {
-    strides.push_back(pstVFSrc->u32Stride[i]);
-    u32_length.push_back(pstVFSrc->u32Length[i]);
-  }
-  if (cpp_img == nullptr) {
-    cpp_img = new CviImg(pstVFSrc->u32Height, pstVFSrc->u32Width, strides, heights, u32_length,
-                         pstVFSrc->pu8VirAddr[0], pstVFSrc->u64PhyAddr[0], img_type, fmt);
-  } else {
-    cpp_img->ReInit(pstVFSrc->u32Height, pstVFSrc->u32Width, strides, heights, u32_length,
-                    pstVFSrc->pu8VirAddr[0], pstVFSrc->u64PhyAddr[0], img_type, fmt);
-  }
-
-  if (!cpp_img->IsInit()) {
-    LOGE("Failed to init IVE_IMAGE_S.\n");
-    return CVI_FAILURE;
-  }
-
-  pstIIDst->tpu_block = reinterpret_cast<CVI_IMG *>(cpp_img);
-  pstIIDst->u32Width = cpp_img->GetImgWidth();
-  pstIIDst->u32Height = cpp_img->GetImgHeight();
-  pstIIDst->u16Reserved = getFmtSize(fmt);
-
-  size_t i_limit = cpp_img->GetImgChannel();
-  for (size_t i = 0; i < i_limit; i++) {
-    pstIIDst->pu8VirAddr[i] = cpp_img->GetVAddr() + cpp_img->GetImgCOffsets()[i];
-    pstIIDst->u64PhyAddr[i] = cpp_img->GetPAddr() + cpp_img->GetImgCOffsets()[i];
-    pstIIDst->u16Stride[i] = cpp_img->GetImgStrides()[i];
-  }
-
-  for (size_t i = i_limit; i < 3; i++) {
-    pstIIDst->pu8VirAddr[i] = NULL;
-    pstIIDst->u64PhyAddr[i] = 0;
-    pstIIDst->u16Stride[i] = 0;
-  }
-  return CVI_SUCCESS;
-}
-
 CVI_S32 CVI_IVE_Blend_Pixel_Y(IVE_HANDLE pIveHandle, VIDEO_FRAME_INFO_S *pstSrc1,
                               VIDEO_FRAME_INFO_S *pstSrc2_dst, VIDEO_FRAME_INFO_S *pstAlpha) {
+  IVE_HANDLE_CTX *handle_ctx = reinterpret_cast<IVE_HANDLE_CTX *>(pIveHandle);
   IVE_IMAGE_S src1, src2, alpha, dst;
   memset(&src1, 0, sizeof(IVE_IMAGE_S));
   memset(&src2, 0, sizeof(IVE_IMAGE_S));
   memset(&alpha, 0, sizeof(IVE_IMAGE_S));
   memset(&dst, 0, sizeof(IVE_IMAGE_S));
 
-  CVI_S32 ret = CVI_SUCCESS;
-  ret = VideoFrameYInfo2Image(pstSrc1, &src1);
+  // The Y planes are wrapped by the handle, recurring frames reuse their wrappers.
+  CVI_S32 ret = acquire_video_frame(handle_ctx, pstSrc1, true, &src1);
   if (ret != CVI_SUCCESS) {
     LOGE("pstSrc1 type not supported,could not extract Y plane");
-    return ret;
   }
-
-  ret = VideoFrameYInfo2Image(pstSrc2_dst, &src2);
-  if (ret != CVI_SUCCESS) {
-    LOGE("pstSrc2_dst type not supported,could not extract Y plane");
-    return ret;
+  if (ret == CVI_SUCCESS) {
+    ret = acquire_video_frame(handle_ctx, pstSrc2_dst, true, &src2);
+    if (ret != CVI_SUCCESS) {
+      LOGE("pstSrc2_dst type not supported,could not extract Y plane");
+    }
   }
-
-  ret = VideoFrameYInfo2Image(pstAlpha, &alpha);
-  if (ret != CVI_SUCCESS) {
-    LOGE("pstAlpha type not supported,could not extract Y plane");
-    return ret;
+  if (ret == CVI_SUCCESS) {
+    ret = acquire_video_frame(handle_ctx, pstAlpha, true, &alpha);
+    if (ret != CVI_SUCCESS) {
+      LOGE("pstAlpha type not supported,could not extract Y plane");
+    }
   }
-
-  ret = VideoFrameYInfo2Image(pstSrc2_dst, &dst);
-  if (ret != CVI_SUCCESS) {
-    LOGE("pstSrc2 type not supported,could not extract Y plane");
-    return ret;
+  if (ret == CVI_SUCCESS) {
+    dst = src2;
+    ret = CVI_IVE_Blend_Pixel(pIveHandle, &src1, &src2, &alpha, &dst, true);
   }
 
-  CVI_IVE_Blend_Pixel(pIveHandle, &src1, &src2, &alpha, &dst, true);
-
   CVI_SYS_FreeI(pIveHandle, &src1);
   CVI_SYS_FreeI(pIveHandle, &src2);
   CVI_SYS_FreeI(pIveHandle, &alpha);
-  CVI_SYS_FreeI(pIveHandle, &dst);
   return ret;
 }
 #endif
+
+CVI_S32 CVI_IVE_CreateBGModel(IVE_HANDLE pIveHandle, IVE_BG_MODEL_S *pstModel,
+                              IVE_BG_MODEL_TYPE_E enType, CVI_U32 u32Width, CVI_U32 u32Height) {
+  ScopedTrace t(__PRETTY_FUNCTION__);
+  CVI_S32 ret = CVI_FAILURE;
+  switch (enType) {
+    case IVE_BG_MODEL_TYPE_RUNNING_AVG:
+      ret = CVI_IVE_CreateImage(pIveHandle, &pstModel->stModel, IVE_IMAGE_TYPE_U16C1, u32Width,
+                                u32Height);
+      break;
+    case IVE_BG_MODEL_TYPE_GMM:
+      ret = CVI_IVE_CreateImage(pIveHandle, &pstModel->stModel, IVE_IMAGE_TYPE_FP32C1, u32Width,
+                                u32Height * 3 * IVE_BG_MODEL_GMM_NUM);
+      break;
+    default:
+      LOGE("Unsupported background model type %d.\n", enType);
+      return CVI_FAILURE;
+  }
+  if (ret != CVI_SUCCESS) {
+    LOGE("Failed to allocate background model.\n");
+    return CVI_FAILURE;
+  }
+  pstModel->enType = enType;
+  pstModel->u32FrameNum = 0;
+  return CVI_SUCCESS;
+}
+
+static bool is_valid_bg_model(const IVE_BG_MODEL_S *pstModel, const CVI_U32 u32Width,
+                              const CVI_U32 u32Height) {
+  const IVE_IMAGE_S &model = pstModel->stModel;
+  if (pstModel->enType == IVE_BG_MODEL_TYPE_RUNNING_AVG) {
+    return model.enType == IVE_IMAGE_TYPE_U16C1 && model.u32Width == u32Width &&
+           model.u32Height == u32Height;
+  }
+  if (pstModel->enType == IVE_BG_MODEL_TYPE_GMM) {
+    return model.enType == IVE_IMAGE_TYPE_FP32C1 && model.u32Width == u32Width &&
+           model.u32Height == u32Height * 3 * IVE_BG_MODEL_GMM_NUM;
+  }
+  return false;
+}
+
+// Row pointers of the weight, mean and variance planes of every GMM mode.
+struct GMMRow {
+  float *w[IVE_BG_MODEL_GMM_NUM];
+  float *m[IVE_BG_MODEL_GMM_NUM];
+  float *v[IVE_BG_MODEL_GMM_NUM];
+
+  GMMRow(const IVE_IMAGE_S &model, const uint32_t height, const uint32_t row) {
+    for (uint32_t k = 0; k < IVE_BG_MODEL_GMM_NUM; k++) {
+      w[k] = gmm_plane_row(model, height, k * 3, row);
+      m[k] = gmm_plane_row(model, height, k * 3 + 1, row);
+      v[k] = gmm_plane_row(model, height, k * 3 + 2, row);
+    }
+  }
+
+  static float *gmm_plane_row(const IVE_IMAGE_S &model, const uint32_t height,
+                              const uint32_t plane, const uint32_t row) {
+    return (float *)(model.pu8VirAddr[0] + (plane * height + row) * model.u16Stride[0]);
+  }
+};
+
+// Stauffer-Grimson update of the modes of one pixel, kept sorted by decreasing weight. Returns
+// true if x is foreground.
+static inline bool gmm_update_pixel(const GMMRow &row, const uint32_t j, const float x,
+                                    const float rate, const float sigma_thr2,
+                                    const float bg_ratio, const float init_var) {
+  const int num = IVE_BG_MODEL_GMM_NUM;
+  float w[num], m[num], v[num];
+  for (int k = 0; k < num; k++) {
+    w[k] = row.w[k][j];
+    m[k] = row.m[k][j];
+    v[k] = row.v[k][j];
+  }
+  int matched = -1;
+  float weight_before = 0.f;
+  for (int k = 0; k < num && w[k] > 0.f; k++) {
+    float d = x - m[k];
+    if (d * d < sigma_thr2 * v[k]) {
+      matched = k;
+      break;
+    }
+    weight_before += w[k];
+  }
+  // The heaviest modes up to a total weight of bg_ratio are the background.
+  bool is_fg = matched < 0 || weight_before > bg_ratio;
+
+  for (int k = 0; k < num; k++) {
+    w[k] *= 1.f - rate;
+  }
+  int updated = matched;
+  if (matched >= 0) {
+    w[matched] += rate;
+    float rho = std::min(rate / w[matched], 1.f);
+    float d = x - m[matched];
+    m[matched] += rho * d;
+    v[matched] = std::max(v[matched] + rho * (d * d - v[matched]), init_var);
+  } else {
+    // Replace the lightest mode.
+    updated = num - 1;
+    w[updated] = rate;
+    m[updated] = x;
+    v[updated] = init_var;
+    float sum = 0.f;
+    for (int k = 0; k < num; k++) {
+      sum += w[k];
+    }
+    for (int k = 0; k < num; k++) {
+      w[k] /= sum;
+    }
+  }
+  for (int k = updated; k > 0 && w[k] > w[k - 1]; k--) {
+    std::swap(w[k], w[k - 1]);
+    std::swap(m[k], m[k - 1]);
+    std::swap(v[k], v[k - 1]);
+  }
+  for (int k = 0; k < num; k++) {
+    row.w[k][j] = w[k];
+    row.m[k][j] = m[k];
+    row.v[k][j] = v[k];
+  }
+  return is_fg;
+}
+
+CVI_S32 CVI_IVE_BGModel(IVE_HANDLE pIveHandle, IVE_SRC_IMAGE_S *pstSrc, IVE_DST_IMAGE_S *pstFg,
+                        IVE_BG_MODEL_S *pstModel, IVE_BG_MODEL_CTRL_S *pstCtrl, bool bInstant) {
+  ScopedTrace t(__PRETTY_FUNCTION__);
+  if (!IsValidImageType(pstSrc, STRFY(pstSrc), IVE_IMAGE_TYPE_U8C1)) {
+    return CVI_FAILURE;
+  }
+  if (!IsValidImageType(pstFg, STRFY(pstFg), IVE_IMAGE_TYPE_U8C1)) {
+    return CVI_FAILURE;
+  }
+  if (pstSrc->u32Width != pstFg->u32Width || pstSrc->u32Height != pstFg->u32Height) {
+    LOGE("pstSrc and pstFg must have the same size.\n");
+    return CVI_FAILURE;
+  }
+  if (!is_valid_bg_model(pstModel, pstSrc->u32Width, pstSrc->u32Height)) {
+    LOGE("Background model does not match the %u x %u frame.\n", pstSrc->u32Width,
+         pstSrc->u32Height);
+    return CVI_FAILURE;
+  }
+  if (pstCtrl->f32LearnRate < 0.f || pstCtrl->f32LearnRate > 1.f) {
+    LOGE("Learning rate %f is not in [0, 1].\n", pstCtrl->f32LearnRate);
+    return CVI_FAILURE;
+  }
+  if (pstModel->enType == IVE_BG_MODEL_TYPE_GMM &&
+      (pstCtrl->f32SigmaThr <= 0.f || pstCtrl->f32InitVar <= 0.f)) {
+    LOGE("f32SigmaThr and f32InitVar must be positive.\n");
+    return CVI_FAILURE;
+  }
+
+  // The first frames are averaged evenly so the model converges quickly.
+  const bool is_first = pstModel->u32FrameNum == 0;
+  const float rate = std::max(pstCtrl->f32LearnRate, 1.f / (pstModel->u32FrameNum + 1));
+  const uint32_t width = pstSrc->u32Width, height = pstSrc->u32Height;
+  const IVE_IMAGE_S &model = pstModel->stModel;
+  CVI_IVE_BufRequest(pIveHandle, pstSrc);
+  if (pstModel->enType == IVE_BG_MODEL_TYPE_RUNNING_AVG) {
+    const int32_t rate_q15 = std::min((int32_t)std::lround(rate * 32768.f), 32767);
+    const uint8_t thr = pstCtrl->u8DiffThr;
+    auto update_rows = [&](uint32_t row_begin, uint32_t row_end) {
+      for (uint32_t i = row_begin; i < row_end; i++) {
+        const uint8_t *src_row = pstSrc->pu8VirAddr[0] + i * pstSrc->u16Stride[0];
+        uint16_t *bg_row = (uint16_t *)(model.pu8VirAddr[0] + i * model.u16Stride[0]);
+        uint8_t *fg_row = pstFg->pu8VirAddr[0] + i * pstFg->u16Stride[0];
+        if (is_first) {
+          for (uint32_t j = 0; j < width; j++) {
+            bg_row[j] = src_row[j] << 8;
+          }
+          memset(fg_row, 0, width);
+          continue;
+        }
+#ifndef CV180X
+        neonU8RunningAvgRow(src_row, bg_row, fg_row, width, rate_q15, thr);
+#else
+        for (uint32_t j = 0; j < width; j++) {
+          int32_t bg = bg_row[j];
+          fg_row[j] = std::abs(src_row[j] - ((bg + 128) >> 8)) > thr ? 255 : 0;
+          bg_row[j] = bg + (((((int32_t)src_row[j] << 8) - bg) * rate_q15 + (1 << 14)) >> 15);
+        }
+#endif
+      }
+    };
+    parallelRows(height, width, update_rows);
+  } else {
+    const float sigma_thr2 = pstCtrl->f32SigmaThr * pstCtrl->f32SigmaThr;
+    const float bg_ratio = pstCtrl->f32BgRatio, init_var = pstCtrl->f32InitVar;
+    auto update_rows = [&](uint32_t row_begin, uint32_t row_end) {
+      for (uint32_t i = row_begin; i < row_end; i++) {
+        const uint8_t *src_row = pstSrc->pu8VirAddr[0] + i * pstSrc->u16Stride[0];
+        uint8_t *fg_row = pstFg->pu8VirAddr[0] + i * pstFg->u16Stride[0];
+        GMMRow row(model, height, i);
+        if (is_first) {
+          for (uint32_t k = 0; k < IVE_BG_MODEL_GMM_NUM; k++) {
+            for (uint32_t j = 0; j < width; j++) {
+              row.w[k][j] = k == 0 ? 1.f : 0.f;
+              row.m[k][j] = k == 0 ? src_row[j] : 0.f;
+              row.v[k][j] = init_var;
+            }
+          }
+          memset(fg_row, 0, width);
+          continue;
+        }
+        for (uint32_t j = 0; j < width; j++) {
+          bool is_fg =
+              gmm_update_pixel(row, j, src_row[j], rate, sigma_thr2, bg_ratio, init_var);
+          fg_row[j] = is_fg ? 255 : 0;
+        }
+      }
+    };
+    parallelRows(height, width * IVE_BG_MODEL_GMM_NUM, update_rows);
+  }
+  pstModel->u32FrameNum++;
+  CVI_IVE_BufFlush(pIveHandle, pstFg);
+  return CVI_SUCCESS;
+}
+
+CVI_S32 CVI_IVE_GetBGImage(IVE_HANDLE pIveHandle, IVE_BG_MODEL_S *pstModel,
+                           IVE_DST_IMAGE_S *pstDst) {
+  ScopedTrace t(__PRETTY_FUNCTION__);
+  if (!IsValidImageType(pstDst, STRFY(pstDst), IVE_IMAGE_TYPE_U8C1)) {
+    return CVI_FAILURE;
+  }
+  if (!is_valid_bg_model(pstModel, pstDst->u32Width, pstDst->u32Height)) {
+    LOGE("Background model does not match the %u x %u image.\n", pstDst->u32Width,
+         pstDst->u32Height);
+    return CVI_FAILURE;
+  }
+  const IVE_IMAGE_S &model = pstModel->stModel;
+  for (uint32_t i = 0; i < pstDst->u32Height; i++) {
+    uint8_t *dst_row = pstDst->pu8VirAddr[0] + i * pstDst->u16Stride[0];
+    if (pstModel->enType == IVE_BG_MODEL_TYPE_RUNNING_AVG) {
+      const uint16_t *bg_row = (const uint16_t *)(model.pu8VirAddr[0] + i * model.u16Stride[0]);
+      for (uint32_t j = 0; j < pstDst->u32Width; j++) {
+        dst_row[j] = (bg_row[j] + 128) >> 8;
+      }
+    } else {
+      GMMRow row(model, pstDst->u32Height, i);
+      for (uint32_t j = 0; j < pstDst->u32Width; j++) {
+        dst_row[j] = std::min(std::max(std::lround(row.m[0][j]), 0l), 255l);
+      }
+    }
+  }
+  CVI_IVE_BufFlush(pIveHandle, pstDst);
+  return CVI_SUCCESS;
+}
+
+#define LK_MAX_LEVEL 4
+#define LK_LANES 4
+
+// One pyramid level of CVI_IVE_LKOpticalFlow. Level 0 borrows the input frames.
+struct LKLevel {
+  IVE_IMAGE_S prev;
+  IVE_IMAGE_S next;
+  IVE_IMAGE_S grad_x;          // 8 times the x derivative of prev.
+  IVE_IMAGE_S grad_y;          // 8 times the y derivative of prev.
+  std::vector<int64_t> integ;  // Integral images of IxIx, IxIy and IyIy, interleaved.
+};
+
+// 2x2 average of src, dst is half of src rounded down.
+static void lk_pyr_down(const IVE_IMAGE_S *src, IVE_IMAGE_S *dst) {
+  auto down_rows = [=](uint32_t row_begin, uint32_t row_end) {
+    for (uint32_t i = row_begin; i < row_end; i++) {
+      const uint8_t *src_row0 = src->pu8VirAddr[0] + 2 * i * src->u16Stride[0];
+      const uint8_t *src_row1 = src_row0 + src->u16Stride[0];
+      uint8_t *dst_row = dst->pu8VirAddr[0] + i * dst->u16Stride[0];
+      for (uint32_t j = 0; j < dst->u32Width; j++) {
+        dst_row[j] = (src_row0[2 * j] + src_row0[2 * j + 1] + src_row1[2 * j] +
+                      src_row1[2 * j + 1] + 2) >> 2;
+      }
+    }
+  };
+  parallelRows(dst->u32Height, dst->u32Width, down_rows);
+}
+
+// Gradient products and their row prefix sums are computed row parallel, then the rows are
+// accumulated over column blocks in parallel.
+static void lk_build_integral(LKLevel *level) {
+  const uint32_t width = level->prev.u32Width, height = level->prev.u32Height;
+  const uint32_t integ_w = width + 1;
+  level->integ.assign((size_t)integ_w * (height + 1) * 3, 0);
+  int64_t *integ = level->integ.data();
+  const IVE_IMAGE_S *grad_x = &level->grad_x, *grad_y = &level->grad_y;
+  auto product_rows = [=](uint32_t row_begin, uint32_t row_end) {
+    for (uint32_t i = row_begin; i < row_end; i++) {
+      const uint16_t *gx_row = (const uint16_t *)(grad_x->pu8VirAddr[0] + i * grad_x->u16Stride[0]);
+      const uint16_t *gy_row = (const uint16_t *)(grad_y->pu8VirAddr[0] + i * grad_y->u16Stride[0]);
+      int64_t *dst = integ + ((size_t)(i + 1) * integ_w + 1) * 3;
+      int64_t sum_xx = 0, sum_xy = 0, sum_yy = 0;
+      for (uint32_t j = 0; j < width; j++) {
+        int32_t ix = std::lround(convert_bf16_fp32(gx_row[j]));
+        int32_t iy = std::lround(convert_bf16_fp32(gy_row[j]));
+        sum_xx += ix * ix;
+        sum_xy += ix * iy;
+        sum_yy += iy * iy;
+        dst[j * 3] = sum_xx;
+        dst[j * 3 + 1] = sum_xy;
+        dst[j * 3 + 2] = sum_yy;
+      }
+    }
+  };
+  parallelRows(height, width, product_rows);
+
+  const uint32_t block = 64;
+  auto accumulate_blocks = [=](uint32_t block_begin, uint32_t block_end) {
+    const size_t col_begin = (size_t)block_begin * block * 3;
+    const size_t col_end = (size_t)std::min(block_end * block, integ_w) * 3;
+    for (uint32_t i = 2; i <= height; i++) {
+      int64_t *row = integ + (size_t)i * integ_w * 3;
+      const int64_t *row_above = row - integ_w * 3;
+      for (size_t c = col_begin; c < col_end; c++) {
+        row[c] += row_above[c];
+      }
+    }
+  };
+  parallelRows((integ_w + block - 1) / block, (uint64_t)block * height, accumulate_blocks);
+}
+
+// Tracks up to LK_LANES points from the top pyramid level down, one point per SIMD lane. patch
+// needs win * win * 3 * LK_LANES floats.
+static void lk_track_lanes(const std::vector<LKLevel> &levels, const IVE_LK_POINT_S *prev_pts,
+                           IVE_LK_POINT_S *next_pts, CVI_U8 *status, CVI_FLOAT *err,
+                           const uint32_t num, const IVE_LK_OPTICAL_FLOW_CTRL_S *ctrl,
+                           float *patch) {
+  const int win = ctrl->u8WinSize, half = win / 2;
+  const float area = win * win;
+  const float eps2 = ctrl->f32Eps * ctrl->f32Eps;
+  float guess_x[LK_LANES] = {0}, guess_y[LK_LANES] = {0};
+  float flow_x[LK_LANES] = {0}, flow_y[LK_LANES] = {0};
+  float mean_err[LK_LANES] = {0};
+  bool lost[LK_LANES];
+  for (uint32_t l = 0; l < LK_LANES; l++) {
+    lost[l] = l >= num;
+  }
+
+  for (int lv = (int)levels.size() - 1; lv >= 0; lv--) {
+    const LKLevel &level = levels[lv];
+    const int width = level.prev.u32Width, height = level.prev.u32Height;
+    const float scale = 1.f / (1 << lv);
+    int anchor_x[LK_LANES], anchor_y[LK_LANES];
+    float inv_g[LK_LANES][3];
+    bool active[LK_LANES];
+    for (uint32_t l = 0; l < LK_LANES; l++) {
+      active[l] = false;
+      flow_x[l] = flow_y[l] = 0.f;
+      bool outside = false;
+      if (!lost[l]) {
+        // The window is anchored on the nearest pixel and assumed to move like the point.
+        anchor_x[l] = std::lround(prev_pts[l].f32X * scale);
+        anchor_y[l] = std::lround(prev_pts[l].f32Y * scale);
+        outside = anchor_x[l] - half < 1 || anchor_x[l] + half > width - 2 ||
+                  anchor_y[l] - half < 1 || anchor_y[l] + half > height - 2;
+        // A coarse level whose window leaves the image is skipped and the guess passes down
+        // unchanged, only the full resolution window decides whether the point is lost.
+        lost[l] = outside && lv == 0;
+      }
+      if (lost[l] || outside) {
+        for (int k = 0; k < win * win * 3; k++) {
+          patch[k * LK_LANES + l] = 0.f;
+        }
+        continue;
+      }
+      const int x0 = anchor_x[l] - half, y0 = anchor_y[l] - half;
+      for (int i = 0; i < win; i++) {
+        const uint8_t *prev_row = level.prev.pu8VirAddr[0] + (y0 + i) * level.prev.u16Stride[0];
+        const uint16_t *gx_row =
+            (const uint16_t *)(level.grad_x.pu8VirAddr[0] + (y0 + i) * level.grad_x.u16Stride[0]);
+        const uint16_t *gy_row =
+            (const uint16_t *)(level.grad_y.pu8VirAddr[0] + (y0 + i) * level.grad_y.u16Stride[0]);
+        for (int j = 0; j < win; j++) {
+          float *dst = patch + (i * win + j) * 3 * LK_LANES + l;
+          dst[0] = prev_row[x0 + j];
+          dst[LK_LANES] = convert_bf16_fp32(gx_row[x0 + j]) * 0.125f;
+          dst[2 * LK_LANES] = convert_bf16_fp32(gy_row[x0 + j]) * 0.125f;
+        }
+      }
+      // Gradient matrix from the integral images, the 1 / 64 removes the Sobel scale.
+      const size_t integ_w = width + 1;
+      const int64_t *top = level.integ.data() + ((size_t)y0 * integ_w + x0) * 3;
+      const int64_t *bottom = top + win * integ_w * 3;
+      float g[3];
+      for (int c = 0; c < 3; c++) {
+        g[c] = (bottom[win * 3 + c] - bottom[c] - top[win * 3 + c] + top[c]) / 64.f;
+      }
+      float det = g[0] * g[2] - g[1] * g[1];
+      float min_eig =
+          (g[0] + g[2] - std::sqrt((g[0] - g[2]) * (g[0] - g[2]) + 4 * g[1] * g[1])) / 2;
+      if (min_eig / area < ctrl->f32MinEigThr || det < std::numeric_limits<float>::epsilon()) {
+        lost[l] = lv == 0;
+        continue;
+      }
+      inv_g[l][0] = g[2] / det;
+      inv_g[l][1] = -g[1] / det;
+      inv_g[l][2] = g[0] / det;
+      active[l] = true;
+    }
+
+    const uint8_t *next_data = level.next.pu8VirAddr[0];
+    const int next_stride = level.next.u16Stride[0];
+    for (int iter = 0; iter < ctrl->u8MaxIter; iter++) {
+      const uint8_t *base[LK_LANES];
+      float w00[LK_LANES], w01[LK_LANES], w10[LK_LANES], w11[LK_LANES];
+      bool any_active = false;
+      for (uint32_t l = 0; l < LK_LANES; l++) {
+        base[l] = next_data;
+        w00[l] = w01[l] = w10[l] = w11[l] = 0.f;
+        if (!active[l]) continue;
+        float jx = anchor_x[l] - half + guess_x[l] + flow_x[l];
+        float jy = anchor_y[l] - half + guess_y[l] + flow_y[l];
+        int x0 = std::floor(jx), y0 = std::floor(jy);
+        if (x0 < 0 || y0 < 0 || x0 + win >= width || y0 + win >= height) {
+          // Keep the flow found so far on a coarse level, the finer levels refine it.
+          active[l] = false;
+          lost[l] = lv == 0;
+          continue;
+        }
+        float ax = jx - x0, ay = jy - y0;
+        base[l] = next_data + y0 * next_stride + x0;
+        w00[l] = (1.f - ax) * (1.f - ay);
+        w01[l] = ax * (1.f - ay);
+        w10[l] = (1.f - ax) * ay;
+        w11[l] = ax * ay;
+        any_active = true;
+      }
+      if (!any_active) break;
+
+      float b_x[LK_LANES], b_y[LK_LANES], abs_sum[LK_LANES];
+#ifndef CV180X
+      const float32x4_t v_w00 = vld1q_f32(w00), v_w01 = vld1q_f32(w01);
+      const float32x4_t v_w10 = vld1q_f32(w10), v_w11 = vld1q_f32(w11);
+      float32x4_t v_bx = vdupq_n_f32(0.f), v_by = vdupq_n_f32(0.f), v_abs = vdupq_n_f32(0.f);
+      for (int i = 0; i < win; i++) {
+        for (int j = 0; j < win; j++) {
+          float t00[LK_LANES], t01[LK_LANES], t10[LK_LANES], t11[LK_LANES];
+          for (uint32_t l = 0; l < LK_LANES; l++) {
+            const uint8_t *p = base[l] + i * next_stride + j;
+            t00[l] = p[0];
+            t01[l] = p[1];
+            t10[l] = p[next_stride];
+            t11[l] = p[next_stride + 1];
+          }
+          const float *src = patch + (i * win + j) * 3 * LK_LANES;
+          float32x4_t v_j = vmulq_f32(v_w00, vld1q_f32(t00));
+          v_j = vmlaq_f32(v_j, v_w01, vld1q_f32(t01));
+          v_j = vmlaq_f32(v_j, v_w10, vld1q_f32(t10));
+          v_j = vmlaq_f32(v_j, v_w11, vld1q_f32(t11));
+          float32x4_t v_diff = vsubq_f32(vld1q_f32(src), v_j);
+          v_bx = vmlaq_f32(v_bx, v_diff, vld1q_f32(src + LK_LANES));
+          v_by = vmlaq_f32(v_by, v_diff, vld1q_f32(src + 2 * LK_LANES));
+          v_abs = vaddq_f32(v_abs, vabsq_f32(v_diff));
+        }
+      }
+      vst1q_f32(b_x, v_bx);
+      vst1q_f32(b_y, v_by);
+      vst1q_f32(abs_sum, v_abs);
+#else
+      for (uint32_t l = 0; l < LK_LANES; l++) {
+        b_x[l] = b_y[l] = abs_sum[l] = 0.f;
+        for (int i = 0; i < win; i++) {
+          for (int j = 0; j < win; j++) {
+            const uint8_t *p = base[l] + i * next_stride + j;
+            const float *src = patch + (i * win + j) * 3 * LK_LANES + l;
+            float diff = src[0] - (w00[l] * p[0] + w01[l] * p[1] + w10[l] * p[next_stride] +
+                                   w11[l] * p[next_stride + 1]);
+            b_x[l] += diff * src[LK_LANES];
+            b_y[l] += diff * src[2 * LK_LANES];
+            abs_sum[l] += std::abs(diff);
+          }
+        }
+      }
+#endif
+      for (uint32_t l = 0; l < LK_LANES; l++) {
+        if (!active[l]) continue;
+        float delta_x = inv_g[l][0] * b_x[l] + inv_g[l][1] * b_y[l];
+        float delta_y = inv_g[l][1] * b_x[l] + inv_g[l][2] * b_y[l];
+        flow_x[l] += delta_x;
+        flow_y[l] += delta_y;
+        mean_err[l] = abs_sum[l] / area;
+        if (delta_x * delta_x + delta_y * delta_y < eps2) {
+          active[l] = false;
+        }
+      }
+    }
+    if (lv > 0) {
+      for (uint32_t l = 0; l < LK_LANES; l++) {
+        guess_x[l] = 2.f * (guess_x[l] + flow_x[l]);
+        guess_y[l] = 2.f * (guess_y[l] + flow_y[l]);
+      }
+    }
+  }
+
+  const float width = levels[0].prev.u32Width, height = levels[0].prev.u32Height;
+  for (uint32_t l = 0; l < num; l++) {
+    next_pts[l].f32X = prev_pts[l].f32X + guess_x[l] + flow_x[l];
+    next_pts[l].f32Y = prev_pts[l].f32Y + guess_y[l] + flow_y[l];
+    status[l] = !lost[l] && next_pts[l].f32X >= 0.f && next_pts[l].f32Y >= 0.f &&
+                next_pts[l].f32X <= width - 1 && next_pts[l].f32Y <= height - 1;
+    if (err != NULL) {
+      err[l] = mean_err[l];
+    }
+  }
+}
+
+CVI_S32 CVI_IVE_LKOpticalFlow(IVE_HANDLE pIveHandle, IVE_SRC_IMAGE_S *pstPrev,
+                              IVE_SRC_IMAGE_S *pstNext, IVE_LK_POINT_S *pstPrevPts,
+                              IVE_LK_POINT_S *pstNextPts, CVI_U8 *pu8Status, CVI_FLOAT *pf32Err,
+                              CVI_U32 u32PtsNum, IVE_LK_OPTICAL_FLOW_CTRL_S *pstLkCtrl,
+                              bool bInstant) {
+  ScopedTrace t(__PRETTY_FUNCTION__);
+  if (!IsValidImageType(pstPrev, STRFY(pstPrev), IVE_IMAGE_TYPE_U8C1)) {
+    return CVI_FAILURE;
+  }
+  if (!IsValidImageType(pstNext, STRFY(pstNext), IVE_IMAGE_TYPE_U8C1)) {
+    return CVI_FAILURE;
+  }
+  if (pstPrev->u32Width != pstNext->u32Width || pstPrev->u32Height != pstNext->u32Height) {
+    LOGE("pstPrev and pstNext must have the same size.\n");
+    return CVI_FAILURE;
+  }
+  if (u32PtsNum != 0 && (pstPrevPts == NULL || pstNextPts == NULL || pu8Status == NULL)) {
+    LOGE("Point and status lists cannot be NULL.\n");
+    return CVI_FAILURE;
+  }
+  const uint32_t win = pstLkCtrl->u8WinSize;
+  if (win < 5 || win > 31 || win % 2 == 0) {
+    LOGE("Window size %u must be odd and in [5, 31].\n", win);
+    return CVI_FAILURE;
+  }
+  if (pstLkCtrl->u8MaxLevel > LK_MAX_LEVEL || pstLkCtrl->u8MaxIter == 0) {
+    LOGE("Pyramid level must be at most %d and iterations at least 1.\n", LK_MAX_LEVEL);
+    return CVI_FAILURE;
+  }
+  if (pstPrev->u32Width < win + 2 || pstPrev->u32Height < win + 2) {
+    LOGE("Image %u x %u is smaller than the window.\n", pstPrev->u32Width, pstPrev->u32Height);
+    return CVI_FAILURE;
+  }
+  if (u32PtsNum == 0) {
+    return CVI_SUCCESS;
+  }
+
+  // Levels that still hold a window with its gradient border.
+  uint32_t level_num = 1;
+  while (level_num <= pstLkCtrl->u8MaxLevel &&
+         (pstPrev->u32Width >> level_num) >= win + 2 &&
+         (pstPrev->u32Height >> level_num) >= win + 2) {
+    level_num++;
+  }
+  std::vector<LKLevel> levels(level_num);
+  for (auto &level : levels) {
+    memset(&level.prev, 0, sizeof(IVE_IMAGE_S));
+    memset(&level.next, 0, sizeof(IVE_IMAGE_S));
+    memset(&level.grad_x, 0, sizeof(IVE_IMAGE_S));
+    memset(&level.grad_y, 0, sizeof(IVE_IMAGE_S));
+  }
+  levels[0].prev = *pstPrev;
+  levels[0].next = *pstNext;
+
+  CVI_S32 ret = CVI_SUCCESS;
+  CVI_IVE_BufRequest(pIveHandle, pstPrev);
+  CVI_IVE_BufRequest(pIveHandle, pstNext);
+  IVE_SOBEL_CTRL_S sobel_ctrl;
+  sobel_ctrl.enOutCtrl = IVE_SOBEL_OUT_CTRL_BOTH;
+  sobel_ctrl.u8MaskSize = 3;
+  for (uint32_t lv = 0; lv < level_num && ret == CVI_SUCCESS; lv++) {
+    LKLevel &level = levels[lv];
+    if (lv > 0) {
+      const uint32_t width = levels[lv - 1].prev.u32Width / 2;
+      const uint32_t height = levels[lv - 1].prev.u32Height / 2;
+      if (CVI_IVE_CreateImage(pIveHandle, &level.prev, IVE_IMAGE_TYPE_U8C1, width, height) !=
+              CVI_SUCCESS ||
+          CVI_IVE_CreateImage(pIveHandle, &level.next, IVE_IMAGE_TYPE_U8C1, width, height) !=
+              CVI_SUCCESS) {
+        LOGE("Failed to allocate pyramid level %u.\n", lv);
+        ret = CVI_FAILURE;
+        break;
+      }
+      lk_pyr_down(&levels[lv - 1].prev, &level.prev);
+      lk_pyr_down(&levels[lv - 1].next, &level.next);
+      CVI_IVE_BufFlush(pIveHandle, &level.prev);
+    }
+    if (CVI_IVE_CreateImage(pIveHandle, &level.grad_x, IVE_IMAGE_TYPE_BF16C1, level.prev.u32Width,
+                            level.prev.u32Height) != CVI_SUCCESS ||
+        CVI_IVE_CreateImage(pIveHandle, &level.grad_y, IVE_IMAGE_TYPE_BF16C1, level.prev.u32Width,
+                            level.prev.u32Height) != CVI_SUCCESS) {
+      LOGE("Failed to allocate gradients of pyramid level %u.\n", lv);
+      ret = CVI_FAILURE;
+      break;
+    }
+    // The vertical output of CVI_IVE_Sobel is the response of the SOBEL_X kernel.
+    if (CVI_IVE_Sobel(pIveHandle, &level.prev, &level.grad_y, &level.grad_x, &sobel_ctrl, 0) !=
+        CVI_SUCCESS) {
+      ret = CVI_FAILURE;
+      break;
+    }
+    CVI_IVE_BufRequest(pIveHandle, &level.grad_x);
+    CVI_IVE_BufRequest(pIveHandle, &level.grad_y);
+    lk_build_integral(&level);
+  }
+
+  if (ret == CVI_SUCCESS) {
+    const uint32_t group_num = (u32PtsNum + LK_LANES - 1) / LK_LANES;
+    auto track_groups = [&](uint32_t group_begin, uint32_t group_end) {
+      std::vector<float> patch(win * win * 3 * LK_LANES);
+      for (uint32_t g = group_begin; g < group_end; g++) {
+        const uint32_t first = g * LK_LANES;
+        lk_track_lanes(levels, pstPrevPts + first, pstNextPts + first, pu8Status + first,
+                       pf32Err == NULL ? NULL : pf32Err + first,
+                       std::min(u32PtsNum - first, (uint32_t)LK_LANES), pstLkCtrl, patch.data());
+      }
+    };
+    parallelRows(group_num, (uint64_t)win * win * pstLkCtrl->u8MaxIter * level_num * LK_LANES,
+                 track_groups);
+  }
+
+  for (uint32_t lv = 0; lv < level_num; lv++) {
+    if (lv > 0) {
+      CVI_SYS_FreeI(pIveHandle, &levels[lv].prev);
+      CVI_SYS_FreeI(pIveHandle, &levels[lv].next);
+    }
+    CVI_SYS_FreeI(pIveHandle, &levels[lv].grad_x);
+    CVI_SYS_FreeI(pIveHandle, &levels[lv].grad_y);
+  }
+  return ret;
+}
+
+// right[x - d] of a row is right_rev[width - 1 - x + d], which makes the disparities of a pixel
+// contiguous. The num_disp padding bytes only feed disparities that are never selected.
+static void bm_reverse_row(const uint8_t *right, uint8_t *right_rev, const uint32_t width,
+                           const uint32_t num_disp) {
+  for (uint32_t x = 0; x < width; x++) {
+    right_rev[width - 1 - x] = right[x];
+  }
+  memset(right_rev + width, right[0], num_disp);
+}
+
+// col[x * num_disp + d] += |left_add[x] - right_add[x - d]| - |left_sub[x] - right_sub[x - d]|,
+// the subtracted row is skipped if left_sub is NULL.
+static void bm_slide_col_sums(uint16_t *col, const uint8_t *left_add, const uint8_t *rev_add,
+                              const uint8_t *left_sub, const uint8_t *rev_sub,
+                              const uint32_t width, const uint32_t num_disp) {
+  for (uint32_t x = 0; x < width; x++) {
+    uint16_t *col_x = col + x * num_disp;
+    const uint8_t *r_add = rev_add + width - 1 - x;
+#ifndef CV180X
+    const uint8x16_t l_add = vdupq_n_u8(left_add[x]);
+    if (left_sub == NULL) {
+      for (uint32_t d = 0; d < num_disp; d += 16) {
+        uint8x16_t ad = vabdq_u8(l_add, vld1q_u8(r_add + d));
+        vst1q_u16(col_x + d, vaddw_u8(vld1q_u16(col_x + d), vget_low_u8(ad)));
+        vst1q_u16(col_x + d + 8, vaddw_u8(vld1q_u16(col_x + d + 8), vget_high_u8(ad)));
+      }
+      continue;
+    }
+    const uint8x16_t l_sub = vdupq_n_u8(left_sub[x]);
+    const uint8_t *r_sub = rev_sub + width - 1 - x;
+    for (uint32_t d = 0; d < num_disp; d += 16) {
+      uint8x16_t ad_add = vabdq_u8(l_add, vld1q_u8(r_add + d));
+      uint8x16_t ad_sub = vabdq_u8(l_sub, vld1q_u8(r_sub + d));
+      uint16x8_t lo = vaddw_u8(vld1q_u16(col_x + d), vget_low_u8(ad_add));
+      uint16x8_t hi = vaddw_u8(vld1q_u16(col_x + d + 8), vget_high_u8(ad_add));
+      vst1q_u16(col_x + d, vsubw_u8(lo, vget_low_u8(ad_sub)));
+      vst1q_u16(col_x + d + 8, vsubw_u8(hi, vget_high_u8(ad_sub)));
+    }
+#else
+    for (uint32_t d = 0; d < num_disp; d++) {
+      col_x[d] += std::abs(left_add[x] - r_add[d]);
+      if (left_sub != NULL) {
+        col_x[d] -= std::abs(left_sub[x] - rev_sub[width - 1 - x + d]);
+      }
+    }
+#endif
+  }
+}
+
+// cost[x * num_disp + d] is the sum of col over [x - half, x + half] for x in
+// [half, width - half).
+static void bm_row_costs(const uint16_t *col, uint16_t *cost, const uint32_t width,
+                         const uint32_t num_disp, const uint32_t half) {
+  uint16_t *first = cost + half * num_disp;
+  memcpy(first, col, num_disp * sizeof(uint16_t));
+  for (uint32_t j = 1; j <= 2 * half; j++) {
+    for (uint32_t d = 0; d < num_disp; d++) {
+      first[d] += col[j * num_disp + d];
+    }
+  }
+  for (uint32_t x = half + 1; x + half < width; x++) {
+    const uint16_t *prev = cost + (x - 1) * num_disp;
+    const uint16_t *col_in = col + (x + half) * num_disp;
+    const uint16_t *col_out = col + (x - half - 1) * num_disp;
+    uint16_t *cur = cost + x * num_disp;
+#ifndef CV180X
+    for (uint32_t d = 0; d < num_disp; d += 8) {
+      uint16x8_t v = vaddq_u16(vld1q_u16(prev + d), vld1q_u16(col_in + d));
+      vst1q_u16(cur + d, vsubq_u16(v, vld1q_u16(col_out + d)));
+    }
+#else
+    for (uint32_t d = 0; d < num_disp; d++) {
+      cur[d] = prev[d] + col_in[d] - col_out[d];
+    }
+#endif
+  }
+}
+
+CVI_S32 CVI_IVE_StereoBM(IVE_HANDLE pIveHandle, IVE_SRC_IMAGE_S *pstLeft, IVE_SRC_IMAGE_S *pstRight,
+                         IVE_DST_IMAGE_S *pstDisp, IVE_DST_IMAGE_S *pstCost,
+                         IVE_STEREO_BM_CTRL_S *pstBmCtrl, bool bInstant) {
+  ScopedTrace t(__PRETTY_FUNCTION__);
+  if (!IsValidImageType(pstLeft, STRFY(pstLeft), IVE_IMAGE_TYPE_U8C1)) {
+    return CVI_FAILURE;
+  }
+  if (!IsValidImageType(pstRight, STRFY(pstRight), IVE_IMAGE_TYPE_U8C1)) {
+    return CVI_FAILURE;
+  }
+  if (!IsValidImageType(pstDisp, STRFY(pstDisp), IVE_IMAGE_TYPE_U8C1)) {
+    return CVI_FAILURE;
+  }
+  if (pstCost != NULL && !IsValidImageType(pstCost, STRFY(pstCost), IVE_IMAGE_TYPE_U16C1)) {
+    return CVI_FAILURE;
+  }
+  const uint32_t width = pstLeft->u32Width, height = pstLeft->u32Height;
+  if (pstRight->u32Width != width || pstRight->u32Height != height ||
+      pstDisp->u32Width != width || pstDisp->u32Height != height ||
+      (pstCost != NULL && (pstCost->u32Width != width || pstCost->u32Height != height))) {
+    LOGE("Input and output images must have the same size.\n");
+    return CVI_FAILURE;
+  }
+  const uint32_t win = pstBmCtrl->u8WinSize, half = win / 2;
+  const uint32_t num_disp = pstBmCtrl->u16NumDisp;
+  if (win < 3 || win > 15 || win % 2 == 0) {
+    LOGE("Window size %u must be odd and in [3, 15].\n", win);
+    return CVI_FAILURE;
+  }
+  if (num_disp == 0 || num_disp > 240 || num_disp % 16 != 0) {
+    LOGE("Disparity number %u must be a multiple of 16 up to 240.\n", num_disp);
+    return CVI_FAILURE;
+  }
+  if (width < win || height < win) {
+    LOGE("Image %u x %u is smaller than the window.\n", width, height);
+    return CVI_FAILURE;
+  }
+
+  CVI_IVE_BufRequest(pIveHandle, pstLeft);
+  CVI_IVE_BufRequest(pIveHandle, pstRight);
+  const uint8_t invalid = pstBmCtrl->u8InvalidVal;
+  const uint32_t ratio = pstBmCtrl->u8UniquenessRatio;
+  const int max_lr_diff = pstBmCtrl->s8MaxLRDiff;
+  auto match_rows = [&](uint32_t row_begin, uint32_t row_end) {
+    std::vector<uint16_t> col((size_t)width * num_disp, 0);
+    std::vector<uint16_t> cost((size_t)width * num_disp);
+    std::vector<uint8_t> rev_add(width + num_disp), rev_sub(width + num_disp);
+    std::vector<uint16_t> right_cost(width);
+    std::vector<uint8_t> right_disp(width);
+    std::vector<int16_t> best_disp(width);
+    const uint8_t *left = pstLeft->pu8VirAddr[0], *right = pstRight->pu8VirAddr[0];
+    const uint32_t l_stride = pstLeft->u16Stride[0], r_stride = pstRight->u16Stride[0];
+    for (uint32_t y = row_begin; y < row_end; y++) {
+      uint8_t *disp_row = pstDisp->pu8VirAddr[0] + y * pstDisp->u16Stride[0];
+      uint16_t *cost_row =
+          pstCost == NULL ? NULL
+                          : (uint16_t *)(pstCost->pu8VirAddr[0] + y * pstCost->u16Stride[0]);
+      memset(disp_row, invalid, width);
+      if (cost_row != NULL) {
+        std::fill(cost_row, cost_row + width, 0xFFFF);
+      }
+      if (y < half || y + half >= height) continue;
+
+      // Column sums of the window rows, slid down by one row after the first row of the band.
+      if (y == row_begin || y == half) {
+        std::fill(col.begin(), col.end(), 0);
+        for (uint32_t i = y - half; i <= y + half; i++) {
+          bm_reverse_row(right + i * r_stride, rev_add.data(), width, num_disp);
+          bm_slide_col_sums(col.data(), left + i * l_stride, rev_add.data(), NULL, NULL, width,
+                            num_disp);
+        }
+      } else {
+        const uint32_t row_add = y + half, row_sub = y - half - 1;
+        bm_reverse_row(right + row_add * r_stride, rev_add.data(), width, num_disp);
+        bm_reverse_row(right + row_sub * r_stride, rev_sub.data(), width, num_disp);
+        bm_slide_col_sums(col.data(), left + row_add * l_stride, rev_add.data(),
+                          left + row_sub * l_stride, rev_sub.data(), width, num_disp);
+      }
+      bm_row_costs(col.data(), cost.data(), width, num_disp, half);
+
+      std::fill(right_cost.begin(), right_cost.end(), 0xFFFF);
+      for (uint32_t x = half; x + half < width; x++) {
+        const uint16_t *c = cost.data() + x * num_disp;
+        const uint32_t max_d = std::min(num_disp - 1, x - half);
+        uint32_t best = 0;
+        for (uint32_t d = 1; d <= max_d; d++) {
+          if (c[d] < c[best]) best = d;
+        }
+        if (cost_row != NULL) {
+          cost_row[x] = c[best];
+        }
+        if (max_lr_diff >= 0) {
+          for (uint32_t d = 0; d <= max_d; d++) {
+            if (c[d] < right_cost[x - d]) {
+              right_cost[x - d] = c[d];
+              right_disp[x - d] = d;
+            }
+          }
+        }
+        best_disp[x] = best;
+        // Disparities next to the best one are expected to be close and are not compared.
+        for (uint32_t d = 0; ratio != 0 && d <= max_d; d++) {
+          if ((d + 1 < best || d > best + 1) && c[d] * 100 < c[best] * (100 + ratio)) {
+            best_disp[x] = -1;
+            break;
+          }
+        }
+      }
+      for (uint32_t x = half; x + half < width; x++) {
+        int d = best_disp[x];
+        if (d >= 0 && (max_lr_diff < 0 || std::abs(right_disp[x - d] - d) <= max_lr_diff)) {
+          disp_row[x] = d;
+        }
+      }
+    }
+  };
+  parallelRows(height, (uint64_t)width * num_disp, match_rows);
+  CVI_IVE_BufFlush(pIveHandle, pstDisp);
+  if (pstCost != NULL) {
+    CVI_IVE_BufFlush(pIveHandle, pstCost);
+  }
+  return CVI_SUCCESS;
+}
+
+// Rows of a slice of the fused motion detection. Smaller slices recompute more halo rows, larger
+// ones leave the cache.
+#define MD_SLICE_ROWS 32
+
+struct MDRun {
+  uint16_t start;
+  uint16_t end;  // Inclusive.
+};
+
+// dst row r is the min (erode) or max over src rows [r - half, r + half] and columns
+// [x - half, x + half], clipped to src rows [src_begin, src_end) and the row width. tmp holds
+// width + 2 * half bytes.
+template <bool ERODE>
+static void md_morph_rows(const uint8_t *src, const uint32_t src_stride, const uint32_t src_begin,
+                          const uint32_t src_end, uint8_t *dst, const uint32_t dst_stride,
+                          const uint32_t dst_begin, const uint32_t dst_end, const uint32_t width,
+                          const uint32_t half, uint8_t *tmp) {
+  const uint8_t pad = ERODE ? 255 : 0;
+  memset(tmp, pad, half);
+  memset(tmp + half + width, pad, half);
+  uint8_t *mid = tmp + half;
+  for (uint32_t r = dst_begin; r < dst_end; r++) {
+    const uint32_t lo = std::max(r, src_begin + half) - half;
+    const uint32_t hi = std::min(r + half + 1, src_end);
+    memcpy(mid, src + (lo - src_begin) * src_stride, width);
+    for (uint32_t i = lo + 1; i < hi; i++) {
+      const uint8_t *row = src + (i - src_begin) * src_stride;
+      uint32_t x = 0;
+#ifndef CV180X
+      for (; x + 16 <= width; x += 16) {
+        uint8x16_t a = vld1q_u8(mid + x), b = vld1q_u8(row + x);
+        vst1q_u8(mid + x, ERODE ? vminq_u8(a, b) : vmaxq_u8(a, b));
+      }
+#endif
+      for (; x < width; x++) {
+        mid[x] = ERODE ? std::min(mid[x], row[x]) : std::max(mid[x], row[x]);
+      }
+    }
+    uint8_t *out = dst + (r - dst_begin) * dst_stride;
+    uint32_t x = 0;
+#ifndef CV180X
+    for (; x + 16 <= width; x += 16) {
+      uint8x16_t v = vld1q_u8(tmp + x);
+      for (uint32_t j = 1; j <= 2 * half; j++) {
+        v = ERODE ? vminq_u8(v, vld1q_u8(tmp + x + j)) : vmaxq_u8(v, vld1q_u8(tmp + x + j));
+      }
+      vst1q_u8(out + x, v);
+    }
+#endif
+    for (; x < width; x++) {
+      uint8_t v = tmp[x];
+      for (uint32_t j = 1; j <= 2 * half; j++) {
+        v = ERODE ? std::min(v, tmp[x + j]) : std::max(v, tmp[x + j]);
+      }
+      out[x] = v;
+    }
+  }
+}
+
+// Appends the runs of non zero pixels of a row.
+static void md_row_runs(const uint8_t *row, const uint32_t width, std::vector<MDRun> *runs) {
+  uint32_t x = 0;
+  while (x < width) {
+#ifndef CV180X
+    // Skip empty blocks.
+    while (x + 16 <= width) {
+      uint64x2_t v = vreinterpretq_u64_u8(vld1q_u8(row + x));
+      if ((vgetq_lane_u64(v, 0) | vgetq_lane_u64(v, 1)) != 0) break;
+      x += 16;
+    }
+#endif
+    while (x < width && row[x] == 0) x++;
+    if (x == width) break;
+    uint32_t start = x;
+    while (x < width && row[x] != 0) x++;
+    runs->push_back({(uint16_t)start, (uint16_t)(x - 1)});
+  }
+}
+
+static uint32_t md_find(std::vector<uint32_t> &parent, uint32_t label) {
+  while (parent[label] != label) {
+    parent[label] = parent[parent[label]];
+    label = parent[label];
+  }
+  return label;
+}
+
+// Merges two labels into the smaller root, which is the blob seen first in raster order.
+static uint32_t md_union(std::vector<uint32_t> &parent, std::vector<IVE_MOTION_BLOB_S> &blobs,
+                         uint32_t a, uint32_t b) {
+  a = md_find(parent, a);
+  b = md_find(parent, b);
+  if (a == b) return a;
+  if (a > b) std::swap(a, b);
+  parent[b] = a;
+  IVE_MOTION_BLOB_S &ba = blobs[a], &bb = blobs[b];
+  uint32_t x0 = std::min(ba.u16X, bb.u16X), y0 = std::min(ba.u16Y, bb.u16Y);
+  uint32_t x1 = std::max(ba.u16X + ba.u16Width, bb.u16X + bb.u16Width);
+  uint32_t y1 = std::max(ba.u16Y + ba.u16Height, bb.u16Y + bb.u16Height);
+  ba.u16X = x0;
+  ba.u16Y = y0;
+  ba.u16Width = x1 - x0;
+  ba.u16Height = y1 - y0;
+  ba.u32Area += bb.u32Area;
+  return a;
+}
+
+CVI_S32 CVI_IVE_MotionDetect(IVE_HANDLE pIveHandle, IVE_SRC_IMAGE_S *pstCur,
+                             IVE_SRC_IMAGE_S *pstRef, IVE_DST_IMAGE_S *pstMask,
+                             IVE_MOTION_BLOB_S *pstBlobs, CVI_U32 u32MaxBlobNum,
+                             CVI_U32 *pu32BlobNum, IVE_MOTION_DETECT_CTRL_S *pstMdCtrl,
+                             bool bInstant) {
+  ScopedTrace t(__PRETTY_FUNCTION__);
+  if (!IsValidImageType(pstCur, STRFY(pstCur), IVE_IMAGE_TYPE_U8C1)) {
+    return CVI_FAILURE;
+  }
+  if (!IsValidImageType(pstRef, STRFY(pstRef), IVE_IMAGE_TYPE_U8C1)) {
+    return CVI_FAILURE;
+  }
+  if (pstMask != NULL && !IsValidImageType(pstMask, STRFY(pstMask), IVE_IMAGE_TYPE_U8C1)) {
+    return CVI_FAILURE;
+  }
+  const uint32_t width = pstCur->u32Width, height = pstCur->u32Height;
+  if (pstRef->u32Width != width || pstRef->u32Height != height ||
+      (pstMask != NULL && (pstMask->u32Width != width || pstMask->u32Height != height))) {
+    LOGE("Input and output images must have the same size.\n");
+    return CVI_FAILURE;
+  }
+  if (pstBlobs == NULL || pu32BlobNum == NULL) {
+    LOGE("pstBlobs and pu32BlobNum cannot be NULL.\n");
+    return CVI_FAILURE;
+  }
+  const uint32_t erode_size = std::max(pstMdCtrl->u8ErodeSize, (CVI_U8)1);
+  const uint32_t dilate_size = std::max(pstMdCtrl->u8DilateSize, (CVI_U8)1);
+  if (erode_size > 15 || erode_size % 2 == 0 || dilate_size > 15 || dilate_size % 2 == 0) {
+    LOGE("Erode size %u and dilate size %u must be odd and up to 15.\n", erode_size,
+         dilate_size);
+    return CVI_FAILURE;
+  }
+
+  CVI_IVE_BufRequest(pIveHandle, pstCur);
+  CVI_IVE_BufRequest(pIveHandle, pstRef);
+  const uint32_t he = erode_size / 2, hd = dilate_size / 2;
+  const uint8_t thr = pstMdCtrl->u8DiffThr;
+  std::vector<std::vector<MDRun>> row_runs(height);
+  auto detect_rows = [&](uint32_t row_begin, uint32_t row_end) {
+    const uint32_t max_rows = MD_SLICE_ROWS + 2 * (he + hd);
+    std::vector<uint8_t> fg((size_t)max_rows * width), eroded((size_t)max_rows * width);
+    std::vector<uint8_t> dilated((size_t)MD_SLICE_ROWS * width), tmp(width + 14);
+    const uint8_t *cur = pstCur->pu8VirAddr[0], *ref = pstRef->pu8VirAddr[0];
+    const uint32_t c_stride = pstCur->u16Stride[0], r_stride = pstRef->u16Stride[0];
+    for (uint32_t s0 = row_begin; s0 < row_end; s0 += MD_SLICE_ROWS) {
+      const uint32_t s1 = std::min(s0 + MD_SLICE_ROWS, row_end);
+      // Rows of the eroded and the thresholded difference images that the slice depends on.
+      const uint32_t e0 = std::max(s0, hd) - hd, e1 = std::min(s1 + hd, height);
+      const uint32_t f0 = std::max(e0, he) - he, f1 = std::min(e1 + he, height);
+      for (uint32_t y = f0; y < f1; y++) {
+        const uint8_t *c = cur + y * c_stride, *r = ref + y * r_stride;
+        uint8_t *f = fg.data() + (y - f0) * width;
+        uint32_t x = 0;
+#ifndef CV180X
+        const uint8x16_t thr_v = vdupq_n_u8(thr);
+        for (; x + 16 <= width; x += 16) {
+          vst1q_u8(f + x, vcgtq_u8(vabdq_u8(vld1q_u8(c + x), vld1q_u8(r + x)), thr_v));
+        }
+#endif
+        for (; x < width; x++) {
+          f[x] = std::abs(c[x] - r[x]) > thr ? 255 : 0;
+        }
+      }
+      const uint8_t *e = fg.data();
+      if (he > 0) {
+        md_morph_rows<true>(fg.data(), width, f0, f1, eroded.data(), width, e0, e1, width, he,
+                            tmp.data());
+        e = eroded.data();
+      }
+      uint8_t *out = dilated.data();
+      uint32_t out_stride = width;
+      if (pstMask != NULL) {
+        out = pstMask->pu8VirAddr[0] + s0 * pstMask->u16Stride[0];
+        out_stride = pstMask->u16Stride[0];
+      }
+      if (hd > 0) {
+        md_morph_rows<false>(e, width, e0, e1, out, out_stride, s0, s1, width, hd, tmp.data());
+      } else if (pstMask != NULL) {
+        for (uint32_t y = s0; y < s1; y++) {
+          memcpy(out + (y - s0) * out_stride, e + (y - e0) * width, width);
+        }
+      } else {
+        out = (uint8_t *)e + (s0 - e0) * width;
+      }
+      for (uint32_t y = s0; y < s1; y++) {
+        md_row_runs(out + (y - s0) * out_stride, width, &row_runs[y]);
+      }
+    }
+  };
+  parallelRows(height, width, detect_rows);
+  if (pstMask != NULL) {
+    CVI_IVE_BufFlush(pIveHandle, pstMask);
+  }
+
+  // Label the runs row by row. Runs touch if they overlap, or are diagonal neighbors with
+  // 8 connectivity.
+  const uint32_t adj = pstMdCtrl->enMode == DIRECTION_8 ? 1 : 0;
+  std::vector<uint32_t> parent;
+  std::vector<IVE_MOTION_BLOB_S> blobs;
+  std::vector<uint32_t> prev_labels, cur_labels;
+  for (uint32_t y = 0; y < height; y++) {
+    const std::vector<MDRun> &runs = row_runs[y];
+    const std::vector<MDRun> *prev = y > 0 ? &row_runs[y - 1] : NULL;
+    cur_labels.resize(runs.size());
+    uint32_t j = 0;
+    for (size_t i = 0; i < runs.size(); i++) {
+      const MDRun &run = runs[i];
+      int64_t label = -1;
+      while (prev != NULL && j < prev->size() && (*prev)[j].end + adj < run.start) j++;
+      for (uint32_t k = j; prev != NULL && k < prev->size() && (*prev)[k].start <= run.end + adj;
+           k++) {
+        label = label < 0 ? md_find(parent, prev_labels[k])
+                          : md_union(parent, blobs, label, prev_labels[k]);
+      }
+      const uint16_t run_width = run.end - run.start + 1;
+      if (label < 0) {
+        label = parent.size();
+        parent.push_back(label);
+        blobs.push_back({run.start, (uint16_t)y, run_width, 1, run_width});
+      } else {
+        IVE_MOTION_BLOB_S &b = blobs[label];
+        uint32_t x0 = std::min(b.u16X, run.start), x1 = std::max(b.u16X + b.u16Width, run.end + 1);
+        b.u16X = x0;
+        b.u16Width = x1 - x0;
+        b.u16Height = y + 1 - b.u16Y;
+        b.u32Area += run_width;
+      }
+      cur_labels[i] = label;
+    }
+    std::swap(prev_labels, cur_labels);
+  }
+
+  std::vector<IVE_MOTION_BLOB_S> found;
+  for (uint32_t label = 0; label < parent.size(); label++) {
+    if (parent[label] == label && blobs[label].u32Area >= pstMdCtrl->u32MinArea) {
+      found.push_back(blobs[label]);
+    }
+  }
+  std::stable_sort(found.begin(), found.end(),
+                   [](const IVE_MOTION_BLOB_S &a, const IVE_MOTION_BLOB_S &b) {
+                     return a.u32Area > b.u32Area;
+                   });
+  *pu32BlobNum = std::min((uint32_t)found.size(), u32MaxBlobNum);
+  std::copy(found.begin(), found.begin() + *pu32BlobNum, pstBlobs);
+  return CVI_SUCCESS;
+}
+
+// Direction codes of the Canny non-maximum suppression, the neighbors compared along the gradient.
+#define CANNY_DIR_HOR 0        // Left and right.
+#define CANNY_DIR_VER 1        // Up and down.
+#define CANNY_DIR_DIAG_SAME 2  // Up left and down right, gx and gy have the same sign.
+#define CANNY_DIR_DIAG_DIFF 3  // Up right and down left.
+// tan(22.5 degrees) in Q15.
+#define CANNY_TG22 13573
+
+static inline void canny_grad_pixel(const uint8_t *r0, const uint8_t *r1, const uint8_t *r2,
+                                    const uint32_t x, const bool l2, uint32_t *mag,
+                                    uint8_t *dir) {
+  int gx = (r0[x + 1] - r0[x - 1]) + 2 * (r1[x + 1] - r1[x - 1]) + (r2[x + 1] - r2[x - 1]);
+  int gy = (r2[x - 1] + 2 * r2[x] + r2[x + 1]) - (r0[x - 1] + 2 * r0[x] + r0[x + 1]);
+  int ax = std::abs(gx), ay = std::abs(gy);
+  mag[x] = l2 ? gx * gx + gy * gy : ax + ay;
+  int tg22x = ax * CANNY_TG22, ay15 = ay << 15;
+  if (ay15 < tg22x) {
+    dir[x] = CANNY_DIR_HOR;
+  } else if (ay15 > tg22x + (ax << 16)) {
+    dir[x] = CANNY_DIR_VER;
+  } else {
+    dir[x] = (gx ^ gy) < 0 ? CANNY_DIR_DIAG_DIFF : CANNY_DIR_DIAG_SAME;
+  }
+}
+
+#ifndef CV180X
+static inline void canny_grad_lanes(const int16x4_t gx, const int16x4_t gy, const bool l2,
+                                    uint32_t *mag, uint16x4_t *dir) {
+  int32x4_t ax = vabsq_s32(vmovl_s16(gx)), ay = vabsq_s32(vmovl_s16(gy));
+  int32x4_t m = l2 ? vmlal_s16(vmull_s16(gx, gx), gy, gy) : vaddq_s32(ax, ay);
+  vst1q_u32(mag, vreinterpretq_u32_s32(m));
+  int32x4_t tg22x = vmulq_n_s32(ax, CANNY_TG22), ay15 = vshlq_n_s32(ay, 15);
+  uint32x4_t hor = vcltq_s32(ay15, tg22x);
+  uint32x4_t ver = vcgtq_s32(ay15, vaddq_s32(tg22x, vshlq_n_s32(ax, 16)));
+  uint32x4_t diff = vcltq_s32(vmovl_s16(veor_s16(gx, gy)), vdupq_n_s32(0));
+  uint32x4_t code = vbslq_u32(diff, vdupq_n_u32(CANNY_DIR_DIAG_DIFF),
+                              vdupq_n_u32(CANNY_DIR_DIAG_SAME));
+  code = vbslq_u32(ver, vdupq_n_u32(CANNY_DIR_VER), code);
+  code = vbslq_u32(hor, vdupq_n_u32(CANNY_DIR_HOR), code);
+  *dir = vmovn_u32(code);
+}
+#endif
+
+// Magnitude and direction of row y in [1, height - 1). Column 0 and width - 1 are 0 magnitude.
+static void canny_grad_row(const uint8_t *src, const uint32_t stride, const uint32_t y,
+                           const uint32_t width, const bool l2, uint32_t *mag, uint8_t *dir) {
+  const uint8_t *r0 = src + (y - 1) * stride, *r1 = src + y * stride, *r2 = src + (y + 1) * stride;
+  mag[0] = mag[width - 1] = 0;
+  dir[0] = dir[width - 1] = CANNY_DIR_HOR;
+  uint32_t x = 1;
+#ifndef CV180X
+  for (; x + 9 <= width; x += 8) {
+    int16x8_t d0 = vreinterpretq_s16_u16(vsubl_u8(vld1_u8(r0 + x + 1), vld1_u8(r0 + x - 1)));
+    int16x8_t d1 = vreinterpretq_s16_u16(vsubl_u8(vld1_u8(r1 + x + 1), vld1_u8(r1 + x - 1)));
+    int16x8_t d2 = vreinterpretq_s16_u16(vsubl_u8(vld1_u8(r2 + x + 1), vld1_u8(r2 + x - 1)));
+    int16x8_t gx = vaddq_s16(vaddq_s16(d0, d2), vshlq_n_s16(d1, 1));
+    uint16x8_t s0 = vaddq_u16(vaddl_u8(vld1_u8(r0 + x - 1), vld1_u8(r0 + x + 1)),
+                              vshll_n_u8(vld1_u8(r0 + x), 1));
+    uint16x8_t s2 = vaddq_u16(vaddl_u8(vld1_u8(r2 + x - 1), vld1_u8(r2 + x + 1)),
+                              vshll_n_u8(vld1_u8(r2 + x), 1));
+    int16x8_t gy = vreinterpretq_s16_u16(vsubq_u16(s2, s0));
+    uint16x4_t dir_lo, dir_hi;
+    canny_grad_lanes(vget_low_s16(gx), vget_low_s16(gy), l2, mag + x, &dir_lo);
+    canny_grad_lanes(vget_high_s16(gx), vget_high_s16(gy), l2, mag + x + 4, &dir_hi);
+    vst1_u8(dir + x, vmovn_u16(vcombine_u16(dir_lo, dir_hi)));
+  }
+#endif
+  for (; x + 1 < width; x++) {
+    canny_grad_pixel(r0, r1, r2, x, l2, mag, dir);
+  }
+}
+
+// Non-maximum suppression of a row, 255 for strong, 1 for weak and 0 for suppressed pixels.
+// Ties along the gradient keep the first pixel in raster order.
+static void canny_nms_row(const uint32_t *m0, const uint32_t *m1, const uint32_t *m2,
+                          const uint8_t *dir, const uint32_t width, const uint32_t low,
+                          const uint32_t high, uint8_t *out) {
+  out[0] = out[width - 1] = 0;
+  uint32_t x = 1;
+#ifndef CV180X
+  const uint32x4_t low_v = vdupq_n_u32(low), high_v = vdupq_n_u32(high);
+  const uint32x4_t weak_v = vdupq_n_u32(1), strong_v = vdupq_n_u32(255);
+  for (; x + 9 <= width; x += 8) {
+    uint16x8_t code16 = vmovl_u8(vld1_u8(dir + x));
+    uint16x4_t res[2];
+    for (uint32_t h = 0; h < 2; h++) {
+      const uint32_t i = x + 4 * h;
+      uint32x4_t code = vmovl_u16(h == 0 ? vget_low_u16(code16) : vget_high_u16(code16));
+      uint32x4_t m = vld1q_u32(m1 + i);
+      uint32x4_t keep_hor = vandq_u32(vcgtq_u32(m, vld1q_u32(m1 + i - 1)),
+                                      vcgeq_u32(m, vld1q_u32(m1 + i + 1)));
+      uint32x4_t keep_ver =
+          vandq_u32(vcgtq_u32(m, vld1q_u32(m0 + i)), vcgeq_u32(m, vld1q_u32(m2 + i)));
+      uint32x4_t keep_same = vandq_u32(vcgtq_u32(m, vld1q_u32(m0 + i - 1)),
+                                       vcgtq_u32(m, vld1q_u32(m2 + i + 1)));
+      uint32x4_t keep_diff = vandq_u32(vcgtq_u32(m, vld1q_u32(m0 + i + 1)),
+                                       vcgtq_u32(m, vld1q_u32(m2 + i - 1)));
+      uint32x4_t keep = keep_diff;
+      keep = vbslq_u32(vceqq_u32(code, vdupq_n_u32(CANNY_DIR_DIAG_SAME)), keep_same, keep);
+      keep = vbslq_u32(vceqq_u32(code, vdupq_n_u32(CANNY_DIR_VER)), keep_ver, keep);
+      keep = vbslq_u32(vceqq_u32(code, vdupq_n_u32(CANNY_DIR_HOR)), keep_hor, keep);
+      uint32x4_t v = vandq_u32(vandq_u32(keep, vcgtq_u32(m, low_v)), weak_v);
+      v = vorrq_u32(v, vandq_u32(vandq_u32(keep, vcgtq_u32(m, high_v)), strong_v));
+      res[h] = vmovn_u32(v);
+    }
+    vst1_u8(out + x, vmovn_u16(vcombine_u16(res[0], res[1])));
+  }
+#endif
+  for (; x + 1 < width; x++) {
+    const uint32_t m = m1[x];
+    bool keep;
+    switch (dir[x]) {
+      case CANNY_DIR_HOR:
+        keep = m > m1[x - 1] && m >= m1[x + 1];
+        break;
+      case CANNY_DIR_VER:
+        keep = m > m0[x] && m >= m2[x];
+        break;
+      case CANNY_DIR_DIAG_SAME:
+        keep = m > m0[x - 1] && m > m2[x + 1];
+        break;
+      default:
+        keep = m > m0[x + 1] && m > m2[x - 1];
+        break;
+    }
+    out[x] = !keep || m <= low ? 0 : (m > high ? 255 : 1);
+  }
+}
+
+CVI_S32 CVI_IVE_Canny(IVE_HANDLE pIveHandle, IVE_SRC_IMAGE_S *pstSrc, IVE_DST_IMAGE_S *pstDst,
+                      IVE_CANNY_CTRL_S *pstCannyCtrl, bool bInstant) {
+  ScopedTrace t(__PRETTY_FUNCTION__);
+  if (!IsValidImageType(pstSrc, STRFY(pstSrc), IVE_IMAGE_TYPE_U8C1)) {
+    return CVI_FAILURE;
+  }
+  if (!IsValidImageType(pstDst, STRFY(pstDst), IVE_IMAGE_TYPE_U8C1)) {
+    return CVI_FAILURE;
+  }
+  const uint32_t width = pstSrc->u32Width, height = pstSrc->u32Height;
+  if (pstDst->u32Width != width || pstDst->u32Height != height) {
+    LOGE("pstSrc and pstDst must have the same size.\n");
+    return CVI_FAILURE;
+  }
+  if (pstSrc->pu8VirAddr[0] == pstDst->pu8VirAddr[0]) {
+    LOGE("pstSrc and pstDst cannot be the same image.\n");
+    return CVI_FAILURE;
+  }
+  if (pstCannyCtrl->enDistCtrl != IVE_MAG_DIST_L1 && pstCannyCtrl->enDistCtrl != IVE_MAG_DIST_L2) {
+    LOGE("Not supported magnitude type %d.\n", pstCannyCtrl->enDistCtrl);
+    return CVI_FAILURE;
+  }
+  if (pstCannyCtrl->u16LowThr > pstCannyCtrl->u16HighThr) {
+    LOGE("Low threshold %u is larger than high threshold %u.\n", pstCannyCtrl->u16LowThr,
+         pstCannyCtrl->u16HighThr);
+    return CVI_FAILURE;
+  }
+  if (width < 3 || height < 3) {
+    LOGE("Image %u x %u is smaller than 3 x 3.\n", width, height);
+    return CVI_FAILURE;
+  }
+
+  CVI_IVE_BufRequest(pIveHandle, pstSrc);
+  const bool l2 = pstCannyCtrl->enDistCtrl == IVE_MAG_DIST_L2;
+  uint32_t low = pstCannyCtrl->u16LowThr, high = pstCannyCtrl->u16HighThr;
+  if (l2) {
+    low *= low;
+    high *= high;
+  }
+  const uint8_t *src = pstSrc->pu8VirAddr[0];
+  uint8_t *dst = pstDst->pu8VirAddr[0];
+  const uint32_t src_stride = pstSrc->u16Stride[0], dst_stride = pstDst->u16Stride[0];
+  std::vector<uint32_t> strong;
+  std::mutex strong_mutex;
+  auto nms_rows = [&](uint32_t row_begin, uint32_t row_end) {
+    // Magnitude and direction of rows y - 1, y and y + 1 in a ring indexed by row % 3.
+    std::vector<uint32_t> mag(3 * width);
+    std::vector<uint8_t> dir(3 * width);
+    std::vector<uint32_t> band_strong;
+    uint32_t next = row_begin == 0 ? 0 : row_begin - 1;
+    for (uint32_t y = row_begin; y < row_end; y++) {
+      uint8_t *out = dst + y * dst_stride;
+      if (y == 0 || y + 1 == height) {
+        memset(out, 0, width);
+        continue;
+      }
+      for (; next <= y + 1; next++) {
+        uint32_t *m = mag.data() + (next % 3) * width;
+        if (next == 0 || next + 1 == height) {
+          memset(m, 0, width * sizeof(uint32_t));
+        } else {
+          canny_grad_row(src, src_stride, next, width, l2, m, dir.data() + (next % 3) * width);
+        }
+      }
+      canny_nms_row(mag.data() + ((y - 1) % 3) * width, mag.data() + (y % 3) * width,
+                    mag.data() + ((y + 1) % 3) * width, dir.data() + (y % 3) * width, width, low,
+                    high, out);
+      for (uint32_t x = 1; x + 1 < width; x++) {
+        if (out[x] == 255) band_strong.push_back(y * dst_stride + x);
+      }
+    }
+    std::lock_guard<std::mutex> lock(strong_mutex);
+    strong.insert(strong.end(), band_strong.begin(), band_strong.end());
+  };
+  parallelRows(height, width, nms_rows);
+
+  // Hysteresis, weak pixels reached from strong ones become strong. The border is never weak, so
+  // the neighbors of a strong pixel are inside the image.
+  const int32_t offsets[8] = {-(int32_t)dst_stride - 1, -(int32_t)dst_stride,
+                              -(int32_t)dst_stride + 1, -1, 1, (int32_t)dst_stride - 1,
+                              (int32_t)dst_stride, (int32_t)dst_stride + 1};
+  while (!strong.empty()) {
+    const uint32_t p = strong.back();
+    strong.pop_back();
+    for (int i = 0; i < 8; i++) {
+      const uint32_t q = p + offsets[i];
+      if (dst[q] == 1) {
+        dst[q] = 255;
+        strong.push_back(q);
+      }
+    }
+  }
+  auto clear_rows = [&](uint32_t row_begin, uint32_t row_end) {
+    for (uint32_t y = row_begin; y < row_end; y++) {
+      uint8_t *out = dst + y * dst_stride;
+      uint32_t x = 0;
+#ifndef CV180X
+      const uint8x16_t strong_v = vdupq_n_u8(255);
+      for (; x + 16 <= width; x += 16) {
+        vst1q_u8(out + x, vceqq_u8(vld1q_u8(out + x), strong_v));
+      }
+#endif
+      for (; x < width; x++) {
+        out[x] = out[x] == 255 ? 255 : 0;
+      }
+    }
+  };
+  parallelRows(height, width, clear_rows);
+  CVI_IVE_BufFlush(pIveHandle, pstDst);
+  return CVI_SUCCESS;
+}
+
+// 3x3 Sobel gradients of row y in [1, height - 1), 0 at column 0 and width - 1.
+static void sobel3x3_row_s16(const uint8_t *src, const uint32_t stride, const uint32_t y,
+                             const uint32_t width, int16_t *gx, int16_t *gy) {
+  const uint8_t *r0 = src + (y - 1) * stride, *r1 = src + y * stride, *r2 = src + (y + 1) * stride;
+  gx[0] = gy[0] = gx[width - 1] = gy[width - 1] = 0;
+  uint32_t x = 1;
+#ifndef CV180X
+  for (; x + 9 <= width; x += 8) {
+    int16x8_t d0 = vreinterpretq_s16_u16(vsubl_u8(vld1_u8(r0 + x + 1), vld1_u8(r0 + x - 1)));
+    int16x8_t d1 = vreinterpretq_s16_u16(vsubl_u8(vld1_u8(r1 + x + 1), vld1_u8(r1 + x - 1)));
+    int16x8_t d2 = vreinterpretq_s16_u16(vsubl_u8(vld1_u8(r2 + x + 1), vld1_u8(r2 + x - 1)));
+    vst1q_s16(gx + x, vaddq_s16(vaddq_s16(d0, d2), vshlq_n_s16(d1, 1)));
+    uint16x8_t s0 = vaddq_u16(vaddl_u8(vld1_u8(r0 + x - 1), vld1_u8(r0 + x + 1)),
+                              vshll_n_u8(vld1_u8(r0 + x), 1));
+    uint16x8_t s2 = vaddq_u16(vaddl_u8(vld1_u8(r2 + x - 1), vld1_u8(r2 + x + 1)),
+                              vshll_n_u8(vld1_u8(r2 + x), 1));
+    vst1q_s16(gy + x, vreinterpretq_s16_u16(vsubq_u16(s2, s0)));
+  }
+#endif
+  for (; x + 1 < width; x++) {
+    gx[x] = (r0[x + 1] - r0[x - 1]) + 2 * (r1[x + 1] - r1[x - 1]) + (r2[x + 1] - r2[x - 1]);
+    gy[x] = (r2[x - 1] + 2 * r2[x] + r2[x + 1]) - (r0[x - 1] + 2 * r0[x] + r0[x + 1]);
+  }
+}
+
+// Adds (sign 1) or subtracts (sign -1) the gradient products of a row to the column sums.
+static void corner_col_update(const int16_t *gx, const int16_t *gy, const uint32_t width,
+                              const int32_t sign, int32_t *sum_xx, int32_t *sum_xy,
+                              int32_t *sum_yy) {
+  uint32_t x = 0;
+#ifndef CV180X
+  for (; x + 4 <= width; x += 4) {
+    int16x4_t dx = vld1_s16(gx + x), dy = vld1_s16(gy + x);
+    int32x4_t xx = vld1q_s32(sum_xx + x), xy = vld1q_s32(sum_xy + x), yy = vld1q_s32(sum_yy + x);
+    if (sign > 0) {
+      xx = vmlal_s16(xx, dx, dx);
+      xy = vmlal_s16(xy, dx, dy);
+      yy = vmlal_s16(yy, dy, dy);
+    } else {
+      xx = vmlsl_s16(xx, dx, dx);
+      xy = vmlsl_s16(xy, dx, dy);
+      yy = vmlsl_s16(yy, dy, dy);
+    }
+    vst1q_s32(sum_xx + x, xx);
+    vst1q_s32(sum_xy + x, xy);
+    vst1q_s32(sum_yy + x, yy);
+  }
+#endif
+  for (; x < width; x++) {
+    sum_xx[x] += sign * gx[x] * gx[x];
+    sum_xy[x] += sign * gx[x] * gy[x];
+    sum_yy[x] += sign * gy[x] * gy[x];
+  }
+}
+
+// Harris or Shi-Tomasi scores of the rows in [row_begin, row_end), 0 within 1 + block / 2 of the
+// border.
+static void corner_matrix_rows(const IVE_IMAGE_S *src, const uint32_t block, const bool harris,
+                               const float k, const uint32_t row_begin, const uint32_t row_end,
+                               float *score) {
+  const uint32_t width = src->u32Width, height = src->u32Height, stride = src->u16Stride[0];
+  const uint32_t half = block / 2, margin = half + 1;
+  const uint32_t y_begin = std::max(row_begin, margin);
+  const uint32_t y_end = std::min(row_end, height > margin ? height - margin : 0);
+  if (y_begin >= y_end || width <= 2 * margin) return;
+  // Gradients of the window rows in a ring indexed by row % block.
+  std::vector<int16_t> gx((size_t)block * width), gy((size_t)block * width);
+  std::vector<int32_t> sum_xx(width, 0), sum_xy(width, 0), sum_yy(width, 0);
+  for (uint32_t r = y_begin - half; r <= y_begin + half; r++) {
+    int16_t *dx = gx.data() + (r % block) * width, *dy = gy.data() + (r % block) * width;
+    sobel3x3_row_s16(src->pu8VirAddr[0], stride, r, width, dx, dy);
+    corner_col_update(dx, dy, width, 1, sum_xx.data(), sum_xy.data(), sum_yy.data());
+  }
+  // Gradients are normalized to [-1, 1] and the products averaged over the window.
+  const float scale = 1.f / (16.f * 255.f * 255.f * block * block);
+  for (uint32_t y = y_begin; y < y_end; y++) {
+    if (y > y_begin) {
+      // Row y + half replaces row y - half - 1 in the same ring slot.
+      const uint32_t slot = ((y + half) % block) * width;
+      int16_t *dx = gx.data() + slot, *dy = gy.data() + slot;
+      corner_col_update(dx, dy, width, -1, sum_xx.data(), sum_xy.data(), sum_yy.data());
+      sobel3x3_row_s16(src->pu8VirAddr[0], stride, y + half, width, dx, dy);
+      corner_col_update(dx, dy, width, 1, sum_xx.data(), sum_xy.data(), sum_yy.data());
+    }
+    int32_t sxx = 0, sxy = 0, syy = 0;
+    for (uint32_t x = 1; x < block; x++) {
+      sxx += sum_xx[x];
+      sxy += sum_xy[x];
+      syy += sum_yy[x];
+    }
+    float *score_row = score + (size_t)y * width;
+    for (uint32_t x = margin; x + margin < width; x++) {
+      sxx += sum_xx[x + half];
+      sxy += sum_xy[x + half];
+      syy += sum_yy[x + half];
+      const float a = sxx * scale, b = sxy * scale, c = syy * scale;
+      score_row[x] = harris ? a * c - b * b - k * (a + c) * (a + c)
+                            : (a + c) * 0.5f - std::sqrt((a - c) * (a - c) * 0.25f + b * b);
+      sxx -= sum_xx[x - half];
+      sxy -= sum_xy[x - half];
+      syy -= sum_yy[x - half];
+    }
+  }
+}
+
+// Largest t for which 9 contiguous pixels of the circle are all brighter or all darker than the
+// center by more than t.
+static int fast_score(const uint8_t *p, const int32_t *circle) {
+  int diff[16];
+  for (int i = 0; i < 16; i++) {
+    diff[i] = p[circle[i]] - p[0];
+  }
+  int best = 0;
+  for (int start = 0; start < 16; start++) {
+    int bright = 255, dark = 255;
+    for (int i = 0; i < 9; i++) {
+      bright = std::min(bright, diff[(start + i) & 15]);
+      dark = std::min(dark, -diff[(start + i) & 15]);
+    }
+    best = std::max(best, std::max(bright, dark));
+  }
+  return best;
+}
+
+// FAST-9 scores of the rows in [row_begin, row_end), 0 for non corners and within 3 pixels of the
+// border.
+static void corner_fast_rows(const IVE_IMAGE_S *src, const uint8_t thr, const uint32_t row_begin,
+                             const uint32_t row_end, float *score) {
+  const uint32_t width = src->u32Width, height = src->u32Height, stride = src->u16Stride[0];
+  static const int8_t dx[16] = {0, 1, 2, 3, 3, 3, 2, 1, 0, -1, -2, -3, -3, -3, -2, -1};
+  static const int8_t dy[16] = {-3, -3, -2, -1, 0, 1, 2, 3, 3, 3, 2, 1, 0, -1, -2, -3};
+  int32_t circle[16];
+  for (int i = 0; i < 16; i++) {
+    circle[i] = dy[i] * (int32_t)stride + dx[i];
+  }
+  const uint32_t y_begin = std::max(row_begin, 3u);
+  const uint32_t y_end = std::min(row_end, height > 3 ? height - 3 : 0);
+  for (uint32_t y = y_begin; y < y_end; y++) {
+    const uint8_t *row = src->pu8VirAddr[0] + y * stride;
+    float *score_row = score + (size_t)y * width;
+    uint32_t x = 3;
+#ifndef CV180X
+    const uint8x16_t thr_v = vdupq_n_u8(thr), one = vdupq_n_u8(1), nine = vdupq_n_u8(9);
+    for (; x + 16 + 3 <= width; x += 16) {
+      const uint8_t *p = row + x;
+      uint8x16_t c = vld1q_u8(p);
+      uint8x16_t hi = vqaddq_u8(c, thr_v), lo = vqsubq_u8(c, thr_v);
+      // An arc of 9 covers at least 2 of the pixels 0, 4, 8 and 12.
+      uint8x16_t bright_num = vdupq_n_u8(0), dark_num = vdupq_n_u8(0);
+      for (int i = 0; i < 16; i += 4) {
+        uint8x16_t v = vld1q_u8(p + circle[i]);
+        bright_num = vsubq_u8(bright_num, vcgtq_u8(v, hi));
+        dark_num = vsubq_u8(dark_num, vcltq_u8(v, lo));
+      }
+      uint8x16_t cand = vorrq_u8(vcgeq_u8(bright_num, vdupq_n_u8(2)),
+                                 vcgeq_u8(dark_num, vdupq_n_u8(2)));
+      uint64x2_t cand64 = vreinterpretq_u64_u8(cand);
+      if ((vgetq_lane_u64(cand64, 0) | vgetq_lane_u64(cand64, 1)) == 0) continue;
+      uint8x16_t bright[16], dark[16];
+      for (int i = 0; i < 16; i++) {
+        uint8x16_t v = vld1q_u8(p + circle[i]);
+        bright[i] = vcgtq_u8(v, hi);
+        dark[i] = vcltq_u8(v, lo);
+      }
+      // Longest run of the circle, wrapped around.
+      uint8x16_t bright_run = vdupq_n_u8(0), dark_run = vdupq_n_u8(0);
+      uint8x16_t bright_max = vdupq_n_u8(0), dark_max = vdupq_n_u8(0);
+      for (int i = 0; i < 16 + 8; i++) {
+        bright_run = vandq_u8(vaddq_u8(bright_run, one), bright[i & 15]);
+        dark_run = vandq_u8(vaddq_u8(dark_run, one), dark[i & 15]);
+        bright_max = vmaxq_u8(bright_max, bright_run);
+        dark_max = vmaxq_u8(dark_max, dark_run);
+      }
+      uint8_t corner[16];
+      vst1q_u8(corner, vorrq_u8(vcgeq_u8(bright_max, nine), vcgeq_u8(dark_max, nine)));
+      for (int i = 0; i < 16; i++) {
+        if (corner[i]) score_row[x + i] = fast_score(p + i, circle);
+      }
+    }
+#endif
+    for (; x + 3 < width; x++) {
+      const uint8_t *p = row + x;
+      int bright_num = 0, dark_num = 0;
+      for (int i = 0; i < 16; i += 4) {
+        bright_num += p[circle[i]] > p[0] + thr;
+        dark_num += p[circle[i]] < p[0] - thr;
+      }
+      if (bright_num < 2 && dark_num < 2) continue;
+      const int s = fast_score(p, circle);
+      if (s > thr) score_row[x] = s;
+    }
+  }
+}
+
+CVI_S32 CVI_IVE_CornerDetect(IVE_HANDLE pIveHandle, IVE_SRC_IMAGE_S *pstSrc,
+                             IVE_CORNER_S *pstCorners, CVI_U32 u32MaxNum, CVI_U32 *pu32Num,
+                             IVE_CORNER_CTRL_S *pstCornerCtrl, bool bInstant) {
+  ScopedTrace t(__PRETTY_FUNCTION__);
+  if (!IsValidImageType(pstSrc, STRFY(pstSrc), IVE_IMAGE_TYPE_U8C1)) {
+    return CVI_FAILURE;
+  }
+  if (pstCorners == NULL || pu32Num == NULL) {
+    LOGE("pstCorners and pu32Num cannot be NULL.\n");
+    return CVI_FAILURE;
+  }
+  const IVE_CORNER_TYPE_E type = pstCornerCtrl->enType;
+  const uint32_t block = pstCornerCtrl->u8BlockSize;
+  const float thr = pstCornerCtrl->f32Thr;
+  uint32_t margin = 3;
+  if (type == IVE_CORNER_TYPE_HARRIS || type == IVE_CORNER_TYPE_SHI_TOMASI) {
+    if (block < 3 || block > 7 || block % 2 == 0) {
+      LOGE("Block size %u must be odd and in [3, 7].\n", block);
+      return CVI_FAILURE;
+    }
+    margin = block / 2 + 1;
+  } else if (type == IVE_CORNER_TYPE_FAST) {
+    if (thr < 0 || thr >= 255) {
+      LOGE("FAST threshold %f must be in [0, 255).\n", thr);
+      return CVI_FAILURE;
+    }
+  } else {
+    LOGE("Not supported corner type %d.\n", type);
+    return CVI_FAILURE;
+  }
+
+  CVI_IVE_BufRequest(pIveHandle, pstSrc);
+  const uint32_t width = pstSrc->u32Width, height = pstSrc->u32Height;
+  std::vector<float> score((size_t)width * height, 0.f);
+  auto score_rows = [&](uint32_t row_begin, uint32_t row_end) {
+    if (type == IVE_CORNER_TYPE_FAST) {
+      corner_fast_rows(pstSrc, (uint8_t)thr, row_begin, row_end, score.data());
+    } else {
+      corner_matrix_rows(pstSrc, block, type == IVE_CORNER_TYPE_HARRIS,
+                         pstCornerCtrl->f32HarrisK, row_begin, row_end, score.data());
+    }
+  };
+  parallelRows(height, width, score_rows);
+
+  // Local maxima in 3x3. Ties keep the first pixel in raster order.
+  std::vector<std::vector<IVE_CORNER_S>> row_corners(height);
+  auto nms_rows = [&](uint32_t row_begin, uint32_t row_end) {
+    for (uint32_t y = std::max(row_begin, margin); y < row_end && y + margin < height; y++) {
+      const float *s0 = score.data() + (size_t)(y - 1) * width;
+      const float *s1 = s0 + width, *s2 = s1 + width;
+      for (uint32_t x = margin; x + margin < width; x++) {
+        const float s = s1[x];
+        if (s > thr && s > s0[x - 1] && s > s0[x] && s > s0[x + 1] && s > s1[x - 1] &&
+            s >= s1[x + 1] && s >= s2[x - 1] && s >= s2[x] && s >= s2[x + 1]) {
+          row_corners[y].push_back({(CVI_U16)x, (CVI_U16)y, s});
+        }
+      }
+    }
+  };
+  parallelRows(height, width, nms_rows);
+
+  std::vector<IVE_CORNER_S> corners;
+  const uint32_t cell = pstCornerCtrl->u16CellSize;
+  if (cell == 0) {
+    for (uint32_t y = 0; y < height; y++) {
+      corners.insert(corners.end(), row_corners[y].begin(), row_corners[y].end());
+    }
+  } else {
+    const uint32_t cells_x = (width + cell - 1) / cell, cells_y = (height + cell - 1) / cell;
+    std::vector<int32_t> best((size_t)cells_x * cells_y, -1);
+    for (uint32_t y = 0; y < height; y++) {
+      for (const IVE_CORNER_S &corner : row_corners[y]) {
+        int32_t &b = best[(y / cell) * cells_x + corner.u16X / cell];
+        if (b < 0) {
+          b = corners.size();
+          corners.push_back(corner);
+        } else if (corner.f32Score > corners[b].f32Score) {
+          corners[b] = corner;
+        }
+      }
+    }
+  }
+  // Kept corners were pushed in raster order of their cells, restore the raster order of pixels
+  // for ties.
+  std::stable_sort(corners.begin(), corners.end(),
+                   [](const IVE_CORNER_S &a, const IVE_CORNER_S &b) {
+                     if (a.f32Score != b.f32Score) return a.f32Score > b.f32Score;
+                     return a.u16Y != b.u16Y ? a.u16Y < b.u16Y : a.u16X < b.u16X;
+                   });
+  *pu32Num = std::min((uint32_t)corners.size(), u32MaxNum);
+  std::copy(corners.begin(), corners.begin() + *pu32Num, pstCorners);
+  return CVI_SUCCESS;
+}
+
+// Source index of i for a line of n pixels, -1 for the constant border.
+static inline int32_t border_index(int32_t i, const int32_t n, const IVE_BORDER_MODE_E mode) {
+  if (i >= 0 && i < n) return i;
+  if (mode == IVE_BORDER_MODE_CONSTANT) return -1;
+  if (mode == IVE_BORDER_MODE_REPLICATE || n == 1) return i < 0 ? 0 : n - 1;
+  // Reflect 101, repeated for kernels wider than the line.
+  const int32_t period = 2 * (n - 1);
+  i = std::abs(i) % period;
+  return i < n ? i : period - i;
+}
+
+// Copy the virtual row v of a U8C1 image to pad with half border pixels on both sides.
+static void border_pad_row(const IVE_IMAGE_S *img, const int32_t v, const int32_t half,
+                           const IVE_BORDER_MODE_E mode, const uint8_t border_val, uint8_t *pad) {
+  const int32_t width = img->u32Width;
+  const int32_t src_y = border_index(v, img->u32Height, mode);
+  if (src_y < 0) {
+    memset(pad, border_val, width + 2 * half);
+    return;
+  }
+  const uint8_t *src = img->pu8VirAddr[0] + src_y * img->u16Stride[0];
+  memcpy(pad + half, src, width);
+  for (int32_t i = 1; i <= half; i++) {
+    int32_t l = border_index(-i, width, mode);
+    int32_t r = border_index(width - 1 + i, width, mode);
+    pad[half - i] = l < 0 ? border_val : src[l];
+    pad[half + width - 1 + i] = r < 0 ? border_val : src[r];
+  }
+}
+
+// inter[x] = sum of mask[k] * row[x + k - size / 2], rounded, shifted and saturated to 16 bits.
+// pad holds the row with size / 2 border pixels on both sides.
+static void sep_filter_row(const uint8_t *pad, const int16_t *mask, const uint32_t size,
+                           const int32_t shift, const uint32_t width, int16_t *inter) {
+  uint32_t x = 0;
+#ifndef CV180X
+  const int32x4_t shift_v = vdupq_n_s32(-shift);
+  for (; x + 8 <= width; x += 8) {
+    int32x4_t lo = vdupq_n_s32(0), hi = vdupq_n_s32(0);
+    for (uint32_t k = 0; k < size; k++) {
+      int16x8_t v = vreinterpretq_s16_u16(vmovl_u8(vld1_u8(pad + x + k)));
+      lo = vmlal_n_s16(lo, vget_low_s16(v), mask[k]);
+      hi = vmlal_n_s16(hi, vget_high_s16(v), mask[k]);
+    }
+    lo = vrshlq_s32(lo, shift_v);
+    hi = vrshlq_s32(hi, shift_v);
+    vst1q_s16(inter + x, vcombine_s16(vqmovn_s32(lo), vqmovn_s32(hi)));
+  }
+#endif
+  const int32_t round = shift > 0 ? 1 << (shift - 1) : 0;
+  for (; x < width; x++) {
+    int32_t sum = 0;
+    for (uint32_t k = 0; k < size; k++) {
+      sum += mask[k] * pad[x + k];
+    }
+    sum = (sum + round) >> shift;
+    inter[x] = std::min(std::max(sum, (int32_t)INT16_MIN), (int32_t)INT16_MAX);
+  }
+}
+
+// dst[x] = sum of mask[k] * rows[k][x], rounded, shifted and saturated to uint8_t or int16_t.
+template <typename T>
+static void sep_filter_col(const int16_t *const *rows, const int16_t *mask, const uint32_t size,
+                           const int32_t shift, const uint32_t width, T *dst) {
+  uint32_t x = 0;
+#ifndef CV180X
+  const int32x4_t shift_v = vdupq_n_s32(-shift);
+  for (; x + 8 <= width; x += 8) {
+    int32x4_t lo = vdupq_n_s32(0), hi = vdupq_n_s32(0);
+    for (uint32_t k = 0; k < size; k++) {
+      int16x8_t v = vld1q_s16(rows[k] + x);
+      lo = vmlal_n_s16(lo, vget_low_s16(v), mask[k]);
+      hi = vmlal_n_s16(hi, vget_high_s16(v), mask[k]);
+    }
+    lo = vrshlq_s32(lo, shift_v);
+    hi = vrshlq_s32(hi, shift_v);
+    if (std::is_same<T, uint8_t>::value) {
+      vst1_u8((uint8_t *)dst + x, vqmovn_u16(vcombine_u16(vqmovun_s32(lo), vqmovun_s32(hi))));
+    } else {
+      vst1q_s16((int16_t *)dst + x, vcombine_s16(vqmovn_s32(lo), vqmovn_s32(hi)));
+    }
+  }
+#endif
+  const int32_t round = shift > 0 ? 1 << (shift - 1) : 0;
+  for (; x < width; x++) {
+    int32_t sum = 0;
+    for (uint32_t k = 0; k < size; k++) {
+      sum += mask[k] * rows[k][x];
+    }
+    sum = (sum + round) >> shift;
+    dst[x] = std::min(std::max(sum, (int32_t)std::numeric_limits<T>::min()),
+                      (int32_t)std::numeric_limits<T>::max());
+  }
+}
+
+CVI_S32 CVI_IVE_SepFilter(IVE_HANDLE pIveHandle, IVE_SRC_IMAGE_S *pstSrc, IVE_DST_IMAGE_S *pstDst,
+                          IVE_SEP_FILTER_CTRL_S *pstSepCtrl, bool bInstant) {
+  ScopedTrace t(__PRETTY_FUNCTION__);
+  if (!IsValidImageType(pstSrc, STRFY(pstSrc), IVE_IMAGE_TYPE_U8C1)) {
+    return CVI_FAILURE;
+  }
+  if (!IsValidImageType(pstDst, STRFY(pstDst), IVE_IMAGE_TYPE_U8C1, IVE_IMAGE_TYPE_S16C1)) {
+    return CVI_FAILURE;
+  }
+  const uint32_t width = pstSrc->u32Width, height = pstSrc->u32Height;
+  if (pstDst->u32Width != width || pstDst->u32Height != height) {
+    LOGE("pstSrc and pstDst must have the same size.\n");
+    return CVI_FAILURE;
+  }
+  const uint32_t row_size = pstSepCtrl->u8RowSize, col_size = pstSepCtrl->u8ColSize;
+  if (row_size == 0 || row_size > IVE_SEP_FILTER_MAX_SIZE || row_size % 2 == 0 ||
+      col_size == 0 || col_size > IVE_SEP_FILTER_MAX_SIZE || col_size % 2 == 0) {
+    LOGE("Kernel sizes %u x %u must be odd and in [1, %d].\n", row_size, col_size,
+         IVE_SEP_FILTER_MAX_SIZE);
+    return CVI_FAILURE;
+  }
+  if (pstSepCtrl->u8RowShift > 30 || pstSepCtrl->u8ColShift > 30) {
+    LOGE("Shifts %u and %u must not exceed 30.\n", pstSepCtrl->u8RowShift,
+         pstSepCtrl->u8ColShift);
+    return CVI_FAILURE;
+  }
+  const IVE_BORDER_MODE_E border = pstSepCtrl->enBorder;
+  if (border >= IVE_BORDER_MODE_BUTT) {
+    LOGE("Not supported border mode %d.\n", border);
+    return CVI_FAILURE;
+  }
+
+  CVI_IVE_BufRequest(pIveHandle, pstSrc);
+  const int32_t row_half = row_size / 2, col_half = col_size / 2;
+  const bool to_u8 = pstDst->enType == IVE_IMAGE_TYPE_U8C1;
+  auto filter_rows = [&](uint32_t row_begin, uint32_t row_end) {
+    // Row filtered lines of the virtual rows [row_begin - col_half, row_end + col_half) in a ring,
+    // virtual rows outside the image follow the border mode.
+    std::vector<int16_t> ring((size_t)col_size * width);
+    std::vector<uint8_t> pad(width + 2 * row_half);
+    std::vector<const int16_t *> rows(col_size);
+    const int32_t base = (int32_t)row_begin - col_half;
+    auto filter_line = [&](int32_t v) {
+      border_pad_row(pstSrc, v, row_half, border, pstSepCtrl->u8BorderVal, pad.data());
+      sep_filter_row(pad.data(), pstSepCtrl->as16RowMask, row_size, pstSepCtrl->u8RowShift, width,
+                     ring.data() + ((v - base) % col_size) * width);
+    };
+    for (int32_t v = base; v < (int32_t)row_begin + col_half; v++) {
+      filter_line(v);
+    }
+    for (uint32_t y = row_begin; y < row_end; y++) {
+      filter_line(y + col_half);
+      for (int32_t k = 0; k < (int32_t)col_size; k++) {
+        rows[k] = ring.data() + ((y - col_half + k - base) % col_size) * width;
+      }
+      uint8_t *dst = pstDst->pu8VirAddr[0] + y * pstDst->u16Stride[0];
+      if (to_u8) {
+        sep_filter_col(rows.data(), pstSepCtrl->as16ColMask, col_size, pstSepCtrl->u8ColShift,
+                       width, dst);
+      } else {
+        sep_filter_col(rows.data(), pstSepCtrl->as16ColMask, col_size, pstSepCtrl->u8ColShift,
+                       width, (int16_t *)dst);
+      }
+    }
+  };
+  parallelRows(height, (uint64_t)width * (row_size + col_size) / 4, filter_rows);
+  CVI_IVE_BufFlush(pIveHandle, pstDst);
+  return CVI_SUCCESS;
+}
+
+CVI_S32 CVI_IVE_InitGaussianSepFilterCtrl(CVI_FLOAT f32Sigma, CVI_U8 u8Size,
+                                          IVE_SEP_FILTER_CTRL_S *pstSepCtrl) {
+  if (!(f32Sigma > 0)) {
+    LOGE("Sigma %f must be positive.\n", f32Sigma);
+    return CVI_FAILURE;
+  }
+  uint32_t size = u8Size;
+  if (size == 0) {
+    size = std::min(2 * (uint32_t)std::ceil(3 * f32Sigma) + 1, (uint32_t)IVE_SEP_FILTER_MAX_SIZE);
+  }
+  if (size > IVE_SEP_FILTER_MAX_SIZE || size % 2 == 0) {
+    LOGE("Kernel size %u must be odd and in [1, %d].\n", size, IVE_SEP_FILTER_MAX_SIZE);
+    return CVI_FAILURE;
+  }
+  const int32_t half = size / 2;
+  float weight[IVE_SEP_FILTER_MAX_SIZE], sum = 0;
+  for (int32_t i = 0; i < (int32_t)size; i++) {
+    weight[i] = std::exp(-(float)((i - half) * (i - half)) / (2 * f32Sigma * f32Sigma));
+    sum += weight[i];
+  }
+  // The rounding error goes to the center tap so that the masks sum to exactly 4096.
+  int32_t total = 0;
+  memset(pstSepCtrl, 0, sizeof(IVE_SEP_FILTER_CTRL_S));
+  for (int32_t i = 0; i < (int32_t)size; i++) {
+    pstSepCtrl->as16RowMask[i] = (CVI_S16)std::lround(weight[i] / sum * 4096);
+    total += pstSepCtrl->as16RowMask[i];
+  }
+  pstSepCtrl->as16RowMask[half] += 4096 - total;
+  memcpy(pstSepCtrl->as16ColMask, pstSepCtrl->as16RowMask, sizeof(pstSepCtrl->as16RowMask));
+  pstSepCtrl->u8RowSize = size;
+  pstSepCtrl->u8ColSize = size;
+  // 255 * 4096 >> 5 still fits in 16 bits, the column pass removes the remaining 19 bits.
+  pstSepCtrl->u8RowShift = 5;
+  pstSepCtrl->u8ColShift = 19;
+  pstSepCtrl->enBorder = IVE_BORDER_MODE_REFLECT_101;
+  return CVI_SUCCESS;
+}
+
+// sum[x] += add[x] - sub[x] and sq[x] += add[x]^2 - sub[x]^2. sub and sq may be NULL.
+static void box_col_update(const uint8_t *add, const uint8_t *sub, const uint32_t n,
+                           uint32_t *sum, uint32_t *sq) {
+  uint32_t x = 0;
+#ifndef CV180X
+  for (; x + 8 <= n; x += 8) {
+    uint8x8_t a = vld1_u8(add + x);
+    uint16x8_t a16 = vmovl_u8(a);
+    uint32x4_t s_lo = vaddw_u16(vld1q_u32(sum + x), vget_low_u16(a16));
+    uint32x4_t s_hi = vaddw_u16(vld1q_u32(sum + x + 4), vget_high_u16(a16));
+    uint8x8_t b = vdup_n_u8(0);
+    if (sub) {
+      b = vld1_u8(sub + x);
+      uint16x8_t b16 = vmovl_u8(b);
+      s_lo = vsubw_u16(s_lo, vget_low_u16(b16));
+      s_hi = vsubw_u16(s_hi, vget_high_u16(b16));
+    }
+    vst1q_u32(sum + x, s_lo);
+    vst1q_u32(sum + x + 4, s_hi);
+    if (sq) {
+      uint16x8_t a2 = vmull_u8(a, a), b2 = vmull_u8(b, b);
+      uint32x4_t q_lo = vaddw_u16(vld1q_u32(sq + x), vget_low_u16(a2));
+      uint32x4_t q_hi = vaddw_u16(vld1q_u32(sq + x + 4), vget_high_u16(a2));
+      vst1q_u32(sq + x, vsubw_u16(q_lo, vget_low_u16(b2)));
+      vst1q_u32(sq + x + 4, vsubw_u16(q_hi, vget_high_u16(b2)));
+    }
+  }
+#endif
+  for (; x < n; x++) {
+    const uint32_t a = add[x], b = sub ? sub[x] : 0;
+    sum[x] += a - b;
+    if (sq) sq[x] += a * a - b * b;
+  }
+}
+
+CVI_S32 CVI_IVE_BoxFilter(IVE_HANDLE pIveHandle, IVE_SRC_IMAGE_S *pstSrc,
+                          IVE_DST_IMAGE_S *pstDstMean, IVE_DST_IMAGE_S *pstDstVar,
+                          IVE_BOX_FILTER_CTRL_S *pstBoxCtrl, bool bInstant) {
+  ScopedTrace t(__PRETTY_FUNCTION__);
+  if (!IsValidImageType(pstSrc, STRFY(pstSrc), IVE_IMAGE_TYPE_U8C1)) {
+    return CVI_FAILURE;
+  }
+  if (!IsValidImageType(pstDstMean, STRFY(pstDstMean), IVE_IMAGE_TYPE_U8C1, IVE_IMAGE_TYPE_U16C1,
+                        IVE_IMAGE_TYPE_FP32C1)) {
+    return CVI_FAILURE;
+  }
+  if (pstDstVar != NULL &&
+      !IsValidImageType(pstDstVar, STRFY(pstDstVar), IVE_IMAGE_TYPE_U16C1, IVE_IMAGE_TYPE_FP32C1)) {
+    return CVI_FAILURE;
+  }
+  const uint32_t width = pstSrc->u32Width, height = pstSrc->u32Height;
+  if (pstDstMean->u32Width != width || pstDstMean->u32Height != height ||
+      (pstDstVar != NULL && (pstDstVar->u32Width != width || pstDstVar->u32Height != height))) {
+    LOGE("pstSrc and the outputs must have the same size.\n");
+    return CVI_FAILURE;
+  }
+  const uint32_t win_w = pstBoxCtrl->u8Width, win_h = pstBoxCtrl->u8Height;
+  if (win_w % 2 == 0 || win_h % 2 == 0) {
+    LOGE("Window size %u x %u must be odd.\n", win_w, win_h);
+    return CVI_FAILURE;
+  }
+  const IVE_BORDER_MODE_E border = pstBoxCtrl->enBorder;
+  if (border >= IVE_BORDER_MODE_BUTT) {
+    LOGE("Not supported border mode %d.\n", border);
+    return CVI_FAILURE;
+  }
+
+  CVI_IVE_BufRequest(pIveHandle, pstSrc);
+  // With at most 255x255 pixels the sum of squares fits in 32 bits and n * sq - sum^2 in 64 bits.
+  const int32_t half_w = win_w / 2, half_h = win_h / 2;
+  const uint32_t pad_w = width + win_w - 1;
+  const uint64_t n = (uint64_t)win_w * win_h;
+  const bool with_var = pstDstVar != NULL;
+  auto box_rows = [&](uint32_t row_begin, uint32_t row_end) {
+    std::vector<uint32_t> col_sum(pad_w, 0), col_sq(with_var ? pad_w : 0, 0);
+    std::vector<uint32_t> sum(width), sq(with_var ? width : 0);
+    std::vector<uint8_t> add(pad_w), sub(pad_w);
+    uint32_t *sq_ptr = with_var ? col_sq.data() : NULL;
+    for (int32_t v = (int32_t)row_begin - half_h; v < (int32_t)row_begin + half_h; v++) {
+      border_pad_row(pstSrc, v, half_w, border, pstBoxCtrl->u8BorderVal, add.data());
+      box_col_update(add.data(), NULL, pad_w, col_sum.data(), sq_ptr);
+    }
+    for (uint32_t y = row_begin; y < row_end; y++) {
+      border_pad_row(pstSrc, y + half_h, half_w, border, pstBoxCtrl->u8BorderVal, add.data());
+      if (y == row_begin) {
+        box_col_update(add.data(), NULL, pad_w, col_sum.data(), sq_ptr);
+      } else {
+        border_pad_row(pstSrc, (int32_t)y - half_h - 1, half_w, border, pstBoxCtrl->u8BorderVal,
+                       sub.data());
+        box_col_update(add.data(), sub.data(), pad_w, col_sum.data(), sq_ptr);
+      }
+      // Slide the horizontal window over the column sums.
+      uint32_t s = 0, q = 0;
+      for (uint32_t k = 0; k < win_w; k++) {
+        s += col_sum[k];
+        if (with_var) q += col_sq[k];
+      }
+      for (uint32_t x = 0;; x++) {
+        sum[x] = s;
+        if (with_var) sq[x] = q;
+        if (x + 1 == width) break;
+        s += col_sum[x + win_w] - col_sum[x];
+        if (with_var) q += col_sq[x + win_w] - col_sq[x];
+      }
+      uint8_t *mean = pstDstMean->pu8VirAddr[0] + y * pstDstMean->u16Stride[0];
+      if (pstDstMean->enType == IVE_IMAGE_TYPE_U8C1) {
+        for (uint32_t x = 0; x < width; x++) {
+          mean[x] = (sum[x] + n / 2) / n;
+        }
+      } else if (pstDstMean->enType == IVE_IMAGE_TYPE_U16C1) {
+        for (uint32_t x = 0; x < width; x++) {
+          ((uint16_t *)mean)[x] = (((uint64_t)sum[x] << 8) + n / 2) / n;
+        }
+      } else {
+        const float inv_n = 1.f / n;
+        for (uint32_t x = 0; x < width; x++) {
+          ((float *)mean)[x] = sum[x] * inv_n;
+        }
+      }
+      if (!with_var) continue;
+      uint8_t *var = pstDstVar->pu8VirAddr[0] + y * pstDstVar->u16Stride[0];
+      const uint64_t n2 = n * n;
+      for (uint32_t x = 0; x < width; x++) {
+        const uint64_t d = n * sq[x] - (uint64_t)sum[x] * sum[x];
+        if (pstDstVar->enType == IVE_IMAGE_TYPE_U16C1) {
+          ((uint16_t *)var)[x] = (d + n2 / 2) / n2;
+        } else {
+          ((float *)var)[x] = (float)((double)d / n2);
+        }
+      }
+    }
+  };
+  parallelRows(height, with_var ? 2 * width : width, box_rows);
+  CVI_IVE_BufFlush(pIveHandle, pstDstMean);
+  if (with_var) {
+    CVI_IVE_BufFlush(pIveHandle, pstDstVar);
+  }
+  return CVI_SUCCESS;
+}
+
+template <bool ERODE>
+static inline uint8_t morph_op(const uint8_t a, const uint8_t b) {
+  return ERODE ? std::min(a, b) : std::max(a, b);
+}
+
+#ifndef CV180X
+template <bool ERODE>
+static inline uint8x16_t morph_op(const uint8x16_t a, const uint8x16_t b) {
+  return ERODE ? vminq_u8(a, b) : vmaxq_u8(a, b);
+}
+#endif
+
+// Van Herk/Gil-Werman running min or max over [x - half, x + half] of a row of n pixels. The row is
+// virtually padded with half identity pixels on both sides and split into blocks of 2 * half + 1.
+// g holds the prefix within each block, the suffix is kept while walking back. g holds n + 2 * half
+// bytes.
+template <bool ERODE>
+static void morph_vhgw_row(const uint8_t *src, const uint32_t n, const uint32_t half, uint8_t *g,
+                           uint8_t *dst) {
+  const uint8_t id = ERODE ? 255 : 0;
+  const uint32_t len = n + 2 * half, k = 2 * half + 1;
+  auto pad = [&](uint32_t i) { return i < half || i >= n + half ? id : src[i - half]; };
+  for (uint32_t i = 0; i < len; i++) {
+    g[i] = i % k == 0 ? pad(i) : morph_op<ERODE>(g[i - 1], pad(i));
+  }
+  uint8_t h = id;
+  for (uint32_t i = len; i-- > 0;) {
+    h = (i % k == k - 1 || i == len - 1) ? pad(i) : morph_op<ERODE>(h, pad(i));
+    if (i < n) dst[i] = morph_op<ERODE>(h, g[i + k - 1]);
+  }
+}
+
+// The same over [y - half, y + half] for the columns [x0, x1) of a U8 plane with height rows,
+// vectorized across the columns. g holds (height + 2 * half) * (x1 - x0) bytes. dst can be src.
+template <bool ERODE>
+static void morph_vhgw_cols(const uint8_t *src, const uint32_t src_stride, const uint32_t height,
+                            const uint32_t x0, const uint32_t x1, const uint32_t half, uint8_t *g,
+                            uint8_t *dst, const uint32_t dst_stride) {
+  const uint8_t id = ERODE ? 255 : 0;
+  const uint32_t len = height + 2 * half, k = 2 * half + 1, w = x1 - x0;
+  std::vector<uint8_t> id_row(w, id), h(w);
+  auto pad = [&](uint32_t i) {
+    return i < half || i >= height + half ? id_row.data() : src + (i - half) * src_stride + x0;
+  };
+  // out = op(a, b) over the strip.
+  auto op_row = [&](const uint8_t *a, const uint8_t *b, uint8_t *out) {
+    uint32_t x = 0;
+#ifndef CV180X
+    for (; x + 16 <= w; x += 16) {
+      vst1q_u8(out + x, morph_op<ERODE>(vld1q_u8(a + x), vld1q_u8(b + x)));
+    }
+#endif
+    for (; x < w; x++) {
+      out[x] = morph_op<ERODE>(a[x], b[x]);
+    }
+  };
+  for (uint32_t i = 0; i < len; i++) {
+    if (i % k == 0) {
+      memcpy(g + i * w, pad(i), w);
+    } else {
+      op_row(g + (i - 1) * w, pad(i), g + i * w);
+    }
+  }
+  for (uint32_t i = len; i-- > 0;) {
+    if (i % k == k - 1 || i == len - 1) {
+      memcpy(h.data(), pad(i), w);
+    } else {
+      op_row(h.data(), pad(i), h.data());
+    }
+    // Row i is read after the rows above it were written, so dst can be src.
+    if (i < height) op_row(h.data(), g + (i + k - 1) * w, dst + i * dst_stride + x0);
+  }
+}
+
+// Rectangle with half sizes (half_w, half_h) from the row pass into tmp and the column pass into
+// dst. tmp has the size of the image with stride width. parallel splits both passes over threads.
+template <bool ERODE>
+static void morph_rect(const uint8_t *src, const uint32_t src_stride, const uint32_t width,
+                       const uint32_t height, const uint32_t half_w, const uint32_t half_h,
+                       uint8_t *tmp, uint8_t *dst, const uint32_t dst_stride, const bool parallel) {
+  const uint8_t *rows = src;
+  uint32_t rows_stride = src_stride;
+  if (half_w > 0) {
+    auto row_pass = [&](uint32_t row_begin, uint32_t row_end) {
+      std::vector<uint8_t> g(width + 2 * half_w);
+      for (uint32_t y = row_begin; y < row_end; y++) {
+        morph_vhgw_row<ERODE>(src + y * src_stride, width, half_w, g.data(), tmp + y * width);
+      }
+    };
+    if (parallel) {
+      parallelRows(height, width, row_pass);
+    } else {
+      row_pass(0, height);
+    }
+    rows = tmp;
+    rows_stride = width;
+  }
+  if (half_h == 0) {
+    for (uint32_t y = 0; y < height; y++) {
+      memmove(dst + y * dst_stride, rows + y * rows_stride, width);
+    }
+    return;
+  }
+  // Column strips of 16 pixels in parallel.
+  auto col_pass = [&](uint32_t strip_begin, uint32_t strip_end) {
+    const uint32_t x0 = strip_begin * 16, x1 = std::min(strip_end * 16, width);
+    std::vector<uint8_t> g((size_t)(height + 2 * half_h) * (x1 - x0));
+    morph_vhgw_cols<ERODE>(rows, rows_stride, height, x0, x1, half_h, g.data(), dst, dst_stride);
+  };
+  const uint32_t strips = (width + 15) / 16;
+  if (parallel) {
+    parallelRows(strips, (uint64_t)16 * height, col_pass);
+  } else {
+    col_pass(0, strips);
+  }
+}
+
+// dst = op over the rectangles with the given half sizes. dst can be src, several rectangles are
+// combined in a separate buffer.
+template <bool ERODE>
+static void morph_rects(const uint8_t *src, const uint32_t src_stride, const uint32_t width,
+                        const uint32_t height,
+                        const std::vector<std::pair<uint32_t, uint32_t>> &rects, uint8_t *dst,
+                        const uint32_t dst_stride, const bool parallel) {
+  std::vector<uint8_t> tmp((size_t)width * height);
+  if (rects.size() == 1) {
+    morph_rect<ERODE>(src, src_stride, width, height, rects[0].first, rects[0].second, tmp.data(),
+                      dst, dst_stride, parallel);
+    return;
+  }
+  std::vector<uint8_t> acc((size_t)width * height), out((size_t)width * height);
+  for (size_t i = 0; i < rects.size(); i++) {
+    uint8_t *res = i == 0 ? acc.data() : out.data();
+    morph_rect<ERODE>(src, src_stride, width, height, rects[i].first, rects[i].second, tmp.data(),
+                      res, width, parallel);
+    if (i == 0) continue;
+    size_t x = 0;
+#ifndef CV180X
+    for (; x + 16 <= acc.size(); x += 16) {
+      vst1q_u8(&acc[x], morph_op<ERODE>(vld1q_u8(&acc[x]), vld1q_u8(&out[x])));
+    }
+#endif
+    for (; x < acc.size(); x++) {
+      acc[x] = morph_op<ERODE>(acc[x], out[x]);
+    }
+  }
+  for (uint32_t y = 0; y < height; y++) {
+    memcpy(dst + y * dst_stride, acc.data() + y * width, width);
+  }
+}
+
+// dst = a - b saturated over rows rows.
+static void morph_sub(const uint8_t *a, const uint32_t a_stride, const uint8_t *b,
+                      const uint32_t b_stride, const uint32_t width, const uint32_t rows,
+                      uint8_t *dst, const uint32_t dst_stride) {
+  for (uint32_t y = 0; y < rows; y++) {
+    const uint8_t *pa = a + y * a_stride, *pb = b + y * b_stride;
+    uint8_t *out = dst + y * dst_stride;
+    uint32_t x = 0;
+#ifndef CV180X
+    for (; x + 16 <= width; x += 16) {
+      vst1q_u8(out + x, vqsubq_u8(vld1q_u8(pa + x), vld1q_u8(pb + x)));
+    }
+#endif
+    for (; x < width; x++) {
+      out[x] = pa[x] > pb[x] ? pa[x] - pb[x] : 0;
+    }
+  }
+}
+
+// Output rows [b0, b1) of a compound operation. The first pass is exact on the rows [f0, f1) that
+// are at most ry away from the band, so it reads a halo of 2 * ry rows of src on each side (ry for
+// the gradient, which has a single pass). Both passes and the subtraction go through band sized
+// buffers.
+static void morph_compound_band(const IVE_MORPH_OP_E op, const uint8_t *src,
+                                const uint32_t src_stride, const uint32_t width,
+                                const uint32_t height,
+                                const std::vector<std::pair<uint32_t, uint32_t>> &rects,
+                                const uint32_t ry, const uint32_t b0, const uint32_t b1,
+                                uint8_t *dst, const uint32_t dst_stride) {
+  const uint32_t f0 = b0 > ry ? b0 - ry : 0, f1 = std::min(height, b1 + ry);
+  const uint32_t rows = b1 - b0;
+  uint8_t *out = dst + b0 * dst_stride;
+  if (op == IVE_MORPH_OP_GRADIENT) {
+    std::vector<uint8_t> dilated((size_t)(f1 - f0) * width), eroded((size_t)(f1 - f0) * width);
+    morph_rects<false>(src + f0 * src_stride, src_stride, width, f1 - f0, rects, dilated.data(),
+                       width, false);
+    morph_rects<true>(src + f0 * src_stride, src_stride, width, f1 - f0, rects, eroded.data(),
+                      width, false);
+    morph_sub(dilated.data() + (b0 - f0) * width, width, eroded.data() + (b0 - f0) * width, width,
+              width, rows, out, dst_stride);
+    return;
+  }
+  const uint32_t s0 = f0 > ry ? f0 - ry : 0, s1 = std::min(height, f1 + ry);
+  std::vector<uint8_t> first((size_t)(s1 - s0) * width), second((size_t)(f1 - f0) * width);
+  const uint8_t *in = src + s0 * src_stride;
+  const uint8_t *mid = first.data() + (f0 - s0) * width;
+  if (op == IVE_MORPH_OP_OPEN || op == IVE_MORPH_OP_TOPHAT) {
+    morph_rects<true>(in, src_stride, width, s1 - s0, rects, first.data(), width, false);
+    morph_rects<false>(mid, width, width, f1 - f0, rects, second.data(), width, false);
+  } else {
+    morph_rects<false>(in, src_stride, width, s1 - s0, rects, first.data(), width, false);
+    morph_rects<true>(mid, width, width, f1 - f0, rects, second.data(), width, false);
+  }
+  const uint8_t *res = second.data() + (b0 - f0) * width;
+  if (op == IVE_MORPH_OP_TOPHAT) {
+    morph_sub(src + b0 * src_stride, src_stride, res, width, width, rows, out, dst_stride);
+  } else if (op == IVE_MORPH_OP_BLACKHAT) {
+    morph_sub(res, width, src + b0 * src_stride, src_stride, width, rows, out, dst_stride);
+  } else {
+    for (uint32_t y = 0; y < rows; y++) {
+      memcpy(out + y * dst_stride, res + y * width, width);
+    }
+  }
+}
+
+CVI_S32 CVI_IVE_Morph(IVE_HANDLE pIveHandle, IVE_SRC_IMAGE_S *pstSrc, IVE_DST_IMAGE_S *pstDst,
+                      IVE_MORPH_CTRL_S *pstMorphCtrl, bool bInstant) {
+  ScopedTrace t(__PRETTY_FUNCTION__);
+  if (!IsValidImageType(pstSrc, STRFY(pstSrc), IVE_IMAGE_TYPE_U8C1)) {
+    return CVI_FAILURE;
+  }
+  if (!IsValidImageType(pstDst, STRFY(pstDst), IVE_IMAGE_TYPE_U8C1)) {
+    return CVI_FAILURE;
+  }
+  const uint32_t width = pstSrc->u32Width, height = pstSrc->u32Height;
+  if (pstDst->u32Width != width || pstDst->u32Height != height) {
+    LOGE("pstSrc and pstDst must have the same size.\n");
+    return CVI_FAILURE;
+  }
+  const uint32_t elem_w = pstMorphCtrl->u8Width, elem_h = pstMorphCtrl->u8Height;
+  if (elem_w % 2 == 0 || elem_h % 2 == 0) {
+    LOGE("Structuring element size %u x %u must be odd.\n", elem_w, elem_h);
+    return CVI_FAILURE;
+  }
+  if (pstMorphCtrl->enOp >= IVE_MORPH_OP_BUTT || pstMorphCtrl->enShape >= IVE_MORPH_SHAPE_BUTT) {
+    LOGE("Not supported operation %d or shape %d.\n", pstMorphCtrl->enOp, pstMorphCtrl->enShape);
+    return CVI_FAILURE;
+  }
+
+  // The element as a union of rectangles given by their half sizes.
+  const uint32_t rx = elem_w / 2, ry = elem_h / 2;
+  std::vector<std::pair<uint32_t, uint32_t>> rects;
+  if (pstMorphCtrl->enShape == IVE_MORPH_SHAPE_RECT) {
+    rects.emplace_back(rx, ry);
+  } else if (pstMorphCtrl->enShape == IVE_MORPH_SHAPE_CROSS) {
+    rects.emplace_back(rx, 0);
+    rects.emplace_back(0, ry);
+  } else {
+    for (int i = 0; i < 4; i++) {
+      const double angle = (2 * i + 1) * M_PI / 16;
+      std::pair<uint32_t, uint32_t> rect(std::lround(rx * std::cos(angle)),
+                                         std::lround(ry * std::sin(angle)));
+      if (rects.empty() || rects.back() != rect) rects.push_back(rect);
+    }
+  }
+
+  CVI_IVE_BufRequest(pIveHandle, pstSrc);
+  const uint8_t *src = pstSrc->pu8VirAddr[0];
+  uint32_t src_stride = pstSrc->u16Stride[0];
+  uint8_t *dst = pstDst->pu8VirAddr[0];
+  const uint32_t dst_stride = pstDst->u16Stride[0];
+  const IVE_MORPH_OP_E op = pstMorphCtrl->enOp;
+  if (op == IVE_MORPH_OP_ERODE) {
+    morph_rects<true>(src, src_stride, width, height, rects, dst, dst_stride, true);
+  } else if (op == IVE_MORPH_OP_DILATE) {
+    morph_rects<false>(src, src_stride, width, height, rects, dst, dst_stride, true);
+  } else {
+    // Bands read the halo rows of their neighbours, so in place runs on a copy of the source.
+    std::vector<uint8_t> copy;
+    if (src == dst) {
+      copy.resize((size_t)width * height);
+      for (uint32_t y = 0; y < height; y++) {
+        memcpy(copy.data() + y * width, src + y * src_stride, width);
+      }
+      src = copy.data();
+      src_stride = width;
+    }
+    const uint32_t band = std::max<uint32_t>(64, 4 * ry);
+    auto band_rows = [&](uint32_t band_begin, uint32_t band_end) {
+      for (uint32_t i = band_begin; i < band_end; i++) {
+        morph_compound_band(op, src, src_stride, width, height, rects, ry, i * band,
+                            std::min(height, (i + 1) * band), dst, dst_stride);
+      }
+    };
+    parallelRows((height + band - 1) / band, (uint64_t)band * width, band_rows);
+  }
+  CVI_IVE_BufFlush(pIveHandle, pstDst);
+  return CVI_SUCCESS;
+}
+
+#define DIST_INF 0xFFFF
+
+// Vertical distance to the nearest background pixel in the same column for the columns
+// [x0, x1), saturated to DIST_INF. g has stride width.
+static void dist_col_pass(const IVE_IMAGE_S *src, const uint32_t x0, const uint32_t x1,
+                          uint16_t *g) {
+  const uint32_t width = src->u32Width, height = src->u32Height;
+  for (uint32_t y = 0; y < height; y++) {
+    const uint8_t *mask = src->pu8VirAddr[0] + y * src->u16Stride[0];
+    uint16_t *cur = g + y * width;
+    const uint16_t *prev = cur - width;
+    uint32_t x = x0;
+#ifndef CV180X
+    const uint16x8_t one = vdupq_n_u16(1);
+    for (; x + 8 <= x1; x += 8) {
+      uint16x8_t up = y == 0 ? vdupq_n_u16(DIST_INF) : vld1q_u16(prev + x);
+      uint16x8_t fg = vmovl_u8(vld1_u8(mask + x));
+      vst1q_u16(cur + x, vandq_u16(vqaddq_u16(up, one), vtstq_u16(fg, fg)));
+    }
+#endif
+    for (; x < x1; x++) {
+      const uint16_t up = y == 0 ? DIST_INF : prev[x];
+      cur[x] = mask[x] == 0 ? 0 : (up == DIST_INF ? DIST_INF : up + 1);
+    }
+  }
+  for (uint32_t y = height - 1; y-- > 0;) {
+    const uint16_t *next = g + (y + 1) * width;
+    uint16_t *cur = g + y * width;
+    uint32_t x = x0;
+#ifndef CV180X
+    const uint16x8_t one = vdupq_n_u16(1);
+    for (; x + 8 <= x1; x += 8) {
+      vst1q_u16(cur + x, vminq_u16(vld1q_u16(cur + x), vqaddq_u16(vld1q_u16(next + x), one)));
+    }
+#endif
+    for (; x < x1; x++) {
+      if (next[x] != DIST_INF) cur[x] = std::min(cur[x], (uint16_t)(next[x] + 1));
+    }
+  }
+}
+
+// Squared Euclidean distance of a row from the vertical distances g, as the lower envelope of the
+// parabolas (x - q)^2 + g[q]^2. v and z hold width and width + 1 elements. Rows without any
+// background in reach get UINT64_MAX.
+static void dist_row_pass(const uint16_t *g, const uint32_t width, int32_t *v, double *z,
+                          uint64_t *d2) {
+  auto f = [&](int32_t q) { return (int64_t)g[q] * g[q] + (int64_t)q * q; };
+  int32_t k = -1;
+  for (int32_t q = 0; q < (int32_t)width; q++) {
+    if (g[q] == DIST_INF) continue;
+    double s = 0;
+    while (k >= 0) {
+      s = (double)(f(q) - f(v[k])) / (2 * (q - v[k]));
+      if (s > z[k]) break;
+      k--;
+    }
+    k++;
+    v[k] = q;
+    z[k] = k == 0 ? -HUGE_VAL : s;
+    z[k + 1] = HUGE_VAL;
+  }
+  if (k < 0) {
+    std::fill(d2, d2 + width, UINT64_MAX);
+    return;
+  }
+  int32_t j = 0;
+  for (int32_t x = 0; x < (int32_t)width; x++) {
+    while (z[j + 1] < x) j++;
+    const int64_t dx = x - v[j];
+    d2[x] = dx * dx + (uint64_t)g[v[j]] * g[v[j]];
+  }
+}
+
+// One raster scan of the 3-4 chamfer distance. d has rows of width + 2 with DIST_INF on both
+// ends, dir is 1 for the forward scan and -1 for the backward one.
+static void dist_chamfer_scan(uint16_t *d, const uint32_t width, const uint32_t height,
+                              const int32_t dir) {
+  const uint32_t stride = width + 2;
+  for (uint32_t i = 0; i < height; i++) {
+    const uint32_t y = dir > 0 ? i : height - 1 - i;
+    uint16_t *cur = d + y * stride + 1;
+    if (i > 0) {
+      // The terms from the previous row are independent across the row.
+      const uint16_t *near = d + (y - dir) * stride + 1;
+      uint32_t x = 0;
+#ifndef CV180X
+      const uint16x8_t three = vdupq_n_u16(3), four = vdupq_n_u16(4);
+      for (; x + 8 <= width; x += 8) {
+        uint16x8_t diag = vminq_u16(vld1q_u16(near + x - 1), vld1q_u16(near + x + 1));
+        uint16x8_t t = vminq_u16(vqaddq_u16(vld1q_u16(near + x), three), vqaddq_u16(diag, four));
+        vst1q_u16(cur + x, vminq_u16(vld1q_u16(cur + x), t));
+      }
+#endif
+      for (; x < width; x++) {
+        const uint16_t *n = near + x;
+        uint32_t t = std::min(n[0] + 3u, std::min(n[-1], n[1]) + 4u);
+        cur[x] = std::min((uint32_t)cur[x], t);
+      }
+    }
+    // The row neighbour depends on the result of the previous pixel.
+    if (dir > 0) {
+      for (uint32_t x = 1; x < width; x++) {
+        cur[x] = std::min(cur[x], (uint16_t)std::min(cur[x - 1] + 3u, (uint32_t)DIST_INF));
+      }
+    } else {
+      for (uint32_t x = width - 1; x-- > 0;) {
+        cur[x] = std::min(cur[x], (uint16_t)std::min(cur[x + 1] + 3u, (uint32_t)DIST_INF));
+      }
+    }
+  }
+}
+
+CVI_S32 CVI_IVE_DistanceTransform(IVE_HANDLE pIveHandle, IVE_SRC_IMAGE_S *pstSrc,
+                                  IVE_DST_IMAGE_S *pstDst,
+                                  IVE_DIST_TRANSFORM_CTRL_S *pstDistCtrl, bool bInstant) {
+  ScopedTrace t(__PRETTY_FUNCTION__);
+  if (!IsValidImageType(pstSrc, STRFY(pstSrc), IVE_IMAGE_TYPE_U8C1)) {
+    return CVI_FAILURE;
+  }
+  if (!IsValidImageType(pstDst, STRFY(pstDst), IVE_IMAGE_TYPE_U16C1, IVE_IMAGE_TYPE_FP32C1)) {
+    return CVI_FAILURE;
+  }
+  const uint32_t width = pstSrc->u32Width, height = pstSrc->u32Height;
+  if (pstDst->u32Width != width || pstDst->u32Height != height) {
+    LOGE("pstSrc and pstDst must have the same size.\n");
+    return CVI_FAILURE;
+  }
+  if (pstDistCtrl->enType >= IVE_DIST_TRANSFORM_TYPE_BUTT) {
+    LOGE("Not supported distance transform type %d.\n", pstDistCtrl->enType);
+    return CVI_FAILURE;
+  }
+
+  CVI_IVE_BufRequest(pIveHandle, pstSrc);
+  const bool to_u16 = pstDst->enType == IVE_IMAGE_TYPE_U16C1;
+  if (pstDistCtrl->enType == IVE_DIST_TRANSFORM_TYPE_EUCLIDEAN) {
+    std::vector<uint16_t> g((size_t)width * height);
+    // Column strips of 64 pixels in parallel.
+    auto col_pass = [&](uint32_t strip_begin, uint32_t strip_end) {
+      dist_col_pass(pstSrc, strip_begin * 64, std::min(strip_end * 64, width), g.data());
+    };
+    parallelRows((width + 63) / 64, (uint64_t)64 * height, col_pass);
+    auto row_pass = [&](uint32_t row_begin, uint32_t row_end) {
+      std::vector<int32_t> v(width);
+      std::vector<double> z(width + 1);
+      std::vector<uint64_t> d2(width);
+      for (uint32_t y = row_begin; y < row_end; y++) {
+        dist_row_pass(g.data() + y * width, width, v.data(), z.data(), d2.data());
+        uint8_t *dst = pstDst->pu8VirAddr[0] + y * pstDst->u16Stride[0];
+        for (uint32_t x = 0; x < width; x++) {
+          const float dist = d2[x] == UINT64_MAX ? INFINITY : std::sqrt((double)d2[x]);
+          if (to_u16) {
+            ((uint16_t *)dst)[x] = std::min(dist + 0.5f, (float)UINT16_MAX);
+          } else {
+            ((float *)dst)[x] = dist;
+          }
+        }
+      }
+    };
+    parallelRows(height, width * 4, row_pass);
+  } else {
+    const uint32_t stride = width + 2;
+    std::vector<uint16_t> d((size_t)stride * height, DIST_INF);
+    for (uint32_t y = 0; y < height; y++) {
+      const uint8_t *mask = pstSrc->pu8VirAddr[0] + y * pstSrc->u16Stride[0];
+      uint16_t *row = d.data() + y * stride + 1;
+      for (uint32_t x = 0; x < width; x++) {
+        if (mask[x] == 0) row[x] = 0;
+      }
+    }
+    dist_chamfer_scan(d.data(), width, height, 1);
+    dist_chamfer_scan(d.data(), width, height, -1);
+    for (uint32_t y = 0; y < height; y++) {
+      const uint16_t *row = d.data() + y * stride + 1;
+      uint8_t *dst = pstDst->pu8VirAddr[0] + y * pstDst->u16Stride[0];
+      for (uint32_t x = 0; x < width; x++) {
+        if (to_u16) {
+          ((uint16_t *)dst)[x] = row[x] == DIST_INF ? DIST_INF : (row[x] + 1) / 3;
+        } else {
+          ((float *)dst)[x] = row[x] == DIST_INF ? INFINITY : row[x] / 3.f;
+        }
+      }
+    }
+  }
+  CVI_IVE_BufFlush(pIveHandle, pstDst);
+  return CVI_SUCCESS;
+}
+
+// Neighbour offsets, clockwise from east. 4-connectivity uses the even directions.
+static const int32_t contour_dx[8] = {1, 1, 0, -1, -1, -1, 0, 1};
+static const int32_t contour_dy[8] = {0, 1, 1, 1, 0, -1, -1, -1};
+
+#define CONTOUR_MARK_VISITED 1
+// Visited and the east neighbour outside the region was examined.
+#define CONTOUR_MARK_RIGHT_CLOSED 2
+
+// Follow the border of the region of value val starting at (x0, y0), whose neighbour in direction
+// start_dir is outside the region. Points are appended to pts when it is not NULL.
+static void contour_follow(const uint8_t *img, const uint32_t stride, const int32_t width,
+                           const int32_t height, const int32_t x0, const int32_t y0,
+                           const int32_t start_dir, const int32_t step, uint8_t *mark,
+                           std::vector<IVE_POINT_U16_S> *pts) {
+  const uint8_t val = img[y0 * stride + x0];
+  auto inside = [&](int32_t x, int32_t y, int32_t dir) {
+    x += contour_dx[dir];
+    y += contour_dy[dir];
+    return x >= 0 && y >= 0 && x < width && y < height && img[y * stride + x] == val;
+  };
+  auto add = [&](int32_t x, int32_t y) {
+    if (pts) pts->push_back({(CVI_U16)x, (CVI_U16)y});
+  };
+  // Clockwise for the first neighbour in the region.
+  int32_t dir1 = -1;
+  for (int32_t k = 0; k < 8; k += step) {
+    if (inside(x0, y0, (start_dir + k) % 8)) {
+      dir1 = (start_dir + k) % 8;
+      break;
+    }
+  }
+  if (dir1 < 0) {
+    mark[y0 * width + x0] = CONTOUR_MARK_RIGHT_CLOSED;
+    add(x0, y0);
+    return;
+  }
+  const int32_t x1 = x0 + contour_dx[dir1], y1 = y0 + contour_dy[dir1];
+  int32_t x3 = x0, y3 = y0, dir2 = dir1;
+  while (true) {
+    // Counterclockwise from the previous border pixel for the next one.
+    bool east_out = false;
+    int32_t dir4 = dir2;
+    for (int32_t k = step; k <= 8; k += step) {
+      dir4 = (dir2 - k + 8) % 8;
+      if (inside(x3, y3, dir4)) break;
+      if (dir4 == 0) east_out = true;
+    }
+    uint8_t &m = mark[y3 * width + x3];
+    if (east_out) {
+      m = CONTOUR_MARK_RIGHT_CLOSED;
+    } else if (m == 0) {
+      m = CONTOUR_MARK_VISITED;
+    }
+    add(x3, y3);
+    const int32_t x4 = x3 + contour_dx[dir4], y4 = y3 + contour_dy[dir4];
+    if (x4 == x0 && y4 == y0 && x3 == x1 && y3 == y1) break;
+    x3 = x4;
+    y3 = y4;
+    dir2 = (dir4 + 4) % 8;
+  }
+}
+
+// Douglas-Peucker on a closed contour, in place. The first point and the farthest point from it
+// are always kept. Returns the number of points left.
+static uint32_t contour_douglas_peucker(IVE_POINT_U16_S *pts, const uint32_t n, const float eps,
+                                        std::vector<uint8_t> *keep,
+                                        std::vector<std::pair<uint32_t, uint32_t>> *stack) {
+  if (n < 3) return n;
+  auto dist2 = [&](uint32_t a, uint32_t b) {
+    const int64_t dx = pts[a].u16X - pts[b].u16X, dy = pts[a].u16Y - pts[b].u16Y;
+    return dx * dx + dy * dy;
+  };
+  uint32_t far = 0;
+  for (uint32_t i = 1; i < n; i++) {
+    if (dist2(i, 0) > dist2(far, 0)) far = i;
+  }
+  if (far == 0) return 1;
+  keep->assign(n, 0);
+  (*keep)[0] = (*keep)[far] = 1;
+  stack->clear();
+  stack->emplace_back(0, far);
+  stack->emplace_back(far, n);
+  const double eps2 = (double)eps * eps;
+  while (!stack->empty()) {
+    const uint32_t a = stack->back().first, b = stack->back().second;
+    stack->pop_back();
+    if (b - a < 2) continue;
+    // b can be n, the first point closing the contour.
+    const IVE_POINT_U16_S &pa = pts[a], &pb = pts[b % n];
+    const int64_t lx = pb.u16X - pa.u16X, ly = pb.u16Y - pa.u16Y;
+    const int64_t len2 = lx * lx + ly * ly;
+    double best = -1;
+    uint32_t best_i = a;
+    for (uint32_t i = a + 1; i < b; i++) {
+      const int64_t px = pts[i].u16X - pa.u16X, py = pts[i].u16Y - pa.u16Y;
+      const int64_t cross = lx * py - ly * px;
+      const double d = len2 == 0 ? (double)(px * px + py * py) : (double)cross * cross / len2;
+      if (d > best) {
+        best = d;
+        best_i = i;
+      }
+    }
+    if (best > eps2) {
+      (*keep)[best_i] = 1;
+      stack->emplace_back(a, best_i);
+      stack->emplace_back(best_i, b);
+    }
+  }
+  uint32_t out = 0;
+  for (uint32_t i = 0; i < n; i++) {
+    if ((*keep)[i]) pts[out++] = pts[i];
+  }
+  return out;
+}
+
+// Convex hull of the contour by the monotone chain, written back to pts. tmp and hull are scratch
+// space.
+static uint32_t contour_convex_hull(IVE_POINT_U16_S *pts, const uint32_t n,
+                                    std::vector<IVE_POINT_U16_S> *tmp,
+                                    std::vector<IVE_POINT_U16_S> *hull) {
+  tmp->assign(pts, pts + n);
+  std::sort(tmp->begin(), tmp->end(), [](const IVE_POINT_U16_S &a, const IVE_POINT_U16_S &b) {
+    return a.u16X < b.u16X || (a.u16X == b.u16X && a.u16Y < b.u16Y);
+  });
+  tmp->erase(std::unique(tmp->begin(), tmp->end(),
+                         [](const IVE_POINT_U16_S &a, const IVE_POINT_U16_S &b) {
+                           return a.u16X == b.u16X && a.u16Y == b.u16Y;
+                         }),
+             tmp->end());
+  const uint32_t m = tmp->size();
+  if (m < 3) {
+    std::copy(tmp->begin(), tmp->end(), pts);
+    return m;
+  }
+  auto cross = [](const IVE_POINT_U16_S &o, const IVE_POINT_U16_S &a, const IVE_POINT_U16_S &b) {
+    return (int64_t)(a.u16X - o.u16X) * (b.u16Y - o.u16Y) -
+           (int64_t)(a.u16Y - o.u16Y) * (b.u16X - o.u16X);
+  };
+  // The chains repeat the first point at the end, so they need m + 1 slots. Only the k - 1
+  // distinct vertices are copied back, which fit in pts.
+  hull->resize(m + 1);
+  IVE_POINT_U16_S *h = hull->data();
+  uint32_t k = 0;
+  for (uint32_t i = 0; i < m; i++) {
+    while (k >= 2 && cross(h[k - 2], h[k - 1], (*tmp)[i]) <= 0) k--;
+    h[k++] = (*tmp)[i];
+  }
+  for (uint32_t i = m - 1, lower = k + 1; i-- > 0;) {
+    while (k >= lower && cross(h[k - 2], h[k - 1], (*tmp)[i]) <= 0) k--;
+    h[k++] = (*tmp)[i];
+  }
+  std::copy(h, h + k - 1, pts);
+  return k - 1;
+}
+
+CVI_S32 CVI_IVE_FindContours(IVE_HANDLE pIveHandle, IVE_SRC_IMAGE_S *pstSrc,
+                             IVE_CONTOUR_S *pstContours, CVI_U32 u32MaxContourNum,
+                             IVE_POINT_U16_S *pstPoints, CVI_U32 u32MaxPointNum,
+                             CVI_U32 *pu32ContourNum, IVE_CONTOUR_CTRL_S *pstContourCtrl,
+                             bool bInstant) {
+  ScopedTrace t(__PRETTY_FUNCTION__);
+  if (!IsValidImageType(pstSrc, STRFY(pstSrc), IVE_IMAGE_TYPE_U8C1)) {
+    return CVI_FAILURE;
+  }
+  if (pstContourCtrl->enApprox >= IVE_CONTOUR_APPROX_BUTT) {
+    LOGE("Not supported approximation %d.\n", pstContourCtrl->enApprox);
+    return CVI_FAILURE;
+  }
+  if (pstContourCtrl->enApprox == IVE_CONTOUR_APPROX_DOUGLAS_PEUCKER &&
+      !(pstContourCtrl->f32Epsilon >= 0)) {
+    LOGE("Epsilon %f must not be negative.\n", pstContourCtrl->f32Epsilon);
+    return CVI_FAILURE;
+  }
+
+  CVI_IVE_BufRequest(pIveHandle, pstSrc);
+  const int32_t width = pstSrc->u32Width, height = pstSrc->u32Height;
+  const uint32_t stride = pstSrc->u16Stride[0];
+  const uint8_t *img = pstSrc->pu8VirAddr[0];
+  const int32_t step = pstContourCtrl->enMode == DIRECTION_8 ? 1 : 2;
+  // Scratch buffers are shared by all contours.
+  std::vector<uint8_t> mark((size_t)width * height, 0);
+  std::vector<IVE_POINT_U16_S> pts, tmp, hull;
+  std::vector<uint8_t> keep;
+  std::vector<std::pair<uint32_t, uint32_t>> stack;
+  uint32_t contour_num = 0, point_num = 0;
+  bool full = false;
+  for (int32_t y = 0; y < height && !full; y++) {
+    const uint8_t *row = img + y * stride;
+    for (int32_t x = 0; x < width && !full; x++) {
+      const uint8_t val = row[x];
+      if (val == 0) continue;
+      const uint8_t m = mark[y * width + x];
+      if (m == 0 && (x == 0 || row[x - 1] != val)) {
+        // Outer border.
+        if (contour_num == u32MaxContourNum) {
+          full = true;
+          break;
+        }
+        pts.clear();
+        contour_follow(img, stride, width, height, x, y, 4, step, mark.data(), &pts);
+        uint16_t x_min = UINT16_MAX, y_min = UINT16_MAX, x_max = 0, y_max = 0;
+        for (const auto &p : pts) {
+          x_min = std::min(x_min, p.u16X);
+          x_max = std::max(x_max, p.u16X);
+          y_min = std::min(y_min, p.u16Y);
+          y_max = std::max(y_max, p.u16Y);
+        }
+        uint32_t n = pts.size();
+        if (pstContourCtrl->enApprox == IVE_CONTOUR_APPROX_DOUGLAS_PEUCKER) {
+          n = contour_douglas_peucker(pts.data(), n, pstContourCtrl->f32Epsilon, &keep, &stack);
+        } else if (pstContourCtrl->enApprox == IVE_CONTOUR_APPROX_CONVEX_HULL) {
+          n = contour_convex_hull(pts.data(), n, &tmp, &hull);
+        }
+        if (point_num + n > u32MaxPointNum) {
+          full = true;
+          break;
+        }
+        memcpy(pstPoints + point_num, pts.data(), n * sizeof(IVE_POINT_U16_S));
+        IVE_CONTOUR_S &contour = pstContours[contour_num++];
+        contour.u32PointOffset = point_num;
+        contour.u32PointNum = n;
+        contour.u8Label = val;
+        contour.u16X = x_min;
+        contour.u16Y = y_min;
+        contour.u16Width = x_max - x_min + 1;
+        contour.u16Height = y_max - y_min + 1;
+        point_num += n;
+      } else if (m != CONTOUR_MARK_RIGHT_CLOSED && (x == width - 1 || row[x + 1] != val)) {
+        // Hole border, only followed for the marks.
+        contour_follow(img, stride, width, height, x, y, 0, step, mark.data(), NULL);
+      }
+    }
+  }
+  *pu32ContourNum = contour_num;
+  if (full) {
+    LOGW("Contours are truncated to %u contours and %u points.\n", contour_num, point_num);
+    return ERR_IVE_BUF_FULL;
+  }
+  return CVI_SUCCESS;
+}
+
+// SAD of the template at one position. Stops after a template row once the sum exceeds limit.
+static uint32_t sad_match_pos(const uint8_t *src, const uint32_t src_stride, const uint8_t *tpl,
+                              const uint32_t tpl_stride, const uint32_t tpl_w,
+                              const uint32_t tpl_h, const uint32_t limit) {
+  uint32_t sum = 0;
+  for (uint32_t r = 0; r < tpl_h && sum <= limit; r++) {
+    const uint8_t *s = src + r * src_stride, *t = tpl + r * tpl_stride;
+    for (uint32_t c = 0; c < tpl_w; c++) {
+      sum += std::abs(s[c] - t[c]);
+    }
+  }
+  return sum;
+}
+
+#ifndef CV180X
+// SAD of the template at the 16 positions starting at src into sad. Every template pixel is
+// compared with 16 source pixels at once, a template row of at most 255 pixels fits in the 16 bit
+// accumulators. Stops after a template row once all the sums exceed limit.
+static void sad_match_block16(const uint8_t *src, const uint32_t src_stride, const uint8_t *tpl,
+                              const uint32_t tpl_stride, const uint32_t tpl_w,
+                              const uint32_t tpl_h, const uint32_t limit, uint32_t *sad) {
+  uint32x4_t acc0 = vdupq_n_u32(0), acc1 = acc0, acc2 = acc0, acc3 = acc0;
+  for (uint32_t r = 0; r < tpl_h; r++) {
+    const uint8_t *s = src + r * src_stride, *t = tpl + r * tpl_stride;
+    uint16x8_t lo = vdupq_n_u16(0), hi = lo;
+    for (uint32_t c = 0; c < tpl_w; c++) {
+      uint8x16_t v = vld1q_u8(s + c);
+      uint8x8_t tv = vdup_n_u8(t[c]);
+      lo = vabal_u8(lo, vget_low_u8(v), tv);
+      hi = vabal_u8(hi, vget_high_u8(v), tv);
+    }
+    acc0 = vaddw_u16(acc0, vget_low_u16(lo));
+    acc1 = vaddw_u16(acc1, vget_high_u16(lo));
+    acc2 = vaddw_u16(acc2, vget_low_u16(hi));
+    acc3 = vaddw_u16(acc3, vget_high_u16(hi));
+    if (limit != UINT32_MAX) {
+      uint32_t min[4];
+      vst1q_u32(min, vminq_u32(vminq_u32(acc0, acc1), vminq_u32(acc2, acc3)));
+      if (std::min(std::min(min[0], min[1]), std::min(min[2], min[3])) > limit) break;
+    }
+  }
+  vst1q_u32(sad, acc0);
+  vst1q_u32(sad + 4, acc1);
+  vst1q_u32(sad + 8, acc2);
+  vst1q_u32(sad + 12, acc3);
+}
+#endif
+
+CVI_S32 CVI_IVE_MatchTemplateSAD(IVE_HANDLE pIveHandle, IVE_SRC_IMAGE_S *pstSrc,
+                                 IVE_SRC_IMAGE_S *pstTemplate, IVE_DST_IMAGE_S *pstDst,
+                                 IVE_TEMPLATE_MATCH_RESULT_S *pstResult, bool bInstant) {
+  ScopedTrace t(__PRETTY_FUNCTION__);
+  if (!IsValidImageType(pstSrc, STRFY(pstSrc), IVE_IMAGE_TYPE_U8C1)) {
+    return CVI_FAILURE;
+  }
+  if (!IsValidImageType(pstTemplate, STRFY(pstTemplate), IVE_IMAGE_TYPE_U8C1)) {
+    return CVI_FAILURE;
+  }
+  if (pstDst != NULL &&
+      !IsValidImageType(pstDst, STRFY(pstDst), IVE_IMAGE_TYPE_U16C1, IVE_IMAGE_TYPE_U32C1)) {
+    return CVI_FAILURE;
+  }
+  const uint32_t tpl_w = pstTemplate->u32Width, tpl_h = pstTemplate->u32Height;
+  if (tpl_w > 255 || tpl_w > pstSrc->u32Width || tpl_h > pstSrc->u32Height) {
+    LOGE("Template %u x %u must be at most 255 wide and fit in the source %u x %u.\n", tpl_w,
+         tpl_h, pstSrc->u32Width, pstSrc->u32Height);
+    return CVI_FAILURE;
+  }
+  const uint32_t out_w = pstSrc->u32Width - tpl_w + 1, out_h = pstSrc->u32Height - tpl_h + 1;
+  if (pstDst != NULL && (pstDst->u32Width != out_w || pstDst->u32Height != out_h)) {
+    LOGE("pstDst size must be %u x %u.\n", out_w, out_h);
+    return CVI_FAILURE;
+  }
+
+  CVI_IVE_BufRequest(pIveHandle, pstSrc);
+  CVI_IVE_BufRequest(pIveHandle, pstTemplate);
+  const uint8_t *tpl = pstTemplate->pu8VirAddr[0];
+  const uint32_t src_stride = pstSrc->u16Stride[0], tpl_stride = pstTemplate->u16Stride[0];
+  const bool to_u16 = pstDst != NULL && pstDst->enType == IVE_IMAGE_TYPE_U16C1;
+  uint32_t best_sad = UINT32_MAX, best_x = 0, best_y = 0;
+  std::mutex best_mutex;
+  auto match_rows = [&](uint32_t row_begin, uint32_t row_end) {
+    uint32_t local_sad = UINT32_MAX, local_x = 0, local_y = 0;
+    // Partial sums above the local best are only allowed without a map.
+    const bool prune = pstDst == NULL;
+    auto visit = [&](uint32_t x, uint32_t y, uint32_t cost) {
+      if (pstDst != NULL) {
+        uint8_t *dst = pstDst->pu8VirAddr[0] + y * pstDst->u16Stride[0];
+        if (to_u16) {
+          ((uint16_t *)dst)[x] = std::min(cost, (uint32_t)UINT16_MAX);
+        } else {
+          ((uint32_t *)dst)[x] = cost;
+        }
+      }
+      if (cost < local_sad) {
+        local_sad = cost;
+        local_x = x;
+        local_y = y;
+      }
+    };
+    for (uint32_t y = row_begin; y < row_end; y++) {
+      const uint8_t *src = pstSrc->pu8VirAddr[0] + y * src_stride;
+      uint32_t x = 0;
+#ifndef CV180X
+      for (; x + 16 <= out_w; x += 16) {
+        uint32_t sad[16];
+        sad_match_block16(src + x, src_stride, tpl, tpl_stride, tpl_w, tpl_h,
+                          prune ? local_sad : UINT32_MAX, sad);
+        for (uint32_t i = 0; i < 16; i++) {
+          visit(x + i, y, sad[i]);
+        }
+      }
+#endif
+      for (; x < out_w; x++) {
+        visit(x, y,
+              sad_match_pos(src + x, src_stride, tpl, tpl_stride, tpl_w, tpl_h,
+                            prune ? local_sad : UINT32_MAX));
+      }
+    }
+    std::lock_guard<std::mutex> lock(best_mutex);
+    if (local_sad < best_sad ||
+        (local_sad == best_sad && (local_y < best_y || (local_y == best_y && local_x < best_x)))) {
+      best_sad = local_sad;
+      best_x = local_x;
+      best_y = local_y;
+    }
+  };
+  parallelRows(out_h, (uint64_t)out_w * tpl_w * tpl_h / 16, match_rows);
+  if (pstDst != NULL) {
+    CVI_IVE_BufFlush(pIveHandle, pstDst);
+  }
+  pstResult->u16X = best_x;
+  pstResult->u16Y = best_y;
+  pstResult->u32MinSad = best_sad;
+  return CVI_SUCCESS;
+}
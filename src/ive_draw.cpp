@@ -1,7 +1,27 @@
 #include "ive_internal.hpp"
 
-CVI_S32 CVI_IVE_DrawRect(IVE_HANDLE pIveHandle, IVE_DST_IMAGE_S *pstDst,
-                         IVE_DRAW_RECT_CTRL_S *pstDrawCtrl, bool bInstant) {
+// Up to this many rectangles the CPU is cheaper than a TPU submission.
+#define DRAW_CPU_MAX_RECTS 8
+// Upper bound of the command buffer bytes taken by one TDMA fill.
+#define DRAW_FILL_CMD_BYTES 128
+
+static void drawFillsCPU(const std::vector<DrawFill> &fills, IVE_IMAGE_S *pstDst) {
+  for (auto &fill : fills) {
+    uint8_t *base = pstDst->pu8VirAddr[fill.plane] + fill.offset;
+    for (uint32_t n = 0; n < fill.n; n++) {
+      for (uint32_t c = 0; c < fill.c; c++) {
+        uint8_t *ptr = base + n * fill.stride_n + c * fill.stride_c;
+        for (uint32_t h = 0; h < fill.h; h++) {
+          memset(ptr + h * fill.stride_h, fill.value, fill.w);
+        }
+      }
+    }
+  }
+}
+
+CVI_S32 CVI_IVE_DrawRects(IVE_HANDLE pIveHandle, IVE_DST_IMAGE_S *pstDst,
+                          IVE_DRAW_RECTS_CTRL_S *pstCtrl, bool bInstant) {
+  ScopedTrace t(__PRETTY_FUNCTION__);
   if (pstDst->tpu_block == NULL) {
     LOGE("Destination cannot be empty.\n");
     return CVI_FAILURE;
@@ -13,33 +33,58 @@ CVI_S32 CVI_IVE_DrawRect(IVE_HANDLE pIveHandle, IVE_DST_IMAGE_S *pstDst,
         "IVE_IMAGE_TYPE_U8C3_PLANAR format.\n");
     return CVI_FAILURE;
   }
-  if (pstDrawCtrl->rect == NULL) {
-    LOGE("pstDrawCtrl->rect is an empty array.\n");
+  if (pstCtrl->u32Num != 0 && pstCtrl->pstItems == NULL) {
+    LOGE("pstCtrl->pstItems is an empty array.\n");
     return CVI_FAILURE;
   }
 
-  CVI_U8 pColorConverted[3] = {0};
-  if (pstDst->enType == IVE_IMAGE_TYPE_YUV420P || pstDst->enType == IVE_IMAGE_TYPE_YUV420SP) {
-    getYUVColorLimitedUV(pstDrawCtrl->color, pColorConverted);
-  } else if (pstDst->enType == IVE_IMAGE_TYPE_U8C3_PLANAR) {
-    pColorConverted[0] = pstDrawCtrl->color.r;
-    pColorConverted[1] = pstDrawCtrl->color.g;
-    pColorConverted[2] = pstDrawCtrl->color.b;
-  } else {
-    LOGE("Unsupported image convert type CVI_IVE_DrawRect.\n");
-    return CVI_FAILURE;
-  }
   IVE_HANDLE_CTX *handle_ctx = reinterpret_cast<IVE_HANDLE_CTX *>(pIveHandle);
   CviImg *cpp_dst = reinterpret_cast<CviImg *>(pstDst->tpu_block);
-  for (CVI_U8 i = 0; i < pstDrawCtrl->numsOfRect; i++) {
-    IVE_RECT_S &rect = pstDrawCtrl->rect[i];
-    IveTPUDrawHollowRect::addCmd(handle_ctx->cvk_ctx, rect.pts[0].x, rect.pts[0].y, rect.pts[1].x,
-                                 rect.pts[1].y, pColorConverted, (*cpp_dst));
-    // Submit every 20 boxes
-    if ((i + 1) % 20 == 0) {
+  std::vector<DrawFill> fills;
+  if (genDrawRectFills(pstCtrl->pstItems, pstCtrl->u32Num, *cpp_dst, &fills) != CVI_SUCCESS) {
+    return CVI_FAILURE;
+  }
+  if (fills.empty()) {
+    return CVI_SUCCESS;
+  }
+
+  bool use_cpu = pstCtrl->enMode == IVE_DRAW_MODE_CPU ||
+                 (pstCtrl->enMode == IVE_DRAW_MODE_AUTO && pstCtrl->u32Num <= DRAW_CPU_MAX_RECTS);
+  if (use_cpu) {
+    CVI_IVE_BufRequest(pIveHandle, pstDst);
+    drawFillsCPU(fills, pstDst);
+    CVI_IVE_BufFlush(pIveHandle, pstDst);
+    return CVI_SUCCESS;
+  }
+
+  // One submission unless the command buffer of the handle cannot hold all the fills.
+  size_t fills_per_submit = handle_ctx->cmdbuf_size / DRAW_FILL_CMD_BYTES;
+  if (fills_per_submit == 0) fills_per_submit = 1;
+  for (size_t i = 0; i < fills.size(); i++) {
+    IveTPUDrawFill::addCmd(handle_ctx->cvk_ctx, fills[i], *cpp_dst);
+    if ((i + 1) % fills_per_submit == 0 && i + 1 != fills.size()) {
       CVI_RT_Submit(handle_ctx->cvk_ctx);
     }
   }
   CVI_RT_Submit(handle_ctx->cvk_ctx);
   return CVI_SUCCESS;
-}
\ No newline at end of file
+}
+
+CVI_S32 CVI_IVE_DrawRect(IVE_HANDLE pIveHandle, IVE_DST_IMAGE_S *pstDst,
+                         IVE_DRAW_RECT_CTRL_S *pstDrawCtrl, bool bInstant) {
+  if (pstDrawCtrl->rect == NULL) {
+    LOGE("pstDrawCtrl->rect is an empty array.\n");
+    return CVI_FAILURE;
+  }
+  std::vector<IVE_DRAW_RECT_ITEM_S> items(pstDrawCtrl->numsOfRect);
+  for (CVI_U8 i = 0; i < pstDrawCtrl->numsOfRect; i++) {
+    items[i].rect = pstDrawCtrl->rect[i];
+    items[i].color = pstDrawCtrl->color;
+    items[i].thickness = 2;
+  }
+  IVE_DRAW_RECTS_CTRL_S ctrl;
+  ctrl.u32Num = items.size();
+  ctrl.pstItems = items.data();
+  ctrl.enMode = IVE_DRAW_MODE_TPU;
+  return CVI_IVE_DrawRects(pIveHandle, pstDst, &ctrl, bInstant);
+}
@@ -142,9 +142,41 @@ struct TPU_HANDLE {
   IveTPUCmpSat t_cmp_sat;
 };
 
+class AsyncImageWriter;
+void destroyAsyncWriter(AsyncImageWriter *writer);
+
+// CviImg wrapper of a VIDEO_FRAME_INFO_S buffer. Frames from a VB pool come back with the same
+// address and layout, so the wrapper is kept by the handle and reused for them.
+struct VideoFrameWrap {
+  uint64_t paddr = 0;
+  uint8_t *vaddr = nullptr;
+  uint32_t pixel_format = 0;
+  uint32_t width = 0;
+  uint32_t height = 0;
+  uint32_t stride[3] = {};
+  uint32_t length[3] = {};
+  bool y_only = false;
+  IVE_IMAGE_TYPE_E en_type = IVE_IMAGE_TYPE_U8C1;
+  // Number of IVE_IMAGE_S currently pointing to img.
+  uint32_t ref = 0;
+  // Invalidated while in use, deleted by the last release.
+  bool stale = false;
+  uint64_t last_use = 0;
+  CviImg *img = nullptr;
+};
+
 struct IVE_HANDLE_CTX {
   CVI_RT_HANDLE rt_handle = NULL;
   cvk_context_t *cvk_ctx = NULL;
+  uint64_t cmdbuf_size = 0;
   TPU_HANDLE t_h;
+  // Scratch images of the 512 entries map, only reallocated when the frame size changes.
+  IVE_IMAGE_S map_table_index = {};
+  IVE_IMAGE_S map_lookup_index = {};
+  // Created by the first asynchronous write.
+  AsyncImageWriter *async_writer = nullptr;
+  // Wrappers of video frames, see CVI_IVE_VideoFrameInfo2ImageCached.
+  std::vector<VideoFrameWrap> frame_wraps;
+  uint64_t frame_wrap_tick = 0;
   // VIP
 };
@@ -58,11 +58,19 @@ int IveTPUFilter::runSetup(CVI_RT_HANDLE rt_handle, cvk_context_t *cvk_ctx,
 
   auto *tl_multiplier = allocTLMem(cvk_ctx, packed_s, CVK_FMT_U8, 1);
   {
-    mp_multiplier =
-        new CviImg(rt_handle, tl_shape.c, 1, MULTIPLIER_ONLY_PACKED_DATA_SIZE, CVK_FMT_U8);
-    getPackedMultiplierArrayBuffer(tl_shape.c, m_kernel->multiplier.base,
-                                   m_kernel->multiplier.shift, mp_multiplier->GetVAddr());
-    cviImgFlush2TL(rt_handle, cvk_ctx, *mp_multiplier, tl_multiplier);
+    // Deferred runs share the multiplier until postProcess, so it covers all the lanes.
+    if (mp_multiplier == nullptr) {
+      uint32_t npu_num = cvk_ctx->info.npu_num;
+      mp_multiplier =
+          new CviImg(rt_handle, npu_num, 1, MULTIPLIER_ONLY_PACKED_DATA_SIZE, CVK_FMT_U8);
+      getPackedMultiplierArrayBuffer(npu_num, m_kernel->multiplier.base,
+                                     m_kernel->multiplier.shift, mp_multiplier->GetVAddr());
+      mp_multiplier->Flush(rt_handle);
+    }
+    int tmp_multiplier_c = mp_multiplier->m_tg.shape.c;
+    mp_multiplier->m_tg.shape.c = tl_shape.c;
+    cviImg2TL(rt_handle, cvk_ctx, *mp_multiplier, tl_multiplier);
+    mp_multiplier->m_tg.shape.c = tmp_multiplier_c;
     tl_multiplier->shape = {1, tl_shape.c, 1, 1};
     tl_multiplier->stride =
         cvk_ctx->ops->tl_default_stride(cvk_ctx, tl_multiplier->shape, tl_multiplier->fmt, 0);
@@ -103,9 +111,11 @@ void IveTPUFilter::operation(CVI_RT_HANDLE rt_handle, cvk_context_t *cvk_ctx, ui
 }
 
 int IveTPUFilter::postProcess(CVI_RT_HANDLE rt_handle) {
-  mp_multiplier->Free(rt_handle);
-  delete mp_multiplier;
-  mp_multiplier = nullptr;
+  if (mp_multiplier) {
+    mp_multiplier->Free(rt_handle);
+    delete mp_multiplier;
+    mp_multiplier = nullptr;
+  }
   return CVI_SUCCESS;
 }
 
@@ -62,7 +62,9 @@ void IveTPUTbl::operation(CVI_RT_HANDLE rt_handle, cvk_context_t *cvk_ctx, uint3
   cvk_ctx->ops->tiu_lookup_table(cvk_ctx, &m_p_tbl);
 }
 
-int IveTPUTbl::postProcess(CVI_RT_HANDLE rt_handle) {
+int IveTPUTbl::postProcess(CVI_RT_HANDLE rt_handle) { return CVI_SUCCESS; }
+
+int IveTPUTbl::freeTable(CVI_RT_HANDLE rt_handle) {
   if (mp_table != nullptr) {
     mp_table->Free(rt_handle);
     delete mp_table;
@@ -202,7 +204,9 @@ void IveTPUTbl512::operation(CVI_RT_HANDLE rt_handle, cvk_context_t *cvk_ctx, ui
   cvk_ctx->ops->tiu_mac(cvk_ctx, &m_p_mac2);
 }
 
-int IveTPUTbl512::postProcess(CVI_RT_HANDLE rt_handle) {
+int IveTPUTbl512::postProcess(CVI_RT_HANDLE rt_handle) { return CVI_SUCCESS; }
+
+int IveTPUTbl512::freeTable(CVI_RT_HANDLE rt_handle) {
   if (mp_table1 != nullptr) {
     mp_table1->Free(rt_handle);
     delete mp_table1;
@@ -8,6 +8,9 @@
 #include "arm_neon.h"
 #endif
 
+int cpu_ref(IVE_SRC_IMAGE_S *src, IVE_DST_IMAGE_S *dst, IVE_16BIT_TO_8BIT_CTRL_S *ctrl);
+int test_s16_modes(IVE_HANDLE handle, IVE_SRC_IMAGE_S *src);
+
 int main(int argc, char** argv) {
   if (argc != 3) {
     printf("Incorrect loop value. Usage: %s <file name> <loop in value (1-1000)>\n", argv[0]);
@@ -46,6 +49,9 @@ int main(int argc, char** argv) {
 
   IVE_16BIT_TO_8BIT_CTRL_S ctrl;
   ctrl.enMode = IVE_16BIT_TO_8BIT_MODE_U16_TO_U8;
+  ctrl.u8Numerator = 1;
+  ctrl.u16Denominator = 1;
+  ctrl.s8Bias = 0;
 
   struct timeval t0, t1;
   gettimeofday(&t0, NULL);
@@ -56,6 +62,8 @@ int main(int argc, char** argv) {
   unsigned long elapsed_cpu = (t1.tv_sec - t0.tv_sec) * 1000000 + t1.tv_usec - t0.tv_usec;
 
   CVI_IVE_BufRequest(handle, &dst);
+  ret |= cpu_ref(&src_u16, &dst, &ctrl);
+  ret |= test_s16_modes(handle, &src);
 
   if (total_run == 1) {
     printf("TPU avg time %s\n", "NA");
@@ -73,3 +81,79 @@ int main(int argc, char** argv) {
 
   return ret;
 }
+
+int cpu_ref(IVE_SRC_IMAGE_S *src, IVE_DST_IMAGE_S *dst, IVE_16BIT_TO_8BIT_CTRL_S *ctrl) {
+  for (size_t i = 0; i < src->u32Height; i++) {
+    for (size_t j = 0; j < src->u32Width; j++) {
+      int val = 0;
+      if (ctrl->enMode == IVE_16BIT_TO_8BIT_MODE_U16_TO_U8) {
+        val = (int)((CVI_U16 *)(src->pu8VirAddr[0] + i * src->u16Stride[0]))[j];
+      } else {
+        val = (int)((CVI_S16 *)(src->pu8VirAddr[0] + i * src->u16Stride[0]))[j];
+      }
+      val = val * ctrl->u8Numerator / (int)ctrl->u16Denominator;
+      int min = 0, max = 255;
+      switch (ctrl->enMode) {
+        case IVE_16BIT_TO_8BIT_MODE_S16_TO_S8:
+          min = -128;
+          max = 127;
+          break;
+        case IVE_16BIT_TO_8BIT_MODE_S16_TO_U8_ABS:
+          val = abs(val);
+          break;
+        case IVE_16BIT_TO_8BIT_MODE_S16_TO_U8_BIAS:
+          val += ctrl->s8Bias;
+          break;
+        default:
+          break;
+      }
+      val = val > max ? max : (val < min ? min : val);
+      int res = ctrl->enMode == IVE_16BIT_TO_8BIT_MODE_S16_TO_S8
+                    ? (int)((CVI_S8 *)(dst->pu8VirAddr[0] + i * dst->u16Stride[0]))[j]
+                    : (int)dst->pu8VirAddr[0][i * dst->u16Stride[0] + j];
+      if (res != val) {
+        printf("Mode %d [%zu, %zu] IVE %d, CPU %d\n", ctrl->enMode, j, i, res, val);
+        return CVI_FAILURE;
+      }
+    }
+  }
+  return CVI_SUCCESS;
+}
+
+int test_s16_modes(IVE_HANDLE handle, IVE_SRC_IMAGE_S *src) {
+  int ret = CVI_SUCCESS;
+  int width = src->u32Width;
+  int height = src->u32Height;
+  // Spread the U8 input over the whole S16 range.
+  IVE_SRC_IMAGE_S src_s16;
+  CVI_IVE_CreateImage(handle, &src_s16, IVE_IMAGE_TYPE_S16C1, width, height);
+  for (int i = 0; i < height; i++) {
+    CVI_S16 *ptr = (CVI_S16 *)(src_s16.pu8VirAddr[0] + i * src_s16.u16Stride[0]);
+    for (int j = 0; j < width; j++) {
+      ptr[j] = (src->pu8VirAddr[0][i * src->u16Stride[0] + j] - 128) * 256;
+    }
+  }
+  CVI_IVE_BufFlush(handle, &src_s16);
+
+  IVE_DST_IMAGE_S dst_u8, dst_s8;
+  CVI_IVE_CreateImage(handle, &dst_u8, IVE_IMAGE_TYPE_U8C1, width, height);
+  CVI_IVE_CreateImage(handle, &dst_s8, IVE_IMAGE_TYPE_S8C1, width, height);
+  IVE_16BIT_TO_8BIT_CTRL_S ctrl;
+  ctrl.u8Numerator = 3;
+  ctrl.u16Denominator = 257;
+  ctrl.s8Bias = -20;
+  IVE_16BIT_TO_8BIT_MODE_E modes[3] = {IVE_16BIT_TO_8BIT_MODE_S16_TO_S8,
+                                       IVE_16BIT_TO_8BIT_MODE_S16_TO_U8_ABS,
+                                       IVE_16BIT_TO_8BIT_MODE_S16_TO_U8_BIAS};
+  for (int i = 0; i < 3; i++) {
+    ctrl.enMode = modes[i];
+    IVE_DST_IMAGE_S *dst = modes[i] == IVE_16BIT_TO_8BIT_MODE_S16_TO_S8 ? &dst_s8 : &dst_u8;
+    ret |= CVI_IVE_16BitTo8Bit(handle, &src_s16, dst, &ctrl, 0);
+    CVI_IVE_BufRequest(handle, dst);
+    ret |= cpu_ref(&src_s16, dst, &ctrl);
+  }
+  CVI_SYS_FreeI(handle, &src_s16);
+  CVI_SYS_FreeI(handle, &dst_u8);
+  CVI_SYS_FreeI(handle, &dst_s8);
+  return ret;
+}
@@ -0,0 +1,133 @@
+#include "cvi_ive.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+
+#define LEARN_FRAMES 30
+
+void make_frame(IVE_HANDLE handle, IVE_IMAGE_S *bg, IVE_IMAGE_S *frame, int with_object);
+int check_mask(IVE_IMAGE_S *fg);
+int run_type(IVE_HANDLE handle, IVE_BG_MODEL_TYPE_E type, size_t total_run);
+
+int main(int argc, char **argv) {
+  if (argc != 2) {
+    printf("Incorrect loop value. Usage: %s <loop in value (1-1000)>\n", argv[0]);
+    return CVI_FAILURE;
+  }
+  size_t total_run = atoi(argv[1]);
+  printf("Loop value: %zu\n", total_run);
+  if (total_run > 1000 || total_run == 0) {
+    printf("Incorrect loop value. Usage: %s <loop in value (1-1000)>\n", argv[0]);
+    return CVI_FAILURE;
+  }
+  // Create instance
+  IVE_HANDLE handle = CVI_IVE_CreateHandle();
+  printf("BM Kernel init.\n");
+
+  int ret = CVI_SUCCESS;
+  ret |= run_type(handle, IVE_BG_MODEL_TYPE_RUNNING_AVG, total_run);
+  ret |= run_type(handle, IVE_BG_MODEL_TYPE_GMM, total_run);
+  printf("%s\n", ret == CVI_SUCCESS ? "Check passed." : "Check failed.");
+
+  CVI_IVE_DestroyHandle(handle);
+  return ret;
+}
+
+// Background plus noise in [-2, 2], with a 64x64 square 100 brighter at (200, 200) if
+// with_object.
+void make_frame(IVE_HANDLE handle, IVE_IMAGE_S *bg, IVE_IMAGE_S *frame, int with_object) {
+  for (CVI_U32 y = 0; y < frame->u32Height; y++) {
+    for (CVI_U32 x = 0; x < frame->u32Width; x++) {
+      int v = bg->pu8VirAddr[0][y * bg->u16Stride[0] + x] + rand() % 5 - 2;
+      if (with_object && x >= 200 && x < 264 && y >= 200 && y < 264) {
+        v += 100;
+      }
+      frame->pu8VirAddr[0][y * frame->u16Stride[0] + x] = v < 0 ? 0 : (v > 255 ? 255 : v);
+    }
+  }
+  CVI_IVE_BufFlush(handle, frame);
+}
+
+int check_mask(IVE_IMAGE_S *fg) {
+  CVI_U32 missed = 0, false_alarm = 0;
+  for (CVI_U32 y = 0; y < fg->u32Height; y++) {
+    for (CVI_U32 x = 0; x < fg->u32Width; x++) {
+      int inside = x >= 200 && x < 264 && y >= 200 && y < 264;
+      CVI_U8 v = fg->pu8VirAddr[0][y * fg->u16Stride[0] + x];
+      if (inside && v != 255) missed++;
+      if (!inside && v != 0) false_alarm++;
+    }
+  }
+  printf("Missed %u, false alarm %u.\n", missed, false_alarm);
+  return missed < 64 * 64 / 100 && false_alarm < fg->u32Width * fg->u32Height / 100
+             ? CVI_SUCCESS
+             : CVI_FAILURE;
+}
+
+int run_type(IVE_HANDLE handle, IVE_BG_MODEL_TYPE_E type, size_t total_run) {
+  const CVI_U32 width = 640, height = 480;
+  IVE_IMAGE_S bg, frame, fg, bg_out;
+  CVI_IVE_CreateImage(handle, &bg, IVE_IMAGE_TYPE_U8C1, width, height);
+  CVI_IVE_CreateImage(handle, &frame, IVE_IMAGE_TYPE_U8C1, width, height);
+  CVI_IVE_CreateImage(handle, &fg, IVE_IMAGE_TYPE_U8C1, width, height);
+  CVI_IVE_CreateImage(handle, &bg_out, IVE_IMAGE_TYPE_U8C1, width, height);
+  srand(type);
+  for (CVI_U32 i = 0; i < bg.u16Stride[0] * height; i++) {
+    bg.pu8VirAddr[0][i] = 20 + rand() % 100;
+  }
+  IVE_BG_MODEL_S model;
+  int ret = CVI_IVE_CreateBGModel(handle, &model, type, width, height);
+  IVE_BG_MODEL_CTRL_S ctrl;
+  ctrl.f32LearnRate = 0.02f;
+  ctrl.u8DiffThr = 15;
+  ctrl.f32SigmaThr = 2.5f;
+  ctrl.f32BgRatio = 0.7f;
+  ctrl.f32InitVar = 16.f;
+
+  for (CVI_U32 i = 0; i < LEARN_FRAMES; i++) {
+    make_frame(handle, &bg, &frame, 0);
+    ret |= CVI_IVE_BGModel(handle, &frame, &fg, &model, &ctrl, 0);
+  }
+  ret |= CVI_IVE_GetBGImage(handle, &model, &bg_out);
+  for (CVI_U32 i = 0; i < width * height; i++) {
+    CVI_U32 x = i % width, y = i / width;
+    int diff = bg_out.pu8VirAddr[0][y * bg_out.u16Stride[0] + x] -
+               bg.pu8VirAddr[0][y * bg.u16Stride[0] + x];
+    if (diff < -2 || diff > 2) {
+      printf("Type %d: background (%u, %u) is off by %d.\n", type, x, y, diff);
+      ret = CVI_FAILURE;
+      break;
+    }
+  }
+
+  // The object is new to the model only in the first update.
+  make_frame(handle, &bg, &frame, 1);
+  ret |= CVI_IVE_BGModel(handle, &frame, &fg, &model, &ctrl, 0);
+  CVI_IVE_BufRequest(handle, &fg);
+  if (check_mask(&fg) != CVI_SUCCESS) {
+    printf("Type %d: foreground mask is incorrect.\n", type);
+    ret = CVI_FAILURE;
+  }
+
+  struct timeval t0, t1;
+  gettimeofday(&t0, NULL);
+  for (size_t i = 0; i < total_run; i++) {
+    ret |= CVI_IVE_BGModel(handle, &frame, &fg, &model, &ctrl, 0);
+  }
+  gettimeofday(&t1, NULL);
+  unsigned long elapsed_cpu =
+      ((t1.tv_sec - t0.tv_sec) * 1000000 + t1.tv_usec - t0.tv_usec) / total_run;
+  if (total_run > 1) {
+    const char *name = type == IVE_BG_MODEL_TYPE_GMM ? "BGModelGMM" : "BGModelAvg";
+    printf("OOO %-10s %10s %10lu %10s\n", name, "NA", elapsed_cpu, "NA");
+  }
+
+  CVI_SYS_FreeI(handle, &model.stModel);
+  CVI_SYS_FreeI(handle, &bg);
+  CVI_SYS_FreeI(handle, &frame);
+  CVI_SYS_FreeI(handle, &fg);
+  CVI_SYS_FreeI(handle, &bg_out);
+  return ret;
+}
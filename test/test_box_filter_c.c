@@ -0,0 +1,173 @@
+#include "cvi_ive.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+
+int cpu_ref(IVE_IMAGE_S *src, IVE_IMAGE_S *mean, IVE_IMAGE_S *var, IVE_BOX_FILTER_CTRL_S *ctrl);
+int run_ctrl(IVE_HANDLE handle, IVE_IMAGE_S *src, IVE_IMAGE_TYPE_E mean_type,
+             IVE_IMAGE_TYPE_E var_type, IVE_BOX_FILTER_CTRL_S *ctrl, const char *name,
+             size_t total_run);
+
+int main(int argc, char **argv) {
+  if (argc != 2) {
+    printf("Incorrect loop value. Usage: %s <loop in value (1-1000)>\n", argv[0]);
+    return CVI_FAILURE;
+  }
+  size_t total_run = atoi(argv[1]);
+  printf("Loop value: %zu\n", total_run);
+  if (total_run > 1000 || total_run == 0) {
+    printf("Incorrect loop value. Usage: %s <loop in value (1-1000)>\n", argv[0]);
+    return CVI_FAILURE;
+  }
+  // Create instance
+  IVE_HANDLE handle = CVI_IVE_CreateHandle();
+  printf("BM Kernel init.\n");
+
+  // The width is not a multiple of the vector size.
+  const CVI_U32 width = 641, height = 479;
+  IVE_IMAGE_S src;
+  CVI_IVE_CreateImage(handle, &src, IVE_IMAGE_TYPE_U8C1, width, height);
+  srand(0);
+  for (CVI_U32 y = 0; y < height; y++) {
+    for (CVI_U32 x = 0; x < width; x++) {
+      src.pu8VirAddr[0][y * src.u16Stride[0] + x] = ((x / 32 + y / 32) % 2) * 180 + rand() % 76;
+    }
+  }
+  CVI_IVE_BufFlush(handle, &src);
+
+  int ret = CVI_SUCCESS;
+  IVE_BOX_FILTER_CTRL_S ctrl;
+  memset(&ctrl, 0, sizeof(ctrl));
+  ctrl.u8Width = 3;
+  ctrl.u8Height = 3;
+  ctrl.enBorder = IVE_BORDER_MODE_REFLECT_101;
+  ret |= run_ctrl(handle, &src, IVE_IMAGE_TYPE_U8C1, IVE_IMAGE_TYPE_BUTT, &ctrl, "Box3", total_run);
+  ctrl.u8Width = 31;
+  ctrl.u8Height = 15;
+  ctrl.enBorder = IVE_BORDER_MODE_REPLICATE;
+  ret |= run_ctrl(handle, &src, IVE_IMAGE_TYPE_U16C1, IVE_IMAGE_TYPE_U16C1, &ctrl, "Box31x15",
+                  total_run);
+  ctrl.u8Width = 255;
+  ctrl.u8Height = 255;
+  ctrl.enBorder = IVE_BORDER_MODE_CONSTANT;
+  ctrl.u8BorderVal = 255;
+  ret |= run_ctrl(handle, &src, IVE_IMAGE_TYPE_FP32C1, IVE_IMAGE_TYPE_FP32C1, &ctrl, "Box255",
+                  total_run);
+  printf("%s\n", ret == CVI_SUCCESS ? "Check passed." : "Check failed.");
+
+  CVI_SYS_FreeI(handle, &src);
+  CVI_IVE_DestroyHandle(handle);
+  return ret;
+}
+
+int run_ctrl(IVE_HANDLE handle, IVE_IMAGE_S *src, IVE_IMAGE_TYPE_E mean_type,
+             IVE_IMAGE_TYPE_E var_type, IVE_BOX_FILTER_CTRL_S *ctrl, const char *name,
+             size_t total_run) {
+  IVE_IMAGE_S mean, var;
+  CVI_IVE_CreateImage(handle, &mean, mean_type, src->u32Width, src->u32Height);
+  IVE_IMAGE_S *var_ptr = NULL;
+  if (var_type != IVE_IMAGE_TYPE_BUTT) {
+    CVI_IVE_CreateImage(handle, &var, var_type, src->u32Width, src->u32Height);
+    var_ptr = &var;
+  }
+  int ret = CVI_SUCCESS;
+  struct timeval t0, t1;
+  gettimeofday(&t0, NULL);
+  for (size_t i = 0; i < total_run; i++) {
+    ret |= CVI_IVE_BoxFilter(handle, src, &mean, var_ptr, ctrl, 0);
+  }
+  gettimeofday(&t1, NULL);
+  unsigned long elapsed_cpu =
+      ((t1.tv_sec - t0.tv_sec) * 1000000 + t1.tv_usec - t0.tv_usec) / total_run;
+  CVI_IVE_BufRequest(handle, &mean);
+  if (var_ptr) {
+    CVI_IVE_BufRequest(handle, var_ptr);
+  }
+  if (cpu_ref(src, &mean, var_ptr, ctrl) != CVI_SUCCESS) {
+    printf("%s: result is different from the reference.\n", name);
+    ret = CVI_FAILURE;
+  }
+  if (total_run > 1) {
+    printf("OOO %-10s %10s %10lu %10s\n", name, "NA", elapsed_cpu, "NA");
+  }
+  CVI_SYS_FreeI(handle, &mean);
+  if (var_ptr) {
+    CVI_SYS_FreeI(handle, var_ptr);
+  }
+  return ret;
+}
+
+int ref_index(int i, int n, IVE_BORDER_MODE_E mode) {
+  if (i >= 0 && i < n) return i;
+  if (mode == IVE_BORDER_MODE_CONSTANT) return -1;
+  if (mode == IVE_BORDER_MODE_REPLICATE) return i < 0 ? 0 : n - 1;
+  while (i < 0 || i >= n) i = i < 0 ? -i : 2 * (n - 1) - i;
+  return i;
+}
+
+// Window sums from integral images of the padded image.
+int cpu_ref(IVE_IMAGE_S *src, IVE_IMAGE_S *mean, IVE_IMAGE_S *var, IVE_BOX_FILTER_CTRL_S *ctrl) {
+  const int width = src->u32Width, height = src->u32Height;
+  const int pw = width + ctrl->u8Width - 1, ph = height + ctrl->u8Height - 1;
+  const int hw = ctrl->u8Width / 2, hh = ctrl->u8Height / 2;
+  unsigned long long *isum = calloc((size_t)(pw + 1) * (ph + 1), sizeof(unsigned long long));
+  unsigned long long *isq = calloc((size_t)(pw + 1) * (ph + 1), sizeof(unsigned long long));
+  for (int y = 0; y < ph; y++) {
+    int sy = ref_index(y - hh, height, ctrl->enBorder);
+    for (int x = 0; x < pw; x++) {
+      int sx = ref_index(x - hw, width, ctrl->enBorder);
+      unsigned long long v = sy < 0 || sx < 0 ? ctrl->u8BorderVal
+                                              : src->pu8VirAddr[0][sy * src->u16Stride[0] + sx];
+      size_t i = (size_t)(y + 1) * (pw + 1) + x + 1;
+      isum[i] = v + isum[i - 1] + isum[i - pw - 1] - isum[i - pw - 2];
+      isq[i] = v * v + isq[i - 1] + isq[i - pw - 1] - isq[i - pw - 2];
+    }
+  }
+  const unsigned long long n = (unsigned long long)ctrl->u8Width * ctrl->u8Height;
+  int ret = CVI_SUCCESS;
+  for (int y = 0; y < height && ret == CVI_SUCCESS; y++) {
+    for (int x = 0; x < width; x++) {
+      size_t tl = (size_t)y * (pw + 1) + x, tr = tl + ctrl->u8Width;
+      size_t bl = tl + (size_t)ctrl->u8Height * (pw + 1), br = bl + ctrl->u8Width;
+      unsigned long long sum = isum[br] - isum[bl] - isum[tr] + isum[tl];
+      unsigned long long sq = isq[br] - isq[bl] - isq[tr] + isq[tl];
+      float result, expected;
+      CVI_U8 *row = mean->pu8VirAddr[0] + y * mean->u16Stride[0];
+      if (mean->enType == IVE_IMAGE_TYPE_U8C1) {
+        result = row[x];
+        expected = (sum + n / 2) / n;
+      } else if (mean->enType == IVE_IMAGE_TYPE_U16C1) {
+        result = ((CVI_U16 *)row)[x];
+        expected = ((sum << 8) + n / 2) / n;
+      } else {
+        result = ((float *)row)[x];
+        expected = sum * (1.f / n);
+      }
+      if (result != expected) {
+        printf("Mean (%d, %d) mismatch. Result: %f, expected: %f.\n", x, y, result, expected);
+        ret = CVI_FAILURE;
+        break;
+      }
+      if (var == NULL) continue;
+      unsigned long long d = n * sq - sum * sum;
+      row = var->pu8VirAddr[0] + y * var->u16Stride[0];
+      if (var->enType == IVE_IMAGE_TYPE_U16C1) {
+        result = ((CVI_U16 *)row)[x];
+        expected = (d + n * n / 2) / (n * n);
+      } else {
+        result = ((float *)row)[x];
+        expected = (float)((double)d / (n * n));
+      }
+      if (result != expected) {
+        printf("Var (%d, %d) mismatch. Result: %f, expected: %f.\n", x, y, result, expected);
+        ret = CVI_FAILURE;
+        break;
+      }
+    }
+  }
+  free(isum);
+  free(isq);
+  return ret;
+}
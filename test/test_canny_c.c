@@ -0,0 +1,177 @@
+#include "cvi_ive.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+
+void cpu_canny(IVE_IMAGE_S *src, CVI_U8 *edge, IVE_CANNY_CTRL_S *ctrl);
+int run_dist(IVE_HANDLE handle, IVE_IMAGE_S *src, IVE_MAG_DIST_E dist, size_t total_run);
+
+int main(int argc, char **argv) {
+  if (argc != 2) {
+    printf("Incorrect loop value. Usage: %s <loop in value (1-1000)>\n", argv[0]);
+    return CVI_FAILURE;
+  }
+  size_t total_run = atoi(argv[1]);
+  printf("Loop value: %zu\n", total_run);
+  if (total_run > 1000 || total_run == 0) {
+    printf("Incorrect loop value. Usage: %s <loop in value (1-1000)>\n", argv[0]);
+    return CVI_FAILURE;
+  }
+  // Create instance
+  IVE_HANDLE handle = CVI_IVE_CreateHandle();
+  printf("BM Kernel init.\n");
+
+  // Noisy discs and rectangles over a ramp.
+  const CVI_U32 width = 640, height = 480;
+  IVE_IMAGE_S src;
+  CVI_IVE_CreateImage(handle, &src, IVE_IMAGE_TYPE_U8C1, width, height);
+  srand(0);
+  for (CVI_U32 y = 0; y < height; y++) {
+    for (CVI_U32 x = 0; x < width; x++) {
+      src.pu8VirAddr[0][y * src.u16Stride[0] + x] = x / 8 + rand() % 16;
+    }
+  }
+  for (int i = 0; i < 20; i++) {
+    int cx = rand() % width, cy = rand() % height, r = 10 + rand() % 50;
+    CVI_U8 v = 100 + rand() % 156;
+    for (int y = cy - r; y <= cy + r; y++) {
+      for (int x = cx - r; x <= cx + r; x++) {
+        if (x < 0 || y < 0 || x >= (int)width || y >= (int)height) continue;
+        if (i % 2 == 0 && (x - cx) * (x - cx) + (y - cy) * (y - cy) > r * r) continue;
+        src.pu8VirAddr[0][y * src.u16Stride[0] + x] = v - rand() % 16;
+      }
+    }
+  }
+  CVI_IVE_BufFlush(handle, &src);
+
+  int ret = CVI_SUCCESS;
+  ret |= run_dist(handle, &src, IVE_MAG_DIST_L1, total_run);
+  ret |= run_dist(handle, &src, IVE_MAG_DIST_L2, total_run);
+  printf("%s\n", ret == CVI_SUCCESS ? "Check passed." : "Check failed.");
+
+  CVI_SYS_FreeI(handle, &src);
+  CVI_IVE_DestroyHandle(handle);
+  return ret;
+}
+
+int run_dist(IVE_HANDLE handle, IVE_IMAGE_S *src, IVE_MAG_DIST_E dist, size_t total_run) {
+  const CVI_U32 width = src->u32Width, height = src->u32Height;
+  IVE_IMAGE_S dst;
+  CVI_IVE_CreateImage(handle, &dst, IVE_IMAGE_TYPE_U8C1, width, height);
+  IVE_CANNY_CTRL_S ctrl;
+  ctrl.enDistCtrl = dist;
+  ctrl.u16LowThr = 60;
+  ctrl.u16HighThr = 150;
+
+  int ret = CVI_SUCCESS;
+  struct timeval t0, t1;
+  gettimeofday(&t0, NULL);
+  for (size_t i = 0; i < total_run; i++) {
+    ret |= CVI_IVE_Canny(handle, src, &dst, &ctrl, 0);
+  }
+  gettimeofday(&t1, NULL);
+  unsigned long elapsed_cpu =
+      ((t1.tv_sec - t0.tv_sec) * 1000000 + t1.tv_usec - t0.tv_usec) / total_run;
+
+  CVI_U8 *edge = malloc(width * height);
+  cpu_canny(src, edge, &ctrl);
+  CVI_IVE_BufRequest(handle, &dst);
+  CVI_U32 edge_num = 0;
+  for (CVI_U32 y = 0; y < height && ret == CVI_SUCCESS; y++) {
+    for (CVI_U32 x = 0; x < width; x++) {
+      CVI_U8 v = dst.pu8VirAddr[0][y * dst.u16Stride[0] + x];
+      edge_num += v == 255;
+      if (v != edge[y * width + x]) {
+        printf("Dist %d (%u, %u) mismatch. Result: %u, expected: %u.\n", dist, x, y, v,
+               edge[y * width + x]);
+        ret = CVI_FAILURE;
+        break;
+      }
+    }
+  }
+  if (edge_num == 0) {
+    printf("Dist %d: no edge found.\n", dist);
+    ret = CVI_FAILURE;
+  }
+
+  if (total_run == 1) {
+    printf("Dist %d found %u edge pixels.\n", dist, edge_num);
+  } else {
+    printf("OOO %-10s %10s %10lu %10s\n", "Canny", "NA", elapsed_cpu, "NA");
+  }
+  free(edge);
+  CVI_SYS_FreeI(handle, &dst);
+  return ret;
+}
+
+// Non-maximum suppression along the gradient quantized to 4 directions, then hysteresis by flood
+// fill from the strong pixels.
+void cpu_canny(IVE_IMAGE_S *src, CVI_U8 *edge, IVE_CANNY_CTRL_S *ctrl) {
+  const int width = src->u32Width, height = src->u32Height, stride = src->u16Stride[0];
+  const CVI_U8 *s = src->pu8VirAddr[0];
+  int *gx = calloc(width * height, sizeof(int));
+  int *gy = calloc(width * height, sizeof(int));
+  long long *mag = calloc(width * height, sizeof(long long));
+  int *stack = malloc(width * height * sizeof(int));
+  long long low = ctrl->u16LowThr, high = ctrl->u16HighThr;
+  int l2 = ctrl->enDistCtrl == IVE_MAG_DIST_L2;
+  if (l2) {
+    low *= low;
+    high *= high;
+  }
+  for (int y = 1; y + 1 < height; y++) {
+    for (int x = 1; x + 1 < width; x++) {
+      int p = y * width + x;
+#define S(i, j) s[(y + (i)) * stride + x + (j)]
+      gx[p] = S(-1, 1) - S(-1, -1) + 2 * (S(0, 1) - S(0, -1)) + S(1, 1) - S(1, -1);
+      gy[p] = S(1, -1) + 2 * S(1, 0) + S(1, 1) - S(-1, -1) - 2 * S(-1, 0) - S(-1, 1);
+#undef S
+      mag[p] = l2 ? (long long)gx[p] * gx[p] + gy[p] * gy[p] : abs(gx[p]) + abs(gy[p]);
+    }
+  }
+  int top = 0;
+  memset(edge, 0, width * height);
+  for (int y = 1; y + 1 < height; y++) {
+    for (int x = 1; x + 1 < width; x++) {
+      int p = y * width + x;
+      long long m = mag[p], ax = abs(gx[p]), ay = abs(gy[p]);
+      int keep;
+      if (ay * 32768 < ax * 13573) {
+        keep = m > mag[p - 1] && m >= mag[p + 1];
+      } else if (ay * 32768 > ax * (13573 + 65536)) {
+        keep = m > mag[p - width] && m >= mag[p + width];
+      } else if ((gx[p] < 0) == (gy[p] < 0)) {
+        keep = m > mag[p - width - 1] && m > mag[p + width + 1];
+      } else {
+        keep = m > mag[p - width + 1] && m > mag[p + width - 1];
+      }
+      if (!keep || m <= low) continue;
+      edge[p] = 1;
+      if (m > high) {
+        edge[p] = 255;
+        stack[top++] = p;
+      }
+    }
+  }
+  while (top > 0) {
+    int p = stack[--top];
+    for (int i = -1; i <= 1; i++) {
+      for (int j = -1; j <= 1; j++) {
+        int q = p + i * width + j;
+        if (edge[q] == 1) {
+          edge[q] = 255;
+          stack[top++] = q;
+        }
+      }
+    }
+  }
+  for (int p = 0; p < width * height; p++) {
+    edge[p] = edge[p] == 255 ? 255 : 0;
+  }
+  free(gx);
+  free(gy);
+  free(mag);
+  free(stack);
+}
@@ -5,6 +5,13 @@
 #include <string.h>
 #include <sys/time.h>
 
+int cpu_ref(IVE_SRC_IMAGE_S *src, IVE_DST_IMAGE_S *dst, IVE_ORD_STAT_FILTER_CTRL_S *ctrl);
+int compare_u8(const void *a, const void *b);
+int run_cpu_filter(IVE_HANDLE handle, IVE_SRC_IMAGE_S *src, IVE_ORD_STAT_FILTER_MODE_E enMode,
+                   CVI_U8 u8KernelSize, size_t total_run, unsigned long *elapsed);
+int run_tpu_chain(IVE_HANDLE handle, IVE_SRC_IMAGE_S *src, IVE_ORD_STAT_FILTER_MODE_E enMode,
+                  CVI_U8 u8KernelSize, size_t total_run, unsigned long *elapsed);
+
 int main(int argc, char **argv) {
   if (argc != 3) {
     printf("Incorrect loop value. Usage: %s <file name> <loop in value (1-1000)>\n", argv[0]);
@@ -19,6 +26,7 @@ int main(int argc, char **argv) {
   }
   // Create instance
   IVE_HANDLE handle = CVI_IVE_CreateHandle();
+  int ret = CVI_SUCCESS;
   printf("BM Kernel init.\n");
 
   // Fetch image information
@@ -35,6 +43,8 @@ int main(int argc, char **argv) {
   printf("Run TPU Max.\n");
   IVE_ORD_STAT_FILTER_CTRL_S pstOrdStatFltCtrl;
   pstOrdStatFltCtrl.enMode = IVE_ORD_STAT_FILTER_MODE_MAX;
+  // Kernel size 0 keeps the legacy 3x3 window.
+  pstOrdStatFltCtrl.u8KernelSize = 0;
   struct timeval t0, t1;
   gettimeofday(&t0, NULL);
   for (size_t i = 0; i < total_run; i++) {
@@ -53,6 +63,30 @@ int main(int argc, char **argv) {
   gettimeofday(&t1, NULL);
   unsigned long elapsed_tpu_min =
       ((t1.tv_sec - t0.tv_sec) * 1000000 + t1.tv_usec - t0.tv_usec) / total_run;
+  CVI_IVE_BufRequest(handle, &dst);
+  CVI_IVE_BufRequest(handle, &dst2);
+  pstOrdStatFltCtrl.enMode = IVE_ORD_STAT_FILTER_MODE_MAX;
+  ret |= cpu_ref(&src, &dst, &pstOrdStatFltCtrl);
+  pstOrdStatFltCtrl.enMode = IVE_ORD_STAT_FILTER_MODE_MIN;
+  ret |= cpu_ref(&src, &dst2, &pstOrdStatFltCtrl);
+
+  // CPU median and separable max/min with larger windows. The 7x7 max/min are timed against the
+  // same window built from three chained TPU 3x3 passes.
+  printf("Run CPU Median and large kernel Max/Min.\n");
+  unsigned long elapsed_cpu_med3, elapsed_cpu_med5, elapsed_cpu_max7, elapsed_cpu_min7;
+  unsigned long elapsed_tpu_max7, elapsed_tpu_min7;
+  ret |= run_cpu_filter(handle, &src, IVE_ORD_STAT_FILTER_MODE_MEDIAN, 3, total_run,
+                        &elapsed_cpu_med3);
+  ret |= run_cpu_filter(handle, &src, IVE_ORD_STAT_FILTER_MODE_MEDIAN, 5, total_run,
+                        &elapsed_cpu_med5);
+  ret |= run_cpu_filter(handle, &src, IVE_ORD_STAT_FILTER_MODE_MAX, 7, total_run,
+                        &elapsed_cpu_max7);
+  ret |= run_cpu_filter(handle, &src, IVE_ORD_STAT_FILTER_MODE_MIN, 7, total_run,
+                        &elapsed_cpu_min7);
+  ret |= run_tpu_chain(handle, &src, IVE_ORD_STAT_FILTER_MODE_MAX, 7, total_run,
+                       &elapsed_tpu_max7);
+  ret |= run_tpu_chain(handle, &src, IVE_ORD_STAT_FILTER_MODE_MIN, 7, total_run,
+                       &elapsed_tpu_min7);
 
   if (total_run == 1) {
     // write result to disk
@@ -62,7 +96,12 @@ int main(int argc, char **argv) {
   } else {
     printf("OOO %-10s %10lu %10s %10s\n", "TPU MAX", elapsed_tpu_max, "NA", "NA");
     printf("OOO %-10s %10lu %10s %10s\n", "TPU MIN", elapsed_tpu_min, "NA", "NA");
+    printf("OOO %-10s %10s %10lu %10s\n", "MEDIAN3", "NA", elapsed_cpu_med3, "NA");
+    printf("OOO %-10s %10s %10lu %10s\n", "MEDIAN5", "NA", elapsed_cpu_med5, "NA");
+    printf("OOO %-10s %10lu %10lu %10s\n", "MAX7", elapsed_tpu_max7, elapsed_cpu_max7, "NA");
+    printf("OOO %-10s %10lu %10lu %10s\n", "MIN7", elapsed_tpu_min7, elapsed_cpu_min7, "NA");
   }
+  printf("%s\n", ret == CVI_SUCCESS ? "Check passed." : "Check failed.");
 
   // Free memory, instance
   CVI_SYS_FreeI(handle, &src);
@@ -70,5 +109,90 @@ int main(int argc, char **argv) {
   CVI_SYS_FreeI(handle, &dst2);
   CVI_IVE_DestroyHandle(handle);
 
-  return 0;
+  return ret;
+}
+
+int run_cpu_filter(IVE_HANDLE handle, IVE_SRC_IMAGE_S *src, IVE_ORD_STAT_FILTER_MODE_E enMode,
+                   CVI_U8 u8KernelSize, size_t total_run, unsigned long *elapsed) {
+  IVE_DST_IMAGE_S dst;
+  CVI_IVE_CreateImage(handle, &dst, IVE_IMAGE_TYPE_U8C1, src->u32Width - u8KernelSize + 1,
+                      src->u32Height - u8KernelSize + 1);
+  IVE_ORD_STAT_FILTER_CTRL_S ctrl;
+  ctrl.enMode = enMode;
+  ctrl.u8KernelSize = u8KernelSize;
+  int ret = CVI_SUCCESS;
+  struct timeval t0, t1;
+  gettimeofday(&t0, NULL);
+  for (size_t i = 0; i < total_run; i++) {
+    ret |= CVI_IVE_OrdStatFilter(handle, src, &dst, &ctrl, 0);
+  }
+  gettimeofday(&t1, NULL);
+  *elapsed = ((t1.tv_sec - t0.tv_sec) * 1000000 + t1.tv_usec - t0.tv_usec) / total_run;
+  CVI_IVE_BufRequest(handle, &dst);
+  ret |= cpu_ref(src, &dst, &ctrl);
+  CVI_SYS_FreeI(handle, &dst);
+  return ret;
+}
+
+// A kz x kz max or min equals (kz - 1) / 2 chained 3x3 passes, each shrinking the image by 2.
+int run_tpu_chain(IVE_HANDLE handle, IVE_SRC_IMAGE_S *src, IVE_ORD_STAT_FILTER_MODE_E enMode,
+                  CVI_U8 u8KernelSize, size_t total_run, unsigned long *elapsed) {
+  const CVI_U32 passes = (u8KernelSize - 1) / 2;
+  IVE_IMAGE_S imgs[8];
+  imgs[0] = *src;
+  for (CVI_U32 p = 1; p <= passes; p++) {
+    CVI_IVE_CreateImage(handle, &imgs[p], IVE_IMAGE_TYPE_U8C1, src->u32Width - 2 * p,
+                        src->u32Height - 2 * p);
+  }
+  IVE_ORD_STAT_FILTER_CTRL_S ctrl;
+  ctrl.enMode = enMode;
+  ctrl.u8KernelSize = 3;
+  int ret = CVI_SUCCESS;
+  struct timeval t0, t1;
+  gettimeofday(&t0, NULL);
+  for (size_t i = 0; i < total_run; i++) {
+    for (CVI_U32 p = 1; p <= passes; p++) {
+      ret |= CVI_IVE_OrdStatFilter(handle, &imgs[p - 1], &imgs[p], &ctrl, 0);
+    }
+  }
+  gettimeofday(&t1, NULL);
+  *elapsed = ((t1.tv_sec - t0.tv_sec) * 1000000 + t1.tv_usec - t0.tv_usec) / total_run;
+  CVI_IVE_BufRequest(handle, &imgs[passes]);
+  ctrl.u8KernelSize = u8KernelSize;
+  ret |= cpu_ref(src, &imgs[passes], &ctrl);
+  for (CVI_U32 p = 1; p <= passes; p++) {
+    CVI_SYS_FreeI(handle, &imgs[p]);
+  }
+  return ret;
+}
+
+int compare_u8(const void *a, const void *b) { return *(CVI_U8 *)a - *(CVI_U8 *)b; }
+
+int cpu_ref(IVE_SRC_IMAGE_S *src, IVE_DST_IMAGE_S *dst, IVE_ORD_STAT_FILTER_CTRL_S *ctrl) {
+  CVI_U32 kz = ctrl->u8KernelSize == 0 ? 3 : ctrl->u8KernelSize;
+  CVI_U8 *window = (CVI_U8 *)malloc(kz * kz);
+  int ret = CVI_SUCCESS;
+  for (CVI_U32 i = 0; i < dst->u32Height && ret == CVI_SUCCESS; i++) {
+    for (CVI_U32 j = 0; j < dst->u32Width; j++) {
+      for (CVI_U32 r = 0; r < kz; r++) {
+        memcpy(window + r * kz, src->pu8VirAddr[0] + (i + r) * src->u16Stride[0] + j, kz);
+      }
+      qsort(window, kz * kz, 1, compare_u8);
+      CVI_U8 expected = window[kz * kz / 2];
+      if (ctrl->enMode == IVE_ORD_STAT_FILTER_MODE_MAX) {
+        expected = window[kz * kz - 1];
+      } else if (ctrl->enMode == IVE_ORD_STAT_FILTER_MODE_MIN) {
+        expected = window[0];
+      }
+      CVI_U8 res = dst->pu8VirAddr[0][i * dst->u16Stride[0] + j];
+      if (res != expected) {
+        printf("Mode %d kernel %u [%u, %u] IVE %u, CPU %u\n", ctrl->enMode, kz, j, i, res,
+               expected);
+        ret = CVI_FAILURE;
+        break;
+      }
+    }
+  }
+  free(window);
+  return ret;
 }
\ No newline at end of file
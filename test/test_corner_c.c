@@ -0,0 +1,198 @@
+#include "cvi_ive.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+
+#define MAX_CORNER_NUM 500
+
+CVI_U32 cpu_ref(IVE_IMAGE_S *src, IVE_CORNER_CTRL_S *ctrl, IVE_CORNER_S *corners);
+int run_type(IVE_HANDLE handle, IVE_IMAGE_S *src, IVE_CORNER_TYPE_E type, float thr,
+             size_t total_run);
+
+int main(int argc, char **argv) {
+  if (argc != 3) {
+    printf("Incorrect loop value. Usage: %s <file_name> <loop in value (1-1000)>\n", argv[0]);
+    return CVI_FAILURE;
+  }
+  const char *file_name = argv[1];
+  size_t total_run = atoi(argv[2]);
+  printf("Loop value: %zu\n", total_run);
+  if (total_run > 1000 || total_run == 0) {
+    printf("Incorrect loop value. Usage: %s <file_name> <loop in value (1-1000)>\n", argv[0]);
+    return CVI_FAILURE;
+  }
+  // Create instance
+  IVE_HANDLE handle = CVI_IVE_CreateHandle();
+  printf("BM Kernel init.\n");
+
+  // Fetch image information
+  IVE_IMAGE_S src = CVI_IVE_ReadImage(handle, file_name, IVE_IMAGE_TYPE_U8C1);
+
+  int ret = CVI_SUCCESS;
+  ret |= run_type(handle, &src, IVE_CORNER_TYPE_HARRIS, 1e-6f, total_run);
+  ret |= run_type(handle, &src, IVE_CORNER_TYPE_SHI_TOMASI, 1e-3f, total_run);
+  ret |= run_type(handle, &src, IVE_CORNER_TYPE_FAST, 20, total_run);
+  printf("%s\n", ret == CVI_SUCCESS ? "Check passed." : "Check failed.");
+
+  CVI_SYS_FreeI(handle, &src);
+  CVI_IVE_DestroyHandle(handle);
+  return ret;
+}
+
+int run_type(IVE_HANDLE handle, IVE_IMAGE_S *src, IVE_CORNER_TYPE_E type, float thr,
+             size_t total_run) {
+  const char *names[] = {"Harris", "ShiTomasi", "FAST"};
+  IVE_CORNER_CTRL_S ctrl;
+  ctrl.enType = type;
+  ctrl.u8BlockSize = 5;
+  ctrl.f32HarrisK = 0.04f;
+  ctrl.f32Thr = thr;
+  ctrl.u16CellSize = 16;
+
+  int ret = CVI_SUCCESS;
+  IVE_CORNER_S corners[MAX_CORNER_NUM], ref_corners[MAX_CORNER_NUM];
+  CVI_U32 num = 0;
+  struct timeval t0, t1;
+  gettimeofday(&t0, NULL);
+  for (size_t i = 0; i < total_run; i++) {
+    ret |= CVI_IVE_CornerDetect(handle, src, corners, MAX_CORNER_NUM, &num, &ctrl, 0);
+  }
+  gettimeofday(&t1, NULL);
+  unsigned long elapsed_cpu =
+      ((t1.tv_sec - t0.tv_sec) * 1000000 + t1.tv_usec - t0.tv_usec) / total_run;
+
+  // Scores are compared with a tolerance, so near ties may be ordered differently.
+  CVI_U32 ref_num = cpu_ref(src, &ctrl, ref_corners);
+  if (num != ref_num) {
+    printf("%s: corner number mismatch. Result: %u, expected: %u.\n", names[type], num, ref_num);
+    ret = CVI_FAILURE;
+  }
+  for (CVI_U32 i = 0; i < num && ret == CVI_SUCCESS; i++) {
+    CVI_U32 j = 0;
+    while (j < ref_num &&
+           (ref_corners[j].u16X != corners[i].u16X || ref_corners[j].u16Y != corners[i].u16Y)) {
+      j++;
+    }
+    if (j == ref_num ||
+        fabsf(corners[i].f32Score - ref_corners[j].f32Score) > 1e-4f * fabsf(corners[i].f32Score)) {
+      printf("%s: corner (%u, %u) score %g is not expected.\n", names[type], corners[i].u16X,
+             corners[i].u16Y, corners[i].f32Score);
+      ret = CVI_FAILURE;
+    }
+  }
+
+  if (total_run == 1) {
+    printf("%s found %u corners.\n", names[type], num);
+  } else {
+    printf("OOO %-10s %10s %10lu %10s\n", names[type], "NA", elapsed_cpu, "NA");
+  }
+  return ret;
+}
+
+int fast_ref_score(IVE_IMAGE_S *src, int x, int y) {
+  const int dx[16] = {0, 1, 2, 3, 3, 3, 2, 1, 0, -1, -2, -3, -3, -3, -2, -1};
+  const int dy[16] = {-3, -3, -2, -1, 0, 1, 2, 3, 3, 3, 2, 1, 0, -1, -2, -3};
+  const int stride = src->u16Stride[0];
+  const CVI_U8 *p = src->pu8VirAddr[0] + y * stride + x;
+  int best = 0;
+  for (int start = 0; start < 16; start++) {
+    int bright = 255, dark = 255;
+    for (int i = 0; i < 9; i++) {
+      int k = (start + i) % 16, d = p[dy[k] * stride + dx[k]] - p[0];
+      bright = d < bright ? d : bright;
+      dark = -d < dark ? -d : dark;
+    }
+    best = bright > best ? bright : best;
+    best = dark > best ? dark : best;
+  }
+  return best;
+}
+
+// Naive window sums, 3x3 maxima, best of each cell and a selection sort.
+CVI_U32 cpu_ref(IVE_IMAGE_S *src, IVE_CORNER_CTRL_S *ctrl, IVE_CORNER_S *corners) {
+  const int width = src->u32Width, height = src->u32Height, stride = src->u16Stride[0];
+  const CVI_U8 *s = src->pu8VirAddr[0];
+  const int fast = ctrl->enType == IVE_CORNER_TYPE_FAST, half = ctrl->u8BlockSize / 2;
+  const int margin = fast ? 3 : half + 1;
+  int *gx = calloc(width * height, sizeof(int));
+  int *gy = calloc(width * height, sizeof(int));
+  float *score = calloc(width * height, sizeof(float));
+  for (int y = 1; y + 1 < height; y++) {
+    for (int x = 1; x + 1 < width; x++) {
+#define S(i, j) s[(y + (i)) * stride + x + (j)]
+      gx[y * width + x] = S(-1, 1) - S(-1, -1) + 2 * (S(0, 1) - S(0, -1)) + S(1, 1) - S(1, -1);
+      gy[y * width + x] = S(1, -1) + 2 * S(1, 0) + S(1, 1) - S(-1, -1) - 2 * S(-1, 0) - S(-1, 1);
+#undef S
+    }
+  }
+  const float scale = 1.f / (16.f * 255.f * 255.f * ctrl->u8BlockSize * ctrl->u8BlockSize);
+  for (int y = margin; y + margin < height; y++) {
+    for (int x = margin; x + margin < width; x++) {
+      if (fast) {
+        int v = fast_ref_score(src, x, y);
+        score[y * width + x] = v > (int)ctrl->f32Thr ? v : 0;
+        continue;
+      }
+      int sxx = 0, sxy = 0, syy = 0;
+      for (int i = -half; i <= half; i++) {
+        for (int j = -half; j <= half; j++) {
+          int p = (y + i) * width + x + j;
+          sxx += gx[p] * gx[p];
+          sxy += gx[p] * gy[p];
+          syy += gy[p] * gy[p];
+        }
+      }
+      float a = sxx * scale, b = sxy * scale, c = syy * scale;
+      score[y * width + x] = ctrl->enType == IVE_CORNER_TYPE_HARRIS
+                                 ? a * c - b * b - ctrl->f32HarrisK * (a + c) * (a + c)
+                                 : (a + c) * 0.5f - sqrtf((a - c) * (a - c) * 0.25f + b * b);
+    }
+  }
+  const int cell = ctrl->u16CellSize, cells_x = (width + cell - 1) / cell;
+  const int cells_y = (height + cell - 1) / cell;
+  IVE_CORNER_S *best = calloc(cells_x * cells_y, sizeof(IVE_CORNER_S));
+  for (int y = margin; y + margin < height; y++) {
+    for (int x = margin; x + margin < width; x++) {
+      float v = score[y * width + x];
+      if (v <= ctrl->f32Thr) continue;
+      int is_max = 1;
+      for (int i = -1; i <= 1; i++) {
+        for (int j = -1; j <= 1; j++) {
+          float n = score[(y + i) * width + x + j];
+          int before = i < 0 || (i == 0 && j < 0);
+          if ((i != 0 || j != 0) && (before ? v <= n : v < n)) is_max = 0;
+        }
+      }
+      IVE_CORNER_S *b = &best[(y / cell) * cells_x + x / cell];
+      if (is_max && (b->f32Score == 0 || v > b->f32Score)) {
+        b->u16X = x;
+        b->u16Y = y;
+        b->f32Score = v;
+      }
+    }
+  }
+  CVI_U32 num = 0;
+  for (int i = 0; i < cells_x * cells_y && num < MAX_CORNER_NUM; i++) {
+    int pick = -1;
+    for (int c = 0; c < cells_x * cells_y; c++) {
+      if (best[c].f32Score == 0) continue;
+      if (pick < 0 || best[c].f32Score > best[pick].f32Score ||
+          (best[c].f32Score == best[pick].f32Score &&
+           (best[c].u16Y < best[pick].u16Y ||
+            (best[c].u16Y == best[pick].u16Y && best[c].u16X < best[pick].u16X)))) {
+        pick = c;
+      }
+    }
+    if (pick < 0) break;
+    corners[num++] = best[pick];
+    best[pick].f32Score = 0;
+  }
+  free(gx);
+  free(gy);
+  free(score);
+  free(best);
+  return num;
+}
@@ -0,0 +1,160 @@
+#include "cvi_ive.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+
+int cpu_ref(IVE_IMAGE_S *src, IVE_IMAGE_S *dst, IVE_DIST_TRANSFORM_TYPE_E type);
+int run_ctrl(IVE_HANDLE handle, IVE_IMAGE_S *src, IVE_DIST_TRANSFORM_TYPE_E type,
+             IVE_IMAGE_TYPE_E dst_type, const char *name, size_t total_run);
+
+int main(int argc, char **argv) {
+  if (argc != 2) {
+    printf("Incorrect loop value. Usage: %s <loop in value (1-1000)>\n", argv[0]);
+    return CVI_FAILURE;
+  }
+  size_t total_run = atoi(argv[1]);
+  printf("Loop value: %zu\n", total_run);
+  if (total_run > 1000 || total_run == 0) {
+    printf("Incorrect loop value. Usage: %s <loop in value (1-1000)>\n", argv[0]);
+    return CVI_FAILURE;
+  }
+  // Create instance
+  IVE_HANDLE handle = CVI_IVE_CreateHandle();
+  printf("BM Kernel init.\n");
+
+  // Foreground with a few background rectangles and dots, thresholded like CVI_IVE_Thresh does.
+  const CVI_U32 width = 201, height = 151;
+  IVE_IMAGE_S src;
+  CVI_IVE_CreateImage(handle, &src, IVE_IMAGE_TYPE_U8C1, width, height);
+  for (CVI_U32 y = 0; y < height; y++) {
+    memset(src.pu8VirAddr[0] + y * src.u16Stride[0], 255, width);
+  }
+  srand(0);
+  for (int i = 0; i < 6; i++) {
+    CVI_U32 x0 = rand() % width, y0 = rand() % height;
+    CVI_U32 w = rand() % 20 + 1, h = rand() % 20 + 1;
+    for (CVI_U32 y = y0; y < y0 + h && y < height; y++) {
+      for (CVI_U32 x = x0; x < x0 + w && x < width; x++) {
+        src.pu8VirAddr[0][y * src.u16Stride[0] + x] = 0;
+      }
+    }
+  }
+  for (int i = 0; i < 20; i++) {
+    src.pu8VirAddr[0][(rand() % height) * src.u16Stride[0] + rand() % width] = 0;
+  }
+  CVI_IVE_BufFlush(handle, &src);
+
+  int ret = CVI_SUCCESS;
+  ret |= run_ctrl(handle, &src, IVE_DIST_TRANSFORM_TYPE_EUCLIDEAN, IVE_IMAGE_TYPE_FP32C1, "EDT32",
+                  total_run);
+  ret |= run_ctrl(handle, &src, IVE_DIST_TRANSFORM_TYPE_EUCLIDEAN, IVE_IMAGE_TYPE_U16C1, "EDT16",
+                  total_run);
+  ret |= run_ctrl(handle, &src, IVE_DIST_TRANSFORM_TYPE_CHAMFER, IVE_IMAGE_TYPE_FP32C1,
+                  "Chamfer32", total_run);
+  ret |= run_ctrl(handle, &src, IVE_DIST_TRANSFORM_TYPE_CHAMFER, IVE_IMAGE_TYPE_U16C1,
+                  "Chamfer16", total_run);
+
+  // Without background every distance is infinite.
+  for (CVI_U32 y = 0; y < height; y++) {
+    memset(src.pu8VirAddr[0] + y * src.u16Stride[0], 1, width);
+  }
+  CVI_IVE_BufFlush(handle, &src);
+  ret |= run_ctrl(handle, &src, IVE_DIST_TRANSFORM_TYPE_EUCLIDEAN, IVE_IMAGE_TYPE_U16C1, "EDTFull",
+                  1);
+  ret |= run_ctrl(handle, &src, IVE_DIST_TRANSFORM_TYPE_CHAMFER, IVE_IMAGE_TYPE_FP32C1,
+                  "ChamferFull", 1);
+  printf("%s\n", ret == CVI_SUCCESS ? "Check passed." : "Check failed.");
+
+  CVI_SYS_FreeI(handle, &src);
+  CVI_IVE_DestroyHandle(handle);
+  return ret;
+}
+
+int run_ctrl(IVE_HANDLE handle, IVE_IMAGE_S *src, IVE_DIST_TRANSFORM_TYPE_E type,
+             IVE_IMAGE_TYPE_E dst_type, const char *name, size_t total_run) {
+  IVE_IMAGE_S dst;
+  CVI_IVE_CreateImage(handle, &dst, dst_type, src->u32Width, src->u32Height);
+  IVE_DIST_TRANSFORM_CTRL_S ctrl;
+  ctrl.enType = type;
+  int ret = CVI_SUCCESS;
+  struct timeval t0, t1;
+  gettimeofday(&t0, NULL);
+  for (size_t i = 0; i < total_run; i++) {
+    ret |= CVI_IVE_DistanceTransform(handle, src, &dst, &ctrl, 0);
+  }
+  gettimeofday(&t1, NULL);
+  unsigned long elapsed_cpu =
+      ((t1.tv_sec - t0.tv_sec) * 1000000 + t1.tv_usec - t0.tv_usec) / total_run;
+  CVI_IVE_BufRequest(handle, &dst);
+  if (cpu_ref(src, &dst, type) != CVI_SUCCESS) {
+    printf("%s: result is different from the reference.\n", name);
+    ret = CVI_FAILURE;
+  }
+  if (total_run > 1) {
+    printf("OOO %-10s %10s %10lu %10s\n", name, "NA", elapsed_cpu, "NA");
+  }
+  CVI_SYS_FreeI(handle, &dst);
+  return ret;
+}
+
+// Brute force over all background pixels. The 3-4 chamfer distance of an offset is
+// 3 * max(|dx|, |dy|) + min(|dx|, |dy|).
+int cpu_ref(IVE_IMAGE_S *src, IVE_IMAGE_S *dst, IVE_DIST_TRANSFORM_TYPE_E type) {
+  const int width = src->u32Width, height = src->u32Height;
+  int *bg = malloc(sizeof(int) * 2 * width * height);
+  int bg_num = 0;
+  for (int y = 0; y < height; y++) {
+    for (int x = 0; x < width; x++) {
+      if (src->pu8VirAddr[0][y * src->u16Stride[0] + x] == 0) {
+        bg[2 * bg_num] = x;
+        bg[2 * bg_num + 1] = y;
+        bg_num++;
+      }
+    }
+  }
+  const int to_u16 = dst->enType == IVE_IMAGE_TYPE_U16C1;
+  int ret = CVI_SUCCESS;
+  for (int y = 0; y < height && ret == CVI_SUCCESS; y++) {
+    for (int x = 0; x < width; x++) {
+      long long best = -1;
+      for (int i = 0; i < bg_num; i++) {
+        long long dx = llabs(bg[2 * i] - x), dy = llabs(bg[2 * i + 1] - y);
+        long long d = type == IVE_DIST_TRANSFORM_TYPE_EUCLIDEAN
+                          ? dx * dx + dy * dy
+                          : 3 * (dx > dy ? dx : dy) + (dx > dy ? dy : dx);
+        if (best < 0 || d < best) best = d;
+      }
+      float dist;
+      if (best < 0) {
+        dist = INFINITY;
+      } else {
+        dist = type == IVE_DIST_TRANSFORM_TYPE_EUCLIDEAN ? (float)sqrt((double)best) : best / 3.f;
+      }
+      float expected, result;
+      CVI_U8 *row = dst->pu8VirAddr[0] + y * dst->u16Stride[0];
+      if (to_u16) {
+        if (best < 0) {
+          expected = 65535;
+        } else if (type == IVE_DIST_TRANSFORM_TYPE_EUCLIDEAN) {
+          expected = (CVI_U16)(dist + 0.5f);
+        } else {
+          expected = (best + 1) / 3;
+        }
+        result = ((CVI_U16 *)row)[x];
+      } else {
+        expected = dist;
+        result = ((float *)row)[x];
+      }
+      if (result != expected) {
+        printf("(%d, %d) mismatch. Result: %f, expected: %f.\n", x, y, result, expected);
+        ret = CVI_FAILURE;
+        break;
+      }
+    }
+  }
+  free(bg);
+  return ret;
+}
@@ -0,0 +1,147 @@
+#include "cvi_ive.h"
+#include "ive_draw.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+
+#define RECT_NUM 64
+#define BG_VALUE 7
+
+void fill_image(IVE_HANDLE handle, IVE_IMAGE_S *img, CVI_U32 plane_num);
+int compare_image(IVE_IMAGE_S *a, IVE_IMAGE_S *b, CVI_U32 plane_num);
+int run_type(IVE_HANDLE handle, IVE_IMAGE_TYPE_E type, CVI_U32 plane_num, size_t total_run);
+
+int main(int argc, char **argv) {
+  if (argc != 2) {
+    printf("Incorrect loop value. Usage: %s <loop in value (1-1000)>\n", argv[0]);
+    return CVI_FAILURE;
+  }
+  size_t total_run = atoi(argv[1]);
+  printf("Loop value: %zu\n", total_run);
+  if (total_run > 1000 || total_run == 0) {
+    printf("Incorrect loop value. Usage: %s <loop in value (1-1000)>\n", argv[0]);
+    return CVI_FAILURE;
+  }
+  // Create instance
+  IVE_HANDLE handle = CVI_IVE_CreateHandle();
+  printf("BM Kernel init.\n");
+
+  int ret = CVI_SUCCESS;
+  ret |= run_type(handle, IVE_IMAGE_TYPE_U8C3_PLANAR, 3, total_run);
+  ret |= run_type(handle, IVE_IMAGE_TYPE_YUV420P, 3, total_run);
+  ret |= run_type(handle, IVE_IMAGE_TYPE_YUV420SP, 2, total_run);
+  printf("%s\n", ret == CVI_SUCCESS ? "Check passed." : "Check failed.");
+
+  CVI_IVE_DestroyHandle(handle);
+  return ret;
+}
+
+void fill_image(IVE_HANDLE handle, IVE_IMAGE_S *img, CVI_U32 plane_num) {
+  for (CVI_U32 i = 0; i < plane_num; i++) {
+    CVI_U32 height = (i == 0 || img->enType == IVE_IMAGE_TYPE_U8C3_PLANAR) ? img->u32Height
+                                                                            : img->u32Height / 2;
+    memset(img->pu8VirAddr[i], BG_VALUE, img->u16Stride[i] * height);
+  }
+  CVI_IVE_BufFlush(handle, img);
+}
+
+int compare_image(IVE_IMAGE_S *a, IVE_IMAGE_S *b, CVI_U32 plane_num) {
+  for (CVI_U32 i = 0; i < plane_num; i++) {
+    CVI_U32 height = (i == 0 || a->enType == IVE_IMAGE_TYPE_U8C3_PLANAR) ? a->u32Height
+                                                                          : a->u32Height / 2;
+    CVI_U32 width = (i == 0 || a->enType != IVE_IMAGE_TYPE_YUV420P) ? a->u32Width
+                                                                     : a->u32Width / 2;
+    for (CVI_U32 y = 0; y < height; y++) {
+      for (CVI_U32 x = 0; x < width; x++) {
+        CVI_U8 va = a->pu8VirAddr[i][y * a->u16Stride[i] + x];
+        CVI_U8 vb = b->pu8VirAddr[i][y * b->u16Stride[i] + x];
+        if (va != vb) {
+          printf("Plane %u (%u, %u) mismatch. TPU: %u, CPU: %u.\n", i, x, y, va, vb);
+          return CVI_FAILURE;
+        }
+      }
+    }
+  }
+  return CVI_SUCCESS;
+}
+
+int run_type(IVE_HANDLE handle, IVE_IMAGE_TYPE_E type, CVI_U32 plane_num, size_t total_run) {
+  const CVI_U32 width = 640, height = 480;
+  IVE_IMAGE_S tpu_img, cpu_img;
+  CVI_IVE_CreateImage(handle, &tpu_img, type, width, height);
+  CVI_IVE_CreateImage(handle, &cpu_img, type, width, height);
+  fill_image(handle, &tpu_img, plane_num);
+  fill_image(handle, &cpu_img, plane_num);
+
+  // The first rectangle has a known geometry. The rest are random below it and may go out of the
+  // image.
+  IVE_DRAW_RECT_ITEM_S items[RECT_NUM];
+  items[0].rect.pts[0].x = 100;
+  items[0].rect.pts[0].y = 100;
+  items[0].rect.pts[1].x = 301;
+  items[0].rect.pts[1].y = 201;
+  items[0].color.r = 255;
+  items[0].color.g = 255;
+  items[0].color.b = 255;
+  items[0].thickness = 4;
+  srand(type);
+  for (CVI_U32 i = 1; i < RECT_NUM; i++) {
+    items[i].rect.pts[0].x = rand() % width;
+    items[i].rect.pts[0].y = 240 + rand() % (height - 240);
+    items[i].rect.pts[1].x = items[i].rect.pts[0].x + rand() % 300;
+    items[i].rect.pts[1].y = items[i].rect.pts[0].y + rand() % 300;
+    items[i].color.r = 255;
+    items[i].color.g = 255;
+    items[i].color.b = 255;
+    items[i].thickness = rand() % 7;
+  }
+  IVE_DRAW_RECTS_CTRL_S ctrl;
+  ctrl.u32Num = RECT_NUM;
+  ctrl.pstItems = items;
+
+  int ret = CVI_SUCCESS;
+  struct timeval t0, t1;
+  ctrl.enMode = IVE_DRAW_MODE_TPU;
+  gettimeofday(&t0, NULL);
+  for (size_t i = 0; i < total_run; i++) {
+    ret |= CVI_IVE_DrawRects(handle, &tpu_img, &ctrl, 0);
+  }
+  gettimeofday(&t1, NULL);
+  unsigned long elapsed_tpu =
+      ((t1.tv_sec - t0.tv_sec) * 1000000 + t1.tv_usec - t0.tv_usec) / total_run;
+  ctrl.enMode = IVE_DRAW_MODE_CPU;
+  gettimeofday(&t0, NULL);
+  for (size_t i = 0; i < total_run; i++) {
+    ret |= CVI_IVE_DrawRects(handle, &cpu_img, &ctrl, 0);
+  }
+  gettimeofday(&t1, NULL);
+  unsigned long elapsed_cpu =
+      ((t1.tv_sec - t0.tv_sec) * 1000000 + t1.tv_usec - t0.tv_usec) / total_run;
+
+  CVI_IVE_BufRequest(handle, &tpu_img);
+  CVI_IVE_BufRequest(handle, &cpu_img);
+  if (compare_image(&tpu_img, &cpu_img, plane_num) != CVI_SUCCESS) {
+    printf("Type %d: TPU and CPU results are different.\n", type);
+    ret = CVI_FAILURE;
+  }
+  // The known rectangle is 4 pixels thick on the luma or the first channel.
+  CVI_U8 *row = cpu_img.pu8VirAddr[0] + 150 * cpu_img.u16Stride[0];
+  if (row[100] == BG_VALUE || row[103] == BG_VALUE || row[104] != BG_VALUE ||
+      row[297] != BG_VALUE || row[298] == BG_VALUE || row[301] == BG_VALUE ||
+      row[302] != BG_VALUE) {
+    printf("Type %d: rectangle edge is incorrect.\n", type);
+    ret = CVI_FAILURE;
+  }
+
+  if (total_run == 1) {
+    printf("Type %d drawn with %d rectangles.\n", type, RECT_NUM);
+  } else {
+    printf("OOO %-10s %10lu %10lu %10s\n", "DrawRects", elapsed_tpu, elapsed_cpu, "NA");
+  }
+
+  CVI_SYS_FreeI(handle, &tpu_img);
+  CVI_SYS_FreeI(handle, &cpu_img);
+  return ret;
+}
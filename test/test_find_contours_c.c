@@ -0,0 +1,349 @@
+#include "cvi_ive.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+
+#define MAX_CONTOUR_NUM 4096
+#define MAX_POINT_NUM (1 << 18)
+
+typedef struct {
+  int x0, y0, x1, y1;
+} box_t;
+
+void fill_image(IVE_IMAGE_S *img, int label_num);
+int check_raw(IVE_IMAGE_S *img, IVE_CC_DIR_E mode, IVE_CONTOUR_S *contours, CVI_U32 num,
+              IVE_POINT_U16_S *points);
+int check_approx(IVE_CONTOUR_S *raw, IVE_POINT_U16_S *raw_points, CVI_U32 num,
+                 IVE_CONTOUR_S *approx, IVE_POINT_U16_S *approx_points, CVI_U32 approx_num,
+                 IVE_CONTOUR_APPROX_E type, float eps);
+
+int main(int argc, char **argv) {
+  if (argc != 2) {
+    printf("Incorrect loop value. Usage: %s <loop in value (1-1000)>\n", argv[0]);
+    return CVI_FAILURE;
+  }
+  size_t total_run = atoi(argv[1]);
+  printf("Loop value: %zu\n", total_run);
+  if (total_run > 1000 || total_run == 0) {
+    printf("Incorrect loop value. Usage: %s <loop in value (1-1000)>\n", argv[0]);
+    return CVI_FAILURE;
+  }
+  // Create instance
+  IVE_HANDLE handle = CVI_IVE_CreateHandle();
+  printf("BM Kernel init.\n");
+
+  IVE_IMAGE_S src;
+  CVI_IVE_CreateImage(handle, &src, IVE_IMAGE_TYPE_U8C1, 160, 120);
+  IVE_CONTOUR_S *raw = malloc(sizeof(IVE_CONTOUR_S) * MAX_CONTOUR_NUM);
+  IVE_CONTOUR_S *approx = malloc(sizeof(IVE_CONTOUR_S) * MAX_CONTOUR_NUM);
+  IVE_POINT_U16_S *raw_points = malloc(sizeof(IVE_POINT_U16_S) * MAX_POINT_NUM);
+  IVE_POINT_U16_S *approx_points = malloc(sizeof(IVE_POINT_U16_S) * MAX_POINT_NUM);
+
+  int ret = CVI_SUCCESS;
+  srand(0);
+  // A binary mask and a label image with touching regions, in both connectivities.
+  for (int c = 0; c < 4; c++) {
+    fill_image(&src, c < 2 ? 1 : 3);
+    CVI_IVE_BufFlush(handle, &src);
+    IVE_CONTOUR_CTRL_S ctrl;
+    ctrl.enMode = c % 2 == 0 ? DIRECTION_8 : DIRECTION_4;
+    ctrl.enApprox = IVE_CONTOUR_APPROX_NONE;
+    ctrl.f32Epsilon = 0;
+    CVI_U32 num = 0, approx_num = 0;
+    struct timeval t0, t1;
+    gettimeofday(&t0, NULL);
+    for (size_t i = 0; i < total_run; i++) {
+      ret |= CVI_IVE_FindContours(handle, &src, raw, MAX_CONTOUR_NUM, raw_points, MAX_POINT_NUM,
+                                  &num, &ctrl, 0);
+    }
+    gettimeofday(&t1, NULL);
+    unsigned long elapsed_cpu =
+        ((t1.tv_sec - t0.tv_sec) * 1000000 + t1.tv_usec - t0.tv_usec) / total_run;
+    if (check_raw(&src, ctrl.enMode, raw, num, raw_points) != CVI_SUCCESS) {
+      printf("Case %d: contours are different from the reference.\n", c);
+      ret = CVI_FAILURE;
+    }
+
+    ctrl.enApprox = IVE_CONTOUR_APPROX_DOUGLAS_PEUCKER;
+    ctrl.f32Epsilon = 1.5f;
+    ret |= CVI_IVE_FindContours(handle, &src, approx, MAX_CONTOUR_NUM, approx_points,
+                                MAX_POINT_NUM, &approx_num, &ctrl, 0);
+    if (check_approx(raw, raw_points, num, approx, approx_points, approx_num, ctrl.enApprox,
+                     ctrl.f32Epsilon) != CVI_SUCCESS) {
+      printf("Case %d: Douglas-Peucker is incorrect.\n", c);
+      ret = CVI_FAILURE;
+    }
+    ctrl.enApprox = IVE_CONTOUR_APPROX_CONVEX_HULL;
+    ret |= CVI_IVE_FindContours(handle, &src, approx, MAX_CONTOUR_NUM, approx_points,
+                                MAX_POINT_NUM, &approx_num, &ctrl, 0);
+    if (check_approx(raw, raw_points, num, approx, approx_points, approx_num, ctrl.enApprox,
+                     0) != CVI_SUCCESS) {
+      printf("Case %d: convex hull is incorrect.\n", c);
+      ret = CVI_FAILURE;
+    }
+
+    // A small arena or contour array keeps the first contours that fit and reports the
+    // truncation, an exact fit does not.
+    ctrl.enApprox = IVE_CONTOUR_APPROX_NONE;
+    CVI_U32 limit = raw[num / 2].u32PointOffset + raw[num / 2].u32PointNum - 1;
+    if (CVI_IVE_FindContours(handle, &src, approx, MAX_CONTOUR_NUM, approx_points, limit,
+                             &approx_num, &ctrl, 0) != ERR_IVE_BUF_FULL ||
+        approx_num != num / 2) {
+      printf("Case %d: %u contours fit in the arena, expected %u.\n", c, approx_num, num / 2);
+      ret = CVI_FAILURE;
+    }
+    if (CVI_IVE_FindContours(handle, &src, approx, num - 1, approx_points, MAX_POINT_NUM,
+                             &approx_num, &ctrl, 0) != ERR_IVE_BUF_FULL ||
+        approx_num != num - 1) {
+      printf("Case %d: %u contours fit in the array, expected %u.\n", c, approx_num, num - 1);
+      ret = CVI_FAILURE;
+    }
+    if (CVI_IVE_FindContours(handle, &src, approx, num, approx_points, MAX_POINT_NUM, &approx_num,
+                             &ctrl, 0) != CVI_SUCCESS ||
+        approx_num != num) {
+      printf("Case %d: exactly fitting contours are reported as truncated.\n", c);
+      ret = CVI_FAILURE;
+    }
+    if (total_run == 1) {
+      printf("Case %d: %u contours with %u points.\n", c, num,
+             num ? raw[num - 1].u32PointOffset + raw[num - 1].u32PointNum : 0);
+    } else {
+      printf("OOO %-10s %10s %10lu %10s\n", "Contours", "NA", elapsed_cpu, "NA");
+    }
+  }
+
+  // Tiny blobs whose border points are all hull vertices, a 2x2 square and a 3 pixel L.
+  memset(src.pu8VirAddr[0], 0, src.u16Stride[0] * src.u32Height);
+  CVI_U8 *tiny = src.pu8VirAddr[0];
+  tiny[10 * src.u16Stride[0] + 10] = tiny[10 * src.u16Stride[0] + 11] = 255;
+  tiny[11 * src.u16Stride[0] + 10] = tiny[11 * src.u16Stride[0] + 11] = 255;
+  tiny[30 * src.u16Stride[0] + 40] = 255;
+  tiny[31 * src.u16Stride[0] + 40] = tiny[31 * src.u16Stride[0] + 41] = 255;
+  CVI_IVE_BufFlush(handle, &src);
+  for (int c = 0; c < 2; c++) {
+    IVE_CONTOUR_CTRL_S ctrl;
+    ctrl.enMode = c == 0 ? DIRECTION_8 : DIRECTION_4;
+    ctrl.enApprox = IVE_CONTOUR_APPROX_NONE;
+    ctrl.f32Epsilon = 0;
+    CVI_U32 num = 0, approx_num = 0;
+    ret |= CVI_IVE_FindContours(handle, &src, raw, MAX_CONTOUR_NUM, raw_points, MAX_POINT_NUM,
+                                &num, &ctrl, 0);
+    ctrl.enApprox = IVE_CONTOUR_APPROX_CONVEX_HULL;
+    ret |= CVI_IVE_FindContours(handle, &src, approx, MAX_CONTOUR_NUM, approx_points,
+                                MAX_POINT_NUM, &approx_num, &ctrl, 0);
+    if (num != 2 ||
+        check_approx(raw, raw_points, num, approx, approx_points, approx_num, ctrl.enApprox,
+                     0) != CVI_SUCCESS ||
+        approx[0].u32PointNum != 4 || approx[1].u32PointNum != 3) {
+      printf("Tiny case %d: convex hull is incorrect.\n", c);
+      ret = CVI_FAILURE;
+    }
+  }
+  printf("%s\n", ret == CVI_SUCCESS ? "Check passed." : "Check failed.");
+
+  free(raw);
+  free(approx);
+  free(raw_points);
+  free(approx_points);
+  CVI_SYS_FreeI(handle, &src);
+  CVI_IVE_DestroyHandle(handle);
+  return ret;
+}
+
+// Random rectangles with holes and sparse noise. Labels are in [1, label_num], 255 for a mask.
+void fill_image(IVE_IMAGE_S *img, int label_num) {
+  const int width = img->u32Width, height = img->u32Height, stride = img->u16Stride[0];
+  CVI_U8 *p = img->pu8VirAddr[0];
+  memset(p, 0, stride * height);
+  for (int i = 0; i < 40; i++) {
+    int x0 = rand() % width, y0 = rand() % height, w = rand() % 30 + 1, h = rand() % 30 + 1;
+    CVI_U8 val = label_num == 1 ? 255 : rand() % label_num + 1;
+    for (int y = y0; y < y0 + h && y < height; y++) {
+      for (int x = x0; x < x0 + w && x < width; x++) {
+        p[y * stride + x] = val;
+      }
+    }
+    // A hole in the larger ones.
+    for (int y = y0 + 3; y < y0 + h - 3 && y < height; y++) {
+      for (int x = x0 + 3; x < x0 + w - 3 && x < width; x++) {
+        p[y * stride + x] = (x + y) % 7 == 0 ? val : 0;
+      }
+    }
+  }
+  for (int i = 0; i < width * height / 20; i++) {
+    p[(rand() % height) * stride + rand() % width] = label_num == 1 ? 255 : rand() % label_num + 1;
+  }
+}
+
+// Regions are found by flood fill in raster order. The outer border of a region is the set of
+// its pixels next to the background component connected to the image frame, with the dual
+// connectivity.
+int check_raw(IVE_IMAGE_S *img, IVE_CC_DIR_E mode, IVE_CONTOUR_S *contours, CVI_U32 num,
+              IVE_POINT_U16_S *points) {
+  const int width = img->u32Width, height = img->u32Height, stride = img->u16Stride[0];
+  const CVI_U8 *p = img->pu8VirAddr[0];
+  const int dx[8] = {1, 0, -1, 0, 1, 1, -1, -1}, dy[8] = {0, 1, 0, -1, 1, -1, 1, -1};
+  const int nb = mode == DIRECTION_8 ? 8 : 4, dual_nb = 12 - nb;
+  int *label = calloc(width * height, sizeof(int));
+  int *queue = malloc(sizeof(int) * width * height);
+  int *state = calloc(width * height, sizeof(int));
+  CVI_U32 region = 0;
+  int ret = CVI_SUCCESS;
+  for (int s = 0; s < width * height && ret == CVI_SUCCESS; s++) {
+    CVI_U8 val = p[(s / width) * stride + s % width];
+    if (val == 0 || label[s]) continue;
+    if (region >= num) {
+      printf("Region %u is missing.\n", region);
+      ret = CVI_FAILURE;
+      break;
+    }
+    region++;
+    box_t box = {width, height, -1, -1};
+    int head = 0, tail = 0;
+    queue[tail++] = s;
+    label[s] = region;
+    while (head < tail) {
+      int x = queue[head] % width, y = queue[head++] / width;
+      box.x0 = x < box.x0 ? x : box.x0;
+      box.y0 = y < box.y0 ? y : box.y0;
+      box.x1 = x > box.x1 ? x : box.x1;
+      box.y1 = y > box.y1 ? y : box.y1;
+      for (int k = 0; k < nb; k++) {
+        int nx = x + dx[k], ny = y + dy[k];
+        if (nx < 0 || ny < 0 || nx >= width || ny >= height) continue;
+        if (label[ny * width + nx] || p[ny * stride + nx] != val) continue;
+        label[ny * width + nx] = region;
+        queue[tail++] = ny * width + nx;
+      }
+    }
+    IVE_CONTOUR_S *c = &contours[region - 1];
+    IVE_POINT_U16_S *pts = points + c->u32PointOffset;
+    if (c->u8Label != val || c->u16X != box.x0 || c->u16Y != box.y0 ||
+        c->u16Width != box.x1 - box.x0 + 1 || c->u16Height != box.y1 - box.y0 + 1 ||
+        pts[0].u16X != s % width || pts[0].u16Y != s / width) {
+      printf("Region %u at (%d, %d) has a wrong header.\n", region, s % width, s / width);
+      ret = CVI_FAILURE;
+      break;
+    }
+    // The outside of the region within its box grown by one, seeded from the box and the image
+    // edges, state 1 for outside.
+    int bx0 = box.x0 - 1, by0 = box.y0 - 1, bx1 = box.x1 + 1, by1 = box.y1 + 1;
+    head = tail = 0;
+    for (int y = by0; y <= by1; y++) {
+      for (int x = bx0; x <= bx1; x++) {
+        if (x < 0 || y < 0 || x >= width || y >= height) continue;
+        state[y * width + x] = 0;
+        int edge = x == bx0 || y == by0 || x == bx1 || y == by1 || x == 0 || y == 0 ||
+                   x == width - 1 || y == height - 1;
+        if (edge && label[y * width + x] != (int)region) {
+          state[y * width + x] = 1;
+          queue[tail++] = y * width + x;
+        }
+      }
+    }
+    while (head < tail) {
+      int x = queue[head] % width, y = queue[head++] / width;
+      for (int k = 0; k < dual_nb; k++) {
+        int nx = x + dx[k], ny = y + dy[k];
+        if (nx < bx0 || ny < by0 || nx > bx1 || ny > by1 || nx < 0 || ny < 0 || nx >= width ||
+            ny >= height) {
+          continue;
+        }
+        if (state[ny * width + nx] || label[ny * width + nx] == region) continue;
+        state[ny * width + nx] = 1;
+        queue[tail++] = ny * width + nx;
+      }
+    }
+    // Contour points get state 2, every border pixel must have it and nothing else.
+    for (CVI_U32 i = 0; i < c->u32PointNum; i++) {
+      int x = pts[i].u16X, y = pts[i].u16Y;
+      IVE_POINT_U16_S *next = &pts[(i + 1) % c->u32PointNum];
+      int ddx = abs(next->u16X - x), ddy = abs(next->u16Y - y);
+      if (x >= width || y >= height || label[y * width + x] != (int)region ||
+          (c->u32PointNum > 1 && (ddx > 1 || ddy > 1 || (nb == 4 && ddx + ddy != 1)))) {
+        printf("Region %u point (%d, %d) is invalid.\n", region, x, y);
+        ret = CVI_FAILURE;
+        break;
+      }
+      state[y * width + x] = 2;
+    }
+    for (int y = box.y0; y <= box.y1 && ret == CVI_SUCCESS; y++) {
+      for (int x = box.x0; x <= box.x1; x++) {
+        if (label[y * width + x] != (int)region) continue;
+        int border = 0;
+        for (int k = 0; k < dual_nb; k++) {
+          int nx = x + dx[k], ny = y + dy[k];
+          border |= nx < 0 || ny < 0 || nx >= width || ny >= height || state[ny * width + nx] == 1;
+        }
+        if (border != (state[y * width + x] == 2)) {
+          printf("Region %u pixel (%d, %d) border %d is not traced correctly.\n", region, x, y,
+                 border);
+          ret = CVI_FAILURE;
+          break;
+        }
+      }
+    }
+  }
+  if (ret == CVI_SUCCESS && region != num) {
+    printf("%u contours for %u regions.\n", num, region);
+    ret = CVI_FAILURE;
+  }
+  free(label);
+  free(queue);
+  free(state);
+  return ret;
+}
+
+long long cross(IVE_POINT_U16_S o, IVE_POINT_U16_S a, IVE_POINT_U16_S b) {
+  return (long long)(a.u16X - o.u16X) * (b.u16Y - o.u16Y) -
+         (long long)(a.u16Y - o.u16Y) * (b.u16X - o.u16X);
+}
+
+// Douglas-Peucker keeps an ordered subset with every dropped point close to the kept segment
+// around it. The hull is strictly convex and contains every border point.
+int check_approx(IVE_CONTOUR_S *raw, IVE_POINT_U16_S *raw_points, CVI_U32 num,
+                 IVE_CONTOUR_S *approx, IVE_POINT_U16_S *approx_points, CVI_U32 approx_num,
+                 IVE_CONTOUR_APPROX_E type, float eps) {
+  if (approx_num != num) return CVI_FAILURE;
+  for (CVI_U32 c = 0; c < num; c++) {
+    IVE_POINT_U16_S *r = raw_points + raw[c].u32PointOffset;
+    IVE_POINT_U16_S *a = approx_points + approx[c].u32PointOffset;
+    CVI_U32 rn = raw[c].u32PointNum, an = approx[c].u32PointNum;
+    if (an == 0 || an > rn || approx[c].u16X != raw[c].u16X || approx[c].u16Y != raw[c].u16Y) {
+      return CVI_FAILURE;
+    }
+    if (type == IVE_CONTOUR_APPROX_DOUGLAS_PEUCKER) {
+      CVI_U32 j = 0;
+      for (CVI_U32 i = 0; i < rn; i++) {
+        if (j < an && r[i].u16X == a[j].u16X && r[i].u16Y == a[j].u16Y) {
+          j++;
+          continue;
+        }
+        if (j == 0) return CVI_FAILURE;
+        IVE_POINT_U16_S p0 = a[j - 1], p1 = a[j % an];
+        long long lx = p1.u16X - p0.u16X, ly = p1.u16Y - p0.u16Y;
+        long long d = cross(p0, p1, r[i]);
+        long long px = r[i].u16X - p0.u16X, py = r[i].u16Y - p0.u16Y;
+        double d2 = lx == 0 && ly == 0 ? (double)(px * px + py * py)
+                                       : (double)d * d / (lx * lx + ly * ly);
+        if (d2 > eps * eps) {
+          printf("Contour %u point %u is %f away.\n", c, i, d2);
+          return CVI_FAILURE;
+        }
+      }
+      if (j != an) return CVI_FAILURE;
+    } else if (an >= 3) {
+      for (CVI_U32 i = 0; i < an; i++) {
+        if (cross(a[i], a[(i + 1) % an], a[(i + 2) % an]) <= 0) return CVI_FAILURE;
+      }
+      for (CVI_U32 k = 0; k < rn; k++) {
+        for (CVI_U32 i = 0; i < an; i++) {
+          if (cross(a[i], a[(i + 1) % an], r[k]) < 0) return CVI_FAILURE;
+        }
+      }
+    }
+  }
+  return CVI_SUCCESS;
+}
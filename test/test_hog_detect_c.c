@@ -0,0 +1,323 @@
+#include "cvi_ive.h"
+
+#include <float.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+
+#define CELL_SIZE 8
+#define BLOCK_SIZE 2
+#define BIN_NUM 9
+#define WIN_WIDTH 64
+#define WIN_HEIGHT 128
+#define MAX_BOX_NUM 4096
+
+// Write a model with the given weights and bias as the decision function of the first label. The
+// labels are written in ascending order so that the loader has to pick the second class as the
+// object class, which negates the weights and the bias.
+int write_model(const char *model_name, const int nr_feature, const float *weight,
+                const float bias);
+CVI_U32 count_windows(const CVI_U32 width, const CVI_U32 height);
+float *ref_scores(IVE_HANDLE handle, IVE_IMAGE_S *src, IVE_HOG_CTRL_S *hog_ctrl,
+                  const float *weight, const float bias);
+int score_matches(const float score, const float expected);
+float bf16_to_float(const CVI_U16 v);
+
+int main(int argc, char **argv) {
+  if (argc != 3) {
+    printf("Incorrect loop value. Usage: %s <file name> <loop in value (1-1000)>\n", argv[0]);
+    return CVI_FAILURE;
+  }
+  const char *filename = argv[1];
+  size_t total_run = atoi(argv[2]);
+  printf("Loop value: %zu\n", total_run);
+  if (total_run > 1000 || total_run == 0) {
+    printf("Incorrect loop value. Usage: %s <file name> <loop in value (1-1000)>\n", argv[0]);
+    return CVI_FAILURE;
+  }
+  // Create instance
+  IVE_HANDLE handle = CVI_IVE_CreateHandle();
+  printf("BM Kernel init.\n");
+
+  // Fetch image information. The image is cropped to whole cells so that CVI_IVE_HOG accepts it
+  // for the reference.
+  IVE_IMAGE_S image = CVI_IVE_ReadImage(handle, filename, IVE_IMAGE_TYPE_U8C1);
+  int width = image.u32Width / CELL_SIZE * CELL_SIZE;
+  int height = image.u32Height / CELL_SIZE * CELL_SIZE;
+  printf("Image size is %d X %d\n", width, height);
+  IVE_IMAGE_S src;
+  CVI_IVE_CreateImage(handle, &src, IVE_IMAGE_TYPE_U8C1, width, height);
+  CVI_IVE_BufRequest(handle, &image);
+  for (int i = 0; i < height; i++) {
+    memcpy(src.pu8VirAddr[0] + i * src.u16Stride[0], image.pu8VirAddr[0] + i * image.u16Stride[0],
+           width);
+  }
+  CVI_IVE_BufFlush(handle, &src);
+
+  IVE_HOG_DETECT_CTRL_S ctrl;
+  memset(&ctrl, 0, sizeof(ctrl));
+  ctrl.stHogCtrl.u8BinSize = BIN_NUM;
+  ctrl.stHogCtrl.u32CellSize = CELL_SIZE;
+  ctrl.stHogCtrl.u16BlkSizeInCell = BLOCK_SIZE;
+  ctrl.stHogCtrl.u16BlkStepX = 1;
+  ctrl.stHogCtrl.u16BlkStepY = 1;
+  ctrl.u16WinWidth = WIN_WIDTH;
+  ctrl.u16WinHeight = WIN_HEIGHT;
+  ctrl.u16WinStepInBlkX = 1;
+  ctrl.u16WinStepInBlkY = 1;
+  ctrl.f32Threshold = -FLT_MAX;
+  ctrl.u8ScaleNum = 1;
+  ctrl.f32ScaleFactor = 1.2f;
+
+  int nr_feature = (WIN_WIDTH / CELL_SIZE - BLOCK_SIZE + 1) *
+                   (WIN_HEIGHT / CELL_SIZE - BLOCK_SIZE + 1) * BLOCK_SIZE * BLOCK_SIZE * BIN_NUM;
+  // Random weights so that every window scores differently.
+  float *weight = (float *)malloc(nr_feature * sizeof(float));
+  srand(0);
+  for (int i = 0; i < nr_feature; i++) {
+    weight[i] = (rand() % 2001 - 1000) / 10000.f;
+  }
+  const float bias = 0.25f;
+  const char *model_name = "test_hog_detect_c.model";
+  if (write_model(model_name, nr_feature, weight, bias) != CVI_SUCCESS) {
+    printf("Failed to write model file.\n");
+    return CVI_FAILURE;
+  }
+  IVE_HOG_SVM_MODEL_S model;
+  int ret = CVI_IVE_LoadHOGSVMModel(handle, model_name, &model);
+  if (ret != CVI_SUCCESS || model.u32FeatureLen != (CVI_U32)nr_feature) {
+    printf("Failed to load model.\n");
+    return CVI_FAILURE;
+  }
+  for (int i = 0; i < nr_feature; i++) {
+    weight[i] = -weight[i];
+    if (((float *)model.stWeight.pu8VirAddr)[i] != weight[i]) {
+      printf("Weight %d is not negated for the object class.\n", i);
+      ret = CVI_FAILURE;
+      break;
+    }
+  }
+  if (model.f32Bias != -bias) {
+    printf("Bias %f is not negated for the object class.\n", model.f32Bias);
+    ret = CVI_FAILURE;
+  }
+  float *expected_score = ref_scores(handle, &src, &ctrl.stHogCtrl, weight, -bias);
+  const CVI_U32 win_num_x = (width - WIN_WIDTH) / CELL_SIZE + 1;
+
+  IVE_HOG_DETECT_BOX_S *boxes = (IVE_HOG_DETECT_BOX_S *)malloc(MAX_BOX_NUM * sizeof(*boxes));
+  CVI_U32 box_num = 0;
+  printf("Run HOG detector.\n");
+  struct timeval t0, t1;
+  gettimeofday(&t0, NULL);
+  for (size_t i = 0; i < total_run; i++) {
+    ret |= CVI_IVE_HOGDetect(handle, &src, &model, boxes, MAX_BOX_NUM, &box_num, &ctrl, 0);
+  }
+  gettimeofday(&t1, NULL);
+  unsigned long elapsed_tpu =
+      ((t1.tv_sec - t0.tv_sec) * 1000000 + t1.tv_usec - t0.tv_usec) / total_run;
+
+  // Without a threshold every window is returned with the right geometry and the score of the
+  // CPU reference.
+  CVI_U32 expected_num = count_windows(width, height);
+  if (expected_num > MAX_BOX_NUM) {
+    expected_num = MAX_BOX_NUM;
+  }
+  if (box_num != expected_num) {
+    printf("Box number mismatch. Given: %u, expected: %u.\n", box_num, expected_num);
+    ret = CVI_FAILURE;
+  }
+  for (CVI_U32 i = 0; i < box_num; i++) {
+    if (boxes[i].u16Width != WIN_WIDTH || boxes[i].u16Height != WIN_HEIGHT ||
+        boxes[i].u16X + WIN_WIDTH > width || boxes[i].u16Y + WIN_HEIGHT > height ||
+        boxes[i].u16X % CELL_SIZE != 0 || boxes[i].u16Y % CELL_SIZE != 0 ||
+        !score_matches(boxes[i].f32Score,
+                       expected_score[boxes[i].u16Y / CELL_SIZE * win_num_x +
+                                      boxes[i].u16X / CELL_SIZE])) {
+      printf("Box %u (%u %u %u %u %f) is incorrect.\n", i, boxes[i].u16X, boxes[i].u16Y,
+             boxes[i].u16Width, boxes[i].u16Height, boxes[i].f32Score);
+      ret = CVI_FAILURE;
+      break;
+    }
+  }
+
+  // The threshold keeps the windows scoring above it, windows within the tolerance of the
+  // threshold may go either way.
+  ctrl.f32Threshold = bias;
+  ret |= CVI_IVE_HOGDetect(handle, &src, &model, boxes, MAX_BOX_NUM, &box_num, &ctrl, 0);
+  CVI_U32 above_num = 0, near_num = 0;
+  for (CVI_U32 i = 0; i < count_windows(width, height); i++) {
+    if (score_matches(expected_score[i], ctrl.f32Threshold)) {
+      near_num++;
+    } else if (expected_score[i] > ctrl.f32Threshold) {
+      above_num++;
+    }
+  }
+  if (above_num > MAX_BOX_NUM) {
+    above_num = near_num = MAX_BOX_NUM;
+  }
+  if (box_num < above_num || box_num > above_num + near_num) {
+    printf("Threshold is not applied, got %u boxes, expected %u.\n", box_num, above_num);
+    ret = CVI_FAILURE;
+  }
+  for (CVI_U32 i = 0; i < box_num; i++) {
+    if (boxes[i].f32Score < ctrl.f32Threshold) {
+      printf("Box %u scores %f below the threshold.\n", i, boxes[i].f32Score);
+      ret = CVI_FAILURE;
+      break;
+    }
+  }
+
+  // Pyramid levels only add boxes larger than the window.
+  ctrl.f32Threshold = -FLT_MAX;
+  ctrl.u8ScaleNum = 3;
+  ret |= CVI_IVE_HOGDetect(handle, &src, &model, boxes, MAX_BOX_NUM, &box_num, &ctrl, 0);
+  CVI_U32 larger_num = 0;
+  for (CVI_U32 i = 0; i < box_num; i++) {
+    if (boxes[i].u16Width > WIN_WIDTH) {
+      larger_num++;
+    }
+  }
+  if (box_num > expected_num && larger_num == 0) {
+    printf("Pyramid boxes not found.\n");
+    ret = CVI_FAILURE;
+  }
+
+  if (total_run == 1) {
+    printf("Found %u windows, %u from pyramid.\n", box_num, larger_num);
+  } else {
+    printf("OOO %-10s %10lu %10s %10s\n", "HOGDetect", elapsed_tpu, "NA", "NA");
+  }
+  printf("%s\n", ret == CVI_SUCCESS ? "Check passed." : "Check failed.");
+
+  // Free memory, instance
+  free(boxes);
+  free(weight);
+  free(expected_score);
+  CVI_SYS_FreeM(handle, &model.stWeight);
+  CVI_SYS_FreeI(handle, &src);
+  CVI_SYS_FreeI(handle, &image);
+  CVI_IVE_DestroyHandle(handle);
+
+  return ret;
+}
+
+int write_model(const char *model_name, const int nr_feature, const float *weight,
+                const float bias) {
+  FILE *fp = fopen(model_name, "w");
+  if (fp == NULL) {
+    return CVI_FAILURE;
+  }
+  fprintf(fp, "solver_type L2R_L2LOSS_SVC_DUAL\n");
+  fprintf(fp, "nr_class 2\n");
+  fprintf(fp, "label -1 1\n");
+  fprintf(fp, "nr_feature %d\n", nr_feature);
+  fprintf(fp, "bias 1\n");
+  fprintf(fp, "w\n");
+  for (int i = 0; i < nr_feature; i++) {
+    fprintf(fp, "%.17g \n", weight[i]);
+  }
+  fprintf(fp, "%.17g \n", bias);
+  fclose(fp);
+  return CVI_SUCCESS;
+}
+
+CVI_U32 count_windows(const CVI_U32 width, const CVI_U32 height) {
+  CVI_U32 width_block = width / CELL_SIZE - BLOCK_SIZE + 1;
+  CVI_U32 height_block = height / CELL_SIZE - BLOCK_SIZE + 1;
+  CVI_U32 win_width_block = WIN_WIDTH / CELL_SIZE - BLOCK_SIZE + 1;
+  CVI_U32 win_height_block = WIN_HEIGHT / CELL_SIZE - BLOCK_SIZE + 1;
+  if (width_block < win_width_block || height_block < win_height_block) {
+    return 0;
+  }
+  return (width_block - win_width_block + 1) * (height_block - win_height_block + 1);
+}
+
+int score_matches(const float score, const float expected) {
+  return fabsf(score - expected) <= 1e-3f * (1.f + fabsf(expected));
+}
+
+float bf16_to_float(const CVI_U16 v) {
+  union {
+    CVI_U32 u;
+    float f;
+  } x;
+  x.u = (CVI_U32)v << 16;
+  return x.f;
+}
+
+// Scores of all the windows in raster order from the CVI_IVE_HOG gradients. The cell histograms,
+// the L2 normalized blocks and the window dot products are computed here, one window at a time.
+float *ref_scores(IVE_HANDLE handle, IVE_IMAGE_S *src, IVE_HOG_CTRL_S *hog_ctrl,
+                  const float *weight, const float bias) {
+  const int width = src->u32Width, height = src->u32Height;
+  IVE_DST_IMAGE_S dst_h, dst_v, dst_mag, dst_ang;
+  CVI_IVE_CreateImage(handle, &dst_h, IVE_IMAGE_TYPE_BF16C1, width, height);
+  CVI_IVE_CreateImage(handle, &dst_v, IVE_IMAGE_TYPE_BF16C1, width, height);
+  CVI_IVE_CreateImage(handle, &dst_mag, IVE_IMAGE_TYPE_BF16C1, width, height);
+  CVI_IVE_CreateImage(handle, &dst_ang, IVE_IMAGE_TYPE_BF16C1, width, height);
+  IVE_DST_MEM_INFO_S dst_hist;
+  CVI_U32 hist_size = 0;
+  CVI_IVE_GET_HOG_SIZE(width, height, BIN_NUM, CELL_SIZE, BLOCK_SIZE, 1, 1, &hist_size);
+  CVI_IVE_CreateMemInfo(handle, &dst_hist, hist_size);
+  CVI_IVE_HOG(handle, src, &dst_h, &dst_v, &dst_mag, &dst_ang, &dst_hist, hog_ctrl, 0);
+  CVI_IVE_BufRequest(handle, &dst_mag);
+  CVI_IVE_BufRequest(handle, &dst_ang);
+
+  const int width_cell = width / CELL_SIZE, height_cell = height / CELL_SIZE;
+  float *cell = (float *)calloc(width_cell * height_cell * BIN_NUM, sizeof(float));
+  const float div = 180 / BIN_NUM;
+  for (int i = 1; i < height - 1; i++) {
+    const CVI_U16 *ang = (const CVI_U16 *)(dst_ang.pu8VirAddr[0] + i * dst_ang.u16Stride[0]);
+    const CVI_U16 *mag = (const CVI_U16 *)(dst_mag.pu8VirAddr[0] + i * dst_mag.u16Stride[0]);
+    for (int j = 1; j < width - 1; j++) {
+      float *hist = cell + ((i / CELL_SIZE) * width_cell + j / CELL_SIZE) * BIN_NUM;
+      float bin_div = (CVI_U32)fabsf(bf16_to_float(ang[j])) / div;
+      int bin = (int)bin_div;
+      float frac = bin_div - bin;
+      bin = bin >= BIN_NUM ? 0 : bin;
+      hist[bin] += bf16_to_float(mag[j]) * (1.f - frac);
+      hist[(bin + 1) % BIN_NUM] += bf16_to_float(mag[j]) * frac;
+    }
+  }
+
+  const int block_len = BLOCK_SIZE * BLOCK_SIZE * BIN_NUM;
+  const int win_num_x = (width - WIN_WIDTH) / CELL_SIZE + 1;
+  const int win_num_y = (height - WIN_HEIGHT) / CELL_SIZE + 1;
+  const int win_block_x = WIN_WIDTH / CELL_SIZE - BLOCK_SIZE + 1;
+  const int win_block_y = WIN_HEIGHT / CELL_SIZE - BLOCK_SIZE + 1;
+  float *score = (float *)malloc(win_num_x * win_num_y * sizeof(float));
+  float block[BLOCK_SIZE * BLOCK_SIZE * BIN_NUM];
+  for (int wy = 0; wy < win_num_y; wy++) {
+    for (int wx = 0; wx < win_num_x; wx++) {
+      double sum = bias;
+      const float *w = weight;
+      for (int by = 0; by < win_block_y; by++) {
+        for (int bx = 0; bx < win_block_x; bx++) {
+          double norm = 0;
+          for (int k = 0; k < BLOCK_SIZE; k++) {
+            const float *row = cell + ((wy + by + k) * width_cell + wx + bx) * BIN_NUM;
+            memcpy(block + k * BLOCK_SIZE * BIN_NUM, row, BLOCK_SIZE * BIN_NUM * sizeof(float));
+          }
+          for (int k = 0; k < block_len; k++) {
+            norm += block[k] * block[k];
+          }
+          const double inv = norm == 0 ? 0 : 1 / sqrt(norm);
+          for (int k = 0; k < block_len; k++) {
+            sum += w[k] * block[k] * inv;
+          }
+          w += block_len;
+        }
+      }
+      score[wy * win_num_x + wx] = sum;
+    }
+  }
+  free(cell);
+  CVI_SYS_FreeM(handle, &dst_hist);
+  CVI_SYS_FreeI(handle, &dst_h);
+  CVI_SYS_FreeI(handle, &dst_v);
+  CVI_SYS_FreeI(handle, &dst_mag);
+  CVI_SYS_FreeI(handle, &dst_ang);
+  return score;
+}
@@ -0,0 +1,158 @@
+#include "cvi_ive.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+
+float get_pixel(IVE_IMAGE_S *img, size_t x, size_t y);
+int check_convert(IVE_HANDLE handle, IVE_IMAGE_S *src, IVE_IMAGE_TYPE_E enDstType,
+                  IVE_ITC_TYPE_E enItcType, IVE_IMAGE_S *dst);
+
+int main(int argc, char **argv) {
+  if (argc != 3) {
+    printf("Incorrect loop value. Usage: %s <file name> <loop in value (1-1000)>\n", argv[0]);
+    return CVI_FAILURE;
+  }
+  const char *filename = argv[1];
+  size_t total_run = atoi(argv[2]);
+  printf("Loop value: %zu\n", total_run);
+  if (total_run > 1000 || total_run == 0) {
+    printf("Incorrect loop value. Usage: %s <file name> <loop in value (1-1000)>\n", argv[0]);
+    return CVI_FAILURE;
+  }
+  // Create instance
+  IVE_HANDLE handle = CVI_IVE_CreateHandle();
+  int ret = CVI_SUCCESS;
+  printf("BM Kernel init.\n");
+
+  // Fetch image information
+  IVE_IMAGE_S src = CVI_IVE_ReadImage(handle, filename, IVE_IMAGE_TYPE_U8C1);
+  int width = src.u32Width;
+  int height = src.u32Height;
+  printf("Image size is %d X %d\n", width, height);
+
+  // Walk through the CPU conversion matrix, every step is checked against the previous image.
+  IVE_IMAGE_S img_s16, img_f32, img_u16, img_bf16, img_s8, img_u8;
+  ret |= check_convert(handle, &src, IVE_IMAGE_TYPE_S16C1, IVE_ITC_NORMALIZE, &img_s16);
+  ret |= check_convert(handle, &img_s16, IVE_IMAGE_TYPE_FP32C1, IVE_ITC_SATURATE, &img_f32);
+  ret |= check_convert(handle, &img_f32, IVE_IMAGE_TYPE_U16C1, IVE_ITC_SATURATE, &img_u16);
+  ret |= check_convert(handle, &img_u16, IVE_IMAGE_TYPE_BF16C1, IVE_ITC_SATURATE, &img_bf16);
+  ret |= check_convert(handle, &img_s16, IVE_IMAGE_TYPE_S8C1, IVE_ITC_NORMALIZE, &img_s8);
+  ret |= check_convert(handle, &img_u16, IVE_IMAGE_TYPE_U8C1, IVE_ITC_NORMALIZE, &img_u8);
+
+  IVE_ITC_CRTL_S iveItcCtrl;
+  iveItcCtrl.enType = IVE_ITC_SATURATE;
+  struct timeval t0, t1;
+  gettimeofday(&t0, NULL);
+  for (size_t i = 0; i < total_run; i++) {
+    ret |= CVI_IVE_ImageTypeConvert(handle, &img_bf16, &img_f32, &iveItcCtrl, 0);
+  }
+  gettimeofday(&t1, NULL);
+  unsigned long elapsed_cpu =
+      ((t1.tv_sec - t0.tv_sec) * 1000000 + t1.tv_usec - t0.tv_usec) / total_run;
+
+  if (total_run == 1) {
+    printf("CPU BF16 to F32 time %lu\n", elapsed_cpu);
+  } else {
+    printf("OOO %-10s %10s %10lu %10s\n", "ITC", "NA", elapsed_cpu, "NA");
+  }
+  printf("%s\n", ret == CVI_SUCCESS ? "Check passed." : "Check failed.");
+
+  // Free memory, instance
+  CVI_SYS_FreeI(handle, &src);
+  CVI_SYS_FreeI(handle, &img_s16);
+  CVI_SYS_FreeI(handle, &img_f32);
+  CVI_SYS_FreeI(handle, &img_u16);
+  CVI_SYS_FreeI(handle, &img_bf16);
+  CVI_SYS_FreeI(handle, &img_s8);
+  CVI_SYS_FreeI(handle, &img_u8);
+  CVI_IVE_DestroyHandle(handle);
+
+  return ret;
+}
+
+float get_pixel(IVE_IMAGE_S *img, size_t x, size_t y) {
+  CVI_U8 *row = img->pu8VirAddr[0] + y * img->u16Stride[0];
+  switch (img->enType) {
+    case IVE_IMAGE_TYPE_U8C1:
+      return row[x];
+    case IVE_IMAGE_TYPE_S8C1:
+      return ((CVI_S8 *)row)[x];
+    case IVE_IMAGE_TYPE_U16C1:
+      return ((CVI_U16 *)row)[x];
+    case IVE_IMAGE_TYPE_S16C1:
+      return ((CVI_S16 *)row)[x];
+    case IVE_IMAGE_TYPE_BF16C1: {
+      CVI_U32 bits = (CVI_U32)((CVI_U16 *)row)[x] << 16;
+      float val;
+      memcpy(&val, &bits, sizeof(val));
+      return val;
+    }
+    default:
+      return ((float *)row)[x];
+  }
+}
+
+int check_convert(IVE_HANDLE handle, IVE_IMAGE_S *src, IVE_IMAGE_TYPE_E enDstType,
+                  IVE_ITC_TYPE_E enItcType, IVE_IMAGE_S *dst) {
+  CVI_IVE_CreateImage(handle, dst, enDstType, src->u32Width, src->u32Height);
+  IVE_ITC_CRTL_S iveItcCtrl;
+  iveItcCtrl.enType = enItcType;
+  if (CVI_IVE_ImageTypeConvert(handle, src, dst, &iveItcCtrl, 0) != CVI_SUCCESS) {
+    printf("Convert %d to %d failed.\n", src->enType, enDstType);
+    return CVI_FAILURE;
+  }
+  CVI_IVE_BufRequest(handle, dst);
+
+  float lo = 0.f, hi = 0.f;
+  switch (enDstType) {
+    case IVE_IMAGE_TYPE_U8C1:
+      hi = 255.f;
+      break;
+    case IVE_IMAGE_TYPE_S8C1:
+      lo = -128.f;
+      hi = 127.f;
+      break;
+    case IVE_IMAGE_TYPE_U16C1:
+      hi = 65535.f;
+      break;
+    case IVE_IMAGE_TYPE_S16C1:
+      lo = -32768.f;
+      hi = 32767.f;
+      break;
+    default:
+      break;
+  }
+  float min = get_pixel(src, 0, 0), max = min;
+  for (size_t i = 0; i < src->u32Height; i++) {
+    for (size_t j = 0; j < src->u32Width; j++) {
+      float val = get_pixel(src, j, i);
+      min = val < min ? val : min;
+      max = val > max ? val : max;
+    }
+  }
+  for (size_t i = 0; i < src->u32Height; i++) {
+    for (size_t j = 0; j < src->u32Width; j++) {
+      float val = get_pixel(src, j, i);
+      float res = get_pixel(dst, j, i);
+      float tolerance = 0.f;
+      if (enItcType == IVE_ITC_NORMALIZE && hi > lo) {
+        val = max > min ? (val - min) * (hi - lo) / (max - min) + lo : lo;
+        tolerance = 1.f;
+      } else if (enDstType == IVE_IMAGE_TYPE_BF16C1) {
+        tolerance = fabsf(val) / 128.f;
+      }
+      if (hi > lo) {
+        val = val > hi ? hi : (val < lo ? lo : roundf(val));
+      }
+      if (fabsf(res - val) > tolerance) {
+        printf("Convert %d to %d [%zu, %zu] IVE %f, CPU %f\n", src->enType, enDstType, j, i, res,
+               val);
+        return CVI_FAILURE;
+      }
+    }
+  }
+  return CVI_SUCCESS;
+}
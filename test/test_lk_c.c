@@ -0,0 +1,137 @@
+#include "cvi_ive.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+
+#define PTS_NUM 100
+#define BORDER_NUM 8
+#define SHIFT_X 5
+#define SHIFT_Y -3
+
+void make_frames(IVE_HANDLE handle, IVE_IMAGE_S *prev, IVE_IMAGE_S *next);
+
+int main(int argc, char **argv) {
+  if (argc != 2) {
+    printf("Incorrect loop value. Usage: %s <loop in value (1-1000)>\n", argv[0]);
+    return CVI_FAILURE;
+  }
+  size_t total_run = atoi(argv[1]);
+  printf("Loop value: %zu\n", total_run);
+  if (total_run > 1000 || total_run == 0) {
+    printf("Incorrect loop value. Usage: %s <loop in value (1-1000)>\n", argv[0]);
+    return CVI_FAILURE;
+  }
+  // Create instance
+  IVE_HANDLE handle = CVI_IVE_CreateHandle();
+  printf("BM Kernel init.\n");
+
+  const CVI_U32 width = 640, height = 480;
+  IVE_IMAGE_S prev, next;
+  CVI_IVE_CreateImage(handle, &prev, IVE_IMAGE_TYPE_U8C1, width, height);
+  CVI_IVE_CreateImage(handle, &next, IVE_IMAGE_TYPE_U8C1, width, height);
+  make_frames(handle, &prev, &next);
+
+  IVE_LK_POINT_S prev_pts[PTS_NUM], next_pts[PTS_NUM];
+  CVI_U8 status[PTS_NUM];
+  CVI_FLOAT err[PTS_NUM];
+  srand(0);
+  for (CVI_U32 i = 0; i < PTS_NUM; i++) {
+    prev_pts[i].f32X = 64 + rand() % (width - 128) + (rand() % 100) / 100.f;
+    prev_pts[i].f32Y = 64 + rand() % (height - 128) + (rand() % 100) / 100.f;
+  }
+  IVE_LK_OPTICAL_FLOW_CTRL_S ctrl;
+  ctrl.u8MaxLevel = 3;
+  ctrl.u8WinSize = 15;
+  ctrl.u8MaxIter = 20;
+  ctrl.f32Eps = 0.01f;
+  ctrl.f32MinEigThr = 0.001f;
+
+  int ret = CVI_SUCCESS;
+  struct timeval t0, t1;
+  gettimeofday(&t0, NULL);
+  for (size_t i = 0; i < total_run; i++) {
+    ret |= CVI_IVE_LKOpticalFlow(handle, &prev, &next, prev_pts, next_pts, status, err, PTS_NUM,
+                                 &ctrl, 0);
+  }
+  gettimeofday(&t1, NULL);
+  unsigned long elapsed_cpu =
+      ((t1.tv_sec - t0.tv_sec) * 1000000 + t1.tv_usec - t0.tv_usec) / total_run;
+
+  CVI_U32 tracked = 0;
+  for (CVI_U32 i = 0; i < PTS_NUM; i++) {
+    float dx = next_pts[i].f32X - prev_pts[i].f32X - SHIFT_X;
+    float dy = next_pts[i].f32Y - prev_pts[i].f32Y - SHIFT_Y;
+    if (status[i] && dx * dx + dy * dy < 0.25f * 0.25f) {
+      tracked++;
+    }
+  }
+  printf("Tracked %u of %u points.\n", tracked, PTS_NUM);
+  if (tracked < PTS_NUM * 9 / 10) {
+    ret = CVI_FAILURE;
+  }
+
+  // Points near the border fall outside the coarse pyramid windows but fit in the half and full
+  // resolution ones, the levels they fit in must still track them.
+  IVE_LK_POINT_S border_prev[BORDER_NUM] = {{18.f, 240.f}, {620.5f, 200.f}, {320.f, 16.f},
+                                           {300.f, 460.f}, {18.f, 18.f},    {618.f, 459.5f},
+                                           {24.f, 456.f},  {616.f, 24.f}};
+  IVE_LK_POINT_S border_next[BORDER_NUM];
+  CVI_U8 border_status[BORDER_NUM];
+  ret |= CVI_IVE_LKOpticalFlow(handle, &prev, &next, border_prev, border_next, border_status,
+                               NULL, BORDER_NUM, &ctrl, 0);
+  for (CVI_U32 i = 0; i < BORDER_NUM; i++) {
+    float dx = border_next[i].f32X - border_prev[i].f32X - SHIFT_X;
+    float dy = border_next[i].f32Y - border_prev[i].f32Y - SHIFT_Y;
+    if (!border_status[i] || dx * dx + dy * dy >= 0.25f * 0.25f) {
+      printf("Border point (%.1f, %.1f) status %u, moved (%.2f, %.2f).\n", border_prev[i].f32X,
+             border_prev[i].f32Y, border_status[i], dx + SHIFT_X, dy + SHIFT_Y);
+      ret = CVI_FAILURE;
+    }
+  }
+  if (total_run > 1) {
+    printf("OOO %-10s %10s %10lu %10s\n", "LKFlow", "NA", elapsed_cpu, "NA");
+  }
+  printf("%s\n", ret == CVI_SUCCESS ? "Check passed." : "Check failed.");
+
+  CVI_SYS_FreeI(handle, &prev);
+  CVI_SYS_FreeI(handle, &next);
+  CVI_IVE_DestroyHandle(handle);
+  return ret;
+}
+
+// prev is a 7x7 box blurred noise, next is prev moved by (SHIFT_X, SHIFT_Y).
+void make_frames(IVE_HANDLE handle, IVE_IMAGE_S *prev, IVE_IMAGE_S *next) {
+  const int width = prev->u32Width, height = prev->u32Height;
+  CVI_U8 *noise = malloc(width * height);
+  for (int i = 0; i < width * height; i++) {
+    noise[i] = rand() % 256;
+  }
+  for (int y = 0; y < height; y++) {
+    for (int x = 0; x < width; x++) {
+      int sum = 0, count = 0;
+      for (int i = -3; i <= 3; i++) {
+        for (int j = -3; j <= 3; j++) {
+          if (y + i >= 0 && y + i < height && x + j >= 0 && x + j < width) {
+            sum += noise[(y + i) * width + x + j];
+            count++;
+          }
+        }
+      }
+      prev->pu8VirAddr[0][y * prev->u16Stride[0] + x] = sum / count;
+    }
+  }
+  for (int y = 0; y < height; y++) {
+    for (int x = 0; x < width; x++) {
+      int sx = x - SHIFT_X, sy = y - SHIFT_Y;
+      sx = sx < 0 ? 0 : (sx >= width ? width - 1 : sx);
+      sy = sy < 0 ? 0 : (sy >= height ? height - 1 : sy);
+      next->pu8VirAddr[0][y * next->u16Stride[0] + x] =
+          prev->pu8VirAddr[0][sy * prev->u16Stride[0] + sx];
+    }
+  }
+  free(noise);
+  CVI_IVE_BufFlush(handle, prev);
+  CVI_IVE_BufFlush(handle, next);
+}
@@ -0,0 +1,129 @@
+#include "cvi_ive.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+
+int run_template(IVE_HANDLE handle, IVE_IMAGE_S *src, CVI_U32 x0, CVI_U32 y0, CVI_U32 width,
+                 CVI_U32 height, const char *name, size_t total_run);
+
+int main(int argc, char **argv) {
+  if (argc != 2) {
+    printf("Incorrect loop value. Usage: %s <loop in value (1-1000)>\n", argv[0]);
+    return CVI_FAILURE;
+  }
+  size_t total_run = atoi(argv[1]);
+  printf("Loop value: %zu\n", total_run);
+  if (total_run > 1000 || total_run == 0) {
+    printf("Incorrect loop value. Usage: %s <loop in value (1-1000)>\n", argv[0]);
+    return CVI_FAILURE;
+  }
+  // Create instance
+  IVE_HANDLE handle = CVI_IVE_CreateHandle();
+  printf("BM Kernel init.\n");
+
+  const CVI_U32 width = 320, height = 240;
+  IVE_IMAGE_S src;
+  CVI_IVE_CreateImage(handle, &src, IVE_IMAGE_TYPE_U8C1, width, height);
+  srand(0);
+  for (CVI_U32 y = 0; y < height; y++) {
+    for (CVI_U32 x = 0; x < width; x++) {
+      src.pu8VirAddr[0][y * src.u16Stride[0] + x] = (x * 7 + y * 3) % 200 + rand() % 56;
+    }
+  }
+  CVI_IVE_BufFlush(handle, &src);
+
+  int ret = CVI_SUCCESS;
+  ret |= run_template(handle, &src, 201, 133, 37, 29, "SAD37x29", total_run);
+  ret |= run_template(handle, &src, 3, 100, 8, 8, "SAD8x8", total_run);
+  ret |= run_template(handle, &src, 60, 7, 255, 4, "SAD255x4", total_run);
+  printf("%s\n", ret == CVI_SUCCESS ? "Check passed." : "Check failed.");
+
+  CVI_SYS_FreeI(handle, &src);
+  CVI_IVE_DestroyHandle(handle);
+  return ret;
+}
+
+// The template is cut from the source at (x0, y0) with some noise, so the best match is close to
+// it. The maps are compared with a direct sum.
+int run_template(IVE_HANDLE handle, IVE_IMAGE_S *src, CVI_U32 x0, CVI_U32 y0, CVI_U32 width,
+                 CVI_U32 height, const char *name, size_t total_run) {
+  IVE_IMAGE_S tpl, map32, map16;
+  CVI_IVE_CreateImage(handle, &tpl, IVE_IMAGE_TYPE_U8C1, width, height);
+  for (CVI_U32 y = 0; y < height; y++) {
+    for (CVI_U32 x = 0; x < width; x++) {
+      int v = src->pu8VirAddr[0][(y0 + y) * src->u16Stride[0] + x0 + x] + rand() % 9 - 4;
+      tpl.pu8VirAddr[0][y * tpl.u16Stride[0] + x] = v < 0 ? 0 : (v > 255 ? 255 : v);
+    }
+  }
+  CVI_IVE_BufFlush(handle, &tpl);
+  const CVI_U32 out_w = src->u32Width - width + 1, out_h = src->u32Height - height + 1;
+  CVI_IVE_CreateImage(handle, &map32, IVE_IMAGE_TYPE_U32C1, out_w, out_h);
+  CVI_IVE_CreateImage(handle, &map16, IVE_IMAGE_TYPE_U16C1, out_w, out_h);
+
+  int ret = CVI_SUCCESS;
+  IVE_TEMPLATE_MATCH_RESULT_S res32, res16, res;
+  struct timeval t0, t1;
+  gettimeofday(&t0, NULL);
+  for (size_t i = 0; i < total_run; i++) {
+    ret |= CVI_IVE_MatchTemplateSAD(handle, src, &tpl, &map32, &res32, 0);
+  }
+  gettimeofday(&t1, NULL);
+  unsigned long elapsed_map =
+      ((t1.tv_sec - t0.tv_sec) * 1000000 + t1.tv_usec - t0.tv_usec) / total_run;
+  gettimeofday(&t0, NULL);
+  for (size_t i = 0; i < total_run; i++) {
+    ret |= CVI_IVE_MatchTemplateSAD(handle, src, &tpl, NULL, &res, 0);
+  }
+  gettimeofday(&t1, NULL);
+  unsigned long elapsed_best =
+      ((t1.tv_sec - t0.tv_sec) * 1000000 + t1.tv_usec - t0.tv_usec) / total_run;
+  ret |= CVI_IVE_MatchTemplateSAD(handle, src, &tpl, &map16, &res16, 0);
+  CVI_IVE_BufRequest(handle, &map32);
+  CVI_IVE_BufRequest(handle, &map16);
+
+  CVI_U32 best = 0xFFFFFFFF, best_x = 0, best_y = 0;
+  for (CVI_U32 y = 0; y < out_h && ret == CVI_SUCCESS; y++) {
+    for (CVI_U32 x = 0; x < out_w; x++) {
+      CVI_U32 sad = 0;
+      for (CVI_U32 r = 0; r < height; r++) {
+        for (CVI_U32 c = 0; c < width; c++) {
+          sad += abs(src->pu8VirAddr[0][(y + r) * src->u16Stride[0] + x + c] -
+                     tpl.pu8VirAddr[0][r * tpl.u16Stride[0] + c]);
+        }
+      }
+      if (sad < best) {
+        best = sad;
+        best_x = x;
+        best_y = y;
+      }
+      CVI_U32 v32 = ((CVI_U32 *)(map32.pu8VirAddr[0] + y * map32.u16Stride[0]))[x];
+      CVI_U32 v16 = ((CVI_U16 *)(map16.pu8VirAddr[0] + y * map16.u16Stride[0]))[x];
+      if (v32 != sad || v16 != (sad > 65535 ? 65535 : sad)) {
+        printf("%s (%u, %u) mismatch. U32: %u, U16: %u, expected: %u.\n", name, x, y, v32, v16,
+               sad);
+        ret = CVI_FAILURE;
+        break;
+      }
+    }
+  }
+  if (res32.u16X != best_x || res32.u16Y != best_y || res32.u32MinSad != best ||
+      res.u16X != best_x || res.u16Y != best_y || res.u32MinSad != best ||
+      res16.u16X != best_x || res16.u16Y != best_y) {
+    printf("%s best match (%u, %u) %u, without map (%u, %u) %u, expected (%u, %u) %u.\n", name,
+           res32.u16X, res32.u16Y, res32.u32MinSad, res.u16X, res.u16Y, res.u32MinSad, best_x,
+           best_y, best);
+    ret = CVI_FAILURE;
+  }
+  if (total_run == 1) {
+    printf("%s best match (%u, %u) with SAD %u.\n", name, res.u16X, res.u16Y, res.u32MinSad);
+  } else {
+    printf("OOO %-10s %10s %10lu %10lu\n", name, "NA", elapsed_map, elapsed_best);
+  }
+
+  CVI_SYS_FreeI(handle, &tpl);
+  CVI_SYS_FreeI(handle, &map32);
+  CVI_SYS_FreeI(handle, &map16);
+  return ret;
+}
@@ -0,0 +1,206 @@
+#include "cvi_ive.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+
+int cpu_ref(IVE_IMAGE_S *src, IVE_IMAGE_S *dst, IVE_MORPH_CTRL_S *ctrl);
+int run_ctrl(IVE_HANDLE handle, IVE_IMAGE_S *src, IVE_MORPH_OP_E op, IVE_MORPH_SHAPE_E shape,
+             CVI_U8 width, CVI_U8 height, const char *name, size_t total_run);
+
+int main(int argc, char **argv) {
+  if (argc != 2) {
+    printf("Incorrect loop value. Usage: %s <loop in value (1-1000)>\n", argv[0]);
+    return CVI_FAILURE;
+  }
+  size_t total_run = atoi(argv[1]);
+  printf("Loop value: %zu\n", total_run);
+  if (total_run > 1000 || total_run == 0) {
+    printf("Incorrect loop value. Usage: %s <loop in value (1-1000)>\n", argv[0]);
+    return CVI_FAILURE;
+  }
+  // Create instance
+  IVE_HANDLE handle = CVI_IVE_CreateHandle();
+  printf("BM Kernel init.\n");
+
+  // Sparse bright spots on a noisy background.
+  const CVI_U32 width = 333, height = 201;
+  IVE_IMAGE_S src;
+  CVI_IVE_CreateImage(handle, &src, IVE_IMAGE_TYPE_U8C1, width, height);
+  srand(0);
+  for (CVI_U32 y = 0; y < height; y++) {
+    for (CVI_U32 x = 0; x < width; x++) {
+      src.pu8VirAddr[0][y * src.u16Stride[0] + x] = rand() % 100 == 0 ? 255 : rand() % 128 + 64;
+    }
+  }
+  CVI_IVE_BufFlush(handle, &src);
+
+  int ret = CVI_SUCCESS;
+  ret |= run_ctrl(handle, &src, IVE_MORPH_OP_ERODE, IVE_MORPH_SHAPE_RECT, 31, 31, "ErodeR31",
+                  total_run);
+  ret |= run_ctrl(handle, &src, IVE_MORPH_OP_DILATE, IVE_MORPH_SHAPE_RECT, 15, 21, "DilateR15",
+                  total_run);
+  ret |= run_ctrl(handle, &src, IVE_MORPH_OP_DILATE, IVE_MORPH_SHAPE_RECT, 1, 255, "DilateR255",
+                  total_run);
+  ret |= run_ctrl(handle, &src, IVE_MORPH_OP_DILATE, IVE_MORPH_SHAPE_CROSS, 25, 9, "DilateX25",
+                  total_run);
+  ret |= run_ctrl(handle, &src, IVE_MORPH_OP_ERODE, IVE_MORPH_SHAPE_ELLIPSE, 31, 31, "ErodeE31",
+                  total_run);
+  ret |= run_ctrl(handle, &src, IVE_MORPH_OP_DILATE, IVE_MORPH_SHAPE_ELLIPSE, 21, 11, "DilateE21",
+                  total_run);
+  ret |= run_ctrl(handle, &src, IVE_MORPH_OP_OPEN, IVE_MORPH_SHAPE_RECT, 15, 15, "OpenR15",
+                  total_run);
+  ret |= run_ctrl(handle, &src, IVE_MORPH_OP_CLOSE, IVE_MORPH_SHAPE_ELLIPSE, 11, 11, "CloseE11",
+                  total_run);
+  ret |= run_ctrl(handle, &src, IVE_MORPH_OP_CLOSE, IVE_MORPH_SHAPE_RECT, 5, 41, "CloseR5x41",
+                  total_run);
+  ret |= run_ctrl(handle, &src, IVE_MORPH_OP_GRADIENT, IVE_MORPH_SHAPE_RECT, 3, 3, "Gradient3",
+                  total_run);
+  ret |= run_ctrl(handle, &src, IVE_MORPH_OP_TOPHAT, IVE_MORPH_SHAPE_CROSS, 9, 15, "TophatX9",
+                  total_run);
+  ret |= run_ctrl(handle, &src, IVE_MORPH_OP_BLACKHAT, IVE_MORPH_SHAPE_RECT, 21, 5, "BlackhatR",
+                  total_run);
+
+  // In place.
+  IVE_IMAGE_S img;
+  CVI_IVE_CreateImage(handle, &img, IVE_IMAGE_TYPE_U8C1, width, height);
+  IVE_MORPH_CTRL_S ctrl = {IVE_MORPH_OP_DILATE, IVE_MORPH_SHAPE_RECT, 9, 7};
+  for (int i = 0; i < 2; i++) {
+    for (CVI_U32 y = 0; y < height; y++) {
+      memcpy(img.pu8VirAddr[0] + y * img.u16Stride[0], src.pu8VirAddr[0] + y * src.u16Stride[0],
+             width);
+    }
+    CVI_IVE_BufFlush(handle, &img);
+    ret |= CVI_IVE_Morph(handle, &img, &img, &ctrl, 0);
+    CVI_IVE_BufRequest(handle, &img);
+    if (cpu_ref(&src, &img, &ctrl) != CVI_SUCCESS) {
+      printf("In place op %d: result is different from the reference.\n", ctrl.enOp);
+      ret = CVI_FAILURE;
+    }
+    ctrl.enOp = IVE_MORPH_OP_TOPHAT;
+    ctrl.enShape = IVE_MORPH_SHAPE_ELLIPSE;
+  }
+  printf("%s\n", ret == CVI_SUCCESS ? "Check passed." : "Check failed.");
+
+  CVI_SYS_FreeI(handle, &img);
+  CVI_SYS_FreeI(handle, &src);
+  CVI_IVE_DestroyHandle(handle);
+  return ret;
+}
+
+int run_ctrl(IVE_HANDLE handle, IVE_IMAGE_S *src, IVE_MORPH_OP_E op, IVE_MORPH_SHAPE_E shape,
+             CVI_U8 width, CVI_U8 height, const char *name, size_t total_run) {
+  IVE_IMAGE_S dst;
+  CVI_IVE_CreateImage(handle, &dst, IVE_IMAGE_TYPE_U8C1, src->u32Width, src->u32Height);
+  IVE_MORPH_CTRL_S ctrl = {op, shape, width, height};
+  int ret = CVI_SUCCESS;
+  struct timeval t0, t1;
+  gettimeofday(&t0, NULL);
+  for (size_t i = 0; i < total_run; i++) {
+    ret |= CVI_IVE_Morph(handle, src, &dst, &ctrl, 0);
+  }
+  gettimeofday(&t1, NULL);
+  unsigned long elapsed_cpu =
+      ((t1.tv_sec - t0.tv_sec) * 1000000 + t1.tv_usec - t0.tv_usec) / total_run;
+  CVI_IVE_BufRequest(handle, &dst);
+  if (cpu_ref(src, &dst, &ctrl) != CVI_SUCCESS) {
+    printf("%s: result is different from the reference.\n", name);
+    ret = CVI_FAILURE;
+  }
+  if (total_run > 1) {
+    printf("OOO %-10s %10s %10lu %10s\n", name, "NA", elapsed_cpu, "NA");
+  }
+  CVI_SYS_FreeI(handle, &dst);
+  return ret;
+}
+
+// Brute force min or max over the element mask, pixels outside the image are skipped.
+void ref_basic(const CVI_U8 *src, int stride, int width, int height, const unsigned char *mask,
+               int rx, int ry, int erode, CVI_U8 *out) {
+  for (int y = 0; y < height; y++) {
+    for (int x = 0; x < width; x++) {
+      int v = erode ? 255 : 0;
+      for (int dy = -ry; dy <= ry; dy++) {
+        for (int dx = -rx; dx <= rx; dx++) {
+          int sx = x + dx, sy = y + dy;
+          if (!mask[(dy + ry) * (2 * rx + 1) + dx + rx] || sx < 0 || sy < 0 || sx >= width ||
+              sy >= height) {
+            continue;
+          }
+          int p = src[sy * stride + sx];
+          v = erode ? (p < v ? p : v) : (p > v ? p : v);
+        }
+      }
+      out[y * width + x] = v;
+    }
+  }
+}
+
+int cpu_ref(IVE_IMAGE_S *src, IVE_IMAGE_S *dst, IVE_MORPH_CTRL_S *ctrl) {
+  const int rx = ctrl->u8Width / 2, ry = ctrl->u8Height / 2, mw = ctrl->u8Width;
+  unsigned char *mask = calloc(ctrl->u8Width * ctrl->u8Height, 1);
+  for (int dy = -ry; dy <= ry; dy++) {
+    for (int dx = -rx; dx <= rx; dx++) {
+      int in = 0;
+      if (ctrl->enShape == IVE_MORPH_SHAPE_RECT) {
+        in = 1;
+      } else if (ctrl->enShape == IVE_MORPH_SHAPE_CROSS) {
+        in = dx == 0 || dy == 0;
+      } else {
+        for (int i = 0; i < 4; i++) {
+          double angle = (2 * i + 1) * M_PI / 16;
+          in |= abs(dx) <= lround(rx * cos(angle)) && abs(dy) <= lround(ry * sin(angle));
+        }
+      }
+      mask[(dy + ry) * mw + dx + rx] = in;
+    }
+  }
+  const int width = src->u32Width, height = src->u32Height, stride = src->u16Stride[0];
+  const CVI_U8 *in = src->pu8VirAddr[0];
+  CVI_U8 *a = malloc(width * height), *b = malloc(width * height);
+  switch (ctrl->enOp) {
+    case IVE_MORPH_OP_ERODE:
+    case IVE_MORPH_OP_DILATE:
+      ref_basic(in, stride, width, height, mask, rx, ry, ctrl->enOp == IVE_MORPH_OP_ERODE, a);
+      break;
+    case IVE_MORPH_OP_OPEN:
+    case IVE_MORPH_OP_TOPHAT:
+      ref_basic(in, stride, width, height, mask, rx, ry, 1, b);
+      ref_basic(b, width, width, height, mask, rx, ry, 0, a);
+      break;
+    case IVE_MORPH_OP_CLOSE:
+    case IVE_MORPH_OP_BLACKHAT:
+      ref_basic(in, stride, width, height, mask, rx, ry, 0, b);
+      ref_basic(b, width, width, height, mask, rx, ry, 1, a);
+      break;
+    default:
+      ref_basic(in, stride, width, height, mask, rx, ry, 0, a);
+      ref_basic(in, stride, width, height, mask, rx, ry, 1, b);
+      break;
+  }
+  int ret = CVI_SUCCESS;
+  for (int y = 0; y < height && ret == CVI_SUCCESS; y++) {
+    for (int x = 0; x < width; x++) {
+      int expected = a[y * width + x];
+      if (ctrl->enOp == IVE_MORPH_OP_GRADIENT) {
+        expected -= b[y * width + x];
+      } else if (ctrl->enOp == IVE_MORPH_OP_TOPHAT) {
+        expected = in[y * stride + x] - expected;
+      } else if (ctrl->enOp == IVE_MORPH_OP_BLACKHAT) {
+        expected -= in[y * stride + x];
+      }
+      int result = dst->pu8VirAddr[0][y * dst->u16Stride[0] + x];
+      if (result != expected) {
+        printf("(%d, %d) mismatch. Result: %d, expected: %d.\n", x, y, result, expected);
+        ret = CVI_FAILURE;
+        break;
+      }
+    }
+  }
+  free(mask);
+  free(a);
+  free(b);
+  return ret;
+}
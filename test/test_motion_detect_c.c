@@ -0,0 +1,211 @@
+#include "cvi_ive.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+
+#define MAX_BLOB_NUM 64
+
+void cpu_mask(IVE_IMAGE_S *cur, IVE_IMAGE_S *ref, CVI_U8 *mask, IVE_MOTION_DETECT_CTRL_S *ctrl);
+CVI_U32 cpu_blobs(CVI_U8 *mask, CVI_U32 width, CVI_U32 height, IVE_MOTION_DETECT_CTRL_S *ctrl,
+                  IVE_MOTION_BLOB_S *blobs);
+int run_mode(IVE_HANDLE handle, IVE_IMAGE_S *cur, IVE_IMAGE_S *ref, IVE_CC_DIR_E mode,
+             CVI_U8 erode_size, CVI_U8 dilate_size, size_t total_run);
+
+int main(int argc, char **argv) {
+  if (argc != 2) {
+    printf("Incorrect loop value. Usage: %s <loop in value (1-1000)>\n", argv[0]);
+    return CVI_FAILURE;
+  }
+  size_t total_run = atoi(argv[1]);
+  printf("Loop value: %zu\n", total_run);
+  if (total_run > 1000 || total_run == 0) {
+    printf("Incorrect loop value. Usage: %s <loop in value (1-1000)>\n", argv[0]);
+    return CVI_FAILURE;
+  }
+  // Create instance
+  IVE_HANDLE handle = CVI_IVE_CreateHandle();
+  printf("BM Kernel init.\n");
+
+  // Moving objects are random rectangles and diagonal lines over a noisy background, with salt
+  // noise that the erosion removes.
+  const CVI_U32 width = 640, height = 480;
+  IVE_IMAGE_S cur, ref;
+  CVI_IVE_CreateImage(handle, &cur, IVE_IMAGE_TYPE_U8C1, width, height);
+  CVI_IVE_CreateImage(handle, &ref, IVE_IMAGE_TYPE_U8C1, width, height);
+  srand(0);
+  for (CVI_U32 y = 0; y < height; y++) {
+    for (CVI_U32 x = 0; x < width; x++) {
+      CVI_U8 v = 100 + rand() % 10;
+      ref.pu8VirAddr[0][y * ref.u16Stride[0] + x] = v;
+      cur.pu8VirAddr[0][y * cur.u16Stride[0] + x] = rand() % 50 == 0 ? 200 : v;
+    }
+  }
+  for (int i = 0; i < 40; i++) {
+    CVI_U32 x0 = rand() % width, y0 = rand() % height;
+    CVI_U32 w = 3 + rand() % 60, h = 3 + rand() % 60;
+    for (CVI_U32 y = y0; y < y0 + h && y < height; y++) {
+      for (CVI_U32 x = x0; x < x0 + w && x < width; x++) {
+        cur.pu8VirAddr[0][y * cur.u16Stride[0] + x] = 30;
+      }
+    }
+  }
+  for (int i = 0; i < 10; i++) {
+    CVI_U32 x0 = rand() % width, y0 = rand() % height;
+    for (CVI_U32 j = 0; j < 80 && x0 + j < width && y0 + j < height; j++) {
+      cur.pu8VirAddr[0][(y0 + j) * cur.u16Stride[0] + x0 + j] = 250;
+    }
+  }
+  CVI_IVE_BufFlush(handle, &cur);
+  CVI_IVE_BufFlush(handle, &ref);
+
+  int ret = CVI_SUCCESS;
+  ret |= run_mode(handle, &cur, &ref, DIRECTION_4, 3, 5, total_run);
+  ret |= run_mode(handle, &cur, &ref, DIRECTION_8, 3, 5, total_run);
+  // Without morphology the diagonal lines are blobs only with 8 connectivity.
+  ret |= run_mode(handle, &cur, &ref, DIRECTION_4, 0, 0, total_run);
+  ret |= run_mode(handle, &cur, &ref, DIRECTION_8, 0, 0, total_run);
+  printf("%s\n", ret == CVI_SUCCESS ? "Check passed." : "Check failed.");
+
+  CVI_SYS_FreeI(handle, &cur);
+  CVI_SYS_FreeI(handle, &ref);
+  CVI_IVE_DestroyHandle(handle);
+  return ret;
+}
+
+int run_mode(IVE_HANDLE handle, IVE_IMAGE_S *cur, IVE_IMAGE_S *ref, IVE_CC_DIR_E mode,
+             CVI_U8 erode_size, CVI_U8 dilate_size, size_t total_run) {
+  const CVI_U32 width = cur->u32Width, height = cur->u32Height;
+  IVE_IMAGE_S mask;
+  CVI_IVE_CreateImage(handle, &mask, IVE_IMAGE_TYPE_U8C1, width, height);
+  IVE_MOTION_DETECT_CTRL_S ctrl;
+  ctrl.u8DiffThr = 20;
+  ctrl.u8ErodeSize = erode_size;
+  ctrl.u8DilateSize = dilate_size;
+  ctrl.enMode = mode;
+  ctrl.u32MinArea = 30;
+
+  int ret = CVI_SUCCESS;
+  IVE_MOTION_BLOB_S blobs[MAX_BLOB_NUM];
+  CVI_U32 blob_num = 0;
+  struct timeval t0, t1;
+  gettimeofday(&t0, NULL);
+  for (size_t i = 0; i < total_run; i++) {
+    ret |= CVI_IVE_MotionDetect(handle, cur, ref, NULL, blobs, MAX_BLOB_NUM, &blob_num, &ctrl, 0);
+  }
+  gettimeofday(&t1, NULL);
+  unsigned long elapsed_cpu =
+      ((t1.tv_sec - t0.tv_sec) * 1000000 + t1.tv_usec - t0.tv_usec) / total_run;
+  ret |= CVI_IVE_MotionDetect(handle, cur, ref, &mask, blobs, MAX_BLOB_NUM, &blob_num, &ctrl, 0);
+
+  CVI_U8 *ref_mask = malloc(width * height);
+  IVE_MOTION_BLOB_S ref_blobs[MAX_BLOB_NUM];
+  cpu_mask(cur, ref, ref_mask, &ctrl);
+  CVI_U32 ref_num = cpu_blobs(ref_mask, width, height, &ctrl, ref_blobs);
+  CVI_IVE_BufRequest(handle, &mask);
+  for (CVI_U32 y = 0; y < height && ret == CVI_SUCCESS; y++) {
+    for (CVI_U32 x = 0; x < width; x++) {
+      CVI_U8 v = mask.pu8VirAddr[0][y * mask.u16Stride[0] + x];
+      if (v != ref_mask[y * width + x]) {
+        printf("Mask (%u, %u) mismatch. Result: %u, expected: %u.\n", x, y, v,
+               ref_mask[y * width + x]);
+        ret = CVI_FAILURE;
+        break;
+      }
+    }
+  }
+  if (blob_num != ref_num || memcmp(blobs, ref_blobs, blob_num * sizeof(blobs[0])) != 0) {
+    printf("Mode %d: blobs are different. Result: %u, expected: %u.\n", mode, blob_num, ref_num);
+    ret = CVI_FAILURE;
+  }
+
+  if (total_run == 1) {
+    printf("Mode %d, erode %u, dilate %u found %u blobs.\n", mode, erode_size, dilate_size,
+           blob_num);
+  } else {
+    printf("OOO %-10s %10s %10lu %10s\n", "MotionDet", "NA", elapsed_cpu, "NA");
+  }
+  free(ref_mask);
+  CVI_SYS_FreeI(handle, &mask);
+  return ret;
+}
+
+// Difference, threshold, erosion and dilation with windows clipped to the image.
+void cpu_mask(IVE_IMAGE_S *cur, IVE_IMAGE_S *ref, CVI_U8 *mask, IVE_MOTION_DETECT_CTRL_S *ctrl) {
+  const int width = cur->u32Width, height = cur->u32Height;
+  CVI_U8 *tmp = malloc(width * height);
+  for (int y = 0; y < height; y++) {
+    for (int x = 0; x < width; x++) {
+      int diff = cur->pu8VirAddr[0][y * cur->u16Stride[0] + x] -
+                 ref->pu8VirAddr[0][y * ref->u16Stride[0] + x];
+      mask[y * width + x] = abs(diff) > ctrl->u8DiffThr ? 255 : 0;
+    }
+  }
+  for (int pass = 0; pass < 2; pass++) {
+    int erode = pass == 0, half = (erode ? ctrl->u8ErodeSize : ctrl->u8DilateSize) / 2;
+    memcpy(tmp, mask, width * height);
+    for (int y = 0; y < height; y++) {
+      for (int x = 0; x < width; x++) {
+        int v = erode ? 255 : 0;
+        for (int i = y - half; i <= y + half; i++) {
+          for (int j = x - half; j <= x + half; j++) {
+            if (i < 0 || j < 0 || i >= height || j >= width) continue;
+            if (erode ? tmp[i * width + j] < v : tmp[i * width + j] > v) v = tmp[i * width + j];
+          }
+        }
+        mask[y * width + x] = v;
+      }
+    }
+  }
+  free(tmp);
+}
+
+// Flood fill labelling, blobs sorted by area and then by their first pixel in raster order.
+CVI_U32 cpu_blobs(CVI_U8 *mask, CVI_U32 width, CVI_U32 height, IVE_MOTION_DETECT_CTRL_S *ctrl,
+                  IVE_MOTION_BLOB_S *blobs) {
+  int *stack = malloc(width * height * sizeof(int));
+  CVI_U8 *visited = calloc(width * height, 1);
+  CVI_U32 num = 0;
+  int conn = ctrl->enMode == DIRECTION_8 ? 8 : 4;
+  const int dx[8] = {1, -1, 0, 0, 1, 1, -1, -1}, dy[8] = {0, 0, 1, -1, 1, -1, 1, -1};
+  IVE_MOTION_BLOB_S all[1024];
+  CVI_U32 all_num = 0;
+  for (CVI_U32 p = 0; p < width * height; p++) {
+    if (mask[p] == 0 || visited[p]) continue;
+    int top = 0, x0 = p % width, x1 = x0, y0 = p / width, y1 = y0;
+    CVI_U32 area = 0;
+    stack[top++] = p;
+    visited[p] = 1;
+    while (top > 0) {
+      int q = stack[--top], qx = q % width, qy = q / width;
+      area++;
+      x0 = qx < x0 ? qx : x0;
+      x1 = qx > x1 ? qx : x1;
+      y1 = qy > y1 ? qy : y1;
+      for (int k = 0; k < conn; k++) {
+        int nx = qx + dx[k], ny = qy + dy[k];
+        if (nx < 0 || ny < 0 || nx >= (int)width || ny >= (int)height) continue;
+        if (mask[ny * width + nx] == 0 || visited[ny * width + nx]) continue;
+        visited[ny * width + nx] = 1;
+        stack[top++] = ny * width + nx;
+      }
+    }
+    if (area >= ctrl->u32MinArea && all_num < 1024) {
+      IVE_MOTION_BLOB_S b = {x0, y0, x1 - x0 + 1, y1 - y0 + 1, area};
+      all[all_num++] = b;
+    }
+  }
+  // Insertion sort keeps the raster order of equal areas.
+  for (CVI_U32 i = 1; i < all_num; i++) {
+    IVE_MOTION_BLOB_S b = all[i];
+    CVI_U32 j = i;
+    for (; j > 0 && all[j - 1].u32Area < b.u32Area; j--) all[j] = all[j - 1];
+    all[j] = b;
+  }
+  num = all_num < MAX_BLOB_NUM ? all_num : MAX_BLOB_NUM;
+  memcpy(blobs, all, num * sizeof(blobs[0]));
+  free(stack);
+  free(visited);
+  return num;
+}
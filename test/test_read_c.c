@@ -4,6 +4,10 @@
 #include <stdlib.h>
 #include <string.h>
 
+#define BATCH_NUM 8
+
+int check_planar(IVE_IMAGE_S *planar, IVE_IMAGE_S *package, int swap);
+
 int main(int argc, char **argv) {
   if (argc != 2) {
     printf("Incorrect loop value. Usage: %s <file_name>\n", argv[0]);
@@ -22,9 +26,68 @@ int main(int argc, char **argv) {
   printf("Save to image.\n");
   CVI_IVE_WriteImage(handle, "test_read_c.png", &src);
 
+  int ret = CVI_SUCCESS;
+  IVE_IMAGE_S package, bgr;
+  memset(&package, 0, sizeof(package));
+  memset(&bgr, 0, sizeof(bgr));
+  ret |= CVI_IVE_ReadImageTo(handle, file_name, &package, IVE_IMAGE_TYPE_U8C3_PACKAGE, 0);
+  ret |= CVI_IVE_ReadImageTo(handle, file_name, &bgr, IVE_IMAGE_TYPE_U8C3_PACKAGE, 1);
+  ret |= check_planar(&src, &package, 0);
+  ret |= check_planar(&src, &bgr, 1);
+
+  // Reading the same size again must not reallocate the image.
+  void *tpu_block = src.tpu_block;
+  memset(src.pu8VirAddr[1], 0, src.u16Stride[1] * src.u32Height);
+  ret |= CVI_IVE_ReadImageTo(handle, file_name, &src, IVE_IMAGE_TYPE_U8C3_PLANAR, 0);
+  if (src.tpu_block != tpu_block) {
+    printf("Image is reallocated.\n");
+    ret = CVI_FAILURE;
+  }
+  ret |= check_planar(&src, &package, 0);
+
+  printf("Run batch loader.\n");
+  const char *file_names[BATCH_NUM];
+  IVE_IMAGE_S batch[BATCH_NUM];
+  memset(batch, 0, sizeof(batch));
+  for (int i = 0; i < BATCH_NUM; i++) {
+    file_names[i] = file_name;
+  }
+  ret |= CVI_IVE_ReadImageBatch(handle, file_names, batch, BATCH_NUM, IVE_IMAGE_TYPE_U8C3_PLANAR,
+                                0, 3);
+  for (int i = 0; i < BATCH_NUM; i++) {
+    ret |= check_planar(&batch[i], &package, 0);
+  }
+  printf("%s\n", ret == CVI_SUCCESS ? "Check passed." : "Check failed.");
+
   // Free memory, instance
+  for (int i = 0; i < BATCH_NUM; i++) {
+    CVI_SYS_FreeI(handle, &batch[i]);
+  }
   CVI_SYS_FreeI(handle, &src);
+  CVI_SYS_FreeI(handle, &package);
+  CVI_SYS_FreeI(handle, &bgr);
   CVI_IVE_DestroyHandle(handle);
 
+  return ret;
+}
+
+int check_planar(IVE_IMAGE_S *planar, IVE_IMAGE_S *package, int swap) {
+  if (planar->tpu_block == NULL || package->tpu_block == NULL ||
+      planar->u32Width != package->u32Width || planar->u32Height != package->u32Height) {
+    printf("Image size mismatch.\n");
+    return CVI_FAILURE;
+  }
+  for (CVI_U32 i = 0; i < planar->u32Height; i++) {
+    for (CVI_U32 j = 0; j < planar->u32Width; j++) {
+      for (int c = 0; c < 3; c++) {
+        CVI_U8 a = planar->pu8VirAddr[c][i * planar->u16Stride[c] + j];
+        CVI_U8 b = package->pu8VirAddr[0][i * package->u16Stride[0] + j * 3 + (swap ? 2 - c : c)];
+        if (a != b) {
+          printf("Channel %d at (%u, %u) mismatch: %u %u.\n", c, j, i, a, b);
+          return CVI_FAILURE;
+        }
+      }
+    }
+  }
   return CVI_SUCCESS;
-}
\ No newline at end of file
+}
@@ -0,0 +1,192 @@
+#include "cvi_ive.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+
+#define ROI_COLS 8
+#define ROI_ROWS 6
+#define ROI_NUM (ROI_COLS * ROI_ROWS)
+
+void fill_random(IVE_HANDLE handle, IVE_IMAGE_S *img, CVI_U8 value);
+int compare_rois(IVE_HANDLE handle, IVE_IMAGE_S *a, IVE_IMAGE_S *b, IVE_ROI_LIST_S *list,
+                 CVI_U32 pad, int tol);
+
+int main(int argc, char **argv) {
+  if (argc != 2) {
+    printf("Incorrect loop value. Usage: %s <loop in value (1-1000)>\n", argv[0]);
+    return CVI_FAILURE;
+  }
+  size_t total_run = atoi(argv[1]);
+  printf("Loop value: %zu\n", total_run);
+  if (total_run > 1000 || total_run == 0) {
+    printf("Incorrect loop value. Usage: %s <loop in value (1-1000)>\n", argv[0]);
+    return CVI_FAILURE;
+  }
+  // Create instance
+  IVE_HANDLE handle = CVI_IVE_CreateHandle();
+  printf("BM Kernel init.\n");
+
+  const CVI_U32 width = 640, height = 480;
+  IVE_IMAGE_S src1, src2, dst_tpu, dst_cpu, dst_full;
+  CVI_IVE_CreateImage(handle, &src1, IVE_IMAGE_TYPE_U8C1, width, height);
+  CVI_IVE_CreateImage(handle, &src2, IVE_IMAGE_TYPE_U8C1, width, height);
+  CVI_IVE_CreateImage(handle, &dst_tpu, IVE_IMAGE_TYPE_U8C1, width, height);
+  CVI_IVE_CreateImage(handle, &dst_cpu, IVE_IMAGE_TYPE_U8C1, width, height);
+  CVI_IVE_CreateImage(handle, &dst_full, IVE_IMAGE_TYPE_U8C1, width, height);
+  srand(0);
+  fill_random(handle, &src1, 0);
+  fill_random(handle, &src2, 0);
+
+  // Non-overlapping ROIs of different sizes on a grid, some of them tiny.
+  IVE_ROI_S rois[ROI_NUM];
+  for (CVI_U32 i = 0; i < ROI_NUM; i++) {
+    CVI_U32 cell_w = width / ROI_COLS, cell_h = height / ROI_ROWS;
+    rois[i].u16X = (i % ROI_COLS) * cell_w + rand() % 8;
+    rois[i].u16Y = (i / ROI_COLS) * cell_h + rand() % 8;
+    rois[i].u16Width = 1 + rand() % (cell_w - 8);
+    rois[i].u16Height = 1 + rand() % (cell_h - 8);
+  }
+  IVE_ROI_LIST_S list;
+  list.u32Num = ROI_NUM;
+  list.pstRois = rois;
+
+  int ret = CVI_SUCCESS;
+  struct timeval t0, t1;
+  unsigned long elapsed_tpu, elapsed_cpu;
+
+  IVE_THRESH_CTRL_S thresh_ctrl;
+  thresh_ctrl.enMode = IVE_THRESH_MODE_BINARY;
+  thresh_ctrl.u8LowThr = 128;
+  thresh_ctrl.u8MinVal = 10;
+  thresh_ctrl.u8MaxVal = 200;
+  fill_random(handle, &dst_tpu, 1);
+  fill_random(handle, &dst_cpu, 1);
+  list.enMode = IVE_ROI_MODE_TPU;
+  gettimeofday(&t0, NULL);
+  for (size_t i = 0; i < total_run; i++) {
+    ret |= CVI_IVE_ThreshROIs(handle, &src1, &dst_tpu, &list, &thresh_ctrl, 0);
+  }
+  gettimeofday(&t1, NULL);
+  elapsed_tpu = ((t1.tv_sec - t0.tv_sec) * 1000000 + t1.tv_usec - t0.tv_usec) / total_run;
+  list.enMode = IVE_ROI_MODE_CPU;
+  gettimeofday(&t0, NULL);
+  for (size_t i = 0; i < total_run; i++) {
+    ret |= CVI_IVE_ThreshROIs(handle, &src1, &dst_cpu, &list, &thresh_ctrl, 0);
+  }
+  gettimeofday(&t1, NULL);
+  elapsed_cpu = ((t1.tv_sec - t0.tv_sec) * 1000000 + t1.tv_usec - t0.tv_usec) / total_run;
+  ret |= CVI_IVE_Thresh(handle, &src1, &dst_full, &thresh_ctrl, 0);
+  if (compare_rois(handle, &dst_tpu, &dst_cpu, &list, 0, 0) != CVI_SUCCESS ||
+      compare_rois(handle, &dst_tpu, &dst_full, &list, 0, 0) != CVI_SUCCESS) {
+    printf("ThreshROIs check failed.\n");
+    ret = CVI_FAILURE;
+  }
+  if (total_run > 1) {
+    printf("OOO %-10s %10lu %10lu %10s\n", "ThreshROIs", elapsed_tpu, elapsed_cpu, "NA");
+  }
+
+  // Every pixel, 0 included, passes a threshold of 0 on both paths.
+  thresh_ctrl.u8LowThr = 0;
+  src1.pu8VirAddr[0][rois[0].u16Y * src1.u16Stride[0] + rois[0].u16X] = 0;
+  CVI_IVE_BufFlush(handle, &src1);
+  fill_random(handle, &dst_full, thresh_ctrl.u8MaxVal);
+  list.enMode = IVE_ROI_MODE_TPU;
+  ret |= CVI_IVE_ThreshROIs(handle, &src1, &dst_tpu, &list, &thresh_ctrl, 0);
+  list.enMode = IVE_ROI_MODE_CPU;
+  ret |= CVI_IVE_ThreshROIs(handle, &src1, &dst_cpu, &list, &thresh_ctrl, 0);
+  if (compare_rois(handle, &dst_tpu, &dst_full, &list, 0, 0) != CVI_SUCCESS ||
+      compare_rois(handle, &dst_cpu, &dst_full, &list, 0, 0) != CVI_SUCCESS) {
+    printf("ThreshROIs with threshold 0 check failed.\n");
+    ret = CVI_FAILURE;
+  }
+
+  IVE_BLEND_CTRL_S blend_ctrl;
+  blend_ctrl.u8Weight = 77;
+  list.enMode = IVE_ROI_MODE_TPU;
+  gettimeofday(&t0, NULL);
+  for (size_t i = 0; i < total_run; i++) {
+    ret |= CVI_IVE_BlendROIs(handle, &src1, &src2, &dst_tpu, &list, &blend_ctrl, 0);
+  }
+  gettimeofday(&t1, NULL);
+  elapsed_tpu = ((t1.tv_sec - t0.tv_sec) * 1000000 + t1.tv_usec - t0.tv_usec) / total_run;
+  list.enMode = IVE_ROI_MODE_CPU;
+  gettimeofday(&t0, NULL);
+  for (size_t i = 0; i < total_run; i++) {
+    ret |= CVI_IVE_BlendROIs(handle, &src1, &src2, &dst_cpu, &list, &blend_ctrl, 0);
+  }
+  gettimeofday(&t1, NULL);
+  elapsed_cpu = ((t1.tv_sec - t0.tv_sec) * 1000000 + t1.tv_usec - t0.tv_usec) / total_run;
+  if (compare_rois(handle, &dst_tpu, &dst_cpu, &list, 0, 1) != CVI_SUCCESS) {
+    printf("BlendROIs check failed.\n");
+    ret = CVI_FAILURE;
+  }
+  if (total_run > 1) {
+    printf("OOO %-10s %10lu %10lu %10s\n", "BlendROIs", elapsed_tpu, elapsed_cpu, "NA");
+  }
+
+  IVE_FILTER_CTRL_S filter_ctrl;
+  CVI_S8 mask[25] = {1, 2, 3, 2, 1, 2, 5, 6, 5, 2, 3, 6, 8, 6, 3, 2, 5, 6, 5, 2, 1, 2, 3, 2, 1};
+  memcpy(filter_ctrl.as8Mask, mask, sizeof(mask));
+  filter_ctrl.u8MaskSize = 5;
+  filter_ctrl.u32Norm = 84;
+  list.enMode = IVE_ROI_MODE_TPU;
+  gettimeofday(&t0, NULL);
+  for (size_t i = 0; i < total_run; i++) {
+    ret |= CVI_IVE_FilterROIs(handle, &src1, &dst_tpu, &list, &filter_ctrl, 0);
+  }
+  gettimeofday(&t1, NULL);
+  elapsed_tpu = ((t1.tv_sec - t0.tv_sec) * 1000000 + t1.tv_usec - t0.tv_usec) / total_run;
+  list.enMode = IVE_ROI_MODE_CPU;
+  gettimeofday(&t0, NULL);
+  for (size_t i = 0; i < total_run; i++) {
+    ret |= CVI_IVE_FilterROIs(handle, &src1, &dst_cpu, &list, &filter_ctrl, 0);
+  }
+  gettimeofday(&t1, NULL);
+  elapsed_cpu = ((t1.tv_sec - t0.tv_sec) * 1000000 + t1.tv_usec - t0.tv_usec) / total_run;
+  if (compare_rois(handle, &dst_tpu, &dst_cpu, &list, 2, 1) != CVI_SUCCESS) {
+    printf("FilterROIs check failed.\n");
+    ret = CVI_FAILURE;
+  }
+  if (total_run > 1) {
+    printf("OOO %-10s %10lu %10lu %10s\n", "FilterROIs", elapsed_tpu, elapsed_cpu, "NA");
+  }
+  printf("%s\n", ret == CVI_SUCCESS ? "Check passed." : "Check failed.");
+
+  CVI_SYS_FreeI(handle, &src1);
+  CVI_SYS_FreeI(handle, &src2);
+  CVI_SYS_FreeI(handle, &dst_tpu);
+  CVI_SYS_FreeI(handle, &dst_cpu);
+  CVI_SYS_FreeI(handle, &dst_full);
+  CVI_IVE_DestroyHandle(handle);
+  return ret;
+}
+
+void fill_random(IVE_HANDLE handle, IVE_IMAGE_S *img, CVI_U8 value) {
+  for (CVI_U32 i = 0; i < img->u16Stride[0] * img->u32Height; i++) {
+    img->pu8VirAddr[0][i] = value ? value : rand() % 256;
+  }
+  CVI_IVE_BufFlush(handle, img);
+}
+
+int compare_rois(IVE_HANDLE handle, IVE_IMAGE_S *a, IVE_IMAGE_S *b, IVE_ROI_LIST_S *list,
+                 CVI_U32 pad, int tol) {
+  CVI_IVE_BufRequest(handle, a);
+  CVI_IVE_BufRequest(handle, b);
+  for (CVI_U32 i = 0; i < list->u32Num; i++) {
+    IVE_ROI_S *roi = &list->pstRois[i];
+    if (roi->u16Width <= 2 * pad || roi->u16Height <= 2 * pad) continue;
+    for (CVI_U32 y = roi->u16Y + pad; y < (CVI_U32)roi->u16Y + roi->u16Height - pad; y++) {
+      for (CVI_U32 x = roi->u16X + pad; x < (CVI_U32)roi->u16X + roi->u16Width - pad; x++) {
+        int va = a->pu8VirAddr[0][y * a->u16Stride[0] + x];
+        int vb = b->pu8VirAddr[0][y * b->u16Stride[0] + x];
+        if (abs(va - vb) > tol) {
+          printf("ROI %u (%u, %u) mismatch: %d, %d.\n", i, x, y, va, vb);
+          return CVI_FAILURE;
+        }
+      }
+    }
+  }
+  return CVI_SUCCESS;
+}
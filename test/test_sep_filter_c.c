@@ -0,0 +1,144 @@
+#include "cvi_ive.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+
+int cpu_ref(IVE_IMAGE_S *src, IVE_IMAGE_S *dst, IVE_SEP_FILTER_CTRL_S *ctrl);
+int run_ctrl(IVE_HANDLE handle, IVE_IMAGE_S *src, IVE_IMAGE_TYPE_E dst_type,
+             IVE_SEP_FILTER_CTRL_S *ctrl, const char *name, size_t total_run);
+
+int main(int argc, char **argv) {
+  if (argc != 2) {
+    printf("Incorrect loop value. Usage: %s <loop in value (1-1000)>\n", argv[0]);
+    return CVI_FAILURE;
+  }
+  size_t total_run = atoi(argv[1]);
+  printf("Loop value: %zu\n", total_run);
+  if (total_run > 1000 || total_run == 0) {
+    printf("Incorrect loop value. Usage: %s <loop in value (1-1000)>\n", argv[0]);
+    return CVI_FAILURE;
+  }
+  // Create instance
+  IVE_HANDLE handle = CVI_IVE_CreateHandle();
+  printf("BM Kernel init.\n");
+
+  // The width is not a multiple of the vector size.
+  const CVI_U32 width = 637, height = 479;
+  IVE_IMAGE_S src;
+  CVI_IVE_CreateImage(handle, &src, IVE_IMAGE_TYPE_U8C1, width, height);
+  srand(0);
+  for (CVI_U32 y = 0; y < height; y++) {
+    for (CVI_U32 x = 0; x < width; x++) {
+      src.pu8VirAddr[0][y * src.u16Stride[0] + x] = ((x / 16 + y / 16) % 2) * 200 + rand() % 56;
+    }
+  }
+  CVI_IVE_BufFlush(handle, &src);
+
+  int ret = CVI_SUCCESS;
+  IVE_SEP_FILTER_CTRL_S ctrl;
+  ret |= CVI_IVE_InitGaussianSepFilterCtrl(6.f, 0, &ctrl);
+  if (ctrl.u8RowSize != IVE_SEP_FILTER_MAX_SIZE) {
+    printf("Gaussian size %u is not capped.\n", ctrl.u8RowSize);
+    ret = CVI_FAILURE;
+  }
+  ret |= run_ctrl(handle, &src, IVE_IMAGE_TYPE_U8C1, &ctrl, "Gauss31", total_run);
+  ctrl.enBorder = IVE_BORDER_MODE_REPLICATE;
+  ret |= run_ctrl(handle, &src, IVE_IMAGE_TYPE_U8C1, &ctrl, "Gauss31Rep", total_run);
+  ret |= CVI_IVE_InitGaussianSepFilterCtrl(1.5f, 7, &ctrl);
+  ctrl.enBorder = IVE_BORDER_MODE_CONSTANT;
+  ctrl.u8BorderVal = 255;
+  ret |= run_ctrl(handle, &src, IVE_IMAGE_TYPE_U8C1, &ctrl, "Gauss7Const", total_run);
+
+  // Sobel 5x5 x derivative to S16.
+  const CVI_S16 deriv[5] = {-1, -2, 0, 2, 1}, smooth[5] = {1, 4, 6, 4, 1};
+  memset(&ctrl, 0, sizeof(ctrl));
+  ctrl.u8RowSize = 5;
+  ctrl.u8ColSize = 5;
+  memcpy(ctrl.as16RowMask, deriv, sizeof(deriv));
+  memcpy(ctrl.as16ColMask, smooth, sizeof(smooth));
+  ctrl.u8ColShift = 2;
+  ctrl.enBorder = IVE_BORDER_MODE_REFLECT_101;
+  ret |= run_ctrl(handle, &src, IVE_IMAGE_TYPE_S16C1, &ctrl, "Sobel5S16", total_run);
+  printf("%s\n", ret == CVI_SUCCESS ? "Check passed." : "Check failed.");
+
+  CVI_SYS_FreeI(handle, &src);
+  CVI_IVE_DestroyHandle(handle);
+  return ret;
+}
+
+int run_ctrl(IVE_HANDLE handle, IVE_IMAGE_S *src, IVE_IMAGE_TYPE_E dst_type,
+             IVE_SEP_FILTER_CTRL_S *ctrl, const char *name, size_t total_run) {
+  IVE_IMAGE_S dst;
+  CVI_IVE_CreateImage(handle, &dst, dst_type, src->u32Width, src->u32Height);
+  int ret = CVI_SUCCESS;
+  struct timeval t0, t1;
+  gettimeofday(&t0, NULL);
+  for (size_t i = 0; i < total_run; i++) {
+    ret |= CVI_IVE_SepFilter(handle, src, &dst, ctrl, 0);
+  }
+  gettimeofday(&t1, NULL);
+  unsigned long elapsed_cpu =
+      ((t1.tv_sec - t0.tv_sec) * 1000000 + t1.tv_usec - t0.tv_usec) / total_run;
+  CVI_IVE_BufRequest(handle, &dst);
+  if (cpu_ref(src, &dst, ctrl) != CVI_SUCCESS) {
+    printf("%s: result is different from the reference.\n", name);
+    ret = CVI_FAILURE;
+  }
+  if (total_run > 1) {
+    printf("OOO %-10s %10s %10lu %10s\n", name, "NA", elapsed_cpu, "NA");
+  }
+  CVI_SYS_FreeI(handle, &dst);
+  return ret;
+}
+
+int ref_index(int i, int n, IVE_BORDER_MODE_E mode) {
+  if (i >= 0 && i < n) return i;
+  if (mode == IVE_BORDER_MODE_CONSTANT) return -1;
+  if (mode == IVE_BORDER_MODE_REPLICATE) return i < 0 ? 0 : n - 1;
+  while (i < 0 || i >= n) i = i < 0 ? -i : 2 * (n - 1) - i;
+  return i;
+}
+
+int clamp(int v, int lo, int hi) { return v < lo ? lo : (v > hi ? hi : v); }
+
+int round_shift(int v, int shift) { return shift > 0 ? (v + (1 << (shift - 1))) >> shift : v; }
+
+// Direct row pass for every output pixel and window row, then the column pass.
+int cpu_ref(IVE_IMAGE_S *src, IVE_IMAGE_S *dst, IVE_SEP_FILTER_CTRL_S *ctrl) {
+  const int width = src->u32Width, height = src->u32Height;
+  const int rh = ctrl->u8RowSize / 2, ch = ctrl->u8ColSize / 2;
+  const int to_u8 = dst->enType == IVE_IMAGE_TYPE_U8C1;
+  for (int y = 0; y < height; y++) {
+    for (int x = 0; x < width; x++) {
+      int col_sum = 0;
+      for (int i = -ch; i <= ch; i++) {
+        int sy = ref_index(y + i, height, ctrl->enBorder);
+        int row_sum = 0;
+        for (int j = -rh; j <= rh; j++) {
+          int sx = ref_index(x + j, width, ctrl->enBorder);
+          int v = sy < 0 || sx < 0 ? ctrl->u8BorderVal
+                                   : src->pu8VirAddr[0][sy * src->u16Stride[0] + sx];
+          row_sum += ctrl->as16RowMask[j + rh] * v;
+        }
+        col_sum += ctrl->as16ColMask[i + ch] *
+                   clamp(round_shift(row_sum, ctrl->u8RowShift), -32768, 32767);
+      }
+      int expected = round_shift(col_sum, ctrl->u8ColShift);
+      int v;
+      if (to_u8) {
+        expected = clamp(expected, 0, 255);
+        v = dst->pu8VirAddr[0][y * dst->u16Stride[0] + x];
+      } else {
+        expected = clamp(expected, -32768, 32767);
+        v = ((CVI_S16 *)(dst->pu8VirAddr[0] + y * dst->u16Stride[0]))[x];
+      }
+      if (v != expected) {
+        printf("(%d, %d) mismatch. Result: %d, expected: %d.\n", x, y, v, expected);
+        return CVI_FAILURE;
+      }
+    }
+  }
+  return CVI_SUCCESS;
+}
@@ -0,0 +1,154 @@
+#include "cvi_ive.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define TEST_W 64
+#define TEST_H 48
+// Odd size, Y4M rounds the chroma planes up to 17 x 9.
+#define ODD_W 33
+#define ODD_H 17
+#define FRAME_NUM 5
+
+CVI_U8 frame_value(int frame, int plane, CVI_U32 x, CVI_U32 y);
+int check_frame(IVE_IMAGE_S *img, int frame, CVI_U32 width, CVI_U32 height);
+int write_sequence(const char *filename, int y4m, CVI_U32 width, CVI_U32 height);
+int check_odd_y4m(IVE_HANDLE handle, const char *filename);
+
+int main(int argc, char **argv) {
+  // Create instance
+  IVE_HANDLE handle = CVI_IVE_CreateHandle();
+  printf("BM Kernel init.\n");
+
+  int ret = CVI_SUCCESS;
+  const char *raw_name = "test_seq_reader_c.yuv";
+  const char *y4m_name = "test_seq_reader_c.y4m";
+  const char *odd_name = "test_seq_reader_c_odd.y4m";
+  if (write_sequence(raw_name, 0, TEST_W, TEST_H) != CVI_SUCCESS ||
+      write_sequence(y4m_name, 1, TEST_W, TEST_H) != CVI_SUCCESS ||
+      write_sequence(odd_name, 1, ODD_W, ODD_H) != CVI_SUCCESS) {
+    printf("Failed to write sequences.\n");
+    return CVI_FAILURE;
+  }
+
+  IVE_IMAGE_S frame;
+  memset(&frame, 0, sizeof(frame));
+  for (int y4m = 0; y4m < 2; y4m++) {
+    IVE_SEQ_READER_S reader;
+    // The type and the size are ignored for Y4M.
+    if (CVI_IVE_OpenSeqReader(handle, y4m ? y4m_name : raw_name, IVE_IMAGE_TYPE_YUV420P,
+                              y4m ? 0 : TEST_W, y4m ? 0 : TEST_H, &reader) != CVI_SUCCESS) {
+      printf("Failed to open sequence.\n");
+      ret = CVI_FAILURE;
+      continue;
+    }
+    if (reader.u32FrameNum != FRAME_NUM || reader.u32Width != TEST_W ||
+        reader.u32Height != TEST_H || reader.enType != IVE_IMAGE_TYPE_YUV420P) {
+      printf("Sequence info mismatch: %u frames %u x %u.\n", reader.u32FrameNum,
+             reader.u32Width, reader.u32Height);
+      ret = CVI_FAILURE;
+    }
+    // Random access, the image is only allocated by the first read.
+    void *tpu_block = NULL;
+    for (int i = FRAME_NUM - 1; i >= 0; i--) {
+      ret |= CVI_IVE_SeqReaderGetFrame(handle, &reader, i, &frame);
+      if (tpu_block != NULL && frame.tpu_block != tpu_block) {
+        printf("Frame image is reallocated.\n");
+        ret = CVI_FAILURE;
+      }
+      tpu_block = frame.tpu_block;
+      CVI_IVE_BufRequest(handle, &frame);
+      ret |= check_frame(&frame, i, TEST_W, TEST_H);
+    }
+    if (CVI_IVE_SeqReaderGetFrame(handle, &reader, FRAME_NUM, &frame) == CVI_SUCCESS) {
+      printf("Out of range frame is returned.\n");
+      ret = CVI_FAILURE;
+    }
+    CVI_IVE_CloseSeqReader(handle, &reader);
+  }
+  ret |= check_odd_y4m(handle, odd_name);
+  printf("%s\n", ret == CVI_SUCCESS ? "Check passed." : "Check failed.");
+
+  // Free memory, instance
+  CVI_SYS_FreeI(handle, &frame);
+  CVI_IVE_DestroyHandle(handle);
+  remove(raw_name);
+  remove(y4m_name);
+  remove(odd_name);
+
+  return ret;
+}
+
+CVI_U8 frame_value(int frame, int plane, CVI_U32 x, CVI_U32 y) {
+  return (CVI_U8)(frame * 31 + plane * 67 + x * 3 + y * 5);
+}
+
+int check_frame(IVE_IMAGE_S *img, int frame, CVI_U32 width, CVI_U32 height) {
+  for (int k = 0; k < 3; k++) {
+    CVI_U32 w = k == 0 ? width : (width + 1) / 2;
+    CVI_U32 h = k == 0 ? height : (height + 1) / 2;
+    for (CVI_U32 y = 0; y < h; y++) {
+      for (CVI_U32 x = 0; x < w; x++) {
+        if (img->pu8VirAddr[k][y * img->u16Stride[k] + x] != frame_value(frame, k, x, y)) {
+          printf("Frame %d plane %d mismatch at (%u, %u).\n", frame, k, x, y);
+          return CVI_FAILURE;
+        }
+      }
+    }
+  }
+  return CVI_SUCCESS;
+}
+
+int write_sequence(const char *filename, int y4m, CVI_U32 width, CVI_U32 height) {
+  FILE *fp = fopen(filename, "wb");
+  if (fp == NULL) {
+    return CVI_FAILURE;
+  }
+  if (y4m) {
+    fprintf(fp, "YUV4MPEG2 W%u H%u F30:1 Ip A1:1 C420jpeg\n", width, height);
+  }
+  for (int i = 0; i < FRAME_NUM; i++) {
+    if (y4m) {
+      fprintf(fp, "FRAME\n");
+    }
+    for (int k = 0; k < 3; k++) {
+      CVI_U32 w = k == 0 ? width : (width + 1) / 2;
+      CVI_U32 h = k == 0 ? height : (height + 1) / 2;
+      for (CVI_U32 y = 0; y < h; y++) {
+        for (CVI_U32 x = 0; x < w; x++) {
+          fputc(frame_value(i, k, x, y), fp);
+        }
+      }
+    }
+  }
+  // A truncated trailing frame is not counted.
+  fputc(0, fp);
+  fclose(fp);
+  return CVI_SUCCESS;
+}
+
+int check_odd_y4m(IVE_HANDLE handle, const char *filename) {
+  IVE_SEQ_READER_S reader;
+  if (CVI_IVE_OpenSeqReader(handle, filename, IVE_IMAGE_TYPE_YUV420P, 0, 0, &reader) !=
+      CVI_SUCCESS) {
+    printf("Failed to open odd size sequence.\n");
+    return CVI_FAILURE;
+  }
+  int ret = CVI_SUCCESS;
+  if (reader.u32FrameNum != FRAME_NUM || reader.u32Width != ODD_W || reader.u32Height != ODD_H) {
+    printf("Odd size sequence info mismatch: %u frames %u x %u.\n", reader.u32FrameNum,
+           reader.u32Width, reader.u32Height);
+    ret = CVI_FAILURE;
+  }
+  IVE_IMAGE_S frame;
+  memset(&frame, 0, sizeof(frame));
+  for (CVI_U32 i = 0; i < reader.u32FrameNum; i++) {
+    ret |= CVI_IVE_SeqReaderGetFrame(handle, &reader, i, &frame);
+    CVI_IVE_BufRequest(handle, &frame);
+    ret |= check_frame(&frame, i, ODD_W, ODD_H);
+  }
+  CVI_IVE_CloseSeqReader(handle, &reader);
+  CVI_SYS_FreeI(handle, &frame);
+  return ret;
+}
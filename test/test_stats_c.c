@@ -0,0 +1,156 @@
+#include "cvi_ive.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+
+#define ROI_NUM 3
+
+int cpu_ref(IVE_SRC_IMAGE_S *src, IVE_SRC_IMAGE_S *mask, IVE_STATS_ROI_S *roi,
+            IVE_STATS_S *stats);
+
+int main(int argc, char **argv) {
+  if (argc != 3) {
+    printf("Incorrect loop value. Usage: %s <file name> <loop in value (1-1000)>\n", argv[0]);
+    return CVI_FAILURE;
+  }
+  const char *filename = argv[1];
+  size_t total_run = atoi(argv[2]);
+  printf("Loop value: %zu\n", total_run);
+  if (total_run > 1000 || total_run == 0) {
+    printf("Incorrect loop value. Usage: %s <file name> <loop in value (1-1000)>\n", argv[0]);
+    return CVI_FAILURE;
+  }
+  // Create instance
+  IVE_HANDLE handle = CVI_IVE_CreateHandle();
+  int ret = CVI_SUCCESS;
+  printf("BM Kernel init.\n");
+
+  // Fetch image information
+  IVE_IMAGE_S src = CVI_IVE_ReadImage(handle, filename, IVE_IMAGE_TYPE_U8C1);
+  int width = src.u32Width;
+  int height = src.u32Height;
+  printf("Image size is %d X %d\n", width, height);
+
+  // Signed copy of the input and a checkerboard mask.
+  IVE_IMAGE_S src_s16, mask;
+  CVI_IVE_CreateImage(handle, &src_s16, IVE_IMAGE_TYPE_S16C1, width, height);
+  CVI_IVE_CreateImage(handle, &mask, IVE_IMAGE_TYPE_U8C1, width, height);
+  for (int i = 0; i < height; i++) {
+    CVI_S16 *ptr = (CVI_S16 *)(src_s16.pu8VirAddr[0] + i * src_s16.u16Stride[0]);
+    for (int j = 0; j < width; j++) {
+      ptr[j] = (src.pu8VirAddr[0][i * src.u16Stride[0] + j] - 128) * 200;
+      mask.pu8VirAddr[0][i * mask.u16Stride[0] + j] = ((i / 16 + j / 16) % 2) * 255;
+    }
+  }
+  CVI_IVE_BufFlush(handle, &src_s16);
+  CVI_IVE_BufFlush(handle, &mask);
+
+  IVE_STATS_ROI_S rois[ROI_NUM] = {{0, 0, (CVI_U16)width, (CVI_U16)height},
+                                   {(CVI_U16)(width / 4), (CVI_U16)(height / 4),
+                                    (CVI_U16)(width / 2), (CVI_U16)(height / 2)},
+                                   {(CVI_U16)(width - 7), (CVI_U16)(height - 3), 7, 3}};
+  IVE_STATS_CTRL_S ctrl;
+  ctrl.pstRoi = rois;
+  ctrl.u32RoiNum = ROI_NUM;
+  IVE_STATS_S stats[ROI_NUM];
+
+  printf("Run CPU stats.\n");
+  struct timeval t0, t1;
+  gettimeofday(&t0, NULL);
+  for (size_t i = 0; i < total_run; i++) {
+    ret |= CVI_IVE_Stats(handle, &src, NULL, stats, NULL, 0);
+  }
+  gettimeofday(&t1, NULL);
+  unsigned long elapsed_cpu =
+      ((t1.tv_sec - t0.tv_sec) * 1000000 + t1.tv_usec - t0.tv_usec) / total_run;
+  ret |= cpu_ref(&src, NULL, &rois[0], &stats[0]);
+
+  float average = 0;
+  ret |= CVI_IVE_Average(handle, &src, &average, 0);
+  if (fabsf(average - stats[0].f32Mean) > 1e-3f) {
+    printf("Average %f does not match mean %f.\n", average, stats[0].f32Mean);
+    ret = CVI_FAILURE;
+  }
+
+  IVE_IMAGE_S *inputs[2] = {&src, &src_s16};
+  IVE_IMAGE_S *masks[2] = {NULL, &mask};
+  for (int i = 0; i < 2; i++) {
+    for (int j = 0; j < 2; j++) {
+      ret |= CVI_IVE_Stats(handle, inputs[i], masks[j], stats, &ctrl, 0);
+      for (int k = 0; k < ROI_NUM; k++) {
+        ret |= cpu_ref(inputs[i], masks[j], &rois[k], &stats[k]);
+      }
+    }
+  }
+
+  if (total_run == 1) {
+    printf("Mean %f, stddev %f, min %f at (%u, %u), max %f at (%u, %u).\n", stats[0].f32Mean,
+           stats[0].f32Stddev, stats[0].f32Min, stats[0].u16MinX, stats[0].u16MinY,
+           stats[0].f32Max, stats[0].u16MaxX, stats[0].u16MaxY);
+  } else {
+    printf("OOO %-10s %10s %10lu %10s\n", "Stats", "NA", elapsed_cpu, "NA");
+  }
+  printf("%s\n", ret == CVI_SUCCESS ? "Check passed." : "Check failed.");
+
+  // Free memory, instance
+  CVI_SYS_FreeI(handle, &src);
+  CVI_SYS_FreeI(handle, &src_s16);
+  CVI_SYS_FreeI(handle, &mask);
+  CVI_IVE_DestroyHandle(handle);
+
+  return ret;
+}
+
+int cpu_ref(IVE_SRC_IMAGE_S *src, IVE_SRC_IMAGE_S *mask, IVE_STATS_ROI_S *roi,
+            IVE_STATS_S *stats) {
+  double sum = 0, sq_sum = 0;
+  float min = 0, max = 0;
+  CVI_U32 count = 0, min_x = 0, min_y = 0, max_x = 0, max_y = 0;
+  for (CVI_U32 i = roi->u16Y; i < (CVI_U32)roi->u16Y + roi->u16Height; i++) {
+    for (CVI_U32 j = roi->u16X; j < (CVI_U32)roi->u16X + roi->u16Width; j++) {
+      if (mask != NULL && mask->pu8VirAddr[0][i * mask->u16Stride[0] + j] == 0) {
+        continue;
+      }
+      float val = src->enType == IVE_IMAGE_TYPE_S16C1
+                      ? ((CVI_S16 *)(src->pu8VirAddr[0] + i * src->u16Stride[0]))[j]
+                      : src->pu8VirAddr[0][i * src->u16Stride[0] + j];
+      if (count == 0 || val < min) {
+        min = val;
+        min_x = j;
+        min_y = i;
+      }
+      if (count == 0 || val > max) {
+        max = val;
+        max_x = j;
+        max_y = i;
+      }
+      sum += val;
+      sq_sum += (double)val * val;
+      count++;
+    }
+  }
+  if (stats->u32Count != count || stats->dSum != sum || stats->dSqSum != sq_sum) {
+    printf("Count/sum mismatch. IVE %u %f %f, CPU %u %f %f\n", stats->u32Count, stats->dSum,
+           stats->dSqSum, count, sum, sq_sum);
+    return CVI_FAILURE;
+  }
+  if (count == 0) {
+    return CVI_SUCCESS;
+  }
+  double mean = sum / count;
+  double stddev = sqrt(sq_sum / count - mean * mean);
+  if (fabs(stats->f32Mean - mean) > 1e-3 * (fabs(mean) + 1) ||
+      fabs(stats->f32Stddev - stddev) > 1e-3 * (stddev + 1) || stats->f32Min != min ||
+      stats->f32Max != max || stats->u16MinX != min_x || stats->u16MinY != min_y ||
+      stats->u16MaxX != max_x || stats->u16MaxY != max_y) {
+    printf("Stats mismatch. IVE %f %f %f (%u, %u) %f (%u, %u), CPU %f %f %f (%u, %u) %f (%u, %u)\n",
+           stats->f32Mean, stats->f32Stddev, stats->f32Min, stats->u16MinX, stats->u16MinY,
+           stats->f32Max, stats->u16MaxX, stats->u16MaxY, mean, stddev, min, min_x, min_y, max,
+           max_x, max_y);
+    return CVI_FAILURE;
+  }
+  return CVI_SUCCESS;
+}
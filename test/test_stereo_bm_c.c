@@ -0,0 +1,159 @@
+#include "cvi_ive.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+
+#define INVALID_DISP 255
+
+int true_disp(CVI_U32 x, CVI_U32 y);
+int cpu_ref(IVE_IMAGE_S *left, IVE_IMAGE_S *right, IVE_IMAGE_S *disp,
+            IVE_STEREO_BM_CTRL_S *ctrl);
+
+int main(int argc, char **argv) {
+  if (argc != 2) {
+    printf("Incorrect loop value. Usage: %s <loop in value (1-1000)>\n", argv[0]);
+    return CVI_FAILURE;
+  }
+  size_t total_run = atoi(argv[1]);
+  printf("Loop value: %zu\n", total_run);
+  if (total_run > 1000 || total_run == 0) {
+    printf("Incorrect loop value. Usage: %s <loop in value (1-1000)>\n", argv[0]);
+    return CVI_FAILURE;
+  }
+  // Create instance
+  IVE_HANDLE handle = CVI_IVE_CreateHandle();
+  printf("BM Kernel init.\n");
+
+  // The left image is the right texture moved by true_disp.
+  const CVI_U32 width = 320, height = 240;
+  IVE_IMAGE_S left, right, disp;
+  CVI_IVE_CreateImage(handle, &left, IVE_IMAGE_TYPE_U8C1, width, height);
+  CVI_IVE_CreateImage(handle, &right, IVE_IMAGE_TYPE_U8C1, width, height);
+  CVI_IVE_CreateImage(handle, &disp, IVE_IMAGE_TYPE_U8C1, width, height);
+  srand(0);
+  for (CVI_U32 y = 0; y < height; y++) {
+    for (CVI_U32 x = 0; x < width; x++) {
+      right.pu8VirAddr[0][y * right.u16Stride[0] + x] = rand() % 256;
+    }
+  }
+  for (CVI_U32 y = 0; y < height; y++) {
+    for (CVI_U32 x = 0; x < width; x++) {
+      int sx = (int)x - true_disp(x, y);
+      left.pu8VirAddr[0][y * left.u16Stride[0] + x] =
+          right.pu8VirAddr[0][y * right.u16Stride[0] + (sx < 0 ? 0 : sx)];
+    }
+  }
+  CVI_IVE_BufFlush(handle, &left);
+  CVI_IVE_BufFlush(handle, &right);
+
+  IVE_STEREO_BM_CTRL_S ctrl;
+  ctrl.u8WinSize = 9;
+  ctrl.u16NumDisp = 48;
+  ctrl.u8UniquenessRatio = 10;
+  ctrl.s8MaxLRDiff = 1;
+  ctrl.u8InvalidVal = INVALID_DISP;
+
+  int ret = CVI_SUCCESS;
+  struct timeval t0, t1;
+  gettimeofday(&t0, NULL);
+  for (size_t i = 0; i < total_run; i++) {
+    ret |= CVI_IVE_StereoBM(handle, &left, &right, &disp, NULL, &ctrl, 0);
+  }
+  gettimeofday(&t1, NULL);
+  unsigned long elapsed_cpu =
+      ((t1.tv_sec - t0.tv_sec) * 1000000 + t1.tv_usec - t0.tv_usec) / total_run;
+
+  CVI_IVE_BufRequest(handle, &disp);
+  if (cpu_ref(&left, &right, &disp, &ctrl) != CVI_SUCCESS) {
+    ret = CVI_FAILURE;
+  }
+  CVI_U32 valid = 0, correct = 0;
+  for (CVI_U32 y = 0; y < height; y++) {
+    for (CVI_U32 x = 0; x < width; x++) {
+      CVI_U8 d = disp.pu8VirAddr[0][y * disp.u16Stride[0] + x];
+      if (d == INVALID_DISP) continue;
+      valid++;
+      correct += d == true_disp(x, y);
+    }
+  }
+  printf("Valid %u, correct %u.\n", valid, correct);
+  if (valid < width * height / 2 || correct < valid * 95 / 100) {
+    ret = CVI_FAILURE;
+  }
+  if (total_run > 1) {
+    printf("OOO %-10s %10s %10lu %10s\n", "StereoBM", "NA", elapsed_cpu, "NA");
+  }
+  printf("%s\n", ret == CVI_SUCCESS ? "Check passed." : "Check failed.");
+
+  CVI_SYS_FreeI(handle, &left);
+  CVI_SYS_FreeI(handle, &right);
+  CVI_SYS_FreeI(handle, &disp);
+  CVI_IVE_DestroyHandle(handle);
+  return ret;
+}
+
+// A near rectangle in front of a far plane.
+int true_disp(CVI_U32 x, CVI_U32 y) { return x >= 100 && x < 220 && y >= 60 && y < 180 ? 20 : 6; }
+
+// Brute force search with the same tie breaking and checks.
+int cpu_ref(IVE_IMAGE_S *left, IVE_IMAGE_S *right, IVE_IMAGE_S *disp,
+            IVE_STEREO_BM_CTRL_S *ctrl) {
+  const int width = left->u32Width, height = left->u32Height;
+  const int half = ctrl->u8WinSize / 2, num_disp = ctrl->u16NumDisp;
+  int *cost = malloc(num_disp * sizeof(int));
+  int *best = malloc(width * sizeof(int));
+  int *right_cost = malloc(width * sizeof(int));
+  int *right_disp = malloc(width * sizeof(int));
+  int ret = CVI_SUCCESS;
+  for (int y = 0; y < height && ret == CVI_SUCCESS; y++) {
+    for (int x = 0; x < width; x++) {
+      best[x] = -1;
+      right_cost[x] = 1 << 30;
+    }
+    for (int x = half; y >= half && y + half < height && x + half < width; x++) {
+      int max_d = x - half < num_disp - 1 ? x - half : num_disp - 1;
+      int b = 0;
+      for (int d = 0; d <= max_d; d++) {
+        cost[d] = 0;
+        for (int i = -half; i <= half; i++) {
+          for (int j = -half; j <= half; j++) {
+            cost[d] += abs(left->pu8VirAddr[0][(y + i) * left->u16Stride[0] + x + j] -
+                           right->pu8VirAddr[0][(y + i) * right->u16Stride[0] + x + j - d]);
+          }
+        }
+        if (cost[d] < cost[b]) b = d;
+        if (cost[d] < right_cost[x - d]) {
+          right_cost[x - d] = cost[d];
+          right_disp[x - d] = d;
+        }
+      }
+      best[x] = b;
+      for (int d = 0; d <= max_d; d++) {
+        if (abs(d - b) > 1 && cost[d] * 100 < cost[b] * (100 + ctrl->u8UniquenessRatio)) {
+          best[x] = -1;
+          break;
+        }
+      }
+    }
+    for (int x = 0; x < width; x++) {
+      int d = best[x];
+      if (d >= 0 && abs(right_disp[x - d] - d) > ctrl->s8MaxLRDiff) {
+        d = -1;
+      }
+      int expected = d < 0 ? INVALID_DISP : d;
+      CVI_U8 v = disp->pu8VirAddr[0][y * disp->u16Stride[0] + x];
+      if (v != expected) {
+        printf("(%d, %d) mismatch. Result: %u, expected: %d.\n", x, y, v, expected);
+        ret = CVI_FAILURE;
+        break;
+      }
+    }
+  }
+  free(cost);
+  free(best);
+  free(right_cost);
+  free(right_disp);
+  return ret;
+}
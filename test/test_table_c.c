@@ -9,7 +9,12 @@
 
 #define TEST_W 16
 #define TEST_H 10
+// Large enough to be dispatched to the TPU.
+#define TEST_LARGE_W 640
+#define TEST_LARGE_H 480
 
+int run_map(IVE_HANDLE handle, IVE_IMAGE_TYPE_E enType, CVI_U32 width, CVI_U32 height,
+            CVI_U32 max_val, size_t total_run, const char *name);
 int cpu_ref(IVE_SRC_IMAGE_S *src, IVE_MEM_INFO_S *table, IVE_DST_IMAGE_S *dst);
 
 int main(int argc, char **argv) {
@@ -28,29 +33,55 @@ int main(int argc, char **argv) {
   IVE_HANDLE handle = CVI_IVE_CreateHandle();
   printf("BM Kernel init.\n");
 
+  int ret = CVI_SUCCESS;
+  ret |= run_map(handle, IVE_IMAGE_TYPE_U8C1, TEST_W, TEST_H, 256, total_run, "MAP");
+  ret |= run_map(handle, IVE_IMAGE_TYPE_U16C1, TEST_W, TEST_H, 512, total_run, "MAP512");
+  ret |= run_map(handle, IVE_IMAGE_TYPE_U8C1, TEST_LARGE_W, TEST_LARGE_H, 256, total_run, "MAPL");
+  ret |= run_map(handle, IVE_IMAGE_TYPE_U16C1, TEST_LARGE_W, TEST_LARGE_H, 512, total_run,
+                 "MAP512L");
+  // U16 values above 511 map to the last entry on both the CPU and the TPU path.
+  ret |= run_map(handle, IVE_IMAGE_TYPE_U16C1, TEST_W, TEST_H, 65536, total_run, "MAP512C");
+  ret |= run_map(handle, IVE_IMAGE_TYPE_U16C1, TEST_LARGE_W, TEST_LARGE_H, 65536, total_run,
+                 "MAP512CL");
+
+  CVI_IVE_DestroyHandle(handle);
+
+  return ret;
+}
+
+int run_map(IVE_HANDLE handle, IVE_IMAGE_TYPE_E enType, CVI_U32 width, CVI_U32 height,
+            CVI_U32 max_val, size_t total_run, const char *name) {
+  const CVI_U32 dstTblByteSize = enType == IVE_IMAGE_TYPE_U16C1 ? 512 : 256;
   IVE_SRC_IMAGE_S src;
-  CVI_IVE_CreateImage(handle, &src, IVE_IMAGE_TYPE_U8C1, TEST_W, TEST_H);
-  CVI_U32 srcLength = (CVI_U32)(TEST_W * TEST_H);
-  for (CVI_U32 i = 0; i < srcLength; i++) {
-    src.pu8VirAddr[0][i] = rand() % 256;
+  CVI_IVE_CreateImage(handle, &src, enType, width, height);
+  for (CVI_U32 i = 0; i < height; i++) {
+    for (CVI_U32 j = 0; j < width; j++) {
+      if (enType == IVE_IMAGE_TYPE_U16C1) {
+        // Every row starts with the largest value so that the clamp is always hit.
+        ((CVI_U16 *)(src.pu8VirAddr[0] + i * src.u16Stride[0]))[j] =
+            j == 0 ? max_val - 1 : (CVI_U32)rand() % max_val;
+      } else {
+        src.pu8VirAddr[0][i * src.u16Stride[0] + j] = rand() % dstTblByteSize;
+      }
+    }
   }
   CVI_IVE_BufFlush(handle, &src);
 
   IVE_DST_IMAGE_S dst;
-  CVI_IVE_CreateImage(handle, &dst, IVE_IMAGE_TYPE_U8C1, TEST_W, TEST_H);
+  CVI_IVE_CreateImage(handle, &dst, IVE_IMAGE_TYPE_U8C1, width, height);
 
   IVE_DST_MEM_INFO_S dstTbl;
-  CVI_U32 dstTblByteSize = 256;
   CVI_IVE_CreateMemInfo(handle, &dstTbl, dstTblByteSize);
   for (CVI_U32 i = 0; i < dstTblByteSize; i++) {
-    dstTbl.pu8VirAddr[i] = dstTblByteSize - 1 - i;
+    dstTbl.pu8VirAddr[i] = (dstTblByteSize - 1 - i) * 7 + 3;
   }
 
-  printf("Run TPU Map.\n");
+  printf("Run %s %u x %u.\n", name, width, height);
+  int ret = CVI_SUCCESS;
   struct timeval t0, t1;
   gettimeofday(&t0, NULL);
   for (size_t i = 0; i < total_run; i++) {
-    CVI_IVE_Map(handle, &src, &dstTbl, &dst, 0);
+    ret |= CVI_IVE_Map(handle, &src, &dstTbl, &dst, 0);
   }
   gettimeofday(&t1, NULL);
   unsigned long elapsed_tpu =
@@ -58,39 +89,41 @@ int main(int argc, char **argv) {
 
   CVI_IVE_BufRequest(handle, &src);
   CVI_IVE_BufRequest(handle, &dst);
-  int ret = cpu_ref(&src, &dstTbl, &dst);
+  ret |= cpu_ref(&src, &dstTbl, &dst);
 
   if (total_run == 1) {
-    printf("TPU avg time %lu\n", elapsed_tpu);
+    printf("%s avg time %lu\n", name, elapsed_tpu);
   }
 #ifdef __ARM_ARCH
   else {
-    printf("OOO %-10s %10lu %10s %10s\n", "MAP", elapsed_tpu, "NA", "NA");
+    printf("OOO %-10s %10lu %10s %10s\n", name, elapsed_tpu, "NA", "NA");
   }
 #endif
 
-  // Free memory, instance
+  // Free memory
   CVI_SYS_FreeI(handle, &src);
   CVI_SYS_FreeI(handle, &dst);
   CVI_SYS_FreeM(handle, &dstTbl);
-  CVI_IVE_DestroyHandle(handle);
-
   return ret;
 }
 
 int cpu_ref(IVE_SRC_IMAGE_S *src, IVE_MEM_INFO_S *table, IVE_DST_IMAGE_S *dst) {
   printf("Check table result: ");
   int ret = CVI_SUCCESS;
-  CVI_U32 srcLength = (CVI_U32)(TEST_W * TEST_H);
-  for (CVI_U32 i = 0; i < srcLength; i++) {
-    CVI_U8 src_val = src->pu8VirAddr[0][i];
-    CVI_U8 value = table->pu8VirAddr[src_val];
-    if (value != dst->pu8VirAddr[0][i]) {
-      printf("Value at index %u are not the same: TPU %u, CPU %u\n", i, dst->pu8VirAddr[0][i],
-             value);
-      ret = CVI_FAILURE;
+  for (CVI_U32 i = 0; i < src->u32Height && ret == CVI_SUCCESS; i++) {
+    for (CVI_U32 j = 0; j < src->u32Width; j++) {
+      CVI_U32 src_val = src->enType == IVE_IMAGE_TYPE_U16C1
+                            ? ((CVI_U16 *)(src->pu8VirAddr[0] + i * src->u16Stride[0]))[j]
+                            : src->pu8VirAddr[0][i * src->u16Stride[0] + j];
+      CVI_U8 value = table->pu8VirAddr[src_val > 511 ? 511 : src_val];
+      CVI_U8 dst_val = dst->pu8VirAddr[0][i * dst->u16Stride[0] + j];
+      if (value != dst_val) {
+        printf("Value at (%u, %u) are not the same: TPU %u, CPU %u\n", j, i, dst_val, value);
+        ret = CVI_FAILURE;
+        break;
+      }
     }
   }
   printf("%s\n", ret == CVI_SUCCESS ? "passed" : "failed");
   return ret;
-}
\ No newline at end of file
+}
@@ -0,0 +1,114 @@
+#include "cvi_ive.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+
+int compare_image(IVE_IMAGE_S *a, IVE_IMAGE_S *b);
+
+int main(int argc, char **argv) {
+  if (argc != 2) {
+    printf("Incorrect loop value. Usage: %s <loop in value (1-1000)>\n", argv[0]);
+    return CVI_FAILURE;
+  }
+  size_t total_run = atoi(argv[1]);
+  printf("Loop value: %zu\n", total_run);
+  if (total_run > 1000 || total_run == 0) {
+    printf("Incorrect loop value. Usage: %s <loop in value (1-1000)>\n", argv[0]);
+    return CVI_FAILURE;
+  }
+  // Create instance
+  IVE_HANDLE handle = CVI_IVE_CreateHandle();
+  printf("BM Kernel init.\n");
+
+  IVE_IMAGE_S src;
+  CVI_IVE_CreateImage(handle, &src, IVE_IMAGE_TYPE_YUV420P, 640, 480);
+  VIDEO_FRAME_INFO_S frame;
+  int ret = CVI_IVE_Image2VideoFrameInfo(&src, &frame);
+
+  // The uncached conversion is the reference.
+  IVE_IMAGE_S ref;
+  memset(&ref, 0, sizeof(ref));
+  ret |= CVI_IVE_VideoFrameInfo2Image(&frame, &ref);
+
+  IVE_IMAGE_S img1, img2;
+  memset(&img1, 0, sizeof(img1));
+  memset(&img2, 0, sizeof(img2));
+  ret |= CVI_IVE_VideoFrameInfo2ImageCached(handle, &frame, &img1);
+  ret |= CVI_IVE_VideoFrameInfo2ImageCached(handle, &frame, &img2);
+  if (compare_image(&img1, &ref) != CVI_SUCCESS || img1.tpu_block != img2.tpu_block) {
+    printf("Cached wrapper is incorrect.\n");
+    ret = CVI_FAILURE;
+  }
+  CVI_IMG_S *wrapper = img1.tpu_block;
+  CVI_SYS_FreeI(handle, &img1);
+  CVI_SYS_FreeI(handle, &img2);
+
+  // A released wrapper is reused by the same frame.
+  ret |= CVI_IVE_VideoFrameInfo2ImageCached(handle, &frame, &img1);
+  if (img1.tpu_block != wrapper) {
+    printf("Wrapper is not reused.\n");
+    ret = CVI_FAILURE;
+  }
+  // Invalidation while in use keeps the image valid until it is released.
+  ret |= CVI_IVE_InvalidateVideoFrame(handle, frame.stVFrame.u64PhyAddr[1]);
+  if (compare_image(&img1, &ref) != CVI_SUCCESS) {
+    printf("Wrapper in use is dropped.\n");
+    ret = CVI_FAILURE;
+  }
+  CVI_SYS_FreeI(handle, &img1);
+  ret |= CVI_IVE_VideoFrameInfo2ImageCached(handle, &frame, &img1);
+  if (compare_image(&img1, &ref) != CVI_SUCCESS) {
+    printf("Wrapper after invalidation is incorrect.\n");
+    ret = CVI_FAILURE;
+  }
+  // A cached wrapper needs its handle, the image is kept when the handle is missing.
+  if (CVI_SYS_FreeI(NULL, &img1) == CVI_SUCCESS || img1.tpu_block == NULL ||
+      compare_image(&img1, &ref) != CVI_SUCCESS) {
+    printf("Cached wrapper is freed without handle.\n");
+    ret = CVI_FAILURE;
+  }
+  CVI_SYS_FreeI(handle, &img1);
+
+  struct timeval t0, t1;
+  gettimeofday(&t0, NULL);
+  for (size_t i = 0; i < total_run; i++) {
+    CVI_IVE_VideoFrameInfo2ImageCached(handle, &frame, &img1);
+    CVI_SYS_FreeI(handle, &img1);
+  }
+  gettimeofday(&t1, NULL);
+  unsigned long elapsed_cached =
+      ((t1.tv_sec - t0.tv_sec) * 1000000 + t1.tv_usec - t0.tv_usec) / total_run;
+  gettimeofday(&t0, NULL);
+  for (size_t i = 0; i < total_run; i++) {
+    CVI_IVE_VideoFrameInfo2Image(&frame, &img1);
+    CVI_SYS_FreeI(handle, &img1);
+  }
+  gettimeofday(&t1, NULL);
+  unsigned long elapsed_new =
+      ((t1.tv_sec - t0.tv_sec) * 1000000 + t1.tv_usec - t0.tv_usec) / total_run;
+  if (total_run > 1) {
+    printf("OOO %-10s %10lu %10lu %10s\n", "VF2Image", elapsed_cached, elapsed_new, "NA");
+  }
+  printf("%s\n", ret == CVI_SUCCESS ? "Check passed." : "Check failed.");
+
+  ret |= CVI_IVE_InvalidateVideoFrame(handle, 0);
+  CVI_SYS_FreeI(handle, &ref);
+  CVI_SYS_FreeI(handle, &src);
+  CVI_IVE_DestroyHandle(handle);
+  return ret;
+}
+
+int compare_image(IVE_IMAGE_S *a, IVE_IMAGE_S *b) {
+  if (a->enType != b->enType || a->u32Width != b->u32Width || a->u32Height != b->u32Height) {
+    return CVI_FAILURE;
+  }
+  for (int i = 0; i < 3; i++) {
+    if (a->pu8VirAddr[i] != b->pu8VirAddr[i] || a->u64PhyAddr[i] != b->u64PhyAddr[i] ||
+        a->u16Stride[i] != b->u16Stride[i]) {
+      return CVI_FAILURE;
+    }
+  }
+  return CVI_SUCCESS;
+}
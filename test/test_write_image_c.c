@@ -0,0 +1,107 @@
+#include "cvi_ive.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+
+#define TEST_W 97
+#define TEST_H 61
+#define FRAME_NUM 16
+
+int compare_image(IVE_IMAGE_S *a, IVE_IMAGE_S *b);
+
+int main(int argc, char **argv) {
+  // Create instance
+  IVE_HANDLE handle = CVI_IVE_CreateHandle();
+  printf("BM Kernel init.\n");
+
+  IVE_IMAGE_S src;
+  CVI_IVE_CreateImage(handle, &src, IVE_IMAGE_TYPE_U8C3_PLANAR, TEST_W, TEST_H);
+  for (int k = 0; k < 3; k++) {
+    for (CVI_U32 i = 0; i < TEST_H; i++) {
+      for (CVI_U32 j = 0; j < TEST_W; j++) {
+        src.pu8VirAddr[k][i * src.u16Stride[k] + j] = rand() % 256;
+      }
+    }
+  }
+  CVI_IVE_BufFlush(handle, &src);
+
+  int ret = CVI_SUCCESS;
+  // Every format is read back and compared with the source.
+  const char *names[] = {"test_write_image_c.png", "test_write_image_c.ppm",
+                         "test_write_image_c.raw"};
+  for (int i = 0; i < 3; i++) {
+    ret |= CVI_IVE_WriteImageAsync(handle, names[i], &src, IVE_WRITE_FORMAT_AUTO);
+  }
+  CVI_U32 drop_num = 0;
+  ret |= CVI_IVE_AsyncWriterFlush(handle, &drop_num);
+  if (drop_num != 0) {
+    printf("%u images are dropped.\n", drop_num);
+    ret = CVI_FAILURE;
+  }
+  for (int i = 0; i < 2; i++) {
+    IVE_IMAGE_S img = CVI_IVE_ReadImage(handle, names[i], IVE_IMAGE_TYPE_U8C3_PLANAR);
+    ret |= compare_image(&src, &img);
+    CVI_SYS_FreeI(handle, &img);
+  }
+  IVE_IMAGE_S raw;
+  memset(&raw, 0, sizeof(raw));
+  ret |= CVI_IVE_ReadRawImage(handle, &raw, names[2], IVE_IMAGE_TYPE_U8C3_PLANAR, TEST_W, TEST_H);
+  ret |= compare_image(&src, &raw);
+  CVI_SYS_FreeI(handle, &raw);
+
+  // A blocking writer keeps every frame, the calling thread only pays for the copy.
+  IVE_ASYNC_WRITER_CTRL_S ctrl;
+  ctrl.u32QueueDepth = 4;
+  ctrl.enPolicy = IVE_ASYNC_WRITE_POLICY_BLOCK;
+  ret |= CVI_IVE_AsyncWriterInit(handle, &ctrl);
+  struct timeval t0, t1;
+  gettimeofday(&t0, NULL);
+  for (int i = 0; i < FRAME_NUM; i++) {
+    ret |= CVI_IVE_WriteImageAsync(handle, "test_write_image_c_seq.ppm", &src,
+                                   IVE_WRITE_FORMAT_PNM);
+  }
+  gettimeofday(&t1, NULL);
+  ret |= CVI_IVE_AsyncWriterFlush(handle, &drop_num);
+  unsigned long elapsed = ((t1.tv_sec - t0.tv_sec) * 1000000 + t1.tv_usec - t0.tv_usec);
+  if (drop_num != 0) {
+    printf("Blocking writer dropped %u images.\n", drop_num);
+    ret = CVI_FAILURE;
+  }
+  printf("Queued %d frames in %lu us.\n", FRAME_NUM, elapsed);
+
+  // U16C1 has no PNG representation.
+  IVE_IMAGE_S u16;
+  CVI_IVE_CreateImage(handle, &u16, IVE_IMAGE_TYPE_U16C1, TEST_W, TEST_H);
+  if (CVI_IVE_WriteImageAsync(handle, "test_write_image_c.png", &u16, IVE_WRITE_FORMAT_PNG) ==
+      CVI_SUCCESS) {
+    printf("Unsupported type is accepted.\n");
+    ret = CVI_FAILURE;
+  }
+  printf("%s\n", ret == CVI_SUCCESS ? "Check passed." : "Check failed.");
+
+  // Free memory, instance
+  CVI_SYS_FreeI(handle, &u16);
+  CVI_SYS_FreeI(handle, &src);
+  CVI_IVE_DestroyHandle(handle);
+
+  return ret;
+}
+
+int compare_image(IVE_IMAGE_S *a, IVE_IMAGE_S *b) {
+  if (a->u32Width != b->u32Width || a->u32Height != b->u32Height || a->enType != b->enType) {
+    printf("Image format mismatch.\n");
+    return CVI_FAILURE;
+  }
+  for (int k = 0; k < 3; k++) {
+    for (CVI_U32 i = 0; i < a->u32Height; i++) {
+      if (memcmp(a->pu8VirAddr[k] + i * a->u16Stride[k], b->pu8VirAddr[k] + i * b->u16Stride[k],
+                 a->u32Width) != 0) {
+        printf("Plane %d row %u mismatch.\n", k, i);
+        return CVI_FAILURE;
+      }
+    }
+  }
+  return CVI_SUCCESS;
+}